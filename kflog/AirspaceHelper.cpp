@@ -17,21 +17,106 @@
 
 #include <QtCore>
 
+#include "airspacecache.h"
 #include "AirspaceHelper.h"
 #include "mapcontents.h"
 #include "OpenAip.h"
 #include "openairparser.h"
+#include "projectionbase.h"
 #include "resource.h"
 
-extern QSettings _settings;
-
 QMap<QString, BaseMapElement::objectType> AirspaceHelper::m_airspaceTypeMap;
 
 QSet<int> AirspaceHelper::m_airspaceDictionary;
 
 QMutex AirspaceHelper::m_mutex;
 
-int AirspaceHelper::loadAirspaces( QList<Airspace>& list )
+/**
+ * \class AirspaceFileTask
+ *
+ * \brief Loads one airspace file in a worker thread.
+ */
+class AirspaceFileTask : public QRunnable
+{
+ public:
+
+  AirspaceFileTask( const QString& fileName,
+                    const QByteArray& projection,
+                    AirspaceHelper::FileResult* result ) :
+    m_fileName(fileName),
+    m_projection(projection),
+    m_result(result)
+  {
+    setAutoDelete( true );
+  };
+
+  virtual ~AirspaceFileTask()
+  {
+  };
+
+  virtual void run();
+
+ private:
+
+  QString m_fileName;
+  QByteArray m_projection;
+  AirspaceHelper::FileResult* m_result;
+};
+
+void AirspaceFileTask::run()
+{
+  bool isOpenAir = m_fileName.endsWith(QString(".TXT")) ||
+                   m_fileName.endsWith(QString(".txt"));
+
+  bool isOpenAip = m_fileName.endsWith(QString(".aip"));
+
+  if( ! isOpenAir && ! isOpenAip )
+    {
+      return;
+    }
+
+  QDataStream in( m_projection );
+  ProjectionBase* projection = LoadProjection( in );
+
+  // The parsed airspaces of every file are stored in a compiled form beside
+  // the file and are taken from there at the next start.
+  AirspaceCache cache( projection );
+
+  if( cache.load( m_fileName, m_result->airspaces ) )
+    {
+      m_result->ok = true;
+      m_result->compiled = true;
+      delete projection;
+      return;
+    }
+
+  QString errorInfo;
+
+  if( isOpenAir )
+    {
+      OpenAirParser oap;
+      oap.setProjection( projection );
+      m_result->ok = oap.parse( m_fileName, m_result->airspaces );
+    }
+  else
+    {
+      OpenAip oaip;
+      oaip.setProjection( projection );
+      m_result->ok = oaip.readAirspaces( m_fileName, m_result->airspaces, errorInfo );
+    }
+
+  if( m_result->ok && cache.save( m_fileName, m_result->airspaces ) == false )
+    {
+      qWarning() << "ASH: Cannot write compiled airspace file for" << m_fileName;
+    }
+
+  delete projection;
+}
+
+int AirspaceHelper::loadAirspaces( QList<Airspace>& list,
+                                   const QString& mapDir,
+                                   const QStringList& fileList,
+                                   const QByteArray& projection )
 {
   // Set a global lock during execution to avoid calls in parallel.
   QMutexLocker locker( &m_mutex );
@@ -40,13 +125,13 @@ int AirspaceHelper::loadAirspaces( QList<Airspace>& list )
 
   m_airspaceDictionary.clear();
 
-  QString mapDir = MapContents::instance()->getMapRootDirectory() + "/airspaces";
+  QString airspaceDir = mapDir + "/airspaces";
   QStringList preselect;
 
   // Setup a filter for the desired file extensions.
   QString filter = "*.txt *.TXT *.aip";
 
-  MapContents::addDir( preselect, mapDir, filter );
+  MapContents::addDir( preselect, airspaceDir, filter );
 
   if( preselect.count() == 0 )
     {
@@ -55,7 +140,7 @@ int AirspaceHelper::loadAirspaces( QList<Airspace>& list )
     }
 
   // Check, which files shall be loaded.
-  QStringList files = _settings.value( "/Airspace/FileList", QStringList(QString("All"))).toStringList();
+  const QStringList& files = fileList;
 
   if( files.isEmpty() )
     {
@@ -79,46 +164,65 @@ int AirspaceHelper::loadAirspaces( QList<Airspace>& list )
         }
     }
 
-  OpenAirParser oap;
-  OpenAip oaip;
-  QString errorInfo;
+  if( m_airspaceTypeMap.isEmpty() )
+    {
+      // The type mapping is used by all parser threads.
+      loadAirspaceTypeMapping();
+    }
+
+  // The projection objects are not thread safe. Every task works with its
+  // own copy of the passed map projection.
+  //
+  // Every file is parsed by its own task. The tasks store their results
+  // in the slot of their file, so that no locking is necessary.
+  QVector<FileResult> results( preselect.size() );
 
-  while( ! preselect.isEmpty() )
+  QThreadPool pool;
+  pool.setMaxThreadCount( qMax( 1, QThread::idealThreadCount() ) );
+
+  for( int i = 0; i < preselect.size(); i++ )
     {
-      QString srcName;
+      pool.start( new AirspaceFileTask( preselect.at(i), projection, &results[i] ) );
+    }
 
-      if( preselect.first().endsWith(QString(".TXT")) ||
-	  preselect.first().endsWith(QString(".txt")) )
-        {
-          srcName = preselect.first();
+  pool.waitForDone();
 
-          if( oap.parse(srcName, list) )
-            {
-              loadCounter++;
-            }
+  uint compiledCounter = 0;
+
+  // The results are merged in the order of the files, as they were
+  // loaded before.
+  for( int f = 0; f < results.size(); f++ )
+    {
+      const FileResult& result = results.at(f);
 
-          preselect.removeAt(0);
+      if( ! result.ok )
+        {
           continue;
         }
 
-      if( preselect.first().endsWith(QString(".aip")) )
+      loadCounter++;
+
+      if( result.compiled )
         {
-          // there can't be the same name aic after this aip
-          // parse found aip file
-          srcName = preselect.first();
+          compiledCounter++;
+        }
 
-          if( oaip.readAirspaces(srcName, list, errorInfo ) )
+      const bool isOpenAip = preselect.at(f).endsWith(QString(".aip"));
+
+      for( int i = 0; i < result.airspaces.size(); i++ )
+        {
+          // there can't be the same openAIP airspace in two files
+          if( isOpenAip && ! addAirspaceIdentifier( result.airspaces.at(i).getId() ) )
             {
-              loadCounter++;
+              continue;
             }
 
-          preselect.removeAt(0);
-          continue;
+          list.append( result.airspaces.at(i) );
         }
+    }
 
-    } // End of While
-
-  qDebug("ASH: %d Airspace file(s) loaded in %dms", loadCounter, t.elapsed());
+  qDebug("ASH: %d Airspace file(s) loaded in %dms, %d of them compiled",
+         loadCounter, t.elapsed(), compiledCounter);
 
 //    for(int i=0; i < list.size(); i++ )
 //      {
@@ -281,11 +385,20 @@ AirspaceHelper::initializeAirspaceTypeMapping(const QString& mapFilePath)
 
 #include <csignal>
 
-AirspaceHelperThread::AirspaceHelperThread( QObject *parent ) :
-  QThread( parent )
+AirspaceHelperThread::AirspaceHelperThread( const QString& mapDir,
+                                            const QStringList& fileList,
+                                            const QByteArray& projection,
+                                            QObject *parent ) :
+  QThread( parent ),
+  m_mapDir( mapDir ),
+  m_fileList( fileList ),
+  m_projection( projection )
 {
   setObjectName( "AirspaceHelperThread" );
 
+  // The list is passed via a queued connection to the receiver.
+  qRegisterMetaType<SortableAirspaceList *>( "SortableAirspaceList*" );
+
   // Activate self destroy after finish signal has been caught.
   connect( this, SIGNAL(finished()), this, SLOT(deleteLater()) );
 }
@@ -313,7 +426,8 @@ void AirspaceHelperThread::run()
 
   SortableAirspaceList* airspaceList = new SortableAirspaceList;
 
-  int ok = AirspaceHelper::loadAirspaces( *airspaceList );
+  int ok = AirspaceHelper::loadAirspaces( *airspaceList, m_mapDir,
+                                          m_fileList, m_projection );
 
   /* It is expected that a receiver slot is connected to this signal. The
    * receiver is responsible to delete the passed lists. Otherwise a big
@@ -69,13 +69,27 @@ class AirspaceHelper
 
   /**
    * Searches on a default place for OpenAir and OpenAip airspace files.
+   * The files are parsed in parallel on a pool of worker threads, the
+   * results are merged in the order of the files.
    *
    * @returns The number of successfully loaded files
    *
    * @param list The list where the Airspace objects should be added from the
    *        read files.
+   *
+   * @param mapDir The map root directory.
+   *
+   * @param fileList The names of the files to be loaded or "All".
+   *
+   * @param projection The map projection, stored by SaveProjection.
+   *
+   * The values are passed by the caller, because this method runs in an
+   * extra thread, which must not use the configuration or the map matrix.
    */
-  static int loadAirspaces( QList<Airspace>& list );
+  static int loadAirspaces( QList<Airspace>& list,
+                            const QString& mapDir,
+                            const QStringList& fileList,
+                            const QByteArray& projection );
 
   /**
    * Initialize a mapping from an airspace type string to the KFLog integer type.
@@ -148,6 +162,27 @@ class AirspaceHelper
 
  private:
 
+  friend class AirspaceFileTask;
+
+  /**
+   * Result of the load of one airspace file.
+   */
+  class FileResult
+  {
+   public:
+
+    FileResult() : ok(false), compiled(false) {};
+
+    /** True, if the file has been loaded. */
+    bool ok;
+
+    /** True, if the file has been taken from its compiled form. */
+    bool compiled;
+
+    /** The airspaces of the file. */
+    QList<Airspace> airspaces;
+  };
+
   /**
    * Creates a mapping from a string representation of the supported
    * airspace types in KFLog to their integer codes.
@@ -195,7 +230,19 @@ class AirspaceHelperThread : public QThread
 
  public:
 
-  AirspaceHelperThread( QObject *parent=0 );
+  /**
+   * The passed values are taken in the main thread.
+   *
+   * \param mapDir The map root directory.
+   *
+   * \param fileList The names of the airspace files to be loaded or "All".
+   *
+   * \param projection The map projection, stored by SaveProjection.
+   */
+  AirspaceHelperThread( const QString& mapDir,
+                        const QStringList& fileList,
+                        const QByteArray& projection,
+                        QObject *parent=0 );
 
   virtual ~AirspaceHelperThread();
 
@@ -217,6 +264,12 @@ class AirspaceHelperThread : public QThread
   *
   */
   void loadedList( int loadedLists, SortableAirspaceList* airspaceList );
+
+ private:
+
+  QString m_mapDir;
+  QStringList m_fileList;
+  QByteArray m_projection;
 };
 
 #endif /* AIRSPACE_HELPER_H */
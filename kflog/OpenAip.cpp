@@ -26,7 +26,9 @@ extern QSettings  _settings;
 
 OpenAip::OpenAip() :
   m_filterRadius(0.0),
-  m_filterRunwayLength(0.0)
+  m_filterRunwayLength(0.0),
+  m_projection(0),
+  m_hasFilterValues(false)
 {
   m_supportedDataFormats << "1.0" << "1.1";
 }
@@ -35,6 +37,16 @@ OpenAip::~OpenAip()
 {
 }
 
+QPoint OpenAip::projectPoint( const int lat, const int lon ) const
+{
+  if( m_projection != 0 )
+    {
+      return MapMatrix::wgsToMap( m_projection, lat, lon );
+    }
+
+  return _globalMapMatrix->wgsToMap( lat, lon );
+}
+
 bool OpenAip::getRootElement( QString fileName,
                               QString& dataFormat,
                               QString& dataItem )
@@ -410,7 +422,7 @@ bool OpenAip::readGeoLocation( QXmlStreamReader& xml, SinglePoint& sp )
                   sp.setWGSPosition( wgsPoint );
 
                   // Map WGS point to map projection
-                  sp.setPosition( _globalMapMatrix->wgsToMap(wgsPoint) );
+                  sp.setPosition( projectPoint( ilat, ilon ) );
                 }
 
               if( elev != INT_MIN )
@@ -1618,14 +1630,29 @@ QString OpenAip::shortName( const QString& name )
   return shortName;
 }
 
+OpenAip::FilterValues OpenAip::userFilterValues()
+{
+  FilterValues values;
+
+  values.countries = _settings.value( "/Points/Countries", "" ).toString();
+  values.home      = _globalMapMatrix->getHomeCoord();
+
+  // Get filter radius around the home position in kilometers.
+  values.radius = _settings.value( "/Points/HomeRadius", 0 ).toDouble();
+
+  return values;
+}
+
 void OpenAip::loadUserFilterValues()
 {
+  // The values set by the caller are used instead of the configuration.
+  const FilterValues values = m_hasFilterValues ? m_filterValues : userFilterValues();
+
   m_countryFilterSet.clear();
-  m_filterRadius = 0.0;
 
-  m_homePosition = _globalMapMatrix->getHomeCoord();
+  m_homePosition = values.home;
 
-  QString cFilter = _settings.value( "/Points/Countries", "" ).toString().toUpper();
+  QString cFilter = values.countries.toUpper();
 
   QStringList clist = cFilter.split( QRegExp("[, ]"), QString::SkipEmptyParts );
 
@@ -1634,8 +1661,7 @@ void OpenAip::loadUserFilterValues()
       m_countryFilterSet.insert( clist.at(i) );
     }
 
-  // Get filter radius around the home position in kilometers.
-  m_filterRadius = _settings.value( "/Points/HomeRadius", 0 ).toDouble();
+  m_filterRadius = values.radius;
 
   // Get runway length filter in meters.
   // m_filterRunwayLength = 0.0;
@@ -1687,6 +1713,10 @@ bool OpenAip::readAirspaces( QString fileName,
   int elementCounter   = 0;
   bool oaipFormatOk = false;
 
+  // Identifiers of the read airspaces. The files are read in parallel,
+  // duplicates between files are removed by the caller.
+  QSet<int> airspaceIds;
+
   // Reset version and data format variable
   m_oaipVersion.clear();
   m_oaipDataFormat.clear();
@@ -1754,8 +1784,9 @@ bool OpenAip::readAirspaces( QString fileName,
                       continue;
                     }
 
-                  if( AirspaceHelper::addAirspaceIdentifier(as.getId()) )
+                  if( ! airspaceIds.contains( as.getId() ) )
                     {
+                      airspaceIds.insert( as.getId() );
                       airspaceList.append( as.createAirspaceObject() );
                     }
                   else
@@ -2118,7 +2149,7 @@ bool OpenAip::readAirspaceGeometrie( QXmlStreamReader& xml, Airspace& as )
       int lonInt = static_cast<int> (rint(600000.0 * lon));
 
       // Project coordinates to map datum and store them in a polygon
-      asPolygon.setPoint( i/2, _globalMapMatrix->wgsToMap( latInt, lonInt ) );
+      asPolygon.setPoint( i/2, projectPoint( latInt, lonInt ) );
     }
 
   if( asPolygon.count() < 2 )
@@ -35,6 +35,7 @@
 
 #include <QList>
 #include <QMap>
+#include <QPoint>
 #include <QSet>
 #include <QString>
 #include <QXmlStreamReader>
@@ -44,10 +45,32 @@
 #include "altitude.h"
 #include "radiopoint.h"
 
+class ProjectionBase;
+
 class OpenAip
 {
  public:
 
+  /**
+   * The user's filter values of the point data. They are taken in the main
+   * thread and passed to readers running in other threads.
+   */
+  class FilterValues
+  {
+   public:
+
+    FilterValues() : radius(0.0) {};
+
+    /** Countries as two letter codes, separated by commas or blanks. */
+    QString countries;
+
+    /** Home position, used as center point for the radius filter. */
+    QPoint home;
+
+    /** Radius in Km around the home position, <= 0 switches it off. */
+    double radius;
+  };
+
   OpenAip();
 
   virtual ~OpenAip();
@@ -157,8 +180,44 @@ class OpenAip
       return m_shortNameSet;
     };
 
+  /**
+   * Sets the projection used for the map positions of the read items. The
+   * caller keeps the ownership. Without a projection the one of the global
+   * map matrix is used, which must not be done outside of the main thread.
+   *
+   * \param projection Projection private to the caller.
+   */
+  void setProjection( ProjectionBase* projection )
+    {
+      m_projection = projection;
+    };
+
+  /**
+   * Sets the filter values used by the read methods. Without them the
+   * user's filter values are read from the configuration, which must not
+   * be done outside of the main thread.
+   *
+   * \param values Filter values taken by \ref userFilterValues.
+   */
+  void setFilterValues( const FilterValues& values )
+    {
+      m_filterValues = values;
+      m_hasFilterValues = true;
+    };
+
+  /**
+   * \return The user's filter values from the configuration. Must be called
+   *         in the main thread.
+   */
+  static FilterValues userFilterValues();
+
  private:
 
+  /**
+   * Projects a WGS84 position with the set projection.
+   */
+  QPoint projectPoint( const int lat, const int lon ) const;
+
   /**
    * Read version and format attribute from OPENAIP tag. Returns true in case
    * of success otherwise false.
@@ -279,6 +338,15 @@ class OpenAip
 
   /** Contains all short names of parsed file. */
   QSet<QString> m_shortNameSet;
+
+  /** Projection of the map positions, if not the global one is used. */
+  ProjectionBase* m_projection;
+
+  /** Filter values set by the caller. */
+  FilterValues m_filterValues;
+
+  /** True, if the filter values have been set by the caller. */
+  bool m_hasFilterValues;
 };
 
 #endif /* OpenAip_h */
@@ -18,15 +18,137 @@
 #include "mapcontents.h"
 #include "OpenAip.h"
 #include "OpenAipPoiLoader.h"
-
-extern QSettings _settings;
+#include "poicache.h"
+#include "projectionbase.h"
 
 // set static member variable
 QMutex OpenAipPoiLoader::m_mutexAf;
 QMutex OpenAipPoiLoader::m_mutexNa;
 QMutex OpenAipPoiLoader::m_mutexHs;
 
-OpenAipPoiLoader::OpenAipPoiLoader()
+/**
+ * \class OpenAipPoiTask
+ *
+ * \brief Loads one openAIP point file in a worker thread.
+ */
+class OpenAipPoiTask : public QRunnable
+{
+ public:
+
+  OpenAipPoiTask( const QString& fileName,
+                  const OpenAipPoiLoader::FileKind kind,
+                  const QByteArray& projection,
+                  const OpenAip::FilterValues& filter,
+                  const QByteArray& filterKey,
+                  OpenAipPoiLoader::FileResult* result ) :
+    m_fileName(fileName),
+    m_kind(kind),
+    m_projection(projection),
+    m_filter(filter),
+    m_filterKey(filterKey),
+    m_result(result)
+  {
+    setAutoDelete( true );
+  };
+
+  virtual ~OpenAipPoiTask()
+  {
+  };
+
+  virtual void run();
+
+ private:
+
+  QString m_fileName;
+  OpenAipPoiLoader::FileKind m_kind;
+  QByteArray m_projection;
+  OpenAip::FilterValues m_filter;
+  QByteArray m_filterKey;
+  OpenAipPoiLoader::FileResult* m_result;
+};
+
+void OpenAipPoiTask::run()
+{
+  // The projection objects are not thread safe. Every task works with its
+  // own copy of the current map projection.
+  QDataStream in( m_projection );
+  ProjectionBase* projection = LoadProjection( in );
+
+  PoiCache cache( m_filterKey, projection );
+  OpenAip openAip;
+  openAip.setProjection( projection );
+  openAip.setFilterValues( m_filter );
+
+  QString errorInfo;
+  OpenAipPoiLoader::FileResult* r = m_result;
+
+  switch( m_kind )
+    {
+      case OpenAipPoiLoader::AirfieldFiles:
+
+        r->compiled = cache.load( m_fileName, r->airfields );
+
+        if( ! r->compiled )
+          {
+            r->ok = openAip.readAirfields( m_fileName, r->airfields, errorInfo, true );
+
+            if( r->ok )
+              {
+                cache.save( m_fileName, r->airfields );
+              }
+          }
+
+        break;
+
+      case OpenAipPoiLoader::NavaidFiles:
+
+        r->compiled = cache.load( m_fileName, r->navaids );
+
+        if( ! r->compiled )
+          {
+            r->ok = openAip.readNavAids( m_fileName, r->navaids, errorInfo, true );
+
+            if( r->ok )
+              {
+                cache.save( m_fileName, r->navaids );
+              }
+          }
+
+        break;
+
+      case OpenAipPoiLoader::HotspotFiles:
+
+        r->compiled = cache.load( m_fileName, r->hotspots );
+
+        if( ! r->compiled )
+          {
+            r->ok = openAip.readHotspots( m_fileName, r->hotspots, errorInfo, true );
+
+            if( r->ok )
+              {
+                cache.save( m_fileName, r->hotspots );
+              }
+          }
+
+        break;
+    }
+
+  if( r->compiled )
+    {
+      r->ok = true;
+    }
+
+  delete projection;
+}
+
+OpenAipPoiLoader::OpenAipPoiLoader( const QString& mapDir,
+                                    const QStringList& fileList,
+                                    const QByteArray& projection,
+                                    const OpenAip::FilterValues& filter ) :
+  m_mapDir(mapDir),
+  m_fileList(fileList),
+  m_projection(projection),
+  m_filter(filter)
 {
 }
 
@@ -43,7 +165,7 @@ int OpenAipPoiLoader::load( QList<Airfield>& airfieldList )
   t.start();
   int loadCounter = 0; // number of successfully loaded files
 
-  QString mapDir = MapContents::instance()->getMapRootDirectory() + "/points";
+  QString mapDir = m_mapDir + "/points";
   QStringList preselect;
 
   // Setup a filter for the desired file extensions.
@@ -58,7 +180,7 @@ int OpenAipPoiLoader::load( QList<Airfield>& airfieldList )
     }
 
   // Check, which files shall be loaded.
-  QStringList files = _settings.value( "/Points/FileList", QStringList(QString("All"))).toStringList();
+  const QStringList& files = m_fileList;
 
   if( files.isEmpty() )
     {
@@ -81,29 +203,29 @@ int OpenAipPoiLoader::load( QList<Airfield>& airfieldList )
         }
     }
 
-  while( ! preselect.isEmpty() )
+  // The files are loaded in parallel and merged in their order.
+  QVector<FileResult> results = __loadFiles( preselect, AirfieldFiles );
+  int compiledCounter = 0; // number of files loaded from their compiled form
+
+  for( int i = 0; i < results.size(); i++ )
     {
-      QString srcName;
-      OpenAip openAip;
-      QString errorInfo;
-
-      srcName = preselect.first();
-
-      // Remove source file to be read from the list.
-      preselect.removeAt(0);
-
-      bool ok = openAip.readAirfields( srcName,
-				       airfieldList,
-				       errorInfo,
-				       true );
-      if( ok )
-	{
-	  loadCounter++;
-	}
+      const FileResult& result = results.at(i);
+
+      if( result.ok )
+        {
+          loadCounter++;
+        }
+
+      if( result.compiled )
+        {
+          compiledCounter++;
+        }
+
+      airfieldList += result.airfields;
     }
 
-  qDebug( "OAIP: %d airfield file(s) with %d items loaded in %dms",
-          loadCounter, airfieldList.size(), t.elapsed() );
+  qDebug( "OAIP: %d airfield file(s) with %d items loaded in %dms, %d of them compiled",
+          loadCounter, airfieldList.size(), t.elapsed(), compiledCounter );
 
   return loadCounter;
 }
@@ -117,7 +239,7 @@ int OpenAipPoiLoader::load( QList<RadioPoint>& navaidsList )
   t.start();
   int loadCounter = 0; // number of successfully loaded files
 
-  QString mapDir = MapContents::instance()->getMapRootDirectory() + "/points";
+  QString mapDir = m_mapDir + "/points";
   QStringList preselect;
 
   // Setup a filter for the desired file extensions.
@@ -132,7 +254,7 @@ int OpenAipPoiLoader::load( QList<RadioPoint>& navaidsList )
     }
 
   // Check, which files shall be loaded.
-  QStringList files = _settings.value( "/Points/FileList", QStringList(QString("All"))).toStringList();
+  const QStringList& files = m_fileList;
 
   if( files.isEmpty() )
     {
@@ -155,30 +277,29 @@ int OpenAipPoiLoader::load( QList<RadioPoint>& navaidsList )
         }
     }
 
-  while( ! preselect.isEmpty() )
-    {
-      QString srcName;
-      OpenAip openAip;
-      QString errorInfo;
+  // The files are loaded in parallel and merged in their order.
+  QVector<FileResult> results = __loadFiles( preselect, NavaidFiles );
+  int compiledCounter = 0; // number of files loaded from their compiled form
 
-      srcName = preselect.first();
+  for( int i = 0; i < results.size(); i++ )
+    {
+      const FileResult& result = results.at(i);
 
-      // Remove source file to be read from the list.
-      preselect.removeAt(0);
+      if( result.ok )
+        {
+          loadCounter++;
+        }
 
-      bool ok = openAip.readNavAids( srcName,
-                                     navaidsList,
-				     errorInfo,
-				     true );
+      if( result.compiled )
+        {
+          compiledCounter++;
+        }
 
-      if( ok )
-	{
-	  loadCounter++;
-	}
+      navaidsList += result.navaids;
     }
 
-  qDebug( "OAIP: %d navaid file(s) with %d items loaded in %dms",
-          loadCounter, navaidsList.size(), t.elapsed() );
+  qDebug( "OAIP: %d navaid file(s) with %d items loaded in %dms, %d of them compiled",
+          loadCounter, navaidsList.size(), t.elapsed(), compiledCounter );
 
   return loadCounter;
 }
@@ -192,7 +313,7 @@ int OpenAipPoiLoader::load( QList<SinglePoint>& hotspotList )
   t.start();
   int loadCounter = 0; // number of successfully loaded files
 
-  QString mapDir = MapContents::instance()->getMapRootDirectory() + "/points";
+  QString mapDir = m_mapDir + "/points";
   QStringList preselect;
 
   // Setup a filter for the desired file extensions.
@@ -207,7 +328,7 @@ int OpenAipPoiLoader::load( QList<SinglePoint>& hotspotList )
     }
 
   // Check, which files shall be loaded.
-  QStringList files = _settings.value( "/Points/FileList", QStringList(QString("All"))).toStringList();
+  const QStringList& files = m_fileList;
 
   if( files.isEmpty() )
     {
@@ -230,30 +351,112 @@ int OpenAipPoiLoader::load( QList<SinglePoint>& hotspotList )
         }
     }
 
-  while( ! preselect.isEmpty() )
-    {
-      QString srcName;
-      OpenAip openAip;
-      QString errorInfo;
+  // The files are loaded in parallel and merged in their order.
+  QVector<FileResult> results = __loadFiles( preselect, HotspotFiles );
+  int compiledCounter = 0; // number of files loaded from their compiled form
 
-      srcName = preselect.first();
+  for( int i = 0; i < results.size(); i++ )
+    {
+      const FileResult& result = results.at(i);
 
-      // Remove source file to be read from the list.
-      preselect.removeAt(0);
+      if( result.ok )
+        {
+          loadCounter++;
+        }
 
-      bool ok = openAip.readHotspots( srcName,
-                                      hotspotList,
-				      errorInfo,
-				      true );
+      if( result.compiled )
+        {
+          compiledCounter++;
+        }
 
-      if( ok )
-	{
-	  loadCounter++;
-	}
+      hotspotList += result.hotspots;
     }
 
-  qDebug( "OAIP: %d hotspot file(s) with %d items loaded in %dms",
-          loadCounter, hotspotList.size(), t.elapsed() );
+  qDebug( "OAIP: %d hotspot file(s) with %d items loaded in %dms, %d of them compiled",
+          loadCounter, hotspotList.size(), t.elapsed(), compiledCounter );
 
   return loadCounter;
 }
+
+QVector<OpenAipPoiLoader::FileResult>
+OpenAipPoiLoader::__loadFiles( const QStringList& files, const FileKind kind ) const
+{
+  // The filter settings are the same for all files.
+  const QByteArray filterKey = __filterKey();
+
+  // Every task stores its result in the slot of its file.
+  QVector<FileResult> results( files.size() );
+
+  QThreadPool pool;
+  pool.setMaxThreadCount( qMax( 1, QThread::idealThreadCount() ) );
+
+  for( int i = 0; i < files.size(); i++ )
+    {
+      pool.start( new OpenAipPoiTask( files.at(i), kind, m_projection,
+                                      m_filter, filterKey, &results[i] ) );
+    }
+
+  pool.waitForDone();
+
+  return results;
+}
+
+QByteArray OpenAipPoiLoader::__filterKey() const
+{
+  // These are the values used by OpenAip::loadUserFilterValues.
+  QString key = m_filter.countries.toUpper();
+
+  key += ";" + QString::number( m_filter.radius );
+
+  key += ";" + QString::number( m_filter.home.x() ) + "," + QString::number( m_filter.home.y() );
+
+  return key.toUtf8();
+}
+
+/*---------------------- OpenAipPoiLoaderThread ------------------------------*/
+
+#include <csignal>
+
+OpenAipPoiLoaderThread::OpenAipPoiLoaderThread( const OpenAipPoiLoader& loader,
+                                                QObject *parent ) :
+  QThread( parent ),
+  m_loader( loader )
+{
+  setObjectName( "OpenAipPoiLoaderThread" );
+
+  // The lists are passed via a queued connection to the receiver.
+  qRegisterMetaType<QList<Airfield> *>( "QList<Airfield>*" );
+  qRegisterMetaType<QList<RadioPoint> *>( "QList<RadioPoint>*" );
+  qRegisterMetaType<QList<SinglePoint> *>( "QList<SinglePoint>*" );
+
+  // Activate self destroy after finish signal has been caught.
+  connect( this, SIGNAL(finished()), this, SLOT(deleteLater()) );
+}
+
+OpenAipPoiLoaderThread::~OpenAipPoiLoaderThread()
+{
+}
+
+void OpenAipPoiLoaderThread::run()
+{
+#ifndef WIN32
+  sigset_t sigset;
+  sigfillset( &sigset );
+
+  // deactivate all signals in this thread
+  pthread_sigmask( SIG_SETMASK, &sigset, 0 );
+#endif
+
+  QList<Airfield>* airfieldList = new QList<Airfield>;
+  QList<RadioPoint>* navaidList = new QList<RadioPoint>;
+  QList<SinglePoint>* hotspotList = new QList<SinglePoint>;
+
+  int ok = m_loader.load( *airfieldList );
+  ok += m_loader.load( *navaidList );
+  ok += m_loader.load( *hotspotList );
+
+  /* It is expected that a receiver slot is connected to this signal. The
+   * receiver is responsible to delete the passed lists.
+   */
+  emit loadedLists( ok, airfieldList, navaidList, hotspotList );
+}
@@ -16,7 +16,7 @@
 /**
  * \class OpenAipPoiLoader
  *
- * \author Axel Pauli
+ * \author agent
  *
  * \brief A class for reading point data from openAIP XML files.
  *
@@ -33,10 +33,15 @@
 #ifndef OpenAip_Poi_Loader_h_
 #define OpenAip_Poi_Loader_h_
 
+#include <QByteArray>
 #include <QList>
 #include <QMutex>
+#include <QStringList>
+#include <QThread>
+#include <QVector>
 
 #include "airfield.h"
+#include "OpenAip.h"
 #include "radiopoint.h"
 #include "singlepoint.h"
 
@@ -44,7 +49,22 @@ class OpenAipPoiLoader
 {
  public:
 
-  OpenAipPoiLoader();
+  /**
+   * The loader runs in an extra thread and uses neither the configuration
+   * nor the map matrix. All values are taken by the main thread.
+   *
+   * \param mapDir The map root directory.
+   *
+   * \param fileList The names of the files to be loaded or "All".
+   *
+   * \param projection The map projection, stored by SaveProjection.
+   *
+   * \param filter The user's filter values of the point data.
+   */
+  OpenAipPoiLoader( const QString& mapDir,
+                    const QStringList& fileList,
+                    const QByteArray& projection,
+                    const OpenAip::FilterValues& filter );
 
   virtual ~OpenAipPoiLoader();
 
@@ -80,10 +100,118 @@ class OpenAipPoiLoader
 
  private:
 
+  friend class OpenAipPoiTask;
+
+  /** Kinds of openAIP point files. */
+  enum FileKind { AirfieldFiles, NavaidFiles, HotspotFiles };
+
+  /**
+   * Result of the load of one point file. Only the list of the file kind
+   * is used.
+   */
+  class FileResult
+  {
+   public:
+
+    FileResult() : ok(false), compiled(false) {};
+
+    /** True, if the file has been loaded. */
+    bool ok;
+
+    /** True, if the file has been taken from its compiled form. */
+    bool compiled;
+
+    QList<Airfield> airfields;
+    QList<RadioPoint> navaids;
+    QList<SinglePoint> hotspots;
+  };
+
+  /**
+   * Loads the passed files in parallel on a pool of worker threads.
+   *
+   * \return The results in the order of the files.
+   */
+  QVector<FileResult> __loadFiles( const QStringList& files,
+                                   const FileKind kind ) const;
+
+  /**
+   * \return The filter settings of the openAIP point data as key of the
+   *         compiled files.
+   */
+  QByteArray __filterKey() const;
+
+  /** The map root directory. */
+  QString m_mapDir;
+
+  /** The names of the files to be loaded or "All". */
+  QStringList m_fileList;
+
+  /** The map projection, stored by SaveProjection. */
+  QByteArray m_projection;
+
+  /** The user's filter values. */
+  OpenAip::FilterValues m_filter;
+
   /** Mutex to ensure thread safety. */
   static QMutex m_mutexAf;
   static QMutex m_mutexNa;
   static QMutex m_mutexHs;
 };
 
+/******************************************************************************/
+
+/**
+* \class OpenAipPoiLoaderThread
+*
+* \author agent
+*
+* \brief Class to read openAIP point data files in an extra thread.
+*
+* This class loads the openAIP airfield, navaid and hotspot files with
+* \ref OpenAipPoiLoader in an extra thread. The results are returned via
+* the signal \ref loadedLists.
+*
+* \date 2026
+*/
+class OpenAipPoiLoaderThread : public QThread
+{
+  Q_OBJECT
+
+ public:
+
+  /**
+   * \param loader The loader of the point files, created in the main thread.
+   */
+  OpenAipPoiLoaderThread( const OpenAipPoiLoader& loader, QObject *parent=0 );
+
+  virtual ~OpenAipPoiLoaderThread();
+
+ protected:
+
+  /**
+   * That is the main method of the thread.
+   */
+  void run();
+
+ signals:
+
+  /**
+  * This signal emits the results of the openAIP load. The receiver slot is
+  * responsible to delete the dynamic allocated lists in every case.
+  *
+  * \param loadedFiles   The number of loaded files
+  * \param airfieldList  The list with the airfield data
+  * \param navaidList    The list with the navaid data
+  * \param hotspotList   The list with the hotspot data
+  */
+  void loadedLists( int loadedFiles,
+                    QList<Airfield>* airfieldList,
+                    QList<RadioPoint>* navaidList,
+                    QList<SinglePoint>* hotspotList );
+
+ private:
+
+  OpenAipPoiLoader m_loader;
+};
+
 #endif /* OpenAip_Poi_Loader_h_ */
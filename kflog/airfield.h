@@ -183,6 +183,14 @@ class Airfield : public SinglePoint
     return m_rwList;
   };
 
+  /**
+   * @return The runway list.
+   */
+  const QList<Runway>& getRunwayList() const
+  {
+    return m_rwList;
+  };
+
   /**
    * Adds a runway to the list of runways.
    *
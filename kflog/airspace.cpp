@@ -95,6 +95,12 @@ Airspace::Airspace( QString name,
   // create a QPainterPath object from the projected airspace.
   m_airspaceRegion.addPolygon(projPolygon);
   m_airspaceRegion.closeSubpath();
+
+  // The path calculates its bounds on the first use and caches them. That
+  // is done here, because the flight import reads the airspaces in its
+  // worker threads, while they are drawn by the main thread.
+  m_airspaceRegion.controlPointRect();
+  m_airspaceRegion.boundingRect();
 }
 
 Airspace Airspace::createAirspaceObject()
@@ -294,6 +300,63 @@ QString Airspace::getInfoString(bool ExtendedHTMLFormat) const
   return text;
 }
 
+/**
+ * Returns false, if no altitude between minAlt and maxAlt can be inside
+ * the vertical limits of the airspace. Only the altitude is considered
+ * not the current position.
+ */
+bool Airspace::mayBeInside( const AltitudeCollection& minAlt,
+                            const AltitudeCollection& maxAlt ) const
+{
+  // The same altitude selection as in conflicts(). The lower limit is
+  // checked with the highest, the upper limit with the lowest altitudes.
+  Altitude lowerAlt(0);
+  Altitude upperAlt(0);
+
+  switch (m_lLimitType)
+    {
+      case NotSet:
+        break;
+      case MSL:
+        lowerAlt = maxAlt.pressureAltitude;
+        break;
+      case GND:
+        lowerAlt = maxAlt.gndAltitude + maxAlt.gndAltitudeError;
+        if (m_lLimit == 0)
+          lowerAlt.setMeters(1); // we're always above ground
+        break;
+      case FL:
+      case STD:
+        lowerAlt = maxAlt.stdAltitude;
+        break;
+      case UNLTD:
+        return false;
+    }
+
+  switch (m_uLimitType)
+    {
+      case NotSet:
+        upperAlt.setMeters(100000);
+        break;
+      case MSL:
+        upperAlt = minAlt.pressureAltitude;
+        break;
+      case GND:
+        upperAlt = minAlt.gndAltitude - minAlt.gndAltitudeError;
+        break;
+      case FL:
+      case STD:
+        upperAlt = minAlt.stdAltitude;
+        break;
+      case UNLTD:
+        upperAlt = m_uLimit - 1;
+        break;
+    }
+
+  return ( (lowerAlt.getMeters() >= m_lLimit.getMeters()) &&
+           (upperAlt.getMeters() <= m_uLimit.getMeters()) );
+}
+
 /**
  * Returns true if the given altitude conflicts with the airspace
  * properties. Only the altitude is considered not the current
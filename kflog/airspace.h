@@ -113,7 +113,7 @@ public:
    * Returns true, if the passed projected coordinate point lays inside the
    * airspace polygon.
    */
-  bool isProjectedPointInside( const QPoint& point )
+  bool isProjectedPointInside( const QPoint& point ) const
   {
     if( m_airspaceRegion.isEmpty() )
       {
@@ -123,6 +123,34 @@ public:
     return m_airspaceRegion.contains( point );
   };
 
+  /**
+   * Returns true, if the passed projected rectangle lays completely inside
+   * the airspace polygon.
+   */
+  bool isProjectedRectInside( const QRect& rect ) const
+  {
+    if( m_airspaceRegion.isEmpty() )
+      {
+        return false;
+      }
+
+    return m_airspaceRegion.contains( QRectF( rect ) );
+  };
+
+  /**
+   * Returns true, if the passed projected rectangle intersects the airspace
+   * polygon.
+   */
+  bool intersectsProjectedRect( const QRect& rect ) const
+  {
+    if( m_airspaceRegion.isEmpty() )
+      {
+        return false;
+      }
+
+    return m_airspaceRegion.intersects( QRectF( rect ) );
+  };
+
   /**
    * Draws the airspace into the given painter.
    * Return a pointer to the drawn region or 0.
@@ -234,6 +262,21 @@ public:
   ConflictType conflicts (const AltitudeCollection& alt,
                           const AirspaceWarningDistance& dist) const;
 
+  /**
+   * Checks, if any altitude of an altitude band can be inside of the
+   * airspace. The band is given by the lowest and the highest value of
+   * every altitude reference. It is used as a cheap prefilter before
+   * \ref conflicts is called for the single altitudes of the band.
+   *
+   * \param minAlt The lowest altitudes of the band.
+   *
+   * \param maxAlt The highest altitudes of the band.
+   *
+   * \return False, if no altitude of the band is inside.
+   */
+  bool mayBeInside( const AltitudeCollection& minAlt,
+                    const AltitudeCollection& maxAlt ) const;
+
   /*
    * Compares two items, in this case, Airspaces.
    * The items are compared on their levels. Because kflog provides a view
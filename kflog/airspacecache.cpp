@@ -0,0 +1,366 @@
+/***********************************************************************
+**
+**   airspacecache.cpp
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <cstring>
+
+#include <QtCore>
+
+#include "airspacecache.h"
+#include "AirspaceHelper.h"
+#include "projectionbase.h"
+
+// compiled airspace file token: @KAC
+#define AS_CACHE_FILE_MAGIC    0x404b4143
+
+// Version of the compiled file layout. Increment it, if the layout is changed.
+#define AS_CACHE_FILE_VERSION  1
+
+// Maximum length of the serialized projection parameters
+#define AS_CACHE_PROJECTION_KEY_SIZE 32
+
+/**
+ * Header at the beginning of every compiled airspace file. The byte order is
+ * the native one, a file written on another architecture is rejected by the
+ * magic check.
+ */
+struct AirspaceCacheHeader
+{
+  quint32 magic;
+  quint16 version;
+  quint16 typeMappingKey;
+  quint32 airspaceCount;
+  quint32 reserved1;
+  qint64  sourceSize;
+  qint64  sourceModified;
+  quint32 projectionKeyLength;
+  char    projectionKey[AS_CACHE_PROJECTION_KEY_SIZE];
+  quint32 reserved2;
+};
+
+/**
+ * Header of a single airspace record. It is followed by the name and the
+ * country as UTF-16 characters, each padded to a multiple of 8 bytes, and
+ * by the projected points as pairs of qint32.
+ */
+struct AirspaceCacheRecord
+{
+  qint32  id;
+  quint8  type;
+  quint8  lowerType;
+  quint8  upperType;
+  quint8  reserved1;
+  double  lower;
+  double  upper;
+  quint32 nameLength;
+  quint32 countryLength;
+  quint32 pointCount;
+  quint32 reserved2;
+};
+
+/** Returns the string size in bytes padded to a multiple of 8. */
+static inline quint32 paddedStringSize( quint32 length )
+{
+  return ( length * sizeof(ushort) + 7 ) & ~7U;
+}
+
+static void appendString( QByteArray& buffer, const QString& string )
+{
+  const int size = string.size() * sizeof(ushort);
+
+  buffer.append( reinterpret_cast<const char *> (string.utf16()), size );
+  buffer.append( QByteArray( paddedStringSize( string.size() ) - size, '\0' ) );
+}
+
+AirspaceCache::AirspaceCache( ProjectionBase* projection )
+{
+  if( projection != 0 )
+    {
+      QDataStream out( &m_projectionKey, QIODevice::WriteOnly );
+      SaveProjection( out, projection );
+    }
+}
+
+AirspaceCache::~AirspaceCache()
+{
+}
+
+QString AirspaceCache::compiledFileName( const QString& sourceFile )
+{
+  return sourceFile + ".kac";
+}
+
+quint16 AirspaceCache::__typeMappingKey( const QString& sourceFile )
+{
+  // The mapping contains the default mapping of the source type and the
+  // user mapping files beside the source.
+  QMap<QString, BaseMapElement::objectType> typeMap =
+    AirspaceHelper::initializeAirspaceTypeMapping( sourceFile );
+
+  QByteArray data;
+  QMap<QString, BaseMapElement::objectType>::const_iterator it;
+
+  for( it = typeMap.constBegin(); it != typeMap.constEnd(); ++it )
+    {
+      data += it.key().toUtf8() + '=' + QByteArray::number( (int) it.value() ) + '\n';
+    }
+
+  return qChecksum( data.constData(), data.size() );
+}
+
+bool AirspaceCache::load( const QString& sourceFile,
+                          QList<Airspace>& airspaces ) const
+{
+  if( m_projectionKey.isEmpty() ||
+      m_projectionKey.size() > AS_CACHE_PROJECTION_KEY_SIZE )
+    {
+      return false;
+    }
+
+  QFileInfo srcInfo( sourceFile );
+
+  if( ! srcInfo.exists() )
+    {
+      return false;
+    }
+
+  QFile cacheFile( compiledFileName( sourceFile ) );
+
+  if( ! cacheFile.exists() || ! cacheFile.open( QIODevice::ReadOnly ) )
+    {
+      return false;
+    }
+
+  const qint64 size = cacheFile.size();
+
+  if( size < (qint64) sizeof(AirspaceCacheHeader) )
+    {
+      return false;
+    }
+
+  // Map the whole file into memory. If that fails, we read it in one go.
+  QByteArray buffer;
+  const uchar* data = cacheFile.map( 0, size );
+
+  if( data == 0 )
+    {
+      buffer = cacheFile.readAll();
+
+      if( buffer.size() != size )
+        {
+          return false;
+        }
+
+      data = reinterpret_cast<const uchar *> (buffer.constData());
+    }
+
+  const AirspaceCacheHeader* header =
+      reinterpret_cast<const AirspaceCacheHeader *> (data);
+
+  if( header->magic != AS_CACHE_FILE_MAGIC ||
+      header->version != AS_CACHE_FILE_VERSION ||
+      header->sourceSize != srcInfo.size() ||
+      header->sourceModified != (qint64) srcInfo.lastModified().toTime_t() ||
+      header->projectionKeyLength != (quint32) m_projectionKey.size() ||
+      memcmp( header->projectionKey, m_projectionKey.constData(),
+              m_projectionKey.size() ) != 0 ||
+      header->typeMappingKey != __typeMappingKey( sourceFile ) )
+    {
+      // Compiled file is outdated or belongs to another projection.
+      return false;
+    }
+
+  QList<Airspace> cached;
+  cached.reserve( header->airspaceCount );
+
+  qint64 pos = sizeof(AirspaceCacheHeader);
+
+  for( quint32 i = 0; i < header->airspaceCount; i++ )
+    {
+      if( pos + (qint64) sizeof(AirspaceCacheRecord) > size )
+        {
+          qWarning() << "AirspaceCache: Truncated file" << cacheFile.fileName();
+          return false;
+        }
+
+      const AirspaceCacheRecord* rec =
+          reinterpret_cast<const AirspaceCacheRecord *> (data + pos);
+
+      pos += sizeof(AirspaceCacheRecord);
+
+      const qint64 nameSize    = paddedStringSize( rec->nameLength );
+      const qint64 countrySize = paddedStringSize( rec->countryLength );
+      const qint64 pointsSize  = (qint64) rec->pointCount * 2 * sizeof(qint32);
+
+      if( pos + nameSize + countrySize + pointsSize > size )
+        {
+          qWarning() << "AirspaceCache: Truncated file" << cacheFile.fileName();
+          return false;
+        }
+
+      QString name;
+      QString country;
+
+      if( rec->nameLength > 0 )
+        {
+          name = QString::fromUtf16( reinterpret_cast<const ushort *> (data + pos),
+                                     rec->nameLength );
+        }
+
+      pos += nameSize;
+
+      if( rec->countryLength > 0 )
+        {
+          country = QString::fromUtf16( reinterpret_cast<const ushort *> (data + pos),
+                                        rec->countryLength );
+        }
+
+      pos += countrySize;
+
+      const qint32* coords = reinterpret_cast<const qint32 *> (data + pos);
+
+      QPolygon polygon( rec->pointCount );
+      QPoint* points = polygon.data();
+
+      for( quint32 j = 0; j < rec->pointCount; j++ )
+        {
+          points[j] = QPoint( coords[2 * j], coords[2 * j + 1] );
+        }
+
+      pos += pointsSize;
+
+      Airspace as( name,
+                   (BaseMapElement::objectType) rec->type,
+                   polygon,
+                   0.0, (BaseMapElement::elevationType) rec->upperType,
+                   0.0, (BaseMapElement::elevationType) rec->lowerType,
+                   rec->id,
+                   country );
+
+      // The limits are restored in meters, as they were stored.
+      as.setUpperL( Altitude( rec->upper ) );
+      as.setLowerL( Altitude( rec->lower ) );
+
+      cached.append( as );
+    }
+
+  airspaces += cached;
+  return true;
+}
+
+bool AirspaceCache::save( const QString& sourceFile,
+                          const QList<Airspace>& airspaces ) const
+{
+  if( m_projectionKey.isEmpty() ||
+      m_projectionKey.size() > AS_CACHE_PROJECTION_KEY_SIZE )
+    {
+      return false;
+    }
+
+  QFileInfo srcInfo( sourceFile );
+
+  if( ! srcInfo.exists() )
+    {
+      return false;
+    }
+
+  AirspaceCacheHeader header;
+  memset( &header, 0, sizeof(header) );
+
+  header.magic               = AS_CACHE_FILE_MAGIC;
+  header.version             = AS_CACHE_FILE_VERSION;
+  header.typeMappingKey      = __typeMappingKey( sourceFile );
+  header.airspaceCount       = airspaces.size();
+  header.sourceSize          = srcInfo.size();
+  header.sourceModified      = srcInfo.lastModified().toTime_t();
+  header.projectionKeyLength = m_projectionKey.size();
+  memcpy( header.projectionKey, m_projectionKey.constData(), m_projectionKey.size() );
+
+  // Assemble the whole file in memory to write it with a single call.
+  QByteArray buffer;
+  buffer.append( reinterpret_cast<const char *> (&header), sizeof(header) );
+
+  for( int i = 0; i < airspaces.size(); i++ )
+    {
+      const Airspace& as = airspaces.at(i);
+      const QPolygon& polygon = as.getProjectedPolygon();
+      const QString name = as.getName();
+      const QString country = as.getCountry();
+
+      AirspaceCacheRecord rec;
+      memset( &rec, 0, sizeof(rec) );
+
+      rec.id            = as.getId();
+      rec.type          = (quint8) as.getTypeID();
+      rec.lowerType     = (quint8) as.getLowerT();
+      rec.upperType     = (quint8) as.getUpperT();
+      rec.lower         = as.getLowerAltitude().getMeters();
+      rec.upper         = as.getUpperAltitude().getMeters();
+      rec.nameLength    = name.size();
+      rec.countryLength = country.size();
+      rec.pointCount    = polygon.size();
+
+      buffer.append( reinterpret_cast<const char *> (&rec), sizeof(rec) );
+
+      appendString( buffer, name );
+      appendString( buffer, country );
+
+      QVector<qint32> coords( 2 * polygon.size() );
+
+      for( int j = 0; j < polygon.size(); j++ )
+        {
+          const QPoint& p = polygon.at(j);
+          coords[2 * j]     = p.x();
+          coords[2 * j + 1] = p.y();
+        }
+
+      buffer.append( reinterpret_cast<const char *> (coords.constData()),
+                     coords.size() * sizeof(qint32) );
+    }
+
+  // Write into a temporary file first and rename it afterwards. So a reader
+  // never sees a partially written file.
+  const QString fileName = compiledFileName( sourceFile );
+  const QString tmpName  = fileName + "." +
+                           QString::number( (quintptr) QThread::currentThreadId() ) +
+                           ".tmp";
+
+  QFile tmpFile( tmpName );
+
+  if( ! tmpFile.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    {
+      qWarning() << "AirspaceCache: Cannot write" << tmpName;
+      return false;
+    }
+
+  if( tmpFile.write( buffer ) != buffer.size() )
+    {
+      qWarning() << "AirspaceCache: Write error on" << tmpName;
+      tmpFile.close();
+      tmpFile.remove();
+      return false;
+    }
+
+  tmpFile.close();
+
+  QFile::remove( fileName );
+
+  if( ! QFile::rename( tmpName, fileName ) )
+    {
+      QFile::remove( tmpName );
+      return false;
+    }
+
+  return true;
+}
@@ -0,0 +1,101 @@
+/***********************************************************************
+**
+**   airspacecache.h
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#ifndef AIRSPACE_CACHE_H
+#define AIRSPACE_CACHE_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+#include "airspace.h"
+
+class ProjectionBase;
+
+/**
+ * \class AirspaceCache
+ *
+ * \author agent
+ *
+ * \brief Compiled form of the airspaces of an OpenAir or openAIP file.
+ *
+ * Parsing an airspace file means reading the text or XML data and
+ * tessellating all arcs and circles. This class stores the parsed and
+ * projected airspaces of a source file in a compiled file beside the
+ * source. A compiled file is only accepted, if the size and the
+ * modification time of its source file, the checksum of the airspace type
+ * mapping and the parameters of the current map projection are unchanged.
+ *
+ * The compiled files use a flat, native byte order layout which is read
+ * back via a memory mapping of the whole file. All records are 8 byte
+ * aligned.
+ *
+ * The class has no mutable state after construction and can be used from
+ * several threads at the same time.
+ *
+ * \date 2026
+ */
+class AirspaceCache
+{
+ public:
+
+  /**
+   * \param projection The current map projection. The airspaces are
+   *        stored with their projected coordinates.
+   */
+  AirspaceCache( ProjectionBase* projection );
+
+  virtual ~AirspaceCache();
+
+  /**
+   * Loads the compiled airspaces of a source file.
+   *
+   * \param sourceFile The path of the OpenAir or openAIP file.
+   *
+   * \param airspaces The loaded airspaces are appended to this list.
+   *
+   * \return True, if a valid compiled file has been loaded.
+   */
+  bool load( const QString& sourceFile, QList<Airspace>& airspaces ) const;
+
+  /**
+   * Writes the compiled airspaces of a source file.
+   *
+   * \param sourceFile The path of the OpenAir or openAIP file.
+   *
+   * \param airspaces The airspaces parsed from the source file.
+   *
+   * \return True in case of success.
+   */
+  bool save( const QString& sourceFile, const QList<Airspace>& airspaces ) const;
+
+  /**
+   * \return The path of the compiled file belonging to a source file.
+   */
+  static QString compiledFileName( const QString& sourceFile );
+
+ private:
+
+  /**
+   * \return The checksum of the airspace type mapping used for the
+   *         source file.
+   */
+  static quint16 __typeMappingKey( const QString& sourceFile );
+
+  /** Serialized parameters of the map projection. */
+  QByteArray m_projectionKey;
+};
+
+#endif
@@ -233,9 +233,9 @@ void AirSpaceListViewItem::AirSpaceFlagListViewItem::activate()
   // - beide Cursors an Anfang und Ende des Luftraums setzen.
   if( m_Flight != 0 )
     {
-      QList<FlightPoint*>& route = m_Flight->getRoute();
-      time_t cursor1 = route[m_ItemToActivate.FirstIndexPointinRoute()]->time;
-      time_t cursor2 = route[m_ItemToActivate.LastIndexPointinRoute()]->time;
+      FlightTrack& route = m_Flight->getRoute();
+      time_t cursor1 = route.time( m_ItemToActivate.FirstIndexPointinRoute() );
+      time_t cursor2 = route.time( m_ItemToActivate.LastIndexPointinRoute() );
 
       EvaluationDialog* evalDialog = 0;
 
@@ -250,8 +250,8 @@ void AirSpaceListViewItem::AirSpaceFlagListViewItem::activate()
             }
         }
 
-      QPoint& p1 = route.at(m_ItemToActivate.FirstIndexPointinRoute())->projP;
-      QPoint& p2 = route.at(m_ItemToActivate.LastIndexPointinRoute())->projP;
+      QPoint p1 = route.projP( m_ItemToActivate.FirstIndexPointinRoute() );
+      QPoint p2 = route.projP( m_ItemToActivate.LastIndexPointinRoute() );
 
       extern Map *_globalMap;
       _globalMap->slotDrawCursor( p1, p2 );
@@ -267,6 +267,13 @@ class BaseMapElement
    */
   virtual bool isVisible() { return true; };
 
+  /**
+   * \return The bounding box of the projected element. Used by the spatial
+   *         index of the map contents. An empty rectangle is returned, if
+   *         the element has no projected position.
+   */
+  virtual QRect getBoundingBox() const { return QRect(); };
+
 protected:
 
   /**
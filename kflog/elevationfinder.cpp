@@ -23,11 +23,18 @@
 extern MapContents *_globalMapContents;
 extern MapMatrix *_globalMapMatrix;
 
+// DEM value of a point without data
+#define DEM_NO_DATA -9999
+
+// Idle time in ms, after that the DEM file is released
+#define DEM_IDLE_TIMEOUT 60000
+
 ElevationFinder::ElevationFinder(QObject *parent) :
  QObject(parent),
  useOGIE(false),
  demFile(0),
- demStream(0)
+ demData(0),
+ demPoints(0)
 {
   setObjectName("ElevationFinder");
 
@@ -39,11 +46,18 @@ ElevationFinder::ElevationFinder(QObject *parent) :
   timer = new QTimer(this);
   timer->setSingleShot( true );
   connect(timer, SIGNAL(timeout()), this, SLOT(timeout()));
+
+  // The singleton can be created by a worker thread. The idle timer needs
+  // the event loop of the main thread.
+  if( QCoreApplication::instance() )
+    {
+      moveToThread( QCoreApplication::instance()->thread() );
+    }
 }
 
 ElevationFinder::~ElevationFinder()
 {
-  timeout(); //takes care of deleting demStream and demFile
+  timeout(); //takes care of unmapping and deleting demFile
 }
 
 ElevationFinder* ElevationFinder::instance()
@@ -86,17 +100,119 @@ int ElevationFinder::elevation(const QPoint& WgsCoordinates, const QPoint& MapCo
   return _globalMapContents->getElevation( MapCoordinates, 0 );
 }
 
-int ElevationFinder::findDEMelevation(const QPoint& coordinates)
+QVector<int> ElevationFinder::elevations( const QVector<QPoint>& WgsCoordinates,
+                                          const QVector<QPoint>& MapCoordinates,
+                                          bool interpolate )
 {
-  timer->stop();
+  QVector<int> result( WgsCoordinates.size(), -1 );
+
+  if( ! useOGIE )
+    {
+      //use the 'old' method
+      for( int i = 0; i < MapCoordinates.size() && i < result.size(); i++ )
+        {
+          result[i] = _globalMapContents->getElevation( MapCoordinates.at(i), 0 );
+        }
+
+      return result;
+    }
+
+  QMutexLocker locker( &demMutex );
+
+  if( ! openDEM() )
+    {
+      return result;
+    }
+
+  for( int i = 0; i < WgsCoordinates.size(); i++ )
+    {
+      result[i] = demElevation( WgsCoordinates.at(i), interpolate );
+    }
+
+  locker.unlock();
+  restartTimer();
+
+  return result;
+}
+
+bool ElevationFinder::openDEM()
+{
+  if( demData )
+    {
+      return true;
+    }
 
   if( !demFile )
     {
       demFile = new QFile( demFileName );
-      demFile->open( QIODevice::ReadOnly );
-      demStream = new QDataStream( demFile );
     }
 
+  if( !demFile->isOpen() && !demFile->open( QIODevice::ReadOnly ) )
+    {
+      qWarning() << "ElevationFinder: Cannot open DEM file" << demFileName;
+      return false;
+    }
+
+  // The whole file is mapped into memory. If that fails, it is read in.
+  demData = demFile->map( 0, demFile->size() );
+
+  if( !demData )
+    {
+      demBuffer = demFile->readAll();
+      demData = reinterpret_cast<const uchar *> (demBuffer.constData());
+    }
+
+  demPoints = demFile->size() / 2;
+  return true;
+}
+
+void ElevationFinder::restartTimer()
+{
+  // The timer can only be used in the thread of the finder. Queries of
+  // other threads restart it through the event loop of that thread.
+  if( QThread::currentThread() == thread() )
+    {
+      timer->start( DEM_IDLE_TIMEOUT );
+    }
+  else
+    {
+      QMetaObject::invokeMethod( timer, "start", Qt::QueuedConnection,
+                                 Q_ARG( int, DEM_IDLE_TIMEOUT ) );
+    }
+}
+
+int ElevationFinder::demValue(int row, int col) const
+{
+  qint64 cell = qint64(row) * demCols + col;
+
+  if( cell < 0 || cell >= demPoints )
+    {
+      return DEM_NO_DATA;
+    }
+
+  // The DEM values are stored as big endian 16 bit integers.
+  return qFromBigEndian<qint16>( demData + 2 * cell );
+}
+
+int ElevationFinder::findDEMelevation(const QPoint& coordinates)
+{
+  QMutexLocker locker( &demMutex );
+
+  if( !openDEM() )
+    {
+      return -1;
+    }
+
+  int h = demElevation( coordinates, false );
+
+  locker.unlock();
+  restartTimer();
+
+  return h;
+}
+
+int ElevationFinder::demElevation(const QPoint& coordinates, bool interpolate) const
+{
   QRect r(QPoint(demBR.x(), demTL.y()), QPoint(demTL.x(), demBR.y()));
 
   if( !r.contains( coordinates.x(), coordinates.y() ) )
@@ -105,15 +221,33 @@ int ElevationFinder::findDEMelevation(const QPoint& coordinates)
       return -1;
     }
 
-  int row = (demTL.x() - coordinates.x()) / demGridLat;
-  int col = -1 * (demTL.y() - coordinates.y()) / demGridLon;
-  qint64 cell = 2 * (row * demCols + col);
-  qint16 h;
+  // position in the DEM grid
+  double fRow = double(demTL.x() - coordinates.x()) / demGridLat;
+  double fCol = double(coordinates.y() - demTL.y()) / demGridLon;
+
+  int row = int(fRow);
+  int col = int(fCol);
 
-  demFile->seek( cell );
-  *demStream >> h;
+  int h = demValue( row, col );
 
-  if( h == -9999 )
+  if( interpolate && row + 1 < demRows && col + 1 < demCols )
+    {
+      int h10 = demValue( row, col + 1 );
+      int h01 = demValue( row + 1, col );
+      int h11 = demValue( row + 1, col + 1 );
+
+      if( h != DEM_NO_DATA && h10 != DEM_NO_DATA &&
+          h01 != DEM_NO_DATA && h11 != DEM_NO_DATA )
+        {
+          double wr = fRow - row;
+          double wc = fCol - col;
+
+          return qRound( ( h * (1.0 - wc) + h10 * wc ) * (1.0 - wr) +
+                         ( h01 * (1.0 - wc) + h11 * wc ) * wr );
+        }
+    }
+
+  if( h == DEM_NO_DATA )
     {
       h = 0;
     }
@@ -123,18 +257,22 @@ int ElevationFinder::findDEMelevation(const QPoint& coordinates)
 
 void ElevationFinder::timeout()
 {
-  if( demStream )
-    {
-      delete demStream;
-    }
+  QMutexLocker locker( &demMutex );
 
   if( demFile )
     {
+      if( demData && demBuffer.isEmpty() )
+        {
+          demFile->unmap( const_cast<uchar *> (demData) );
+        }
+
       demFile->close();
       delete demFile;
     }
 
-  demStream = 0;
+  demData = 0;
+  demBuffer.clear();
+  demPoints = 0;
   demFile = 0;
 }
 
@@ -19,11 +19,13 @@
 #ifndef ELEVATION_FINDER_H
 #define ELEVATION_FINDER_H
 
+#include <QByteArray>
 #include <QObject>
+#include <QMutex>
 #include <QPoint>
 #include <QTimer>
 #include <QFile>
-#include <QDataStream>
+#include <QVector>
 
 /**
  * \class ElevationFinder
@@ -39,6 +41,10 @@
  * The preferred method is number 1, as it is much faster and more detailed
  * in comparison to the latter. 
  *
+ * The DEM file is mapped into memory on the first query and released again
+ * after an idle period. Many points can be queried with one call of
+ * \ref elevations, optionally interpolated between the DEM grid points.
+ *
  * \date 2004-2011
  *
  * \version $Id$
@@ -82,6 +88,18 @@ class ElevationFinder : public QObject
    * method of getting the elevation.
    */
   int elevation(const QPoint& WgsCoordinates, const QPoint& MapCoordinates);
+  /**
+   * Find the elevations of many points with one call.
+   * @returns Elevations in meters or -1 for points without a valid result.
+   * @args WgsCoordinates Coordinates of the points in wgs format.
+   * @args MapCoordinates Coordinates of the points in map projection format.
+   * Both vectors must have the same size and represent the same points.
+   * @args interpolate If true, the DEM elevations are bilinear interpolated
+   * between the neighbouring grid points.
+   */
+  QVector<int> elevations( const QVector<QPoint>& WgsCoordinates,
+                           const QVector<QPoint>& MapCoordinates,
+                           bool interpolate=false );
   /**
    * @returns A pointer to the instance of the object to use. Use only this static
    * method to get an ElevationFinder object!
@@ -98,9 +116,16 @@ private slots:
 
 private:
 
-  int findDEMelevation(const QPoint&);
+  int findDEMelevation(const QPoint& coordinates);
+  /** Looks up a point in the opened DEM file, demMutex must be locked. */
+  int demElevation(const QPoint& coordinates, bool interpolate) const;
+  bool openDEM();
+  void restartTimer();
   bool tryOpenGLIGCexplorer();
 
+  /** Returns the DEM value at the given grid position. */
+  int demValue(int row, int col) const;
+
   bool useOGIE;
 
   //name of DEM (Digital Elevation Model) file
@@ -115,7 +140,14 @@ private:
   int demGridLon;
   QTimer * timer;
   QFile * demFile;
-  QDataStream * demStream;
+  //start of the DEM file in memory
+  const uchar * demData;
+  //DEM file content, if the file cannot be mapped
+  QByteArray demBuffer;
+  //number of grid points in the DEM data
+  qint64 demPoints;
+  //protects the DEM file access
+  QMutex demMutex;
 };
 
 #endif
@@ -0,0 +1,170 @@
+/***********************************************************************
+**
+**   elevationgrid.cpp
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <cmath>
+
+#include <QtCore>
+
+#include "elevationgrid.h"
+
+// Maximum number of cells per grid edge
+#define ELEVATION_GRID_SIZE 512
+
+// Marker of a cell without elevation
+#define ELEVATION_NO_DATA -32768
+
+ElevationGrid::ElevationGrid( const QRect& bounds ) :
+  m_bounds(bounds.normalized()),
+  m_cellSize(1),
+  m_cols(0),
+  m_rows(0)
+{
+  if( m_bounds.isEmpty() )
+    {
+      return;
+    }
+
+  m_cellSize = qMax( m_bounds.width(), m_bounds.height() ) / ELEVATION_GRID_SIZE + 1;
+
+  m_cols = m_bounds.width() / m_cellSize + 1;
+  m_rows = m_bounds.height() / m_cellSize + 1;
+
+  m_cells.fill( ELEVATION_NO_DATA, m_cols * m_rows );
+}
+
+ElevationGrid::~ElevationGrid()
+{
+}
+
+void ElevationGrid::addIsoline( const QPolygon& polygon, const short elevation )
+{
+  const int cnt = polygon.size();
+
+  if( cnt < 3 || m_cols == 0 )
+    {
+      return;
+    }
+
+  QRect box = polygon.boundingRect().intersected( m_bounds );
+
+  if( box.isEmpty() )
+    {
+      return;
+    }
+
+  const QPoint* pts = polygon.constData();
+
+  int r1 = ( box.top() - m_bounds.top() ) / m_cellSize;
+  int r2 = ( box.bottom() - m_bounds.top() ) / m_cellSize;
+
+  QVector<double> xs;
+
+  // Scanline fill through the cell centers with the odd-even rule, as used
+  // by QPainterPath::contains before.
+  for( int r = r1; r <= r2; r++ )
+    {
+      const double y = m_bounds.top() + ( r + 0.5 ) * m_cellSize;
+
+      xs.clear();
+
+      for( int i = 0, j = cnt - 1; i < cnt; j = i++ )
+        {
+          const double y1 = pts[j].y();
+          const double y2 = pts[i].y();
+
+          if( (y1 <= y && y < y2) || (y2 <= y && y < y1) )
+            {
+              xs.append( pts[j].x() + (y - y1) * (pts[i].x() - pts[j].x()) / (y2 - y1) );
+            }
+        }
+
+      if( xs.size() < 2 )
+        {
+          continue;
+        }
+
+      qSort( xs.begin(), xs.end() );
+
+      qint16* row = m_cells.data() + r * m_cols;
+
+      for( int k = 0; k + 1 < xs.size(); k += 2 )
+        {
+          // First and last cell, whose center is inside the span.
+          int c1 = int( ceil( (xs.at(k) - m_bounds.left()) / m_cellSize - 0.5 ) );
+          int c2 = int( ceil( (xs.at(k + 1) - m_bounds.left()) / m_cellSize - 0.5 ) ) - 1;
+
+          c1 = qMax( c1, 0 );
+          c2 = qMin( c2, m_cols - 1 );
+
+          for( int c = c1; c <= c2; c++ )
+            {
+              if( row[c] < elevation )
+                {
+                  row[c] = elevation;
+                }
+            }
+        }
+    }
+}
+
+int ElevationGrid::level( const QPoint& coordMap ) const
+{
+  if( m_cols == 0 || ! m_bounds.contains( coordMap ) )
+    {
+      return -1;
+    }
+
+  qint16 h = __cell( ( coordMap.x() - m_bounds.left() ) / m_cellSize,
+                     ( coordMap.y() - m_bounds.top() ) / m_cellSize );
+
+  return ( h == ELEVATION_NO_DATA ) ? -1 : h;
+}
+
+int ElevationGrid::elevation( const QPoint& coordMap ) const
+{
+  if( m_cols == 0 || ! m_bounds.contains( coordMap ) )
+    {
+      return -1;
+    }
+
+  // Position relative to the cell centers
+  const double fx = double( coordMap.x() - m_bounds.left() ) / m_cellSize - 0.5;
+  const double fy = double( coordMap.y() - m_bounds.top() ) / m_cellSize - 0.5;
+
+  const int c0 = qBound( 0, int( floor( fx ) ), m_cols - 1 );
+  const int r0 = qBound( 0, int( floor( fy ) ), m_rows - 1 );
+  const int c1 = qMin( c0 + 1, m_cols - 1 );
+  const int r1 = qMin( r0 + 1, m_rows - 1 );
+
+  const qint16 h00 = __cell( c0, r0 );
+  const qint16 h10 = __cell( c1, r0 );
+  const qint16 h01 = __cell( c0, r1 );
+  const qint16 h11 = __cell( c1, r1 );
+
+  if( h00 == ELEVATION_NO_DATA || h10 == ELEVATION_NO_DATA ||
+      h01 == ELEVATION_NO_DATA || h11 == ELEVATION_NO_DATA )
+    {
+      // At the border of the covered area, use the nearest cell only.
+      return level( coordMap );
+    }
+
+  const double wx = qBound( 0.0, fx - c0, 1.0 );
+  const double wy = qBound( 0.0, fy - r0, 1.0 );
+
+  const double h = ( h00 * (1.0 - wx) + h10 * wx ) * (1.0 - wy) +
+                   ( h01 * (1.0 - wx) + h11 * wx ) * wy;
+
+  return qRound( h );
+}
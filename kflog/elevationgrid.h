@@ -0,0 +1,115 @@
+/***********************************************************************
+**
+**   elevationgrid.h
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#ifndef ELEVATION_GRID_H
+#define ELEVATION_GRID_H
+
+#include <QPolygon>
+#include <QRect>
+#include <QVector>
+
+/**
+ * \class ElevationGrid
+ *
+ * \author agent
+ *
+ * \brief Quantized elevation raster of a map tile.
+ *
+ * The grid covers the projected area of a map tile with square cells. Every
+ * cell contains the elevation of the highest isoline, which encloses the
+ * cell center. The grid is filled once, when the isolines of the tile are
+ * loaded. Afterwards an elevation lookup is a simple array access.
+ *
+ * The lookup methods do not modify the grid and can be called from any
+ * thread, as long as nobody fills the grid at the same time.
+ *
+ * \date 2026
+ */
+class ElevationGrid
+{
+ public:
+
+  /**
+   * Creates an empty grid.
+   *
+   * \param bounds The covered area in projected map coordinates.
+   */
+  ElevationGrid( const QRect& bounds );
+
+  virtual ~ElevationGrid();
+
+  /**
+   * Fills all cells enclosed by the isoline with its elevation, if the cell
+   * does not contain a higher elevation already.
+   *
+   * \param polygon The isoline in projected map coordinates.
+   *
+   * \param elevation The elevation of the isoline in meters.
+   */
+  void addIsoline( const QPolygon& polygon, const short elevation );
+
+  /**
+   * \return The elevation level of the cell containing the point or -1,
+   *         if the cell is not covered by an isoline.
+   */
+  int level( const QPoint& coordMap ) const;
+
+  /**
+   * \return The elevation at the point, bilinear interpolated between the
+   *         neighbouring cells, or -1, if the point is not covered.
+   */
+  int elevation( const QPoint& coordMap ) const;
+
+  /**
+   * \return The covered area in projected map coordinates.
+   */
+  const QRect& bounds() const
+  {
+    return m_bounds;
+  };
+
+  /**
+   * \return The memory used by the grid in bytes.
+   */
+  qint64 memoryUsage() const
+  {
+    return sizeof(ElevationGrid) + m_cells.size() * sizeof(qint16);
+  };
+
+ private:
+
+  /** Returns the cell value at the given column and row. */
+  qint16 __cell( const int col, const int row ) const
+  {
+    return m_cells.at( row * m_cols + col );
+  };
+
+  /** Area covered by the grid. */
+  QRect m_bounds;
+
+  /** Edge length of a cell in map coordinates. */
+  int m_cellSize;
+
+  /** Number of cell columns. */
+  int m_cols;
+
+  /** Number of cell rows. */
+  int m_rows;
+
+  /** The elevations of the cells, row by row. */
+  QVector<qint16> m_cells;
+};
+
+#endif
@@ -271,6 +271,12 @@ void EvaluationDialog::updateText(int index1, int index2, bool updateAll)
                             "<TD ALIGN=right>" + erg.at(29) + "</TD>" +
                             "<TD>&nbsp;</TD>" +
                             "<TD>&nbsp;</TD>" +
+                            "</TR>" +
+
+                            "<TR><TD>&nbsp;</TD>" +
+                            "<TD colspan=\"7\" ALIGN=left>" +
+                            tr("Altitude max.:") + "&nbsp;" + erg.at(30) + "&nbsp;&nbsp;" +
+                            tr("min.:") + "&nbsp;" + erg.at(31) + "</TD>" +
                             "</TR></TABLE><BR><HR><BR>";
 
         QList<statePoint*> state_list;
@@ -36,28 +36,24 @@
 #include "mapcalc.h"
 #include "mapconfig.h"
 #include "mapcontents.h"
+#include "mapelementindex.h"
 #include "mapmatrix.h"
 #include "optimizationwizard.h"
+#include "scoringengine.h"
 #include "wgspoint.h"
 
 extern QSettings _settings;
 
-/* Number of tasks to be handled during optimization */
-#define NUM_TASKS 25
-#define NUM_TASKS_POINTS ( NUM_TASKS * 3 )
-#define MAX_TASK_ID NUM_TASKS - 1
-
-/* Die Einstellungen können mal in die Voreinstellungsdatei wandern ... */
-#define FAI_POINT 2.0
-#define NORMAL_POINT 1.75
-
 /* Maximale Vergrößerung beim Prüfen! */
 #define SCALE 10.0
 
+/* Number of consecutive fixes checked together against the airspaces */
+#define AS_SEGMENT_SIZE 32
+
 #define APPEND_WAYPOINT(a, b, c) \
       wpL.append(new Waypoint); \
-      wpL.last()->origP = route.at( a )->origP; \
-      wpL.last()->projP = route.at( a )->projP; \
+      wpL.last()->origP = route.origP(a); \
+      wpL.last()->projP = route.projP(a); \
       wpL.last()->distance = ( b ); \
       wpL.last()->name = c; \
       wpL.last()->sector1 = 0; \
@@ -68,22 +64,24 @@ extern QSettings _settings;
 
 #define APPEND_WAYPOINT_OLC2003(a, b, c) \
       wpL.append(new Waypoint); \
-      wpL.last()->origP = route.at( a )->origP; \
-      wpL.last()->projP = route.at( a )->projP; \
+      wpL.last()->origP = route.origP(a); \
+      wpL.last()->projP = route.projP(a); \
       wpL.last()->distance = ( b ); \
       wpL.last()->name = c; \
       wpL.last()->sector1 = 0; \
       wpL.last()->sector2 = 0; \
       wpL.last()->sectorFAI = 0; \
       wpL.last()->angle = -100; \
-      wpL.last()->fixTime = route.at( a )->time;
+      wpL.last()->fixTime = route.time(a);
 
 extern MainWindow*  _mainWindow;
 extern MapContents* _globalMapContents;
 
 Flight::Flight( const QString& fName,
-                const QList<FlightPoint*>& r,
-                const FlightStaticData& flightStaticData )
+                const FlightTrack& r,
+                const FlightStaticData& flightStaticData,
+                const bool showWarnings,
+                const Environment* environment )
   : BaseFlightElement("flight", BaseMapElement::Flight, fName),
     m_flightStaticData(flightStaticData),
     v_max(0),
@@ -91,30 +89,50 @@ Flight::Flight( const QString& fName,
     va_min(0),
     va_max(0),
     route(r),
-    startTime(route.at(0)->time),
-    landTime(route.last()->time),
+    startTime(route.time(0)),
+    landTime(route.time(route.count() - 1)),
     startIndex(0),
     landIndex(route.count()-1),
     origTask(FlightTask(flightStaticData.waypoints, true, QObject::tr("Original task"))),
     optimizedTask(FlightTask(QObject::tr("Optimized task"))),
     optimized(false),
     nAnimationIndex(0),
+    nAnimationDrawn(0),
     bAnimationActive(false),
     taskTimesSet(false),
     m_dfpt(MapConfig::Altitude)
 {
-  origTask.checkWaypoints(route, flightStaticData.gliderType);
+  if( environment != 0 )
+    {
+      origTask.checkWaypoints( route, flightStaticData.gliderType,
+                               showWarnings, environment->pointSettings );
+    }
+  else
+    {
+      origTask.checkWaypoints(route, flightStaticData.gliderType, showWarnings);
+    }
+
+  m_lod.build( route );
 
   __calculateBasicInformation();
   __checkMaxMin();
   __flightState();
-  calAirSpaceIntersections();
+  m_stats.build( route );
+
+  if( environment != 0 )
+    {
+      calAirSpaceIntersections( environment->airspaces );
+    }
+  else
+    {
+      calAirSpaceIntersections();
+    }
 
   header.append(flightStaticData.pilot);
   header.append(flightStaticData.gliderRegistration);
   header.append(flightStaticData.gliderType);
   header.append(flightStaticData.date);
-  header.append(printTime(route.last()->time - route.at(0)->time));
+  header.append(printTime(route.time(route.count() - 1) - route.time(0)));
   header.append(getTaskTypeString());
   header.append(getDistance());
   header.append(getPoints());
@@ -125,55 +143,6 @@ Flight::Flight( const QString& fName,
 
 Flight::~Flight()
 {
-  qDeleteAll( route );
-}
-
-void Flight::__moveOptimizePoint( unsigned int idList[],
-                                  double taskValue[],
-                                  unsigned int id )
-{
-  if(id > MAX_TASK_ID - 1)
-    {
-      return;
-    }
-
-  taskValue[id + 1] = taskValue[id];
-  idList[3 * id + 3] = idList[3 * id];
-  idList[3 * id + 4] = idList[3 * id + 1];
-  idList[3 * id + 5] = idList[3 * id + 2];
-}
-
-void Flight::__setOptimizeRange( unsigned int start[],
-                                 unsigned int stop[],
-                                 unsigned int idList[],
-                                 unsigned int id,
-                                 unsigned int step )
-{
-  /*
-   * Die benutzten Abschnitte müssen komplett innerhalb des Fluges liegen.
-   * Daher werden sie hier ggf. verschoben.
-   */
-  start[0] = qMax(idList[id], step) - step;
-  start[1] = idList[id + 1] - step;
-  start[2] = qMin((int)(idList[id + 2] + step), route.count()) - ( 2 * step );
-
-  stop[0] = start[0] + ( 2 * step );
-  stop[1] = start[1] + ( 2 * step );
-  stop[2] = qMin((int)(start[2] + ( 2 * step )), route.count() - 1);
-}
-
-double Flight::__calculateOptimizePoints( FlightPoint* fp1,
-                                          FlightPoint* fp2,
-                                          FlightPoint* fp3 )
-{
-  double dist1 = dist(fp1, fp2);
-  double dist2 = dist(fp2, fp3);
-  double dist3 = dist(fp1, fp3);
-  double tDist = dist1 + dist2 + dist3;
-
-  if(FlightTask::isFAI(tDist, dist1, dist2, dist3)) return tDist * FAI_POINT;
-
-  return tDist * NORMAL_POINT;
 }
 
 void Flight::__flightState()
@@ -197,8 +166,8 @@ void Flight::__flightState()
 
       while(delta_T<10)
       {
-        delta_T += route.at(m)->dT;
-        bearing += fabs(route.at(m)->dBearing);
+        delta_T += route.dT(m);
+        bearing += fabs(route.dBearing(m));
         m++;
         if(m==route.count())
           break;
@@ -211,10 +180,10 @@ void Flight::__flightState()
           proceed = 0;
           // Turn direction (Drehrichtung)
           // filter large/unrealistic bearing changes: include only changes in bearing which are smaller than 22.5 deg/sec
-          if(fabs(route.at(n)->dBearing*180/(M_PI*route.at(n)->dT)) < 22.5)
+          if(fabs(route.dBearing(n)*180/(M_PI*route.dT(n))) < 22.5)
           {
-            circles += route.at(n)->dBearing;
-            circles_abs += fabs(route.at(n)->dBearing);
+            circles += route.dBearing(n);
+            circles_abs += fabs(route.dBearing(n));
           }
 
           // Kreisflug eingeleitet
@@ -222,8 +191,8 @@ void Flight::__flightState()
               s_point = n;
       }
       else if(s_point > -1 &&
-              route.at(n)->time - route.at(n - proceed)->time  >= 20 &&
-              route.at(n - proceed)->time - route.at(s_point)->time > 45)
+              route.time(n) - route.time(n - proceed)  >= 20 &&
+              route.time(n - proceed) - route.time(s_point) > 45)
       {
           // Circling time at least 20 s (Zeit eines Kreisfluges mindestens 20s)
           // Time between two thermals at most 20 s (Zeit zwischen zwei Kreisflügen höchstens 20s)
@@ -237,11 +206,11 @@ void Flight::__flightState()
               // if 80% of the turns are to the right, then the thermal flight
               // will be to the right
               if(circles>circles_abs*0.8)
-                route.at(n)->f_state = Flight::RightTurn;
+                route.setFState(n, Flight::RightTurn);
               else if(circles<-circles_abs*0.8)
-                route.at(n)->f_state = Flight::LeftTurn;
+                route.setFState(n, Flight::LeftTurn);
               else
-                route.at(n)->f_state = Flight::MixedTurn;
+                route.setFState(n, Flight::MixedTurn);
             }
           s_point = - 1;
           e_point = - 1;
@@ -251,7 +220,7 @@ void Flight::__flightState()
       }
       else
       {
-          if( (route.at(n)->time - route.at(n - proceed)->time)  >= 20)
+          if( (route.time(n) - route.time(n - proceed))  >= 20)
             {
               // Kreisflug war unter 20s und wird daher nicht gewertet
               s_point = - 1;
@@ -274,59 +243,60 @@ void Flight::__calculateBasicInformation()
    * of thermals.
    */
   float        prevBearing = 0, nextBearing = 0 , diffBearing = 0, prevDiffBearing = 0;
+  float        bearing = 0, dBearing = 0;
   unsigned int points = route.count();
 
+  // dH, dT and dS are calculated column wise by the track.
+  route.calculateDeltas();
+
+  if( points < 2 )
+    {
+      return;
+    }
+
   for(unsigned int n = 0; n < points; n++)
   {
     if(n==0)
     {
-      route.at(n)->dH = 0;
-      route.at(n)->dT = qMax( (route.at(n+1)->time - route.at(n)->time), time_t(1));
-      route.at(n)->dS = 0;
-
-      route.at(n)->bearing  = getBearing(*route.at(n), *route.at(n+1));
-      route.at(n)->dBearing = 0;
+      route.setBearing(n, route.course(n, n+1));
+      route.setDBearing(n, 0);
     }
     else if(n==(points-1))
     {
-      route.at(n)->dH = route.at(n)->height - route.at(n-1)->height;
-      route.at(n)->dT = qMax( (route.at(n)->time - route.at(n-1)->time), time_t(1));
-      route.at(n)->dS = (int)(dist(route.at(n)->origP.lat(), route.at(n)->origP.lon(), route.at(n-1)->origP.lat(), route.at(n-1)->origP.lon()) * 1000.0);
-
-      route.at(n)->bearing  = getBearing(*route.at(n-1), *route.at(n));
-      route.at(n)->dBearing = __diffAngle(route.at(n-1)->bearing, route.at(n)->bearing);
+      route.setBearing(n, route.course(n-1, n));
+      route.setDBearing(n, __diffAngle(route.bearing(n-1), route.bearing(n)));
     }
     //calculate the bearing by calculating the average between the bearing with the previous and next point
     else
     {
-      route.at(n)->dH = route.at(n)->height - route.at(n-1)->height;
-      route.at(n)->dT = qMax( (route.at(n)->time - route.at(n-1)->time), time_t(1));
-      route.at(n)->dS = (int)(dist(route.at(n)->origP.lat(), route.at(n)->origP.lon(), route.at(n-1)->origP.lat(), route.at(n-1)->origP.lon()) * 1000.0);
-
-      prevBearing = getBearing(*route.at(n-1), *route.at(n));
-      nextBearing = getBearing(*route.at(n), *route.at(n+1));
+      prevBearing = route.course(n-1, n);
+      nextBearing = route.course(n, n+1);
       diffBearing = __diffAngle(prevBearing, nextBearing);
 
       //in windy conditions large changes in diffBearing can occur, which means that the plane suddenly changes its turn direction
-      if(fabs(prevDiffBearing-diffBearing)*9/route.at(n)->dT > M_PI)
+      if(fabs(prevDiffBearing-diffBearing)*9/route.dT(n) > M_PI)
         diffBearing = -diffBearing;
 
       //calculate the bearing as an average of the previous and the next bearing
       if(diffBearing<0)
-        route.at(n)->bearing = fabs(diffBearing)/2+nextBearing;
+        bearing = fabs(diffBearing)/2+nextBearing;
       else
-        route.at(n)->bearing = fabs(diffBearing)/2+prevBearing;
+        bearing = fabs(diffBearing)/2+prevBearing;
 
       //be sure that the bearing is not larger than 360 degrees
-      if(route.at(n)->bearing > 2.0*M_PI)
-        route.at(n)->bearing  = route.at(n)->bearing - 2.0*M_PI;
+      if(bearing > 2.0*M_PI)
+        bearing = bearing - 2.0*M_PI;
 
-      route.at(n)->dBearing = __diffAngle(route.at(n-1)->bearing, route.at(n)->bearing);
+      route.setBearing(n, bearing);
+
+      dBearing = __diffAngle(route.bearing(n-1), bearing);
       //in windy conditions large changes in dBearing can occur, which means that the plane suddenly changes its turn direction
-      if((route.at(n)->dBearing-route.at(n-1)->dBearing)*9/route.at(n)->dT>270/180*M_PI && route.at(n)->dBearing>0)
-        route.at(n)->dBearing = route.at(n)->dBearing - 2*M_PI;
-      else if((route.at(n)->dBearing-route.at(n-1)->dBearing)*9/route.at(n)->dT<(-270/180*M_PI) && route.at(n)->dBearing<0)
-        route.at(n)->dBearing = route.at(n)->dBearing + 2*M_PI;
+      if((dBearing-route.dBearing(n-1))*9/route.dT(n)>270/180*M_PI && dBearing>0)
+        dBearing = dBearing - 2*M_PI;
+      else if((dBearing-route.dBearing(n-1))*9/route.dT(n)<(-270/180*M_PI) && dBearing<0)
+        dBearing = dBearing + 2*M_PI;
+
+      route.setDBearing(n, dBearing);
 
       prevDiffBearing = diffBearing;
     }
@@ -345,68 +315,6 @@ float Flight::__diffAngle(float firstAngle, float secondAngle)
   return diffAngle;
 }
 
-unsigned int Flight::__calculateBestTask( unsigned int start[],
-                                          unsigned int stop[],
-                                          unsigned int step,
-                                          unsigned int idList[],
-                                          double taskValue[],
-                                          bool isTotal )
-{
-  unsigned int numSteps = 0;
-  double temp = 0;
-  FlightPoint *pointA, *pointB, *pointC;
-
-  for(int loopA = start[0]; loopA <= qMin((int)stop[0], route.count() - 1); loopA += step)
-    {
-      pointA = route.at(loopA);
-
-      if(isTotal) start[1] = loopA + step;
-
-      for(int loopB = start[1]; loopB <= qMin((int)stop[1], route.count() - 1); loopB += step)
-        {
-          pointB = route.at(loopB);
-
-          if(isTotal) start[2] = loopB + step;
-
-          for(int loopC = start[2]; loopC <= qMin((int)stop[2], route.count() - 1); loopC += step)
-            {
-              pointC = route.at(loopC);
-              temp = __calculateOptimizePoints(pointA, pointB, pointC);
-
-              /* wir behalten die besten Dreiecke ( taskValue[0] := bester ) */
-              if(temp > taskValue[MAX_TASK_ID])
-                {
-                  for(unsigned int loop = MAX_TASK_ID; loop > 0; loop--)
-                    {
-                      if(temp > taskValue[loop - 1])
-                        {
-                          __moveOptimizePoint(idList, taskValue, loop - 1);
-                          if(loop == 1)
-                            {
-                              /* temp ist der weiteste Flug */
-                              taskValue[0] = temp;
-                              idList[0] = loopA;
-                              idList[1] = loopB;
-                              idList[2] = loopC;
-                            }
-                        }
-                      else
-                        {
-                          taskValue[loop] = temp;
-                          idList[ 3 * loop ] = loopA;
-                          idList[( 3 * loop ) + 1] = loopB;
-                          idList[( 3 * loop ) + 2] = loopC;
-                          break;
-                        }
-                    }
-                }
-              numSteps++;
-            }
-        }
-    }
-  return numSteps;
-}
-
 void Flight::printMapElement(QPainter* targetPainter, bool isText)
 {
   // qDebug() << "Flight::printMapElement()";
@@ -420,7 +328,7 @@ void Flight::printMapElement(QPainter* targetPainter, bool isText)
   int delta = 1;
   if(!glMapMatrix->isSwitchScale())  delta = 8;
 
-  QPoint curPointA = glMapMatrix->print(route.at(0)->projP);
+  QPoint curPointA = glMapMatrix->print(route.projP(0));
   bBoxFlight.setLeft(curPointA.x());
   bBoxFlight.setTop(curPointA.y());
   bBoxFlight.setRight(curPointA.x());
@@ -433,16 +341,14 @@ void Flight::printMapElement(QPainter* targetPainter, bool isText)
 
   for(int n = delta; n < route.count(); n = n + delta)
     {
-      FlightPoint* pointB = route.at(n);
-
-      QPoint curPointB = glMapMatrix->print(pointB->projP);
+      QPoint curPointB = glMapMatrix->print(route.projP(n));
 
       bBoxFlight.setLeft(qMin(curPointB.x(), bBoxFlight.left()));
       bBoxFlight.setTop(qMax(curPointB.y(), bBoxFlight.top()));
       bBoxFlight.setRight(qMax(curPointB.x(), bBoxFlight.right()));
       bBoxFlight.setBottom(qMin(curPointB.y(), bBoxFlight.bottom()));
 
-      QPen drawP = glConfig->getDrawPen( pointB,
+      QPen drawP = glConfig->getDrawPen( route, n,
                                          vario_min,
                                          vario_max,
                                          altitude_max,
@@ -476,15 +382,17 @@ bool Flight::drawMapElement( QPainter* targetPainter )
       origTask.drawMapElement( targetPainter );
     }
 
-  // Draw flight way
-  unsigned int delta = 1;
+  // Draw flight way. The level of detail is selected by the map scale,
+  // chunks outside of the map view are skipped.
+  const QTransform& matrix = glMapMatrix->getWorldMatrix();
+  const int level = m_lod.levelForScale( FlightTrackLod::pixelsPerUnit( matrix ) );
+  const QVector<int>& indices = m_lod.indices( level );
+  const QVector<FlightTrackLod::Chunk>& chunks = m_lod.chunks( level );
 
-  if(!glMapMatrix->isSwitchScale())
-    {
-      delta = 8;
-    }
+  // Margin for the width of the pens.
+  const QRect view = targetPainter->window().adjusted( -8, -8, 8, 8 );
 
-  QPoint curPointA = glMapMatrix->map(route.at(0)->projP);
+  QPoint curPointA = glMapMatrix->map(route.projP(0));
   bBoxFlight.setLeft(curPointA.x());
   bBoxFlight.setTop(curPointA.y());
   bBoxFlight.setRight(curPointA.x());
@@ -502,28 +410,104 @@ bool Flight::drawMapElement( QPainter* targetPainter )
 
   m_dfpt = (MapConfig::DrawFlightPointType) _settings.value( "/Flight/DrawType", MapConfig::Altitude).toInt();
 
-  for(unsigned int n = delta; n < nStop; n = n + delta)
+  for( int c = 0; c < chunks.size(); c++ )
     {
-      FlightPoint* pointB = route.at(n);
+      const FlightTrackLod::Chunk& chunk = chunks.at(c);
+      const QRect box = matrix.mapRect( chunk.box );
 
-      QPoint curPointB = glMapMatrix->map(pointB->projP);
+      // The bounding box covers the whole flight, also the hidden parts.
+      bBoxFlight.setLeft(qMin(box.left(), bBoxFlight.left()));
+      bBoxFlight.setTop(qMax(box.bottom(), bBoxFlight.top()));
+      bBoxFlight.setRight(qMax(box.right(), bBoxFlight.right()));
+      bBoxFlight.setBottom(qMin(box.top(), bBoxFlight.bottom()));
 
-      bBoxFlight.setLeft(qMin(curPointB.x(), bBoxFlight.left()));
-      bBoxFlight.setTop(qMax(curPointB.y(), bBoxFlight.top()));
-      bBoxFlight.setRight(qMax(curPointB.x(), bBoxFlight.right()));
-      bBoxFlight.setBottom(qMin(curPointB.y(), bBoxFlight.bottom()));
+      if( (unsigned int) indices[chunk.first] >= nStop || ! view.intersects( box ) )
+        {
+          continue;
+        }
+
+      curPointA = glMapMatrix->map(route.projP(indices[chunk.first]));
+
+      for( int i = chunk.first + 1; i <= chunk.last; i++ )
+        {
+          const int n = indices[i];
 
-      QPen drawP = glConfig->getDrawPen(pointB, vario_min, vario_max, altitude_max, speed_max, m_dfpt);
+          if( (unsigned int) n >= nStop )
+            {
+              break;
+            }
+
+          QPoint curPointB = glMapMatrix->map(route.projP(n));
+
+          QPen drawP = glConfig->getDrawPen(route, n, vario_min, vario_max, altitude_max, speed_max, m_dfpt);
+          drawP.setCapStyle(Qt::SquareCap);
+          targetPainter->setPen(drawP);
+          targetPainter->drawLine(curPointA, curPointB);
+
+          curPointA = curPointB;
+        }
+    }
+
+  // The animation continues behind the last fix of the level before nStop.
+  nAnimationDrawn = ( nStop > 0 ) ? indices[m_lod.position( level, nStop - 1 )] : 0;
+
+  return true;
+}
+
+QRect Flight::drawAnimationStep( QPainter* targetPainter )
+{
+  QRect dirty;
+
+  if( ! isVisible() )
+    {
+      return dirty;
+    }
+
+  // The same level is used as by drawMapElement, the result is identical
+  // to a complete redraw.
+  const int level = m_lod.levelForScale( FlightTrackLod::pixelsPerUnit( glMapMatrix->getWorldMatrix() ) );
+  const QVector<int>& indices = m_lod.indices( level );
+
+  int nStop = bAnimationActive ? nAnimationIndex : route.count() - 1;
+  int pos = m_lod.position( level, nAnimationDrawn );
+
+  if( pos + 1 >= indices.size() || indices[pos + 1] >= nStop )
+    {
+      return dirty;
+    }
+
+  float vario_min = getPoint(VA_MIN).dH/getPoint(VA_MIN).dT;
+  float vario_max = getPoint(VA_MAX).dH/getPoint(VA_MAX).dT;
+  int altitude_max = getPoint(H_MAX).height;
+  float speed_max = getPoint(V_MAX).dS/getPoint(V_MAX).dT;
+
+  m_dfpt = (MapConfig::DrawFlightPointType) _settings.value( "/Flight/DrawType", MapConfig::Altitude).toInt();
+
+  QPoint curPointA = glMapMatrix->map(route.projP(indices[pos]));
+  int penWidth = 0;
+
+  dirty = QRect( curPointA, curPointA );
+
+  for( pos++; pos < indices.size() && indices[pos] < nStop; pos++ )
+    {
+      const int n = indices[pos];
+
+      QPoint curPointB = glMapMatrix->map(route.projP(n));
+
+      QPen drawP = glConfig->getDrawPen(route, n, vario_min, vario_max, altitude_max, speed_max, m_dfpt);
       drawP.setCapStyle(Qt::SquareCap);
       targetPainter->setPen(drawP);
       targetPainter->drawLine(curPointA, curPointB);
 
-      /* tries to find the elevation of the surface under the point */
-      // send a signal with the curPointA, and the index of the point [ n * delta - (delta - 1) ] */
+      penWidth = qMax( penWidth, drawP.width() );
+      dirty |= QRect( curPointB, curPointB );
+
       curPointA = curPointB;
+      nAnimationDrawn = n;
     }
 
-  return true;
+  // The square caps extend the lines by half of the pen width.
+  return dirty.adjusted( -penWidth - 1, -penWidth - 1, penWidth + 1, penWidth + 1 );
 }
 
 QString Flight::getTaskTypeString( bool isOrig ) const
@@ -546,8 +530,8 @@ int Flight::getPointIndexByTime(time_t time)
  int diff, n, sp, ep;
 
   // Estimate a near point on the route to reduce linear search
-  diff = (route.last()->time - route.at(0)->time) / route.count();
-  sp = (time - route.at(0)->time) / diff;
+  diff = (route.time(route.count() - 1) - route.time(0)) / route.count();
+  sp = (time - route.time(0)) / diff;
   if ( sp < 0 )
     sp = 0;
 
@@ -555,7 +539,7 @@ int Flight::getPointIndexByTime(time_t time)
     sp = route.count()-1;
 
   // sp is now hopefully an index near to the wanted fix time
-  if( route.at(sp)->time < time ) {
+  if( route.time(sp) < time ) {
     n = 1;
     ep = route.count() - 1;
   }
@@ -564,14 +548,14 @@ int Flight::getPointIndexByTime(time_t time)
     ep = 0;
   }
 
-  diff = route.at(sp)->time - time;
+  diff = route.time(sp) - time;
   diff = abs(diff);
 
   if ( sp != ep )
   {
     for(int l = sp+n; l != ep; l += n) // l < (int)route.count() && l >= 0; l += n)
     {
-      int a = route.at(l)->time - time;
+      int a = route.time(l) - time;
       a = abs(a);
       if( a > diff )
         return l-n;
@@ -587,15 +571,15 @@ FlightPoint Flight::getPoint(int n)
 {
   if( n >= 0 && n < route.count() )
     {
-      return *route.at( n );
+      return route.point(n);
     }
 
   switch(n)
     {
-      case V_MAX: return *route.at(v_max);
-      case H_MAX: return *route.at(h_max);
-      case VA_MAX: return *route.at(va_max);
-      case VA_MIN: return *route.at(va_min);
+      case V_MAX: return route.point(v_max);
+      case H_MAX: return route.point(h_max);
+      case VA_MAX: return route.point(va_max);
+      case VA_MIN: return route.point(va_min);
       default:
         FlightPoint ret;
         ret.gpsHeight = 0;
@@ -615,45 +599,25 @@ QStringList Flight::getFlightValues(unsigned int start, unsigned int end)
   //  noch abchecken, dass end <= fluglänge
   end = qMin(route.count() - 1, (int)end);
 
-  for(unsigned int n = start; n < end; n++)
-    {
-      switch(route.at(n)->f_state)
-        {
-          case Flight::RightTurn:
-            if(route.at(n)->dH > 0)
-                k_height_pos_r += (float)route.at(n)->dH;
-            else
-                k_height_neg_r += (float)route.at(n)->dH;
-
-            kurbel_r += route.at(n)->dT;
-            break;
-          case Flight::LeftTurn:
-            if(route.at(n)->dH > 0)
-                k_height_pos_l += (float)route.at(n)->dH;
-            else
-                k_height_neg_l += (float)route.at(n)->dH;
-
-            kurbel_l += route.at(n)->dT;
-            break;
-          case Flight::MixedTurn:
-            if(route.at(n)->dH > 0)
-                k_height_pos_v += (float)route.at(n)->dH;
-            else
-                k_height_neg_v += (float)route.at(n)->dH;
-
-            kurbel_v += route.at(n)->dT;
-            break;
-          default:
-           // immer oder bloß auf Strecke ??
-           distance += (float)route.at(n)->dS;
-
-           if(route.at(n)->dH > 0)
-                s_height_pos += (float)route.at(n)->dH;
-            else
-                s_height_neg += (float)route.at(n)->dH;
-           break;
-         }
-    }
+  // The sums of the section are taken from the prefix sums of the route.
+  const FlightTrackStats::Sums sums = m_stats.sums( start, end );
+
+  k_height_pos_r = (float)sums.dHPos[Flight::RightTurn];
+  k_height_neg_r = (float)sums.dHNeg[Flight::RightTurn];
+  kurbel_r       = sums.dT[Flight::RightTurn];
+
+  k_height_pos_l = (float)sums.dHPos[Flight::LeftTurn];
+  k_height_neg_l = (float)sums.dHNeg[Flight::LeftTurn];
+  kurbel_l       = sums.dT[Flight::LeftTurn];
+
+  k_height_pos_v = (float)sums.dHPos[Flight::MixedTurn];
+  k_height_neg_v = (float)sums.dHNeg[Flight::MixedTurn];
+  kurbel_v       = sums.dT[Flight::MixedTurn];
+
+  // immer oder bloß auf Strecke ??
+  distance     = (float)sums.dS;
+  s_height_pos = (float)sums.dHPos[Flight::Straight];
+  s_height_neg = (float)sums.dHNeg[Flight::Straight];
 
   QStringList result;
   QString text;
@@ -677,7 +641,7 @@ QStringList Flight::getFlightValues(unsigned int start, unsigned int end)
   //index: 3 total turn time
   text.sprintf("%s <small>(%.1f%%)</small>",
                printTime((kurbel_r + kurbel_l + kurbel_v), true, true, true).toLatin1().data(),
-               (float)(kurbel_r + kurbel_l + kurbel_v) / (float)( route.at(end)->time - route.at(start)->time ) * 100.0);
+               (float)(kurbel_r + kurbel_l + kurbel_v) / (float)( route.time(end) - route.time(start) ) * 100.0);
   result.append(text);
 
   //index: 4 right turn vario
@@ -739,7 +703,7 @@ QStringList Flight::getFlightValues(unsigned int start, unsigned int end)
   result.append(text);
   //index: 21 straight speed
   text.sprintf("%.1f km/h",distance /
-        ((float)(route.at(end)->time - route.at(start)->time -
+        ((float)(route.time(end) - route.time(start) -
         (kurbel_r + kurbel_l + kurbel_v))) * 3.6);
   result.append(text);
   //index: 22 straight dH
@@ -756,14 +720,14 @@ QStringList Flight::getFlightValues(unsigned int start, unsigned int end)
   result.append(text);
   //index: 26 straight time
   text.sprintf("%s <small>(%.1f%%)</small>",
-               printTime( (int)( route.at(end)->time - route.at(start)->time - ( kurbel_r + kurbel_l + kurbel_v ) ) , true, true, true).toLatin1().data(),
-               (float)( route.at(end)->time - route.at(start)->time - ( kurbel_r + kurbel_l + kurbel_v ) ) / (float)( route.at(end)->time - route.at(start)->time ) * 100.0);
+               printTime( (int)( route.time(end) - route.time(start) - ( kurbel_r + kurbel_l + kurbel_v ) ) , true, true, true).toLatin1().data(),
+               (float)( route.time(end) - route.time(start) - ( kurbel_r + kurbel_l + kurbel_v ) ) / (float)( route.time(end) - route.time(start) ) * 100.0);
   result.append(text);
 
   //Total
   //index: 27 total time
   text.sprintf("%s",
-      printTime((int)(route.at(end)->time - route.at(start)->time), true, true, true).toLatin1().data());
+      printTime((int)(route.time(end) - route.time(start)), true, true, true).toLatin1().data());
   result.append(text);
   //index: 28 total dH
   text.sprintf("%.0f m",s_height_pos   + k_height_pos_r
@@ -774,6 +738,16 @@ QStringList Flight::getFlightValues(unsigned int start, unsigned int end)
                       + k_height_neg_l + k_height_neg_v);
   result.append(text);
 
+  int minHeight = 0, maxHeight = 0;
+  m_stats.heightRange( start, end, minHeight, maxHeight );
+
+  //index: 30 maximum altitude
+  text.sprintf("%d m", maxHeight);
+  result.append(text);
+  //index: 31 minimum altitude
+  text.sprintf("%d m", minHeight);
+  result.append(text);
+
   // Rückgabe:
   // kurbelanteil r - l - v - g
   // mittleres Steigen r - l - v - g
@@ -789,24 +763,46 @@ QList<statePoint*> Flight::getFlightStates(unsigned int start, unsigned int end)
 {
   int dH_pos = 0, dH_neg = 0;
   int duration = 0;
-  int n_start = 0;
+  int n_start = start;
   int distance = 0;
   float circ_angle_sum = 0;
   float vario = 0;
-  unsigned int state = route.at(start)->f_state;
+  unsigned int state;
   QList<statePoint*> state_list;
   statePoint state_info;
 
   end = qMin(route.count() - 1, (int)end);
 
-  for(unsigned int n = start; n < end; n++)
-  {
-      // copy info about previous state into state_list, when state changes
-    if(state!=route.at(n)->f_state || n==(end-1))
+  if( (int) end <= 0 || start >= end )
     {
+      return state_list;
+    }
+
+  // A state ends at every change of the flight state and at the end of
+  // the section.
+  QVector<int> stateEnds = m_stats.stateChanges( start, end - 1 );
+  stateEnds.append( end - 1 );
+
+  for(int i = 0; i < stateEnds.size(); i++)
+    {
+      const int n = stateEnds.at(i);
+
+      // The sums of the state are taken from the prefix sums of the route.
+      state = route.fState(n_start);
+
+      const int s = FlightTrackStats::stateIndex(state);
+      const FlightTrackStats::Sums sums = m_stats.sums(n_start, n);
+
+      dH_pos = sums.dHPos[s];
+      dH_neg = sums.dHNeg[s];
+      duration = sums.dT[s];
+      distance = sums.dS;
+      circ_angle_sum = (float) m_stats.bearingSum(n_start, n);
+
+      // copy info about the state into state_list
       state_info.f_state = state;
-      state_info.start_time = route.at(n_start)->time;
-      state_info.end_time = route.at(n)->time;
+      state_info.start_time = route.time(n_start);
+      state_info.end_time = route.time(n);
       state_info.duration = duration;
       if(state==Flight::Straight)
         //cruising:
@@ -815,12 +811,12 @@ QList<statePoint*> Flight::getFlightStates(unsigned int start, unsigned int end)
       else
         //circling:
         //distance of a straight line between start and end point
-        state_info.distance = dist(route.at(n_start), route.at(n));
+        state_info.distance = route.distance(n_start, n);
       state_info.speed = state_info.distance/duration*3600.0;
-      state_info.L_D = state_info.distance*1000.0/(route.at(n_start)->height-route.at(n)->height);
+      state_info.L_D = state_info.distance*1000.0/(route.height(n_start)-route.height(n));
       state_info.circles = fabs(circ_angle_sum/(2*M_PI));
       if(duration>0) //to prevent a buffer overflow
-        vario = (route.at(n)->height-route.at(n_start)->height)/((float) duration);
+        vario = (route.height(n)-route.height(n_start))/((float) duration);
       state_info.vario = vario;
       state_info.dH_pos = dH_pos;
       state_info.dH_neg = dH_neg;
@@ -828,23 +824,9 @@ QList<statePoint*> Flight::getFlightStates(unsigned int start, unsigned int end)
       state_list.append(new statePoint);
       *(state_list.last()) = state_info;
 
-      //reset for next state
-      state = route.at(n)->f_state;
-      dH_pos = 0;
-      dH_neg = 0;
-      duration = 0;
-      distance = 0;
-      circ_angle_sum = 0;
+      // next state
       n_start = n;
     }
-      if(route.at(n)->dH > 0)
-        dH_pos += route.at(n)->dH;
-      else
-        dH_neg += route.at(n)->dH;
-      duration += route.at(n)->dT;
-      distance += route.at(n)->dS;
-      circ_angle_sum += route.at(n)->bearing;
-    }
 
     return state_list;
 }
@@ -891,33 +873,63 @@ int Flight::getLandIndex() const { return landIndex; }
 
 int Flight::searchPoint(const QPoint& cPoint, FlightPoint& searchPoint)
 {
-  unsigned int delta = 1;
   int index = -1;
 
   double minDist = 1000.0, distance = 0.0;
 
-  if(!glMapMatrix->isSwitchScale())  delta = 8;
+  // Only the chunks in the near of the position are searched. They are
+  // taken from level 0, that the nearest logged fix is found.
+  const QTransform& matrix = glMapMatrix->getWorldMatrix();
+  const double pixelsPerUnit = FlightTrackLod::pixelsPerUnit( matrix );
+
+  if( pixelsPerUnit <= 0.0 || m_lod.levels() == 0 )
+    {
+      return index;
+    }
+
+  const int radius = (int) ceil( 30.0 / pixelsPerUnit );
+  const QPoint projCursor = matrix.inverted().map( cPoint );
+
+  const QVector<int>& indices = m_lod.indices( 0 );
+  const QVector<FlightTrackLod::Chunk>& chunks = m_lod.chunks( 0 );
 
   QPoint fPoint;
 
-  for(int loop = 0; loop < route.count(); loop = loop + delta)
+  for( int c = 0; c < chunks.size(); c++ )
     {
-      fPoint = glMapMatrix->map(route.at(loop)->projP);
-      int dX = cPoint.x() - fPoint.x();
-      int dY = cPoint.y() - fPoint.y();
-      distance = sqrt( (dX * dX) + (dY * dY) );
+      const FlightTrackLod::Chunk& chunk = chunks.at(c);
 
-      /* Maximaler Abstand: 30 Punkte */
-      if(distance < 30.0)
+      if( ! chunk.box.adjusted( -radius, -radius, radius, radius ).contains( projCursor ) )
         {
-          if(distance < minDist)
+          continue;
+        }
+
+      for( int i = chunk.first; i <= chunk.last; i++ )
+        {
+          const int loop = indices[i];
+
+          fPoint = glMapMatrix->map(route.projP(loop));
+          int dX = cPoint.x() - fPoint.x();
+          int dY = cPoint.y() - fPoint.y();
+          distance = sqrt( (dX * dX) + (dY * dY) );
+
+          /* Maximaler Abstand: 30 Punkte */
+          if(distance < 30.0)
             {
-              minDist = distance;
-              index = loop;
-              searchPoint = *route.at(index);
+              if(distance < minDist)
+                {
+                  minDist = distance;
+                  index = loop;
+                }
             }
         }
     }
+
+  if( index >= 0 )
+    {
+      searchPoint = route.point(index);
+    }
+
   return index;
 }
 
@@ -939,23 +951,27 @@ void Flight::__checkMaxMin()
   va_min = 0;
   float tmp, refv = .0, refh = .0, refva1 = .0 , refva2 = 500.;
 
-  FlightPoint *fp;
-  unsigned int loop = 0;
-  foreach(fp, route) {
+  const int  cnt    = route.count();
+  const int* height = route.heights();
+  const int* dH     = route.dHs();
+  const int* dT     = route.dTs();
+  const int* dS     = route.dSs();
+
+  for(int loop = 0; loop < cnt; loop++) {
       // Fetch extreme values
-      tmp = (float)fp->dS / (float)fp->dT;
+      tmp = (float)dS[loop] / (float)dT[loop];
       if(tmp > refv) {
           v_max = loop;
           refv = tmp;
       }
 
-      tmp = fp->height;
+      tmp = height[loop];
       if(tmp > refh) {
           h_max = loop;
           refh = tmp;
       }
 
-      tmp = (float)fp->dH / (float)fp->dT;
+      tmp = (float)dH[loop] / (float)dT[loop];
       if(tmp > refva1) {
           va_max = loop;
           refva1 = tmp;
@@ -964,8 +980,6 @@ void Flight::__checkMaxMin()
           va_min = loop;
           refva2 = tmp;
       }
-
-      loop++;
   }
 }
 
@@ -1012,26 +1026,19 @@ bool Flight::optimizeTaskOLC( Map* map )
   QList<Waypoint*> wpL;
 
   APPEND_WAYPOINT_OLC2003(startIndex, 0, QObject::tr("Take-Off"))
-  APPEND_WAYPOINT_OLC2003(idList[0], dist(route.at(idList[0]), route.at(0)),
+  APPEND_WAYPOINT_OLC2003(idList[0], route.distance(idList[0], 0),
       QObject::tr("Soaring Begin"))
-  APPEND_WAYPOINT_OLC2003(idList[1], dist(route.at(idList[1]), route.at(1)),
+  APPEND_WAYPOINT_OLC2003(idList[1], route.distance(idList[1], 1),
       QObject::tr("Task Begin"))
-  APPEND_WAYPOINT_OLC2003(idList[2], dist(route.at(idList[2]),
-      route.at(idList[1])), QObject::tr("OLC 1"))
-  APPEND_WAYPOINT_OLC2003(idList[3], dist(route.at(idList[3]),
-      route.at(idList[2])), QObject::tr("OLC 2"))
-  APPEND_WAYPOINT_OLC2003(idList[4], dist(route.at(idList[4]),
-      route.at(idList[3])), QObject::tr("OLC 3"))
-  APPEND_WAYPOINT_OLC2003(idList[5], dist(route.at(idList[5]),
-      route.at(idList[4])), QObject::tr("OLC 4"))
-  APPEND_WAYPOINT_OLC2003(idList[6], dist(route.at(idList[6]),
-      route.at(idList[5])), QObject::tr("OLC 5"))
-  APPEND_WAYPOINT_OLC2003(idList[7], dist(route.at(idList[7]),
-      route.at(idList[6])), QObject::tr("Task End"))
-  APPEND_WAYPOINT_OLC2003(idList[8], dist(route.at(idList[8]),
-      route.at(idList[7])), QObject::tr("Soaring End"))
-  APPEND_WAYPOINT_OLC2003(landIndex, dist(route.last(),
-      route.at(idList[8])), QObject::tr("Landing"))
+  APPEND_WAYPOINT_OLC2003(idList[2], route.distance(idList[2], idList[1]), QObject::tr("OLC 1"))
+  APPEND_WAYPOINT_OLC2003(idList[3], route.distance(idList[3], idList[2]), QObject::tr("OLC 2"))
+  APPEND_WAYPOINT_OLC2003(idList[4], route.distance(idList[4], idList[3]), QObject::tr("OLC 3"))
+  APPEND_WAYPOINT_OLC2003(idList[5], route.distance(idList[5], idList[4]), QObject::tr("OLC 4"))
+  APPEND_WAYPOINT_OLC2003(idList[6], route.distance(idList[6], idList[5]), QObject::tr("OLC 5"))
+  APPEND_WAYPOINT_OLC2003(idList[7], route.distance(idList[7], idList[6]), QObject::tr("Task End"))
+  APPEND_WAYPOINT_OLC2003(idList[8], route.distance(idList[8], idList[7]), QObject::tr("Soaring End"))
+  APPEND_WAYPOINT_OLC2003(landIndex, route.distance(route.count() - 1,
+      idList[8]), QObject::tr("Landing"))
 
   optimizedTask.setWaypointList(wpL);
   optimizedTask.checkWaypoints(route, m_flightStaticData.gliderType);
@@ -1043,123 +1050,56 @@ bool Flight::optimizeTaskOLC( Map* map )
 }
 
 /*
- * The optimization is done in two runs. During the first run, we go
- * with a special step-width, which is calculated
+ * The FAI and the free triangle are searched by the ScoringEngine. It
+ * calculates the distances between selected candidate fixes once, takes the
+ * best triangles of all candidate triples and at last moves every turnpoint
+ * to the best fix of the full track in its neighbourhood. All standard
+ * rules are scored in this pass. The better one of both triangles is offered
+ * to the user as the new task, the other results are shown with it.
  */
 bool Flight::optimizeTask()
 {
   if( route.count() < 10)  return false;
 
-  unsigned int curNumSteps = 0, temp, step = 0, minNumSteps = 400000000;
+  const QList<ScoringRule> rules = ScoringRule::standardRules();
 
-  for(unsigned int curStep = 1; curStep < 100; curStep++)
-    {
-      /*
-       * ( route.count / curStep ) is the number of points used for the
-       * first optimization-run. If this number is smaller than 3, we
-       * cannot create a triangle.
-       */
-      if((route.count() / curStep) < 3)
-        {
-          break;
-        }
+  ScoringEngine engine;
 
-      curNumSteps = 1;
-      temp = 1;
+  for( int i = 0; i < rules.size(); i++ )
+    {
+      engine.addRule( rules.at(i) );
+    }
 
-      /*
-       * Calculating the step-width for the first run.
-       */
-      for(unsigned int loop = 3; loop < ( route.count() / curStep ); loop++)
-        {
-          curNumSteps += temp + loop;
-          temp += loop;
-        }
+  QList<ScoringResult> results = engine.score( route );
 
-      temp = 1;
+  // Only a triangle can be used as task.
+  int best = -1;
 
-      /*
-       * Calculating the number of steps for the second run.
-       */
-      for(unsigned int loop = 3; loop < ( curStep - 1 ) * 6; loop++)
+  for( int i = 0; i < results.size(); i++ )
+    {
+      if( rules.at(i).discipline != ScoringRule::FaiTriangle &&
+          rules.at(i).discipline != ScoringRule::FreeTriangle )
         {
-          curNumSteps += temp + loop;
-          temp += loop;
+          continue;
         }
 
-      if(minNumSteps > curNumSteps)
+      if( results.at(i).valid &&
+          ( best < 0 || results.at(i).points > results.at(best).points ) )
         {
-          minNumSteps = curNumSteps;
-          step = curStep;
+          best = i;
         }
     }
 
-  unsigned int numSteps = 0, totalSteps = 0, secondSteps = 0, start[3], stop[3];
-  /*
-   * in taskValues stehen jetzt die Längen der längsten Flüge.
-   * in idList die Indizes der drei Punkte dieser Flüge.
-   */
-  unsigned int idList[NUM_TASKS_POINTS], idTempList[NUM_TASKS_POINTS];
-  double taskValue[NUM_TASKS];
-
-  for( unsigned int loop = 0; loop < NUM_TASKS; loop++ )
+  if( best < 0 )
     {
-      taskValue[loop] = 0;
-    }
-
-  start[0] = 0;
-  start[1] = step - 1;
-  start[2] = (2 * step) - 1;
-  stop[0] = route.count() - ( 2 * step );
-  stop[1] = route.count() - step;
-  stop[2] = route.count();
-
-  for( unsigned int loop = 0; loop < NUM_TASKS; loop++ )
-    {
-      taskValue[loop] = 0;
-    }
-
-  // steps muss noch besser berechnet werden!!!
-  step = step * 3;
-
-  numSteps = __calculateBestTask(start, stop, step, idList, taskValue, true);
-  totalSteps = numSteps;
-
-  // Sichern der ID's der Favoriten
-  for( unsigned int loop = 0; loop < NUM_TASKS_POINTS; loop++ )
-    {
-      idTempList[loop] = idList[loop];
-    }
-
-  unsigned int stepB = qMax((int)step / 6, 4);
-
-  for(unsigned int loop = 0; loop < NUM_TASKS; loop++)
-    {
-      __setOptimizeRange(start, stop, idTempList, loop * 3, step);
-
-      numSteps = __calculateBestTask(start, stop, stepB, idList, taskValue, false);
-      secondSteps += numSteps;
-    }
-  step = stepB;
-
-  secondSteps = 0;
-  // Sichern der ID's der Favoriten
-  for(unsigned int loop = 0; loop < NUM_TASKS_POINTS; loop++)
-      idTempList[loop] = idList[loop];
-
-  for(unsigned int loop = 0; loop < NUM_TASKS / 2; loop++)
-    {
-      __setOptimizeRange(start, stop, idTempList, loop * 3, step);
-
-      numSteps = __calculateBestTask(start, stop, 1, idList, taskValue, false);
-      secondSteps += numSteps;
+      return false;
     }
 
-  totalSteps += secondSteps;
+  const QVector<int>& idList = results.at(best).fixes;
 
-  double dist1 = dist(route.at(idList[0]), route.at(idList[1]));
-  double dist2 = dist(route.at(idList[1]), route.at(idList[2]));
-  double dist3 = dist(route.at(idList[0]), route.at(idList[2]));
+  double dist1 = route.distance(idList[0], idList[1]);
+  double dist2 = route.distance(idList[1], idList[2]);
+  double dist3 = route.distance(idList[0], idList[2]);
   double totalDist = dist1 + dist2 + dist3;
 
   /*
@@ -1168,23 +1108,37 @@ bool Flight::optimizeTask()
    * Da wir wissen, dass alle Wegpunkte erreicht worden sind, können wir
    * hier die Berechnung der Punkte vereinfachen!
    */
-  QString text, distText, pointText;
+  QString text, distText, pointText, rulesText;
 
   if(FlightTask::isFAI(totalDist, dist1, dist2, dist3))
-      pointText.sprintf(" %d (FAI)", (int)(totalDist * 2.0 * 0.85));
+      pointText.sprintf(" %d (FAI)", (int)(totalDist * FAI_POINT * 0.85));
   else
-      pointText.sprintf(" %d", (int)(totalDist * 1.75 * 0.85));
+      pointText.sprintf(" %d", (int)(totalDist * NORMAL_POINT * 0.85));
+
+  for( int i = 0; i < results.size(); i++ )
+    {
+      const ScoringResult& result = results.at(i);
+
+      if( result.valid )
+        {
+          rulesText += QString("\t%1:  %2 km  %3\n")
+                       .arg( result.rule )
+                       .arg( result.distance, 0, 'f', 2 )
+                       .arg( result.points, 0, 'f', 1 );
+        }
+    }
 
   distText.sprintf(" %.2f km  ", totalDist);
   text = QObject::tr("The task has been optimized. The best task found is:\n\n");
   text = text + "\t1:  "
-      + WGSPoint::printPos(route.at(idList[0])->origP.lat()) + " / "
-      + WGSPoint::printPos(route.at(idList[0])->origP.lon(), false) + "\n\t2:  "
-      + WGSPoint::printPos(route.at(idList[1])->origP.lat()) + " / "
-      + WGSPoint::printPos(route.at(idList[1])->origP.lon(), false) + "\n\t3:  "
-      + WGSPoint::printPos(route.at(idList[2])->origP.lat()) + " / "
-      + WGSPoint::printPos(route.at(idList[2])->origP.lon(), false) + "\n\n\t"
+      + WGSPoint::printPos(route.lat(idList[0])) + " / "
+      + WGSPoint::printPos(route.lon(idList[0]), false) + "\n\t2:  "
+      + WGSPoint::printPos(route.lat(idList[1])) + " / "
+      + WGSPoint::printPos(route.lon(idList[1]), false) + "\n\t3:  "
+      + WGSPoint::printPos(route.lat(idList[2])) + " / "
+      + WGSPoint::printPos(route.lon(idList[2]), false) + "\n\n\t"
       + QObject::tr("Distance:") + distText + QObject::tr("Points:") + pointText + "\n\n"
+      + QObject::tr("Scores of the contest rules:") + "\n" + rulesText + "\n"
       + QObject::tr("Do You want to use this task and replace the old?");
 
   if(QMessageBox::question(0, QObject::tr("Optimizing"), text, QMessageBox::Yes, QMessageBox::No) ==
@@ -1194,13 +1148,11 @@ bool Flight::optimizeTask()
 
       APPEND_WAYPOINT(0, 0, QObject::tr("Take-Off"))
       APPEND_WAYPOINT(0, 0, QObject::tr("Begin of Task"))
-      APPEND_WAYPOINT(idList[0], dist(route.at(idList[0]), route.at(0)),
+      APPEND_WAYPOINT(idList[0], route.distance(idList[0], 0),
           QObject::tr("Optimize 1"))
-      APPEND_WAYPOINT(idList[1], dist(route.at(idList[1]),
-          route.at(idList[0])), QObject::tr("Optimize 2"))
-      APPEND_WAYPOINT(idList[2], dist(route.at(idList[2]),
-          route.at(idList[1])), QObject::tr("Optimize 3"))
-      APPEND_WAYPOINT(0, dist(route.at(0), route.at(idList[1])),
+      APPEND_WAYPOINT(idList[1], route.distance(idList[1], idList[0]), QObject::tr("Optimize 2"))
+      APPEND_WAYPOINT(idList[2], route.distance(idList[2], idList[1]), QObject::tr("Optimize 3"))
+      APPEND_WAYPOINT(0, route.distance(0, idList[1]),
           QObject::tr("End of Task"))
       APPEND_WAYPOINT(0, 0, QObject::tr("Landing"))
 
@@ -1225,7 +1177,7 @@ int Flight::searchGetNextPoint(int index, FlightPoint& searchPoint)
     }
 
   // now update searchPoint struct
-  searchPoint = *route.at( index );
+  searchPoint = route.point(index);
   return index;
 }
 
@@ -1239,7 +1191,7 @@ int Flight::searchGetPrevPoint(int index, FlightPoint& searchPoint)
     }
 
   // now update searchPoint struct
-  searchPoint = *route.at( index );
+  searchPoint = route.point(index);
   return index;
 }
 
@@ -1313,6 +1265,24 @@ void Flight::setAnimationNextIndex(void)
     }
 }
 
+/** Advances the nAnimationIndex member by the playback time */
+void Flight::setAnimationTime(int seconds)
+{
+  const time_t t = route.time(0) + seconds;
+
+  // The index is only moved forward, that keeps a tick at O(new fixes).
+  while( nAnimationIndex + 1 < route.count() && route.time(nAnimationIndex + 1) <= t )
+    {
+      nAnimationIndex++;
+    }
+
+  if( nAnimationIndex >= route.count() - 1 )
+    {
+      nAnimationIndex = route.count() - 1;
+      bAnimationActive = false; //stop the animation of this flight
+    }
+}
+
 /** sets the bAnimationActive flag */
 void Flight::setAnimationActive(bool b)  {  bAnimationActive = b;  }
 
@@ -1333,131 +1303,277 @@ void Flight::reProject()
 {
   extern MapMatrix *_globalMapMatrix;
 
-  FlightPoint *fp;
+  for( int i = 0; i < route.count(); i++ )
+    {
+      route.setProjP( i, _globalMapMatrix->wgsToMap( route.lat(i), route.lon(i) ) );
+    }
 
-  foreach(fp, route)
-      fp->projP = _globalMapMatrix->wgsToMap(fp->origP);
+  m_lod.build( route );
 
   origTask.reProject();
   optimizedTask.reProject();
   calAirSpaceIntersections();
 }
 
+/**
+ * Extends an altitude band by the altitudes of a fix.
+ */
+static void extendAltitudeBand( AltitudeCollection& minAlt,
+                                AltitudeCollection& maxAlt,
+                                const AltitudeCollection& alt )
+{
+  minAlt.pressureAltitude = qMin( minAlt.pressureAltitude, alt.pressureAltitude );
+  maxAlt.pressureAltitude = qMax( maxAlt.pressureAltitude, alt.pressureAltitude );
+  minAlt.gndAltitude      = qMin( minAlt.gndAltitude, alt.gndAltitude );
+  maxAlt.gndAltitude      = qMax( maxAlt.gndAltitude, alt.gndAltitude );
+  minAlt.stdAltitude      = qMin( minAlt.stdAltitude, alt.stdAltitude );
+  maxAlt.stdAltitude      = qMax( maxAlt.stdAltitude, alt.stdAltitude );
+}
+
 void Flight::calAirSpaceIntersections()
+{
+  // Get all loaded airspaces from MapContent.
+  calAirSpaceIntersections( _globalMapContents->getAirspaceList() );
+}
+
+void Flight::calAirSpaceIntersections( const SortableAirspaceList& loadedAirspaces )
 {
   // List with finished airspace intersections
   m_airspaceIntersections.clear();
 
-  if( route.size() == 0 )
+  const int cnt = route.size();
+
+  if( cnt == 0 )
     {
       return;
     }
 
-  // Get all loaded airspaces from MapContent.
-  SortableAirspaceList& loadedAirspaces = _globalMapContents->getAirspaceList();
+  // The altitudes of every fix in all airspace references.
+  QVector<AltitudeCollection> altitudes( cnt );
 
-  // List with started airspace intersections
-  QList<Flight::AirSpaceIntersection> asStartIntersections;
-
-  for( int ridx = 0; ridx < route.size(); ridx++ )
+  for( int ridx = 0; ridx < cnt; ridx++ )
     {
-      FlightPoint* fp = route.at(ridx);
+      route.setAirspaceIntersected( ridx, false );
 
-      fp->isAirspaceIntersected = false;
+      const int height = route.height(ridx);
 
-      // Check for airspace violations at the current coordinate.
-      AltitudeCollection altitudesForI;
-      altitudesForI.pressureAltitude = Altitude(fp->height);
-      altitudesForI.gpsAltitude = Altitude(fp->gpsHeight);
-      altitudesForI.gndAltitude = Altitude((fp->height) - (fp->surfaceHeight));
+      AltitudeCollection& altitudesForI = altitudes[ridx];
+      altitudesForI.pressureAltitude = Altitude(height);
+      altitudesForI.gpsAltitude = Altitude(route.gpsHeight(ridx));
+      altitudesForI.gndAltitude = Altitude(height - route.surfaceHeight(ridx));
       altitudesForI.gndAltitudeError = Altitude(0);
-      altitudesForI.stdAltitude.setStdAltitude(fp->height, m_flightStaticData.qnh);
+      altitudesForI.stdAltitude.setStdAltitude(height, m_flightStaticData.qnh);
+    }
+
+  // The track is divided into segments of consecutive fixes. Every segment
+  // has a bounding box and an altitude band, which are checked against the
+  // airspaces before the single fixes.
+  const int segments = ( cnt + AS_SEGMENT_SIZE - 1 ) / AS_SEGMENT_SIZE;
+
+  QVector<QRect> segBox( segments );
+  QVector<AltitudeCollection> segMin( segments ), segMax( segments );
+
+  QRect trackBox;
+  AltitudeCollection trackMin = altitudes[0];
+  AltitudeCollection trackMax = altitudes[0];
+
+  for( int seg = 0; seg < segments; seg++ )
+    {
+      const int first = seg * AS_SEGMENT_SIZE;
+      const int last  = qMin( first + AS_SEGMENT_SIZE, cnt );
+
+      int minX = route.projP(first).x(), maxX = minX;
+      int minY = route.projP(first).y(), maxY = minY;
 
-      AirspaceWarningDistance awdForI;
+      segMin[seg] = altitudes[first];
+      segMax[seg] = altitudes[first];
 
-      // look for violated airspaces
-      for ( int i = 0 ; i < loadedAirspaces.count(); i++ )
+      for( int ridx = first + 1; ridx < last; ridx++ )
         {
-          bool insideAs = false;
+          const QPoint projP = route.projP(ridx);
+
+          minX = qMin( minX, projP.x() );
+          maxX = qMax( maxX, projP.x() );
+          minY = qMin( minY, projP.y() );
+          maxY = qMax( maxY, projP.y() );
+
+          extendAltitudeBand( segMin[seg], segMax[seg], altitudes[ridx] );
+        }
 
-          Airspace& as = loadedAirspaces[i];
+      segBox[seg] = QRect( QPoint( minX, minY ), QPoint( maxX, maxY ) );
+
+      trackBox = trackBox.united( segBox[seg] );
+      extendAltitudeBand( trackMin, trackMax, segMin[seg] );
+      extendAltitudeBand( trackMin, trackMax, segMax[seg] );
+    }
+
+  // Only the airspaces touching the track area and its altitude band are
+  // indexed.
+  QVector<int> candidates;
+  QVector<QRect> boxes;
+
+  for( int i = 0; i < loadedAirspaces.count(); i++ )
+    {
+      const Airspace& as = loadedAirspaces.at(i);
+
+      if( as.getTypeID() == BaseMapElement::AirFir )
+        {
+          // Don't consider FIR airspaces
+          continue;
+        }
+
+      const QRect box = as.getBoundingBox();
+
+      if( ! box.intersects( trackBox ) || ! as.mayBeInside( trackMin, trackMax ) )
+        {
+          continue;
+        }
+
+      candidates.append( i );
+      boxes.append( box );
+    }
 
-          if( as.getTypeID() == BaseMapElement::AirFir )
+  if( candidates.isEmpty() )
+    {
+      return;
+    }
+
+  MapElementIndex index;
+  index.build( boxes );
+
+  // The fixes inside of an airspace in ascending order, the key is the
+  // index of the airspace.
+  QMap<int, QVector<int> > insideFixes;
+
+  AirspaceWarningDistance awdForI;
+
+  for( int seg = 0; seg < segments; seg++ )
+    {
+      const int first = seg * AS_SEGMENT_SIZE;
+      const int last  = qMin( first + AS_SEGMENT_SIZE, cnt );
+
+      // Enlarged by one unit, so that fixes on the border are not lost.
+      const QRect area = segBox[seg].adjusted( -1, -1, 1, 1 );
+
+      const QVector<int> hits = index.query( area );
+
+      for( int h = 0; h < hits.size(); h++ )
+        {
+          const int c = hits[h];
+
+          const Airspace& as = loadedAirspaces.at(candidates[c]);
+
+          if( ! boxes[c].intersects( area ) ||
+              ! as.mayBeInside( segMin[seg], segMax[seg] ) ||
+              ! as.intersectsProjectedRect( area ) )
             {
-              // Don't consider FIR airspaces
               continue;
             }
 
-          // At first check, if the projected coordinate lays inside the
-          // airspace polygon.
-          if( as.isProjectedPointInside( fp->projP ) )
+          // If the segment lays completely inside, only the altitudes of
+          // the fixes must be checked.
+          const bool segmentInside = as.isProjectedRectInside( area );
+
+          for( int ridx = first; ridx < last; ridx++ )
             {
-              Airspace::ConflictType conflict =
-                  loadedAirspaces[i].conflicts( altitudesForI, awdForI );
+              if( ! segmentInside && ! as.isProjectedPointInside( route.projP(ridx) ) )
+                {
+                  continue;
+                }
 
-              if( conflict == Airspace::Inside )
+              if( as.conflicts( altitudes[ridx], awdForI ) == Airspace::Inside )
                 {
-                  insideAs = true;
+                  route.setAirspaceIntersected( ridx, true );
+                  insideFixes[candidates[c]].append( ridx );
                 }
             }
+        }
+    }
 
-          if( insideAs == true )
-            {
-              fp->isAirspaceIntersected = true;
+  // Every run of consecutive fixes inside an airspace is an intersection.
+  // The intersections are ordered as by the former fix by fix scan: the
+  // closed ones by their end, the ones still open at the end of the flight
+  // in reverse order of their start.
+  QList<Flight::AirSpaceIntersection> runs;
 
-              bool violationIsKnown = false;
+  // The keys order the runs, the values are indexes of runs.
+  QMap< QPair<int, int>, int > closed;
+  QMap< QPair<int, int>, int > open;
 
-              // Check, if violated airspace is already handled by us.
-              for( int i = 0; i < asStartIntersections.size(); i++ )
-                {
-                  Flight::AirSpaceIntersection& asi = asStartIntersections[i];
-
-                  if( asi.AirSpace() == &as )
-                    {
-                      // update end point
-                      asi.SetLastIndexPointinRoute(ridx);
-                      violationIsKnown = true;
-                      break;
-                    }
-                }
+  QMap<int, QVector<int> >::const_iterator it;
 
-              if( violationIsKnown == false )
-                {
-                  // Unknown violation, add it to the start list
-                  Flight::AirSpaceIntersection newAsi( &as, ridx, ridx );
-                  asStartIntersections.append( newAsi );
-                }
+  for( it = insideFixes.constBegin(); it != insideFixes.constEnd(); ++it )
+    {
+      const QVector<int>& fixes = it.value();
+      // The list is only read here. The intersections refer to the
+      // airspaces of the passed list.
+      Airspace* as = const_cast<Airspace*>( &loadedAirspaces.at(it.key()) );
+
+      int begin = 0;
+
+      for( int i = 1; i <= fixes.size(); i++ )
+        {
+          if( i < fixes.size() && fixes[i] == fixes[i - 1] + 1 )
+            {
+              continue;
+            }
+
+          runs.append( Flight::AirSpaceIntersection( as, fixes[begin], fixes[i - 1] ) );
+
+          if( fixes[i - 1] == cnt - 1 )
+            {
+              open.insert( qMakePair( fixes[begin], it.key() ), runs.size() - 1 );
             }
           else
             {
-              // Not or not more inside. Look in start list, if airspace
-              // conflicts can be closed.
-              for( int i = asStartIntersections.size() - 1; i >= 0; i-- )
-                {
-                  Flight::AirSpaceIntersection& asi = asStartIntersections[i];
-
-                  if( asi.AirSpace() == &as )
-                    {
-                      // Take conflict from the start list and put it in the
-                      // finished list.
-                      m_airspaceIntersections.append( asStartIntersections.takeAt(i) );
-                      break;
-                    }
-                }
+              closed.insert( qMakePair( fixes[i - 1] + 1, it.key() ), runs.size() - 1 );
             }
+
+          begin = i;
         }
     }
 
+  QMap< QPair<int, int>, int >::const_iterator rit;
+
+  for( rit = closed.constBegin(); rit != closed.constEnd(); ++rit )
+    {
+      m_airspaceIntersections.append( runs.at( rit.value() ) );
+    }
+
   // Close all still open airspace conflicts at the end of the flight.
-  for( int i = asStartIntersections.size() - 1; i >= 0; i-- )
+  const QList<int> openRuns = open.values();
+
+  for( int i = openRuns.size() - 1; i >= 0; i-- )
+    {
+      m_airspaceIntersections.append( runs.at( openRuns.at(i) ) );
+    }
+}
+
+void Flight::rebindAirSpaceIntersections( const SortableAirspaceList& from,
+                                          SortableAirspaceList& to )
+{
+  // The index of every airspace in the list of the calculation.
+  QHash<const Airspace*, int> indexes;
+
+  for( int i = 0; i < from.size(); i++ )
     {
-      Flight::AirSpaceIntersection& asi = asStartIntersections[i];
+      indexes.insert( &from.at(i), i );
+    }
 
-      // update end point
-      asi.SetLastIndexPointinRoute( route.size() - 1 );
+  for( int i = 0; i < m_airspaceIntersections.size(); i++ )
+    {
+      AirSpaceIntersection& asi = m_airspaceIntersections[i];
+
+      const int idx = indexes.value( asi.AirSpace(), -1 );
+
+      if( idx < 0 || idx >= to.size() )
+        {
+          // Should not happen, the lists have the same content.
+          calAirSpaceIntersections( to );
+          return;
+        }
 
-      // Get conflict from the start list and put it in the finished list.
-      m_airspaceIntersections.append( asi );
+      asi.setAirSpace( &to[idx] );
     }
 }
 
@@ -26,6 +26,9 @@
 #include <QStringList>
 
 #include "baseflightelement.h"
+#include "flighttrack.h"
+#include "flighttracklod.h"
+#include "flighttrackstats.h"
 #include "flighttask.h"
 #include "map.h"
 #include "optimization.h"
@@ -86,6 +89,9 @@ class Flight : public BaseFlightElement
       Airspace* AirSpace()
         { return m_AirSpace; };
 
+      void setAirSpace( Airspace* as )
+        { m_AirSpace = as; };
+
       Airspace::ConflictType Type()
         { return m_TypeOfIntersection; };
 
@@ -140,15 +146,36 @@ class Flight : public BaseFlightElement
     int qnh;
   };
 
+  /**
+   * The values of the main thread used by the constructor. With them a
+   * flight can be constructed in another thread.
+   */
+  class Environment
+  {
+    public:
+
+    /** The settings of the waypoint check. */
+    FlightTask::PointSettings pointSettings;
+
+    /** A copy of the loaded airspaces. */
+    SortableAirspaceList airspaces;
+  };
+
   /**
    * Creates a new flight-object.
    * @param  fileName  The name of the igc-file
    * @param  route  The logged flight-points
    * @param  flightData  The static data of the flight
+   * @param  showWarnings  If false, the waypoint check shows no message boxes
+   * @param  environment  If set, its values are used instead of the settings
+   *                      and the airspaces of the map contents. The airspace
+   *                      intersections refer to its airspace list then.
    */
   Flight( const QString& fileName,
-          const QList<FlightPoint*>& route,
-          const FlightStaticData& flightStaticData );
+          const FlightTrack& route,
+          const FlightStaticData& flightStaticData,
+          const bool showWarnings=true,
+          const Environment* environment=0 );
   /**
    * Destroys the flight-object.
    */
@@ -248,7 +275,7 @@ class Flight : public BaseFlightElement
  /**
   * @return the route
   */
-  QList<FlightPoint*>& getRoute()
+  FlightTrack& getRoute()
     {
       return route;
     };
@@ -402,6 +429,19 @@ class Flight : public BaseFlightElement
   bool isAnimationActive(void);
   /** No descriptions */
   int getAnimationIndex();
+  /**
+   * Advances the nAnimationIndex member to the last fix, which was recorded
+   * within the passed number of seconds after the first fix. The animation
+   * of this flight is stopped at the last fix.
+   */
+  void setAnimationTime(int seconds);
+  /**
+   * Draws the part of the flight way, which was reached by the animation
+   * since the last call or since the last drawing of the whole flight.
+   *
+   * @return the bounding-box of the drawn segments or an invalid rectangle.
+   */
+  QRect drawAnimationStep( QPainter* targetPainter );
 
   /** No descriptions */
   void setLastAnimationPixmap(QPixmap& newPixmap)
@@ -454,6 +494,22 @@ class Flight : public BaseFlightElement
    */
   void calAirSpaceIntersections();
 
+  /**
+   * Calculate the airspace intersections of this flight against the passed
+   * airspaces.
+   */
+  void calAirSpaceIntersections( const SortableAirspaceList& airspaces );
+
+  /**
+   * Moves the airspace intersections from one airspace list to another one
+   * with the same content.
+   *
+   * @param from The list used for the calculation of the intersections.
+   * @param to The list the intersections shall refer to.
+   */
+  void rebindAirSpaceIntersections( const SortableAirspaceList& from,
+                                    SortableAirspaceList& to );
+
   /**
    * \return The statistical data of the stored flight.
    */
@@ -501,20 +557,6 @@ class Flight : public BaseFlightElement
 
 private:
 
-  /** */
-  unsigned int __calculateBestTask(unsigned int start[], unsigned int stop[],
-      unsigned int step, unsigned int idList[],
-      double taskValue[], bool isTotal);
-  /** */
-  void __moveOptimizePoint(unsigned int idList[], double taskValue[],
-      unsigned int id);
-  /** */
-  void __setOptimizeRange(unsigned int start[], unsigned int stop[],
-      unsigned int idList[], unsigned int id, unsigned int step);
-  /** */
-  double __calculateOptimizePoints(FlightPoint* fp1,
-                                   FlightPoint* fp2,
-                                   FlightPoint* fp3);
     /** */
   void __checkMaxMin();
 
@@ -535,7 +577,14 @@ private:
   unsigned int va_min;
   unsigned int va_max;
 
-  QList<FlightPoint*> route;
+  /** The logged fixes, stored column wise. */
+  FlightTrack route;
+
+  /** Levels of detail of the projected flight way. */
+  FlightTrackLod m_lod;
+
+  /** Range statistics of the route for the evaluation. */
+  FlightTrackStats m_stats;
 
   QRect bBoxFlight;
   time_t startTime;
@@ -553,6 +602,11 @@ private:
    * Index into flight used for animation
    */
   int nAnimationIndex;
+  /**
+   * Index of the last fix, up to which the flight way was drawn during
+   * the animation.
+   */
+  int nAnimationDrawn;
   /**  */
   bool bAnimationActive;
   bool taskTimesSet;
@@ -0,0 +1,182 @@
+/***********************************************************************
+**
+**   flightdownloadqueue.cpp
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <QtCore>
+
+#include "flightdownloadqueue.h"
+#include "flightrecorderpluginbase.h"
+
+/**
+ * \class FlightConvertTask
+ *
+ * \brief Converts the flight memory of one flight into an IGC file.
+ */
+class FlightConvertTask : public QRunnable
+{
+ public:
+
+  FlightConvertTask( FlightDownloadQueue* queue,
+                     const QByteArray& data,
+                     const QString& fileName ) :
+    m_queue(queue),
+    m_data(data),
+    m_fileName(fileName)
+  {
+    setAutoDelete( true );
+  };
+
+  virtual ~FlightConvertTask()
+  {
+  };
+
+  virtual void run()
+  {
+    QString error;
+
+    int rc = m_queue->m_recorder->convertFlightData( m_data, m_fileName, error );
+
+    m_queue->__report( m_fileName, rc, error );
+  };
+
+ private:
+
+  FlightDownloadQueue* m_queue;
+  QByteArray m_data;
+  QString m_fileName;
+};
+
+FlightDownloadQueue::FlightDownloadQueue( FlightRecorderPluginBase* recorder,
+                                          QObject* parent ) :
+  QThread(parent),
+  m_recorder(recorder),
+  m_secMode(0),
+  m_cancel(0),
+  m_pool(0),
+  m_downloaded(0),
+  m_failed(0)
+{
+  setObjectName( "FlightDownloadQueue" );
+
+  m_pool = new QThreadPool( this );
+
+  // The converters of the plugins are not reentrant.
+  m_pool->setMaxThreadCount( 1 );
+}
+
+FlightDownloadQueue::~FlightDownloadQueue()
+{
+  m_pool->waitForDone();
+}
+
+void FlightDownloadQueue::addFlight( const int flightID, const QString& fileName )
+{
+  Job job;
+  job.flightID = flightID;
+  job.fileName = fileName;
+
+  m_jobs.append( job );
+}
+
+void FlightDownloadQueue::cancel()
+{
+  m_cancel.fetchAndStoreOrdered( 1 );
+}
+
+int FlightDownloadQueue::downloaded() const
+{
+  QMutexLocker locker( &m_mutex );
+  return m_downloaded;
+}
+
+int FlightDownloadQueue::failed() const
+{
+  QMutexLocker locker( &m_mutex );
+  return m_failed;
+}
+
+void FlightDownloadQueue::__report( const QString& fileName,
+                                    const int rc,
+                                    const QString& error )
+{
+  m_mutex.lock();
+
+  if( rc == FR_OK )
+    {
+      m_downloaded++;
+    }
+  else
+    {
+      m_failed++;
+    }
+
+  m_mutex.unlock();
+
+  if( rc == FR_OK )
+    {
+      emit flightDownloaded( fileName );
+    }
+  else
+    {
+      emit flightFailed( fileName, error );
+    }
+}
+
+void FlightDownloadQueue::run()
+{
+#ifndef WIN32
+  sigset_t sigset;
+  sigfillset( &sigset );
+
+  // deactivate all signals in this thread
+  pthread_sigmask( SIG_SETMASK, &sigset, 0 );
+#endif
+
+  // Set to false, if the plugin cannot split a download.
+  bool split = true;
+
+  for( int i = 0; i < m_jobs.size() && m_cancel.fetchAndAddOrdered( 0 ) == 0; i++ )
+    {
+      const Job& job = m_jobs.at( i );
+
+      emit transferStarted( i, m_jobs.size() );
+
+      int rc = FR_NOTSUPPORTED;
+
+      if( split )
+        {
+          QByteArray data;
+
+          rc = m_recorder->readFlightData( job.flightID, m_secMode, data );
+
+          if( rc == FR_OK )
+            {
+              // The conversion runs in parallel to the next transfer.
+              m_pool->start( new FlightConvertTask( this, data, job.fileName ) );
+              continue;
+            }
+
+          split = ( rc != FR_NOTSUPPORTED );
+        }
+
+      if( ! split )
+        {
+          rc = m_recorder->downloadFlight( job.flightID, m_secMode, job.fileName );
+        }
+
+      __report( job.fileName, rc, m_recorder->lastError() );
+    }
+
+  m_pool->waitForDone();
+}
@@ -0,0 +1,164 @@
+/***********************************************************************
+**
+**   flightdownloadqueue.h
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#ifndef FLIGHT_DOWNLOAD_QUEUE_H
+#define FLIGHT_DOWNLOAD_QUEUE_H
+
+#include <QAtomicInt>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+
+class FlightRecorderPluginBase;
+class QThreadPool;
+
+/**
+ * \class FlightDownloadQueue
+ *
+ * \author agent
+ *
+ * \brief Downloads a list of flights from a flight recorder in the background.
+ *
+ * The queue runs the flight recorder plugin in its own thread, so that the
+ * GUI stays responsive during a download. If the plugin supports
+ * \ref FlightRecorderPluginBase::readFlightData, a flight is only read by
+ * the queue thread and converted into an IGC file on a worker thread. The
+ * conversion of a flight runs then in parallel to the transfer of the next
+ * one. The conversions run one after another, because the converters of
+ * the plugins use global and static buffers. Otherwise every flight is downloaded with
+ * \ref FlightRecorderPluginBase::downloadFlight.
+ *
+ * The plugin must not be used by other threads, as long as the queue is
+ * running. The results are reported by signals. The end of the download is
+ * reported by the signal finished() of the thread.
+ *
+ * \date 2026
+ */
+class FlightDownloadQueue : public QThread
+{
+  Q_OBJECT
+
+ private:
+
+  Q_DISABLE_COPY ( FlightDownloadQueue )
+
+ public:
+
+  FlightDownloadQueue( FlightRecorderPluginBase* recorder,
+                       QObject* parent = 0 );
+
+  virtual ~FlightDownloadQueue();
+
+  /**
+   * Adds a flight to the queue. Must be called before the thread is started.
+   *
+   * \param flightID The index of the flight in the flight directory.
+   *
+   * \param fileName The path of the IGC file to be written.
+   */
+  void addFlight( const int flightID, const QString& fileName );
+
+  /**
+   * Sets the security mode passed to the plugin, 1 for signed flights.
+   */
+  void setSecMode( const int secMode )
+  {
+    m_secMode = secMode;
+  };
+
+  /**
+   * Requests the end of the download. The flight in transfer and the
+   * running conversions are finished before.
+   */
+  void cancel();
+
+  /** \return The number of flights in the queue. */
+  int count() const
+  {
+    return m_jobs.size();
+  };
+
+  /** \return The number of successfully downloaded flights. */
+  int downloaded() const;
+
+  /** \return The number of flights, which could not be downloaded. */
+  int failed() const;
+
+ signals:
+
+  /**
+   * Emitted, when the transfer of a flight is started.
+   *
+   * \param index The position of the flight in the queue.
+   *
+   * \param total The number of flights in the queue.
+   */
+  void transferStarted( int index, int total );
+
+  /**
+   * Emitted, if the IGC file of a flight has been written.
+   */
+  void flightDownloaded( const QString& fileName );
+
+  /**
+   * Emitted, if a flight could not be downloaded.
+   */
+  void flightFailed( const QString& fileName, const QString& reason );
+
+ protected:
+
+  /**
+   * That is the main method of the thread.
+   */
+  void run();
+
+ private:
+
+  friend class FlightConvertTask;
+
+  /** Called by the queue and the workers to report a result. */
+  void __report( const QString& fileName, const int rc, const QString& error );
+
+  class Job
+  {
+   public:
+
+    Job() : flightID(-1) {};
+
+    int flightID;
+    QString fileName;
+  };
+
+  FlightRecorderPluginBase* m_recorder;
+
+  QList<Job> m_jobs;
+
+  int m_secMode;
+
+  QAtomicInt m_cancel;
+
+  /** Worker pool of the conversions, it has a single thread. */
+  QThreadPool* m_pool;
+
+  /** Protects the counters. */
+  mutable QMutex m_mutex;
+
+  int m_downloaded;
+
+  int m_failed;
+};
+
+#endif
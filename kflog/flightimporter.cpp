@@ -0,0 +1,363 @@
+/***********************************************************************
+**
+**   flightimporter.cpp
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <QtCore>
+
+#include "elevationfinder.h"
+#include "flight.h"
+#include "flightimporter.h"
+#include "flightloader.h"
+#include "igcparser.h"
+#include "mapcontents.h"
+#include "mapmatrix.h"
+#include "projectionbase.h"
+
+extern MapContents *_globalMapContents;
+extern MapMatrix   *_globalMapMatrix;
+
+/**
+ * \return The current map projection, stored by SaveProjection.
+ */
+static QByteArray currentProjection()
+{
+  QByteArray projData;
+  QDataStream out( &projData, QIODevice::WriteOnly );
+  SaveProjection( out, _globalMapMatrix->getProjection() );
+
+  return projData;
+}
+
+/**
+ * \class FlightImportTask
+ *
+ * \brief Imports one flight file in a worker thread.
+ */
+class FlightImportTask : public QRunnable
+{
+ public:
+
+  FlightImportTask( FlightImporter* importer,
+                    const QString& fileName,
+                    const uint generation,
+                    const QByteArray& projection,
+                    const Flight::Environment& environment,
+                    const uint airspaceGeneration ) :
+    m_importer(importer),
+    m_fileName(fileName),
+    m_generation(generation),
+    m_projection(projection),
+    m_environment(environment),
+    m_airspaceGeneration(airspaceGeneration)
+  {
+    setAutoDelete( true );
+  };
+
+  virtual ~FlightImportTask()
+  {
+  };
+
+  virtual void run();
+
+ private:
+
+  FlightImporter* m_importer;
+  QString m_fileName;
+  uint m_generation;
+  QByteArray m_projection;
+  Flight::Environment m_environment;
+  uint m_airspaceGeneration;
+};
+
+void FlightImportTask::run()
+{
+  FlightImporter::Result result;
+  result.fileName   = m_fileName;
+  result.generation = m_generation;
+
+  m_importer->m_mutex.lock();
+  bool canceled = ( m_generation != m_importer->m_generation );
+  m_importer->m_mutex.unlock();
+
+  if( canceled )
+    {
+      m_importer->__storeResult( result );
+      return;
+    }
+
+  // The projection objects are not thread safe. Every task works with its
+  // own copy of the current map projection.
+  QDataStream in( m_projection );
+  ProjectionBase* projection = LoadProjection( in );
+
+  FlightTrack route;
+  Flight::FlightStaticData fsd;
+
+  const QString suffix = QFileInfo( m_fileName ).suffix().toLower();
+
+  if( suffix == "igc" )
+    {
+      IgcParser parser;
+
+      IgcParser::Result res = parser.parse( m_fileName, projection );
+
+      if( res == IgcParser::FileError )
+        {
+          result.error = QObject::tr("File can not be read");
+        }
+      else if( res == IgcParser::SyntaxError )
+        {
+          result.error = QObject::tr("Syntax error in line %1").arg( parser.errorLine() );
+        }
+      else
+        {
+          route = parser.takeRoute();
+          fsd   = parser.takeStaticData();
+        }
+    }
+  else if( suffix == "gdn" || suffix == "trk" )
+    {
+      FlightLoader::parseGardownFile( m_fileName, projection, route, fsd );
+    }
+  else
+    {
+      result.error = QObject::tr("Unknown file extension");
+    }
+
+  delete projection;
+
+  if( result.error.isEmpty() && route.isEmpty() )
+    {
+      result.error = QObject::tr("File contains no flight");
+    }
+
+  if( ! result.error.isEmpty() )
+    {
+      qDeleteAll( fsd.waypoints );
+      m_importer->__storeResult( result );
+      return;
+    }
+
+  FlightLoader::setSurfaceHeights( route );
+
+  // The flight takes over the waypoints. Its constructor determines the
+  // flight states and the airspace intersections. The waypoint check must
+  // not open message boxes during the import.
+  result.flight = new Flight( m_fileName, route, fsd, false, &m_environment );
+
+  result.projection         = m_projection;
+  result.airspaces          = m_environment.airspaces;
+  result.airspaceGeneration = m_airspaceGeneration;
+
+  m_importer->__storeResult( result );
+}
+
+/*---------------------- FlightImporter --------------------------------------*/
+
+FlightImporter::FlightImporter( QObject* parent ) :
+  QObject(parent),
+  m_generation(0),
+  m_total(0),
+  m_done(0),
+  m_failed(0)
+{
+  setObjectName( "FlightImporter" );
+
+  m_pool = new QThreadPool( this );
+  m_pool->setMaxThreadCount( qMax( 1, QThread::idealThreadCount() ) );
+}
+
+FlightImporter::~FlightImporter()
+{
+  slotCancel();
+  m_pool->waitForDone();
+
+  for( int i = 0; i < m_results.size(); i++ )
+    {
+      delete m_results.at(i).flight;
+    }
+}
+
+void FlightImporter::importFiles( const QStringList& files )
+{
+  if( files.isEmpty() )
+    {
+      return;
+    }
+
+  if( m_total == 0 )
+    {
+      m_done   = 0;
+      m_failed = 0;
+    }
+
+  // Create the elevation finder in this thread, before the workers use it.
+  ElevationFinder::instance();
+
+  QByteArray projData = currentProjection();
+
+  // The workers must not use the settings and the map contents. They get
+  // copies of the values needed by the flight construction.
+  Flight::Environment environment;
+  environment.pointSettings = FlightTask::PointSettings::load();
+  environment.airspaces     = _globalMapContents->getAirspaceList();
+
+  // The copy gets its own airspace objects now. Otherwise the next write
+  // access to the map's list would detach it, and the pointers of the map
+  // and of the flights would refer to the airspaces of the copy.
+  environment.airspaces.detach();
+
+  uint airspaceGeneration = _globalMapContents->getAirspaceGeneration();
+
+  m_mutex.lock();
+  uint generation = m_generation;
+  m_mutex.unlock();
+
+  m_total += files.size();
+
+  for( int i = 0; i < files.size(); i++ )
+    {
+      m_pool->start( new FlightImportTask( this, files.at(i), generation, projData,
+                                           environment, airspaceGeneration ) );
+    }
+
+  emit progress( m_done, m_total );
+}
+
+bool FlightImporter::isRunning() const
+{
+  return m_total > 0;
+}
+
+void FlightImporter::waitForDone()
+{
+  m_pool->waitForDone();
+}
+
+void FlightImporter::slotCancel()
+{
+  m_mutex.lock();
+
+  m_generation++;
+
+  for( int i = 0; i < m_results.size(); i++ )
+    {
+      delete m_results.at(i).flight;
+    }
+
+  m_results.clear();
+  m_mutex.unlock();
+
+  if( m_total > 0 )
+    {
+      __finish();
+    }
+}
+
+void FlightImporter::__storeResult( const Result& result )
+{
+  m_mutex.lock();
+  m_results.append( result );
+  m_mutex.unlock();
+
+  // Inform the importer in its own thread about the new result.
+  QMetaObject::invokeMethod( this, "slotFileFinished", Qt::QueuedConnection );
+}
+
+void FlightImporter::slotFileFinished()
+{
+  m_mutex.lock();
+  QList<Result> results = m_results;
+  uint generation = m_generation;
+  m_results.clear();
+  m_mutex.unlock();
+
+  for( int i = 0; i < results.size(); i++ )
+    {
+      const Result& result = results.at(i);
+
+      if( result.generation != generation )
+        {
+          // Result of a canceled import.
+          delete result.flight;
+          continue;
+        }
+
+      m_done++;
+
+      if( result.error.isEmpty() )
+        {
+          __adaptFlight( result );
+
+          _globalMapContents->appendFlight( result.flight );
+          emit flightImported( result.fileName );
+        }
+      else
+        {
+          m_failed++;
+          qWarning() << "FlightImporter:" << result.fileName << result.error;
+          emit importFailed( result.fileName, result.error );
+        }
+    }
+
+  if( results.isEmpty() || m_total == 0 )
+    {
+      return;
+    }
+
+  emit progress( m_done, m_total );
+
+  if( m_done >= m_total )
+    {
+      __finish();
+    }
+}
+
+void FlightImporter::__adaptFlight( const Result& result )
+{
+  Flight* flight = result.flight;
+
+  if( result.projection != currentProjection() )
+    {
+      // The map projection has been changed during the import. That
+      // calculates the airspace intersections too.
+      flight->reProject();
+    }
+  else if( result.airspaceGeneration != _globalMapContents->getAirspaceGeneration() )
+    {
+      // The airspaces have been changed during the import.
+      flight->calAirSpaceIntersections();
+    }
+  else
+    {
+      // The intersections refer to the copy of the airspace list.
+      flight->rebindAirSpaceIntersections( result.airspaces,
+                                           _globalMapContents->getAirspaceList() );
+    }
+}
+
+void FlightImporter::__finish()
+{
+  int imported = m_done - m_failed;
+  int failed   = m_failed;
+
+  m_total  = 0;
+  m_done   = 0;
+  m_failed = 0;
+
+  qDebug() << "FlightImporter:" << imported << "flights imported,"
+           << failed << "files failed";
+
+  emit finished( imported, failed );
+}
@@ -0,0 +1,197 @@
+/***********************************************************************
+**
+**   flightimporter.h
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#ifndef FLIGHT_IMPORTER_H
+#define FLIGHT_IMPORTER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include "flight.h"
+
+class QThreadPool;
+
+/**
+ * \class FlightImporter
+ *
+ * \author agent
+ *
+ * \brief Imports many flight files in parallel.
+ *
+ * The importer reads IGC and Gardown files on a pool of worker threads. A
+ * worker parses the file, determines the surface heights of the track and
+ * constructs the \ref Flight object. The settings of the waypoint check and
+ * a copy of the airspace list are taken in the thread of the importer and
+ * passed to the workers. The finished flights are handed over to
+ * \ref MapContents::appendFlight, only that is done in the thread of the
+ * importer.
+ *
+ * No message boxes are shown during an import. Errors are reported with
+ * the signal \ref importFailed.
+ *
+ * \date 2026
+ */
+class FlightImporter : public QObject
+{
+  Q_OBJECT
+
+ private:
+
+  Q_DISABLE_COPY ( FlightImporter )
+
+ public:
+
+  FlightImporter( QObject* parent = 0 );
+
+  virtual ~FlightImporter();
+
+  /**
+   * Starts the import of the given files. The files are added to a running
+   * import.
+   *
+   * \param files The paths of the IGC and Gardown files.
+   */
+  void importFiles( const QStringList& files );
+
+  /**
+   * \return True, if an import is running.
+   */
+  bool isRunning() const;
+
+  /**
+   * Waits until all workers are finished. The results are handed over
+   * later on by the event loop.
+   */
+  void waitForDone();
+
+ public slots:
+
+  /**
+   * Aborts the import. Files already in work are finished and dropped.
+   */
+  void slotCancel();
+
+ signals:
+
+  /**
+   * Emitted after every finished file.
+   *
+   * \param done The number of finished files.
+   *
+   * \param total The number of files of the import.
+   */
+  void progress( int done, int total );
+
+  /**
+   * Emitted, if a flight has been added to the flight list.
+   */
+  void flightImported( const QString& fileName );
+
+  /**
+   * Emitted, if a file could not be imported.
+   */
+  void importFailed( const QString& fileName, const QString& reason );
+
+  /**
+   * Emitted, when all files of the import are done.
+   *
+   * \param imported The number of imported flights.
+   *
+   * \param failed The number of files, which could not be imported.
+   */
+  void finished( int imported, int failed );
+
+ private slots:
+
+  /**
+   * Called via a queued connection, if a worker has finished a file.
+   */
+  void slotFileFinished();
+
+ private:
+
+  friend class FlightImportTask;
+
+  /**
+   * The result of a worker.
+   */
+  class Result
+  {
+   public:
+
+    Result() : flight(0), airspaceGeneration(0), generation(0) {};
+
+    QString fileName;
+
+    /** The constructed flight, owned by the result. Null in case of an error. */
+    Flight* flight;
+
+    /** The map projection used by the worker, stored by SaveProjection. */
+    QByteArray projection;
+
+    /** The airspaces used by the worker, the intersections refer to them. */
+    SortableAirspaceList airspaces;
+
+    /** The generation of the map's airspace list, the copy was taken from. */
+    uint airspaceGeneration;
+
+    /** The error reason. */
+    QString error;
+
+    /** The import generation of the request. */
+    uint generation;
+  };
+
+  /**
+   * Adapts a constructed flight to the current map contents. The map
+   * projection or the airspaces may have been changed during the import.
+   */
+  void __adaptFlight( const Result& result );
+
+  /**
+   * Called by a worker thread to store its result.
+   */
+  void __storeResult( const Result& result );
+
+  /** Finishes the running import. */
+  void __finish();
+
+  /** Worker pool of the importer. */
+  QThreadPool* m_pool;
+
+  /** Protects m_results. */
+  mutable QMutex m_mutex;
+
+  /** Finished files, not yet handed over. */
+  QList<Result> m_results;
+
+  /** Current import generation, incremented by a cancel. */
+  uint m_generation;
+
+  /** Number of files of the running import. */
+  int m_total;
+
+  /** Number of finished files. */
+  int m_done;
+
+  /** Number of files, which could not be imported. */
+  int m_failed;
+};
+
+#endif
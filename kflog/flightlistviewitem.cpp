@@ -217,16 +217,22 @@ void FlightListViewItem::activate()
   if( m_flight->getRoute().size() > 0 )
     {
       // Reset flight cursors at the map
-      QPoint& p1 = m_flight->getRoute().first()->projP;
-      QPoint& p2 = m_flight->getRoute().last()->projP;
+      QPoint p1 = m_flight->getRoute().projP( 0 );
+      QPoint p2 = m_flight->getRoute().projP( m_flight->getRouteLength() - 1 );
 
       extern Map *_globalMap;
       _globalMap->slotDrawCursor( p1, p2 );
     }
 
-  QList<FlightPoint*>& route = m_flight->getRoute();
-  time_t cursor1 = route.first()->time;
-  time_t cursor2 = route.last()->time;
+  FlightTrack& route = m_flight->getRoute();
+
+  if( route.isEmpty() )
+    {
+      return;
+    }
+
+  time_t cursor1 = route.time( 0 );
+  time_t cursor2 = route.time( route.count() - 1 );
 
   EvaluationDialog* evalDialog = 0;
 
@@ -242,8 +248,8 @@ void FlightListViewItem::activate()
     }
 
   // Reset flight flags at the map
-  QPoint& p1 = route.first()->projP;
-  QPoint& p2 = route.last()->projP;
+  QPoint p1 = route.projP( 0 );
+  QPoint p2 = route.projP( route.count() - 1 );
 
   extern Map *_globalMap;
   _globalMap->slotDrawCursor( p1, p2 );
@@ -23,7 +23,10 @@
 
 #include <QFile>
 #include <QFileInfo>
-#include <QHash>
+
+#include "flight.h"
+
+class ProjectionBase;
 
 class FlightLoader : public QObject
 {
@@ -63,23 +66,32 @@ class FlightLoader : public QObject
    */
   bool openGardownFile(QFile&, QFileInfo&);
 
+  /**
+   * Reads the flight points of a Gardown file without any user interaction.
+   * The method can be called from any thread.
+   *
+   * @param  fileName  The path to the Gardown-file
+   * @param  projection  The projection used for the projected positions.
+   *                     Every thread must use its own projection object.
+   * @param  flightRoute  The list, to which the flight points are appended
+   * @param  fsd  The static flight data to be set
+   * @return "true", when flight points have been read
+   */
+  static bool parseGardownFile( const QString& fileName,
+                                ProjectionBase* projection,
+                                FlightTrack& flightRoute,
+                                Flight::FlightStaticData& fsd );
+
+  /**
+   * Fills the surface heights of all flight points with one elevation
+   * query. The method can be called from any thread.
+   */
+  static void setSurfaceHeights( FlightTrack& flightRoute );
+
   private slots:
 
   void slot_CancelLoad();
 
-  private:
-
-  // Short structure to handle the optional entries in an igc file
-  class bOption
-  {
-    public:
-      int begin, length;
-      char mnemonic[4];
-  };
-
-  /** Flight recorder manufactures. */
-  static QHash<QString, QString> m_manufactures;
-
 };
 
 #endif
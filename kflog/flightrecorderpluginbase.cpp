@@ -94,6 +94,20 @@ FlightRecorderPluginBase::~FlightRecorderPluginBase()
 {
 }
 
+int FlightRecorderPluginBase::readFlightData( int /*flightID*/,
+                                              int /*secMode*/,
+                                              QByteArray& /*data*/ )
+{
+  return FR_NOTSUPPORTED;
+}
+
+int FlightRecorderPluginBase::convertFlightData( const QByteArray& /*data*/,
+                                                 const QString& /*fileName*/,
+                                                 QString& /*errorInfo*/ )
+{
+  return FR_NOTSUPPORTED;
+}
+
 /**
  * Returns additional info about an error that occurred (optional).
  * _errorinfo is reset afterwards.
@@ -23,6 +23,7 @@
 #include <termios.h>
 #endif
 
+#include <QByteArray>
 #include <QObject>
 #include <QList>
 #include <QString>
@@ -206,6 +207,21 @@ public:
    * Downloads a specific flight.
    */
   virtual int downloadFlight(int flightID, int secMode, const QString& fileName)=0;
+  /**
+   * Reads the raw flight memory of a specific flight without converting
+   * it. Together with \ref convertFlightData it splits a download, so that
+   * the conversion of a flight can run in parallel to the transfer of the
+   * next one. The default implementation returns FR_NOTSUPPORTED, then
+   * \ref downloadFlight must be used.
+   */
+  virtual int readFlightData(int flightID, int secMode, QByteArray& data);
+  /**
+   * Converts the raw flight memory read by \ref readFlightData into an IGC
+   * file. The method is called from another thread than the other methods
+   * of the plugin and must not use the connection or the members of the
+   * plugin. Errors are returned in errorInfo.
+   */
+  virtual int convertFlightData(const QByteArray& data, const QString& fileName, QString& errorInfo);
   /**
    * get recorder basic data
    */
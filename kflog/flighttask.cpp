@@ -30,9 +30,6 @@
 #define CUR_ID loop
 #define NEXT_ID loop + 1
 
-/* Die Einstellungen können mal in die Voreinstellungsdatei wandern ... */
-#define FAI_POINT 2.0
-#define NORMAL_POINT 1.75
 #define R1 (3000.0 / glMapMatrix->getScale())
 #define R2 (500.0 / glMapMatrix->getScale())
 
@@ -40,6 +37,51 @@
 QHash<int, QString> FlightTask::taskTypeTranslations;
 QStringList FlightTask::sortedTaskTypeTranslations;
 
+FlightTask::PointSettings::PointSettings() :
+  showWaypointWarnings(true),
+  faiPoint(2.0),
+  normalPoint(1.75),
+  cancelPoint(1.0),
+  zielSPoint(1.5),
+  malusValue(15.0),
+  sectorMalus(-0.1)
+{
+}
+
+FlightTask::PointSettings FlightTask::PointSettings::load()
+{
+  extern QSettings _settings;
+
+  PointSettings ps;
+
+  ps.showWaypointWarnings = _settings.value("/GeneralOptions/ShowWaypointWarnings",true).toBool();
+
+  ps.faiPoint = _settings.value("/FlightPoints/FAIPoint", 2.0).toDouble();
+  ps.normalPoint = _settings.value("/FlightPoints/NormalPoint", 1.75).toDouble();
+  ps.cancelPoint = _settings.value("/FlightPoints/CancelPoint", 1.0).toDouble();
+  ps.zielSPoint = _settings.value("/FlightPoints/ZielSPoint", 1.5).toDouble();
+  ps.malusValue = _settings.value("/FlightPoints/MalusValue", 15.0).toDouble();
+  ps.sectorMalus = _settings.value("/FlightPoints/SectorMalus", -0.1).toDouble();
+
+  _settings.beginGroup("GliderTypes");
+
+  const QStringList keys = _settings.allKeys();
+
+  for( int i = 0; i < keys.size(); i++ )
+    {
+      ps.gliderIndexes.insert( keys.at(i), _settings.value(keys.at(i), 100).toInt() );
+    }
+
+  _settings.endGroup();
+
+  return ps;
+}
+
+int FlightTask::PointSettings::gliderIndex( const QString& gliderType ) const
+{
+  return gliderIndexes.value( gliderType, 100 );
+}
+
 FlightTask::FlightTask(const QString& fName) :
   BaseFlightElement("task", BaseMapElement::Task, fName),
   isOrig(false),
@@ -741,7 +783,17 @@ double FlightTask::getOlcPoints()
   return  olcPoints;
 }
 
-void FlightTask::checkWaypoints(QList<FlightPoint*> route, const QString& gliderType)
+void FlightTask::checkWaypoints( const FlightTrack& route,
+                                 const QString& gliderType,
+                                 const bool warnings )
+{
+  checkWaypoints( route, gliderType, warnings, PointSettings::load() );
+}
+
+void FlightTask::checkWaypoints( const FlightTrack& route,
+                                 const QString& gliderType,
+                                 const bool warnings,
+                                 const PointSettings& settings )
 {
   /*
    *   �berpr�ft, ob die Sektoren der Wendepunkte erreicht wurden
@@ -757,32 +809,30 @@ void FlightTask::checkWaypoints(QList<FlightPoint*> route, const QString& glider
 
   int gliderIndex = 100, preTime = 0;
 
-  extern QSettings _settings;
-
-  bool showWarnings = _settings.value("/GeneralOptions/ShowWaypointWarnings",true).toBool();
+  bool showWarnings = warnings && settings.showWaypointWarnings;
 
-  double pointFAI = _settings.value("/FlightPoints/FAIPoint", 2.0).toDouble();
-  double pointNormal = _settings.value("/FlightPoints/NormalPoint", 1.75).toDouble();
-  double pointCancel = _settings.value("/FlightPoints/CancelPoint", 1.0).toDouble();
-  double pointZielS = _settings.value("/FlightPoints/ZielSPoint", 1.5).toDouble();
-  double malusValue = _settings.value("/FlightPoints/MalusValue", 15.0).toDouble();
-  double sectorMalus = _settings.value("/FlightPoints/SectorMalus", -0.1).toDouble();
+  double pointFAI = settings.faiPoint;
+  double pointNormal = settings.normalPoint;
+  double pointCancel = settings.cancelPoint;
+  double pointZielS = settings.zielSPoint;
+  double malusValue = settings.malusValue;
+  double sectorMalus = settings.sectorMalus;
 
   if(! gliderType.isEmpty() )
     {
-      gliderIndex = _settings.value("/GliderTypes/"+gliderType, 100).toInt();
+      gliderIndex = settings.gliderIndex( gliderType );
     }
 
   for(int loop = 0; loop < route.count(); loop++)
     {
-      if(loop && (route.at(loop)->time - preTime > 70))
+      if(loop && (route.time(loop) - preTime > 70))
         /*
          *           Zeitabstand zwischen Loggerpunkten ist zu gross!
          *                      (vgl. Code Sportif 3, Ziffer 1.9.2.1)
          */
         time_error = true;
 
-      preTime = route.at(loop)->time;
+      preTime = route.time(loop);
     }
 
   unsigned int startIndex = 0, dummy = 0;
@@ -802,17 +852,17 @@ void FlightTask::checkWaypoints(QList<FlightPoint*> route, const QString& glider
        */
       for(int pLoop = startIndex + 1; pLoop < route.count(); pLoop++)
         {
-          if( wpList.at(loop)->projP == route.at(pLoop)->projP )
+          if( wpList.at(loop)->projP == route.projP(pLoop) )
             {
               // Wir sind in allen Sektoren ...
               if(!wpList.at(loop)->sector1)
-                wpList.at(loop)->sector1 = route.at(pLoop)->time;
+                wpList.at(loop)->sector1 = route.time(pLoop);
 
               if(!wpList.at(loop)->sector2)
-                wpList.at(loop)->sector2 = route.at(pLoop)->time;
+                wpList.at(loop)->sector2 = route.time(pLoop);
 
               if(!wpList.at(loop)->sectorFAI)
-                wpList.at(loop)->sectorFAI = route.at(pLoop)->time;
+                wpList.at(loop)->sectorFAI = route.time(pLoop);
 
               // ... daher ist ein Abbruch m�glich!
               startIndex = pLoop;
@@ -820,14 +870,14 @@ void FlightTask::checkWaypoints(QList<FlightPoint*> route, const QString& glider
             }
           else
             {
-              if(dist(wpList.at(loop), route.at(pLoop)) <= 0.5)
+              if(dist(wpList.at(loop), route, pLoop) <= 0.5)
                 {
                   // Wir sind im kleinen Zylinder ...
                   if(!wpList.at(loop)->sector1)
-                    wpList.at(loop)->sector1 = route.at(pLoop)->time;
+                    wpList.at(loop)->sector1 = route.time(pLoop);
 
                   if(!wpList.at(loop)->sector2)
-                    wpList.at(loop)->sector2 = route.at(pLoop)->time;
+                    wpList.at(loop)->sector2 = route.time(pLoop);
 
                   if(!dummy)
                     {
@@ -837,8 +887,8 @@ void FlightTask::checkWaypoints(QList<FlightPoint*> route, const QString& glider
                 }
 
               pointAngle = polar(
-                                 ( wpList.at(loop)->projP.x() - route.at(pLoop)->projP.x() ),
-                                 ( wpList.at(loop)->projP.y() - route.at(pLoop)->projP.y() ) );
+                                 ( wpList.at(loop)->projP.x() - route.projP(pLoop).x() ),
+                                 ( wpList.at(loop)->projP.y() - route.projP(pLoop).y() ) );
 
               deltaAngle = sqrt( ( pointAngle - wpList.at(loop)->angle ) *
                                  ( pointAngle - wpList.at(loop)->angle ) );
@@ -847,14 +897,14 @@ void FlightTask::checkWaypoints(QList<FlightPoint*> route, const QString& glider
                 {
                   // Wir sind im FAI-Sektor ...
                   if(!wpList.at(loop)->sectorFAI)
-                    wpList.at(loop)->sectorFAI = route.at(pLoop)->time;
+                    wpList.at(loop)->sectorFAI = route.time(pLoop);
 
-                  if(dist(wpList.at(loop), route.at(pLoop)) <= 3.0)
+                  if(dist(wpList.at(loop), route, pLoop) <= 3.0)
                     {
                       // ... und in Sektor 1 ...
                       if(!wpList.at(loop)->sector1)
                         {
-                          wpList.at(loop)->sector1 = route.at(pLoop)->time;
+                          wpList.at(loop)->sector1 = route.time(pLoop);
                           // ... daher ist ein Abbruch m�glich!
                           startIndex = pLoop;
                           break;
@@ -866,7 +916,7 @@ void FlightTask::checkWaypoints(QList<FlightPoint*> route, const QString& glider
                 {
                   // "nur" in Sektor 2
                   if(!wpList.at(loop)->sector2)
-                    wpList.at(loop)->sector2 = route.at(pLoop)->time;
+                    wpList.at(loop)->sector2 = route.time(pLoop);
 
                   if(!dummy)
                     {
@@ -933,13 +983,13 @@ void FlightTask::checkWaypoints(QList<FlightPoint*> route, const QString& glider
                              QObject::tr("You have not reached the last point of your task."),
 			     QMessageBox::Ok, 0);
 
-      if(dist(wpList.at(1 + dmstCount), route.last()) < 1.0)
+      if(dist(wpList.at(1 + dmstCount), route, route.count() - 1) < 1.0)
         {
           // Landung auf letztem Wegpunkt
         }
       else
         // Aussenlandung -- Wertung: + 1Punkt bis zur Aussenlandung
-        aussenlande = dist(wpList.at(1 + dmstCount), route.last());
+        aussenlande = dist(wpList.at(1 + dmstCount), route, route.count() - 1);
     }
   else
     {
@@ -20,6 +20,7 @@
 #define FLIGHT_TASK_H
 
 #include "baseflightelement.h"
+#include "flighttrack.h"
 #include "lineelement.h"
 
 #include <QHash>
@@ -27,6 +28,10 @@
 #include <QRect>
 #include <QPolygon>
 
+/* Die Einstellungen können mal in die Voreinstellungsdatei wandern ... */
+#define FAI_POINT 2.0
+#define NORMAL_POINT 1.75
+
 struct faiRange
 {
   double minLength28;
@@ -59,6 +64,38 @@ struct faiAreaSector
 class FlightTask : public BaseFlightElement
 {
  public:
+  /**
+   * The settings used by \ref checkWaypoints. They are read in the main
+   * thread by \ref load, so that a task can be checked in another thread.
+   */
+  class PointSettings
+  {
+   public:
+
+    PointSettings();
+
+    /**
+     * Reads the settings from the configuration. Must be called in the
+     * main thread.
+     */
+    static PointSettings load();
+
+    /**
+     * \return The index of the glider type, 100 for unknown types.
+     */
+    int gliderIndex( const QString& gliderType ) const;
+
+    bool showWaypointWarnings;
+    double faiPoint;
+    double normalPoint;
+    double cancelPoint;
+    double zielSPoint;
+    double malusValue;
+    double sectorMalus;
+
+    /** The indexes of the configured glider types. */
+    QHash<QString, int> gliderIndexes;
+  };
   /**
    * Creates an empty task and sets isOrig to false.
    */
@@ -109,8 +146,21 @@ class FlightTask : public BaseFlightElement
   /** */
   void printMapElement(QPainter* targetP, bool isText);
   void printMapElement(QPainter* targetP, bool isText, double dX, double dY);
-  /** */
-  void checkWaypoints(QList<FlightPoint*> route, const QString& gliderType);
+  /**
+   * Checks, if the sectors of the waypoints have been reached.
+   * If warnings is false, no message boxes are shown.
+   */
+  void checkWaypoints( const FlightTrack& route,
+                       const QString& gliderType,
+                       const bool warnings=true );
+  /**
+   * Checks, if the sectors of the waypoints have been reached. The passed
+   * settings are used instead of the configuration.
+   */
+  void checkWaypoints( const FlightTrack& route,
+                       const QString& gliderType,
+                       const bool warnings,
+                       const PointSettings& settings );
   /** */
   double getOlcPoints();
   /** */
@@ -0,0 +1,165 @@
+/***********************************************************************
+**
+**   flighttrack.cpp
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <QtCore>
+
+#include "flighttrack.h"
+#include "mapcalc.h"
+
+FlightTrack::FlightTrack()
+{
+}
+
+FlightTrack::~FlightTrack()
+{
+}
+
+void FlightTrack::clear()
+{
+  m_lat.clear();
+  m_lon.clear();
+  m_projX.clear();
+  m_projY.clear();
+  m_time.clear();
+  m_height.clear();
+  m_gpsHeight.clear();
+  m_engineNoise.clear();
+  m_surfaceHeight.clear();
+  m_dH.clear();
+  m_dT.clear();
+  m_dS.clear();
+  m_bearing.clear();
+  m_dBearing.clear();
+  m_fState.clear();
+  m_airspace.clear();
+}
+
+void FlightTrack::reserve( const int size )
+{
+  m_lat.reserve( size );
+  m_lon.reserve( size );
+  m_projX.reserve( size );
+  m_projY.reserve( size );
+  m_time.reserve( size );
+  m_height.reserve( size );
+  m_gpsHeight.reserve( size );
+  m_engineNoise.reserve( size );
+  m_surfaceHeight.reserve( size );
+  m_dH.reserve( size );
+  m_dT.reserve( size );
+  m_dS.reserve( size );
+  m_bearing.reserve( size );
+  m_dBearing.reserve( size );
+  m_fState.reserve( size );
+  m_airspace.reserve( size );
+}
+
+void FlightTrack::append( const WGSPoint& origP,
+                          const QPoint& projP,
+                          const time_t time,
+                          const int height,
+                          const int gpsHeight,
+                          const int engineNoise )
+{
+  m_lat.append( origP.lat() );
+  m_lon.append( origP.lon() );
+  m_projX.append( projP.x() );
+  m_projY.append( projP.y() );
+  m_time.append( time );
+  m_height.append( height );
+  m_gpsHeight.append( gpsHeight );
+  m_engineNoise.append( engineNoise );
+  m_surfaceHeight.append( -1 );
+
+  m_dH.append( 0 );
+  m_dT.append( 0 );
+  m_dS.append( 0 );
+  m_bearing.append( 0.0 );
+  m_dBearing.append( 0.0 );
+  m_fState.append( 0 );
+  m_airspace.append( false );
+}
+
+FlightPoint FlightTrack::point( const int i ) const
+{
+  FlightPoint fp;
+
+  fp.origP                 = origP( i );
+  fp.projP                 = projP( i );
+  fp.height                = m_height[i];
+  fp.gpsHeight             = m_gpsHeight[i];
+  fp.engineNoise           = m_engineNoise[i];
+  fp.surfaceHeight         = m_surfaceHeight[i];
+  fp.time                  = m_time[i];
+  fp.dH                    = m_dH[i];
+  fp.dT                    = m_dT[i];
+  fp.dS                    = m_dS[i];
+  fp.bearing               = m_bearing[i];
+  fp.dBearing              = m_dBearing[i];
+  fp.f_state               = m_fState[i];
+  fp.isAirspaceIntersected = m_airspace[i];
+
+  return fp;
+}
+
+void FlightTrack::calculateDeltas()
+{
+  const int cnt = size();
+
+  if( cnt == 0 )
+    {
+      return;
+    }
+
+  const int*    height = m_height.constData();
+  const time_t* time   = m_time.constData();
+  int* dH = m_dH.data();
+  int* dT = m_dT.data();
+  int* dS = m_dS.data();
+
+  dH[0] = 0;
+  dT[0] = ( cnt > 1 ) ? qMax( int(time[1] - time[0]), 1 ) : 1;
+  dS[0] = 0;
+
+  for( int i = 1; i < cnt; i++ )
+    {
+      dH[i] = height[i] - height[i - 1];
+      dT[i] = qMax( int(time[i] - time[i - 1]), 1 );
+    }
+
+  for( int i = 1; i < cnt; i++ )
+    {
+      dS[i] = (int) ( distance( i, i - 1 ) * 1000.0 );
+    }
+}
+
+double FlightTrack::distance( const int i, const int j ) const
+{
+  return dist( m_lat[i], m_lon[i], m_lat[j], m_lon[j] );
+}
+
+float FlightTrack::course( const int i, const int j ) const
+{
+  return getBearing( m_lat[i], m_lon[i], m_lat[j], m_lon[j] );
+}
+
+int FlightTrack::memoryUsage() const
+{
+  int perFix = 6 * sizeof(int) + sizeof(time_t) + 2 * sizeof(qint16) +
+               3 * sizeof(int) + 2 * sizeof(float) + sizeof(quint8) +
+               sizeof(bool);
+
+  return sizeof(FlightTrack) + m_time.capacity() * perFix;
+}
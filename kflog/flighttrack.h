@@ -0,0 +1,300 @@
+/***********************************************************************
+**
+**   flighttrack.h
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#ifndef FLIGHT_TRACK_H
+#define FLIGHT_TRACK_H
+
+#include <ctime>
+
+#include <QPoint>
+#include <QVector>
+
+#include "flightpoint.h"
+#include "wgspoint.h"
+
+/**
+ * \class FlightTrack
+ *
+ * \author agent
+ *
+ * \brief Column store of the logged fixes of a flight.
+ *
+ * Every attribute of a fix is stored in its own contiguous array, indexed
+ * by the number of the fix. The analysis loops touch only the columns they
+ * need and do not chase a pointer per fix. A \ref FlightPoint is only
+ * assembled on request by \ref point.
+ *
+ * The logged values are set by \ref append. The derived values dH, dT and dS
+ * are calculated by \ref calculateDeltas, the bearings, the flight states and
+ * the airspace flags are set by the owning flight.
+ *
+ * \date 2026
+ */
+class FlightTrack
+{
+ public:
+
+  FlightTrack();
+
+  ~FlightTrack();
+
+  /**
+   * \return The number of fixes.
+   */
+  int size() const
+  {
+    return m_time.size();
+  };
+
+  int count() const
+  {
+    return m_time.size();
+  };
+
+  bool isEmpty() const
+  {
+    return m_time.isEmpty();
+  };
+
+  /** Removes all fixes. */
+  void clear();
+
+  /** Reserves space for the given number of fixes. */
+  void reserve( const int size );
+
+  /**
+   * Appends a logged fix. The derived values of the fix are reset.
+   *
+   * \param origP The WGS84 position in the internal KFLog format.
+   *
+   * \param projP The projected position.
+   *
+   * \param time The time of the fix.
+   *
+   * \param height The barometric altitude.
+   *
+   * \param gpsHeight The GPS altitude.
+   *
+   * \param engineNoise The engine noise level or -1, if not logged.
+   */
+  void append( const WGSPoint& origP,
+               const QPoint& projP,
+               const time_t time,
+               const int height,
+               const int gpsHeight,
+               const int engineNoise = -1 );
+
+  /**
+   * \return A copy of the fix with the index i.
+   */
+  FlightPoint point( const int i ) const;
+
+  WGSPoint origP( const int i ) const
+  {
+    return WGSPoint( m_lat[i], m_lon[i] );
+  };
+
+  int lat( const int i ) const
+  {
+    return m_lat[i];
+  };
+
+  int lon( const int i ) const
+  {
+    return m_lon[i];
+  };
+
+  QPoint projP( const int i ) const
+  {
+    return QPoint( m_projX[i], m_projY[i] );
+  };
+
+  void setProjP( const int i, const QPoint& projP )
+  {
+    m_projX[i] = projP.x();
+    m_projY[i] = projP.y();
+  };
+
+  time_t time( const int i ) const
+  {
+    return m_time[i];
+  };
+
+  int height( const int i ) const
+  {
+    return m_height[i];
+  };
+
+  int gpsHeight( const int i ) const
+  {
+    return m_gpsHeight[i];
+  };
+
+  int engineNoise( const int i ) const
+  {
+    return m_engineNoise[i];
+  };
+
+  int surfaceHeight( const int i ) const
+  {
+    return m_surfaceHeight[i];
+  };
+
+  void setSurfaceHeight( const int i, const int height )
+  {
+    m_surfaceHeight[i] = height;
+  };
+
+  int dH( const int i ) const
+  {
+    return m_dH[i];
+  };
+
+  int dT( const int i ) const
+  {
+    return m_dT[i];
+  };
+
+  int dS( const int i ) const
+  {
+    return m_dS[i];
+  };
+
+  float bearing( const int i ) const
+  {
+    return m_bearing[i];
+  };
+
+  void setBearing( const int i, const float bearing )
+  {
+    m_bearing[i] = bearing;
+  };
+
+  float dBearing( const int i ) const
+  {
+    return m_dBearing[i];
+  };
+
+  void setDBearing( const int i, const float dBearing )
+  {
+    m_dBearing[i] = dBearing;
+  };
+
+  unsigned int fState( const int i ) const
+  {
+    return m_fState[i];
+  };
+
+  void setFState( const int i, const unsigned int state )
+  {
+    m_fState[i] = state;
+  };
+
+  bool isAirspaceIntersected( const int i ) const
+  {
+    return m_airspace[i];
+  };
+
+  void setAirspaceIntersected( const int i, const bool flag )
+  {
+    m_airspace[i] = flag;
+  };
+
+  /**
+   * Calculates the elevation, time and distance differences of every fix
+   * to its predecessor. The time difference is at least one second, also
+   * for the first fix, which gets the difference to its successor.
+   */
+  void calculateDeltas();
+
+  /**
+   * \return The distance between the fixes i and j in km.
+   */
+  double distance( const int i, const int j ) const;
+
+  /**
+   * \return The bearing from fix i to fix j in radians.
+   */
+  float course( const int i, const int j ) const;
+
+  /**
+   * \return The time column.
+   */
+  const time_t* times() const
+  {
+    return m_time.constData();
+  };
+
+  /**
+   * \return The barometric altitude column.
+   */
+  const int* heights() const
+  {
+    return m_height.constData();
+  };
+
+  /**
+   * \return The elevation difference column.
+   */
+  const int* dHs() const
+  {
+    return m_dH.constData();
+  };
+
+  /**
+   * \return The time difference column.
+   */
+  const int* dTs() const
+  {
+    return m_dT.constData();
+  };
+
+  /**
+   * \return The distance difference column.
+   */
+  const int* dSs() const
+  {
+    return m_dS.constData();
+  };
+
+  /**
+   * \return The used memory in bytes.
+   */
+  int memoryUsage() const;
+
+ private:
+
+  /** Logged values */
+  QVector<int> m_lat;
+  QVector<int> m_lon;
+  QVector<int> m_projX;
+  QVector<int> m_projY;
+  QVector<time_t> m_time;
+  QVector<int> m_height;
+  QVector<int> m_gpsHeight;
+  QVector<qint16> m_engineNoise;
+  QVector<qint16> m_surfaceHeight;
+
+  /** Derived values */
+  QVector<int> m_dH;
+  QVector<int> m_dT;
+  QVector<int> m_dS;
+  QVector<float> m_bearing;
+  QVector<float> m_dBearing;
+  QVector<quint8> m_fState;
+  QVector<bool> m_airspace;
+};
+
+#endif
@@ -0,0 +1,260 @@
+/***********************************************************************
+**
+**   flighttracklod.cpp
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <cfloat>
+#include <cmath>
+
+#include <QtCore>
+
+#include "flighttrack.h"
+#include "flighttracklod.h"
+
+// Number of segments of a chunk
+#define LOD_CHUNK_SIZE 64
+
+// The simplification works on blocks of fixes. That limits the costs of
+// the worst case to LOD_BLOCK_SIZE per fix.
+#define LOD_BLOCK_SIZE 1024
+
+// Maximum number of levels
+#define LOD_MAX_LEVELS 24
+
+FlightTrackLod::FlightTrackLod()
+{
+}
+
+FlightTrackLod::~FlightTrackLod()
+{
+}
+
+void FlightTrackLod::clear()
+{
+  m_indices.clear();
+  m_chunks.clear();
+  m_tolerance.clear();
+}
+
+void FlightTrackLod::build( const FlightTrack& track )
+{
+  clear();
+
+  if( track.isEmpty() )
+    {
+      return;
+    }
+
+  QVector<double> importance;
+  __calculateImportance( track, importance );
+
+  // Level 0 contains all fixes.
+  __addLevel( track, importance, -1.0 );
+
+  double tolerance = 1.0;
+
+  for( int k = 1; k < LOD_MAX_LEVELS && m_indices.last().size() > 2; k++ )
+    {
+      // Skip levels, which would not save enough fixes.
+      int count = 0;
+
+      for( int i = 0; i < importance.size(); i++ )
+        {
+          if( importance[i] > tolerance )
+            {
+              count++;
+            }
+        }
+
+      if( count < m_indices.last().size() * 3 / 4 )
+        {
+          __addLevel( track, importance, tolerance );
+        }
+
+      tolerance *= 2.0;
+    }
+}
+
+void FlightTrackLod::__calculateImportance( const FlightTrack& track,
+                                            QVector<double>& importance )
+{
+  const int n = track.count();
+
+  importance.fill( 0.0, n );
+
+  // The borders of the blocks are always kept.
+  for( int i = 0; i < n; i += LOD_BLOCK_SIZE )
+    {
+      importance[i] = DBL_MAX;
+    }
+
+  importance[n - 1] = DBL_MAX;
+
+  // Open parts of the track, the importance of the parent part limits the
+  // importance of its fixes, that the levels stay nested.
+  struct Part
+  {
+    int first;
+    int last;
+    double limit;
+  };
+
+  QVector<Part> stack;
+
+  for( int i = 0; i < n - 1; i += LOD_BLOCK_SIZE )
+    {
+      Part part = { i, qMin( i + LOD_BLOCK_SIZE, n - 1 ), DBL_MAX };
+      stack.append( part );
+    }
+
+  while( ! stack.isEmpty() )
+    {
+      Part part = stack.last();
+      stack.pop_back();
+
+      if( part.last - part.first < 2 )
+        {
+          continue;
+        }
+
+      const QPoint a = track.projP( part.first );
+      const QPoint b = track.projP( part.last );
+
+      const double dx = b.x() - a.x();
+      const double dy = b.y() - a.y();
+      const double length2 = dx * dx + dy * dy;
+
+      double maxDist = -1.0;
+      int maxIndex = part.first + 1;
+
+      for( int i = part.first + 1; i < part.last; i++ )
+        {
+          const QPoint p = track.projP( i );
+
+          const double px = p.x() - a.x();
+          const double py = p.y() - a.y();
+
+          // Distance from the segment between a and b. A fix beyond one of
+          // its ends is measured to that end, a track turning back keeps it.
+          double t = 0.0;
+
+          if( length2 > 0.0 )
+            {
+              t = qBound( 0.0, (px * dx + py * dy) / length2, 1.0 );
+            }
+
+          const double ex = px - t * dx;
+          const double ey = py - t * dy;
+          const double dist = sqrt( ex * ex + ey * ey );
+
+          if( dist > maxDist )
+            {
+              maxDist  = dist;
+              maxIndex = i;
+            }
+        }
+
+      const double limit = qMin( maxDist, part.limit );
+
+      importance[maxIndex] = limit;
+
+      Part left  = { part.first, maxIndex, limit };
+      Part right = { maxIndex, part.last, limit };
+
+      stack.append( left );
+      stack.append( right );
+    }
+}
+
+void FlightTrackLod::__addLevel( const FlightTrack& track,
+                                 const QVector<double>& importance,
+                                 const double tolerance )
+{
+  QVector<int> indices;
+
+  for( int i = 0; i < importance.size(); i++ )
+    {
+      if( importance[i] > tolerance )
+        {
+          indices.append( i );
+        }
+    }
+
+  QVector<Chunk> chunks;
+
+  for( int first = 0; first == 0 || first < indices.size() - 1; first += LOD_CHUNK_SIZE )
+    {
+      Chunk chunk;
+      chunk.first = first;
+      chunk.last  = qMin( first + LOD_CHUNK_SIZE, indices.size() - 1 );
+
+      const QPoint p0 = track.projP( indices[first] );
+      int left = p0.x(), right = p0.x(), top = p0.y(), bottom = p0.y();
+
+      for( int i = first + 1; i <= chunk.last; i++ )
+        {
+          const QPoint p = track.projP( indices[i] );
+
+          left   = qMin( left, p.x() );
+          right  = qMax( right, p.x() );
+          top    = qMin( top, p.y() );
+          bottom = qMax( bottom, p.y() );
+        }
+
+      chunk.box = QRect( QPoint( left, top ), QPoint( right, bottom ) );
+      chunks.append( chunk );
+    }
+
+  m_indices.append( indices );
+  m_chunks.append( chunks );
+  m_tolerance.append( tolerance );
+}
+
+int FlightTrackLod::levelForScale( const double pixelsPerUnit ) const
+{
+  if( pixelsPerUnit <= 0.0 )
+    {
+      return 0;
+    }
+
+  const double allowed = 0.5 / pixelsPerUnit;
+
+  int level = 0;
+
+  for( int k = 1; k < m_tolerance.size(); k++ )
+    {
+      if( m_tolerance[k] > allowed )
+        {
+          break;
+        }
+
+      level = k;
+    }
+
+  return level;
+}
+
+int FlightTrackLod::position( const int level, const int index ) const
+{
+  const QVector<int>& indices = m_indices.at( level );
+
+  // The first fix with a greater index follows the wanted position.
+  QVector<int>::const_iterator it = qUpperBound( indices.begin(), indices.end(), index );
+
+  return qMax( 0, (int) (it - indices.begin()) - 1 );
+}
+
+double FlightTrackLod::pixelsPerUnit( const QTransform& matrix )
+{
+  return sqrt( fabs( matrix.m11() * matrix.m22() - matrix.m12() * matrix.m21() ) );
+}
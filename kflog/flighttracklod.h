@@ -0,0 +1,146 @@
+/***********************************************************************
+**
+**   flighttracklod.h
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#ifndef FLIGHT_TRACK_LOD_H
+#define FLIGHT_TRACK_LOD_H
+
+#include <QList>
+#include <QRect>
+#include <QTransform>
+#include <QVector>
+
+class FlightTrack;
+
+/**
+ * \class FlightTrackLod
+ *
+ * \author agent
+ *
+ * \brief Levels of detail of the projected flight way.
+ *
+ * Every fix of a track gets an importance, which is the distance from the
+ * simplified line, at which a Douglas-Peucker simplification keeps the fix.
+ * Level 0 contains all fixes, level k all fixes with an importance above
+ * 2^(k-1) projected units. A level is only stored, if it contains clearly
+ * less fixes than the level before.
+ *
+ * The fixes of every level are grouped into chunks of consecutive segments
+ * with a bounding box in projected coordinates. The last fix of a chunk is
+ * also the first fix of the next chunk, so that every chunk can be drawn
+ * on its own.
+ *
+ * The levels must be rebuilt, if the projected positions of the track are
+ * changed.
+ *
+ * \date 2026
+ */
+class FlightTrackLod
+{
+ public:
+
+  /**
+   * A chunk of a level.
+   */
+  class Chunk
+  {
+   public:
+
+    Chunk() : first(0), last(0) {};
+
+    /** Position of the first fix in the index list of the level. */
+    int first;
+
+    /** Position of the last fix in the index list of the level. */
+    int last;
+
+    /** Bounding box of the fixes in projected coordinates. */
+    QRect box;
+  };
+
+  FlightTrackLod();
+
+  ~FlightTrackLod();
+
+  /**
+   * Builds the levels from the projected positions of the track.
+   */
+  void build( const FlightTrack& track );
+
+  /** Removes all levels. */
+  void clear();
+
+  int levels() const
+  {
+    return m_indices.size();
+  };
+
+  /**
+   * \return The coarsest level, which deviates less than half a pixel
+   *         from the flight way at the passed scale.
+   */
+  int levelForScale( const double pixelsPerUnit ) const;
+
+  /**
+   * \return The ascending fix indices of the level.
+   */
+  const QVector<int>& indices( const int level ) const
+  {
+    return m_indices.at( level );
+  };
+
+  /**
+   * \return The chunks of the level.
+   */
+  const QVector<Chunk>& chunks( const int level ) const
+  {
+    return m_chunks.at( level );
+  };
+
+  /**
+   * \return The position of the last fix of the level, whose index is not
+   *         greater than the passed fix index.
+   */
+  int position( const int level, const int index ) const;
+
+  /**
+   * \return The number of pixels per projected unit of the passed map
+   *         matrix.
+   */
+  static double pixelsPerUnit( const QTransform& matrix );
+
+ private:
+
+  /**
+   * Calculates the importance of every fix.
+   */
+  static void __calculateImportance( const FlightTrack& track,
+                                     QVector<double>& importance );
+
+  /** Adds a level with the fixes above the tolerance. */
+  void __addLevel( const FlightTrack& track,
+                   const QVector<double>& importance,
+                   const double tolerance );
+
+  /** Fix indices per level. */
+  QList< QVector<int> > m_indices;
+
+  /** Chunks per level. */
+  QList< QVector<Chunk> > m_chunks;
+
+  /** Maximum deviation per level in projected units. */
+  QVector<double> m_tolerance;
+};
+
+#endif
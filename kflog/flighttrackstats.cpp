@@ -0,0 +1,210 @@
+/***********************************************************************
+**
+**   flighttrackstats.cpp
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <climits>
+
+#include <QtCore>
+
+#include "flighttrack.h"
+#include "flighttrackstats.h"
+
+FlightTrackStats::Sums::Sums() : dS(0)
+{
+  for( int s = 0; s < States; s++ )
+    {
+      dHPos[s] = 0;
+      dHNeg[s] = 0;
+      dT[s] = 0;
+    }
+}
+
+FlightTrackStats::FlightTrackStats() :
+  m_leaves(0)
+{
+}
+
+FlightTrackStats::~FlightTrackStats()
+{
+}
+
+void FlightTrackStats::clear()
+{
+  m_prefix.clear();
+  m_bearing.clear();
+  m_stateChanges.clear();
+  m_leaves = 0;
+  m_minHeight.clear();
+  m_maxHeight.clear();
+}
+
+void FlightTrackStats::build( const FlightTrack& track )
+{
+  clear();
+
+  const int n = track.count();
+
+  if( n == 0 )
+    {
+      return;
+    }
+
+  const int* dH = track.dHs();
+  const int* dT = track.dTs();
+  const int* dS = track.dSs();
+
+  m_prefix.resize( n + 1 );
+  m_bearing.resize( n + 1 );
+  m_bearing[0] = 0.0;
+
+  for( int i = 0; i < n; i++ )
+    {
+      Sums sums = m_prefix.at(i);
+
+      const int s = stateIndex( track.fState(i) );
+
+      if( dH[i] > 0 )
+        {
+          sums.dHPos[s] += dH[i];
+        }
+      else
+        {
+          sums.dHNeg[s] += dH[i];
+        }
+
+      sums.dT[s] += dT[i];
+
+      if( s == 0 )
+        {
+          sums.dS += dS[i];
+        }
+
+      m_prefix[i + 1] = sums;
+      m_bearing[i + 1] = m_bearing[i] + track.bearing(i);
+
+      if( i > 0 && track.fState(i) != track.fState(i - 1) )
+        {
+          m_stateChanges.append( i );
+        }
+    }
+
+  // The trees are stored as arrays, the children of node k are the nodes
+  // 2k and 2k + 1.
+  m_leaves = 1;
+
+  while( m_leaves < n )
+    {
+      m_leaves *= 2;
+    }
+
+  m_minHeight.fill( INT_MAX, 2 * m_leaves );
+  m_maxHeight.fill( INT_MIN, 2 * m_leaves );
+
+  for( int i = 0; i < n; i++ )
+    {
+      m_minHeight[m_leaves + i] = track.height(i);
+      m_maxHeight[m_leaves + i] = track.height(i);
+    }
+
+  for( int k = m_leaves - 1; k > 0; k-- )
+    {
+      m_minHeight[k] = qMin( m_minHeight[2 * k], m_minHeight[2 * k + 1] );
+      m_maxHeight[k] = qMax( m_maxHeight[2 * k], m_maxHeight[2 * k + 1] );
+    }
+}
+
+FlightTrackStats::Sums FlightTrackStats::sums( const int first, const int last ) const
+{
+  Sums result;
+
+  if( first < 0 || first >= last || last >= m_prefix.size() )
+    {
+      return result;
+    }
+
+  const Sums& a = m_prefix.at( first );
+  const Sums& b = m_prefix.at( last );
+
+  for( int s = 0; s < States; s++ )
+    {
+      result.dHPos[s] = b.dHPos[s] - a.dHPos[s];
+      result.dHNeg[s] = b.dHNeg[s] - a.dHNeg[s];
+      result.dT[s] = b.dT[s] - a.dT[s];
+    }
+
+  result.dS = b.dS - a.dS;
+
+  return result;
+}
+
+double FlightTrackStats::bearingSum( const int first, const int last ) const
+{
+  if( first < 0 || first >= last || last >= m_bearing.size() )
+    {
+      return 0.0;
+    }
+
+  return m_bearing.at( last ) - m_bearing.at( first );
+}
+
+QVector<int> FlightTrackStats::stateChanges( const int first, const int last ) const
+{
+  QVector<int>::const_iterator begin = qUpperBound( m_stateChanges.begin(),
+                                                    m_stateChanges.end(),
+                                                    first );
+
+  QVector<int>::const_iterator end = qLowerBound( begin,
+                                                  m_stateChanges.end(),
+                                                  last );
+  QVector<int> result;
+
+  for( QVector<int>::const_iterator it = begin; it < end; ++it )
+    {
+      result.append( *it );
+    }
+
+  return result;
+}
+
+bool FlightTrackStats::heightRange( const int first, const int last,
+                                    int& minHeight, int& maxHeight ) const
+{
+  if( first < 0 || first > last || last >= m_leaves )
+    {
+      return false;
+    }
+
+  minHeight = INT_MAX;
+  maxHeight = INT_MIN;
+
+  // Walk up from both leaves, taking the nodes lying inside of the range.
+  for( int l = first + m_leaves, r = last + m_leaves + 1; l < r; l /= 2, r /= 2 )
+    {
+      if( l & 1 )
+        {
+          minHeight = qMin( minHeight, m_minHeight[l] );
+          maxHeight = qMax( maxHeight, m_maxHeight[l] );
+          l++;
+        }
+
+      if( r & 1 )
+        {
+          r--;
+          minHeight = qMin( minHeight, m_minHeight[r] );
+          maxHeight = qMax( maxHeight, m_maxHeight[r] );
+        }
+    }
+
+  return minHeight <= maxHeight;
+}
@@ -0,0 +1,140 @@
+/***********************************************************************
+**
+**   flighttrackstats.h
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#ifndef FLIGHT_TRACK_STATS_H
+#define FLIGHT_TRACK_STATS_H
+
+#include <QVector>
+
+class FlightTrack;
+
+/**
+ * \class FlightTrackStats
+ *
+ * \author agent
+ *
+ * \brief Range statistics of a flight track.
+ *
+ * The altitude gain and loss, the time per flight state and the distance
+ * flown straight are stored as prefix sums over the segments of the track.
+ * The sums of any range of segments are then the difference of two
+ * entries. The changes of the flight state are stored as sorted list of
+ * fix indices. The minimum and maximum barometric height of any range of
+ * fixes are answered by a segment tree.
+ *
+ * The segment n is the way from fix n to fix n + 1. The statistics must be
+ * rebuilt, if the deltas or the flight states of the track are changed.
+ *
+ * \date 2026
+ */
+class FlightTrackStats
+{
+ public:
+
+  /** Number of distinguished flight states. */
+  enum { States = 4 };
+
+  /**
+   * The sums over a range of segments.
+   */
+  class Sums
+  {
+   public:
+
+    Sums();
+
+    /** Altitude gain per flight state. */
+    int dHPos[States];
+
+    /** Altitude loss per flight state, a negative value. */
+    int dHNeg[States];
+
+    /** Duration per flight state in seconds. */
+    int dT[States];
+
+    /** Distance of the straight segments in meters. */
+    int dS;
+  };
+
+  FlightTrackStats();
+
+  ~FlightTrackStats();
+
+  /**
+   * Builds the statistics from the deltas and flight states of the track.
+   */
+  void build( const FlightTrack& track );
+
+  /** Removes all statistics. */
+  void clear();
+
+  /**
+   * \return The position in the per state arrays of \ref Sums for the
+   *         passed flight state. Unknown states are counted as straight.
+   */
+  static int stateIndex( const unsigned int fState )
+  {
+    return fState < (unsigned int) States ? (int) fState : 0;
+  };
+
+  /**
+   * \return The sums over the segments first up to last - 1. The sums are
+   *         zero, if the range is empty.
+   */
+  Sums sums( const int first, const int last ) const;
+
+  /**
+   * \return The sum of the bearings of the segments first up to last - 1.
+   */
+  double bearingSum( const int first, const int last ) const;
+
+  /**
+   * \return The ascending indices of the fixes after first and before
+   *         last, whose flight state differs from the one of the previous
+   *         fix.
+   */
+  QVector<int> stateChanges( const int first, const int last ) const;
+
+  /**
+   * Determines the minimum and maximum barometric height of the fixes
+   * first up to last.
+   *
+   * \return False, if the range contains no fix.
+   */
+  bool heightRange( const int first, const int last,
+                    int& minHeight, int& maxHeight ) const;
+
+ private:
+
+  /** Prefix sums, entry n contains the sums of the segments 0 to n - 1. */
+  QVector<Sums> m_prefix;
+
+  /** Prefix sums of the bearings. */
+  QVector<double> m_bearing;
+
+  /** Fixes starting a new flight state. */
+  QVector<int> m_stateChanges;
+
+  /** Number of leaves of the segment trees. */
+  int m_leaves;
+
+  /** Segment tree of the minimum heights, the leaves start at m_leaves. */
+  QVector<int> m_minHeight;
+
+  /** Segment tree of the maximum heights, the leaves start at m_leaves. */
+  QVector<int> m_maxHeight;
+};
+
+#endif
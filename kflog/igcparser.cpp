@@ -0,0 +1,759 @@
+/***********************************************************************
+**
+**   igcparser.cpp
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <cctype>
+#include <cstring>
+
+#include <QtCore>
+
+#include "igcparser.h"
+#include "mapcalc.h"
+#include "mapmatrix.h"
+
+// Number of bytes parsed between two progress reports
+#define PROGRESS_CHUNK_SIZE (64 * 1024)
+
+// Minimum length of a B record without extensions
+#define B_RECORD_LENGTH 35
+
+/**
+ * Decodes a fixed column unsigned decimal number. Returns false, if a
+ * column does not contain a digit.
+ */
+static inline bool decodeNumber( const char* p, const int len, int& value )
+{
+  int v = 0;
+
+  for( int i = 0; i < len; i++ )
+    {
+      const char c = p[i];
+
+      if( c < '0' || c > '9' )
+        {
+          return false;
+        }
+
+      v = v * 10 + ( c - '0' );
+    }
+
+  value = v;
+  return true;
+}
+
+/**
+ * Decodes a fixed column altitude. The first column can contain a minus
+ * sign. Returns false, if the field is malformed.
+ */
+static inline bool decodeAltitude( const char* p, const int len, int& value )
+{
+  if( p[0] == '-' )
+    {
+      if( ! decodeNumber( p + 1, len - 1, value ) )
+        {
+          return false;
+        }
+
+      value = -value;
+      return true;
+    }
+
+  return decodeNumber( p, len, value );
+}
+
+/**
+ * Decodes a fixed column number like sscanf("%d") did before. Leading
+ * blanks and a sign are accepted, decoding stops at the first non digit.
+ * Returns false, if no digit is found.
+ */
+static inline bool decodeLooseNumber( const char* p, const int len, int& value )
+{
+  int i = 0;
+
+  while( i < len && p[i] == ' ' )
+    {
+      i++;
+    }
+
+  bool negative = false;
+
+  if( i < len && ( p[i] == '-' || p[i] == '+' ) )
+    {
+      negative = ( p[i] == '-' );
+      i++;
+    }
+
+  int v = 0;
+  int digits = 0;
+
+  for( ; i < len && p[i] >= '0' && p[i] <= '9'; i++, digits++ )
+    {
+      v = v * 10 + ( p[i] - '0' );
+    }
+
+  if( digits == 0 )
+    {
+      return false;
+    }
+
+  value = negative ? -v : v;
+  return true;
+}
+
+/**
+ * Decodes a coordinate of the form DDMMmmmN or DDDMMmmmE into the internal
+ * KFLog format. degLen is the number of degree columns.
+ */
+static inline bool decodeCoordinate( const char* p, const int degLen,
+                                     const char positive, const char negative,
+                                     int& value )
+{
+  int deg, min;
+
+  if( ! decodeNumber( p, degLen, deg ) ||
+      ! decodeNumber( p + degLen, 5, min ) )
+    {
+      return false;
+    }
+
+  const char hemisphere = p[degLen + 5];
+
+  if( hemisphere != positive && hemisphere != negative )
+    {
+      return false;
+    }
+
+  value = deg * 600000 + min * 10;
+
+  if( hemisphere == negative )
+    {
+      value = -value;
+    }
+
+  return true;
+}
+
+/**
+ * Returns the text after the colon of a header record. The whole line is
+ * returned, if there is no colon.
+ */
+static inline QString headerValue( const char* line, const int len )
+{
+  const char* colon = static_cast<const char *> (memchr( line, ':', len ));
+
+  if( colon == 0 )
+    {
+      return QString::fromLocal8Bit( line, len );
+    }
+
+  return QString::fromLocal8Bit( colon + 1, len - int( colon - line ) - 1 );
+}
+
+IgcParser::IgcParser( QObject* parent ) :
+  QObject(parent),
+  m_timeOfFlightDay(0),
+  m_preTime(0),
+  m_preWP(0),
+  m_wpCount(0),
+  m_last0(-1),
+  m_lineCount(0),
+  m_errorLine(0),
+  m_canceled(0)
+{
+  setObjectName( "IgcParser" );
+}
+
+IgcParser::~IgcParser()
+{
+  __clear();
+}
+
+void IgcParser::__clear()
+{
+  m_route.clear();
+
+  qDeleteAll( m_fsd.waypoints );
+  m_fsd = Flight::FlightStaticData();
+
+  m_kRecords.clear();
+  m_bExtensions.clear();
+  m_kExtensions.clear();
+
+  m_timeOfFlightDay = 0;
+  m_preTime = 0;
+  m_preWP = 0;
+  m_wpCount = 0;
+  m_last0 = -1;
+  m_lineCount = 0;
+  m_errorLine = 0;
+}
+
+/** Creates the table of the flight recorder manufacturers. */
+static QHash<QString, QString> createManufacturerTable()
+{
+  QHash<QString, QString> table;
+
+  table.insert( "GCS", "Garrecht" );
+  table.insert( "CAM", "Cambridge Aero Instruments" );
+  table.insert( "DSX", "Data Swan/DSX" );
+  table.insert( "EWA", "EW Avionics" );
+  table.insert( "FIL", "Filser" );
+  table.insert( "FLA", "Flarm" );
+  table.insert( "SCH", "Scheffel" );
+  table.insert( "ACT", "Aircotec" );
+  table.insert( "NKL", "Nielsen Kellerman" );
+  table.insert( "LXN", "LX Navigation" );
+  table.insert( "IMI", "IMI Gliding Equipment" );
+  table.insert( "NTE", "New Technologies s.r.l." );
+  table.insert( "PES", "Peschges" );
+  table.insert( "PRT", "Print Technik" );
+  table.insert( "SDI", "Streamline Data Instruments" );
+  table.insert( "TRI", "Triadis Engineering GmbH" );
+  table.insert( "LXV", "LXNAV d.o.o." );
+  table.insert( "WES", "Westerboer" );
+  table.insert( "ZAN", "Zander" );
+  table.insert( "XXX", QObject::tr("unknow manufacture") );
+
+  return table;
+}
+
+QString IgcParser::manufacturerName( const QString& code )
+{
+  // Initialized once on the first call, also if called by several threads.
+  static const QHash<QString, QString> manufacturers = createManufacturerTable();
+
+  if( manufacturers.contains( code ) )
+    {
+      return manufacturers.value( code );
+    }
+
+  return QObject::tr("unknown manufacturer");
+}
+
+void IgcParser::slotCancel()
+{
+  m_canceled.fetchAndStoreOrdered( 1 );
+}
+
+FlightTrack IgcParser::takeRoute()
+{
+  FlightTrack route = m_route;
+  m_route.clear();
+  return route;
+}
+
+Flight::FlightStaticData IgcParser::takeStaticData()
+{
+  Flight::FlightStaticData fsd = m_fsd;
+  m_fsd.waypoints.clear();
+  return fsd;
+}
+
+IgcParser::Result IgcParser::parse( const QString& fileName,
+                                    ProjectionBase* projection )
+{
+  QFile file( fileName );
+
+  if( ! file.open( QIODevice::ReadOnly ) )
+    {
+      qWarning() << "IgcParser: Cannot open file" << fileName;
+      return FileError;
+    }
+
+  const qint64 size = file.size();
+
+  if( size == 0 )
+    {
+      return parse( "", 0, projection );
+    }
+
+  // Map the whole file into memory. If that fails, we read it in one go.
+  QByteArray buffer;
+  const char* data = reinterpret_cast<const char *> (file.map( 0, size ));
+
+  if( data == 0 )
+    {
+      buffer = file.readAll();
+
+      if( buffer.size() != size )
+        {
+          qWarning() << "IgcParser: Read error on file" << fileName;
+          return FileError;
+        }
+
+      data = buffer.constData();
+    }
+
+  return parse( data, size, projection );
+}
+
+IgcParser::Result IgcParser::parse( const char* data,
+                                    const qint64 size,
+                                    ProjectionBase* projection )
+{
+  __clear();
+  m_canceled.fetchAndStoreOrdered( 0 );
+
+  // Most lines of an IGC file are B records of about 40 bytes.
+  m_route.reserve( int( qMin( size / 40, qint64(1000000) ) ) );
+
+  const char* end = data + size;
+  const char* line = data;
+  qint64 nextReport = PROGRESS_CHUNK_SIZE;
+
+  bool isHeader = true;
+
+  while( line < end )
+    {
+      const char* eol = static_cast<const char *> (memchr( line, '\n', end - line ));
+
+      if( eol == 0 )
+        {
+          eol = end;
+        }
+
+      int len = int( eol - line );
+
+      // Remove the carriage return of the line end.
+      if( len > 0 && line[len - 1] == '\r' )
+        {
+          len--;
+        }
+
+      const char* next = ( eol < end ) ? eol + 1 : end;
+
+      m_lineCount++;
+
+      if( next - data >= nextReport )
+        {
+          nextReport += PROGRESS_CHUNK_SIZE;
+
+          emit progress( int( ( next - data ) * 100 / size ) );
+
+          if( m_canceled.fetchAndAddOrdered( 0 ) != 0 )
+            {
+              __clear();
+              return Canceled;
+            }
+        }
+
+      // Skip empty lines and lines containing only blanks.
+      int first = 0;
+
+      while( first < len && isspace( (uchar) line[first] ) )
+        {
+          first++;
+        }
+
+      if( first == len )
+        {
+          line = next;
+          continue;
+        }
+
+      // First character of the read line is the key.
+      switch( line[0] )
+        {
+          case 'B':
+
+            isHeader = false;
+
+            if( ! __parseBRecord( line, len, projection ) )
+              {
+                m_errorLine = m_lineCount;
+
+                qWarning( "IgcParser: Syntax error in line %d of igc-file",
+                          m_lineCount );
+
+                m_route.clear();
+                return SyntaxError;
+              }
+
+            break;
+
+          case 'A':
+            {
+              // We have an manufacturer identifier
+              QString manufactureCode = QString::fromLatin1( line + 1, qMin( 3, len - 1 ) ).toUpper();
+
+              if( len > 1 && line[1] == 'X' )
+                {
+                  manufactureCode = "XXX";
+                }
+
+              m_fsd.frManufacturer = manufacturerName( manufactureCode ) +
+                                     " (" + manufactureCode + ")";
+
+              if( len > 4 )
+                {
+                  m_fsd.frManufacturer += ", " +
+                    QString::fromLatin1( line + 4, qMin( 3, len - 4 ) ).toUpper();
+                }
+            }
+
+            break;
+
+          case 'H':
+            __parseHRecord( line, len );
+            break;
+
+          case 'I':
+            __parseExtensions( line, len, m_bExtensions );
+            break;
+
+          case 'J':
+            __parseExtensions( line, len, m_kExtensions );
+            break;
+
+          case 'K':
+            __parseKRecord( line, len );
+            break;
+
+          case 'C':
+
+            if( isHeader )
+              {
+                __parseCRecord( line, len, projection );
+              }
+
+            break;
+
+          default:
+            // ignore other lines in file for now...
+            break;
+        }
+
+      line = next;
+    }
+
+  emit progress( 100 );
+
+  return Ok;
+}
+
+bool IgcParser::__parseBRecord( const char* line, const int len,
+                                ProjectionBase* projection )
+{
+  //
+  // BHHMMSSDDMMMMMNDDDMMMMMEVPPPPPGGGGGAAASSNNN
+  //
+  // HHMMSS       : Time of Fix, given in UTC                 6 byte
+  //
+  // DDMMmmmN/S   : Latitude (degree, minutes,                8 byte
+  //                decimal of minutes)
+  //
+  //
+  //                       quality
+  //    time   lat      lon   |   h   GPS   ???
+  //   |----||------||-------|||---||----||----?
+  // ^B0944584832663N00856771EA0037700400100004
+  //
+  if( len < B_RECORD_LENGTH )
+    {
+      return false;
+    }
+
+  int hh, mm, ss, latTemp, lonTemp, baroAltTemp, gpsAltTemp;
+
+  if( ! decodeNumber( line + 1, 2, hh ) ||
+      ! decodeNumber( line + 3, 2, mm ) ||
+      ! decodeNumber( line + 5, 2, ss ) ||
+      ! decodeCoordinate( line + 7, 2, 'N', 'S', latTemp ) ||
+      ! decodeCoordinate( line + 15, 3, 'E', 'W', lonTemp ) ||
+      ( line[24] != 'A' && line[24] != 'V' ) ||
+      ! decodeAltitude( line + 25, 5, baroAltTemp ) ||
+      ! decodeAltitude( line + 30, 5, gpsAltTemp ) )
+    {
+      return false;
+    }
+
+  if( hh > 29 || mm > 69 || ss > 69 )
+    {
+      return false;
+    }
+
+  if( line[24] == 'V' )
+    {
+      // void, not valid
+      return true;
+    }
+
+  // Ignoring a wrong point ...
+  if( latTemp == 0 && lonTemp == 0 )
+    {
+      return true;
+    }
+
+  int engineNoise = -1;
+
+  // Scan the optional parts of the B record
+  for( int i = 0; i < m_bExtensions.size(); i++ )
+    {
+      const Extension& ext = m_bExtensions.at(i);
+
+      // Parse only known options
+      if( ext.mnemonic.compare( "ENL", Qt::CaseInsensitive ) == 0 &&
+          ext.begin >= 0 && ext.begin < len )
+        {
+          decodeLooseNumber( line + ext.begin,
+                             qMin( ext.length, len - ext.begin ),
+                             engineNoise );
+        }
+    }
+
+  time_t curTime = m_timeOfFlightDay + 3600 * hh + 60 * mm + ss;
+
+  if( curTime < m_preTime )
+    {
+      // The new fix as a smaller time stamp. Therefore we assume, that
+      // we have an overnight-flight. So we must add one day (e.g. 86400 sec.)
+      m_timeOfFlightDay += 86400;
+      curTime += 86400;
+    }
+
+  m_preTime = curTime;
+
+  QPoint projP;
+
+  if( projection != 0 )
+    {
+      projP = MapMatrix::wgsToMap( projection, latTemp, lonTemp );
+    }
+
+  m_route.append( WGSPoint( latTemp, lonTemp ), projP, curTime,
+                  baroAltTemp, gpsAltTemp, engineNoise );
+  return true;
+}
+
+void IgcParser::__parseHRecord( const char* line, const int len )
+{
+  // We have a headline
+  // The general format of the H-Record is: H, data source (S), subtype (CCC), subtype long name,
+  // colon, text string. The long name and text string are intended as an aid for people reading the file.
+  if( len < 5 )
+    {
+      return;
+    }
+
+  const QByteArray htype = QByteArray( line + 1, 4 ).toUpper();
+
+  if( htype == "FPLT" ) // pilot in charge
+    m_fsd.pilot = headerValue( line, len );
+  else if( htype == "PCM2" ) // copilot
+    m_fsd.copilot = headerValue( line, len );
+  else if( htype == "FGTY" ) // glider type
+    m_fsd.gliderType = headerValue( line, len );
+  else if( htype == "FGID" ) // gilder Id
+    m_fsd.gliderRegistration = headerValue( line, len );
+  else if( htype == "FRFW" ) // firmeware version
+    m_fsd.firmewareVersion = headerValue( line, len );
+  else if( htype == "FRHW" ) // hardware version
+    m_fsd.hardwareVersion = headerValue( line, len );
+  else if( htype == "FFTY" ) // flight recorder type
+    m_fsd.frType = headerValue( line, len );
+  else if( htype == "FGPS" ) // GPS manufacture
+    m_fsd.gpsManufacturer = QString::fromLocal8Bit( line + 5, len - 5 );
+  else if( htype == "FDTM" ) // GPS datum
+    m_fsd.gpsDatum = headerValue( line, len );
+  else if( htype == "FPRS" ) // pressure sensor
+    m_fsd.altitudePressureSensor = headerValue( line, len );
+  else if( htype == "FCID" )
+    m_fsd.competitionId = headerValue( line, len );
+  else if( htype == "FCCL" )
+    m_fsd.competitionClass = headerValue( line, len );
+  else if( htype == "FDTE" && len >= 11 ) // date of flight
+    {
+      int day, mon, year;
+
+      bool ok = decodeNumber( line + 5, 2, day ) &&
+                decodeNumber( line + 7, 2, mon ) &&
+                decodeNumber( line + 9, 2, year );
+
+      QString century;
+
+      if( ok && year > 80 )
+        {
+          // seems to be an old flight
+          century = "19";
+          year += 1900;
+        }
+      else
+        {
+          century = "20";
+          year += 2000;
+        }
+
+      // Begin time of flight
+      m_fsd.date = century + QString::fromLatin1( line + 9, 2 ) + "-" +
+                   QString::fromLatin1( line + 7, 2 ) + "-" +
+                   QString::fromLatin1( line + 5, 2 );
+
+      // Set current flight date time. This will consider flights over
+      // midnight.
+      QDate date( year, mon, day );
+
+      m_timeOfFlightDay = timeToDay( date.year(), date.month(), date.day() );
+    }
+}
+
+void IgcParser::__parseExtensions( const char* line, const int len,
+                                   QList<Extension>& extensions )
+{
+  // This record defines the extension of the mandatory fix B Record (I) or
+  // of the K Record (J). Only one record of each is allowed in each file.
+  // Format of I and J Record:
+  //    I N N S S F F M M M S S F F M M M CR LF
+  // Description             Size          Element   Remarks
+  //   # of  extensions        2 bytes       NN        Valid characters 0-9
+  //   Start byte number       2 bytes       SS        Valid characters 0-9
+  //   Finish byte number      2 bytes       FF        Valid characters 0-9
+  //   Mnemonic                3 bytes       MMM       Valid characters alphanumeric
+  // The byte count starts from the beginning of the record starting at 1.
+  int nrOfOpts = 0;
+
+  extensions.clear();
+
+  if( len < 3 || ! decodeNumber( line + 1, 2, nrOfOpts ) ||
+      nrOfOpts < 1 || nrOfOpts > 10 )
+    {
+      // Must be wrong
+      qWarning( "IgcParser: Wrong extension definition in line %d of igc-file",
+                m_lineCount );
+    }
+
+  for( int i = 0; i < nrOfOpts; i++ )
+    {
+      const char* p = line + 3 + i * 7;
+
+      if( p + 7 > line + len )
+        {
+          break;
+        }
+
+      Extension ext;
+      int finish;
+
+      if( ! decodeNumber( p, 2, ext.begin ) || ! decodeNumber( p + 2, 2, finish ) )
+        {
+          break;
+        }
+
+      ext.begin -= 1; // record starts with 1!
+      ext.length = finish - ext.begin;
+      ext.mnemonic = QString::fromLatin1( p + 4, 3 );
+
+      extensions.append( ext );
+    }
+}
+
+void IgcParser::__parseKRecord( const char* line, const int len )
+{
+  // Format of K record: K HHMMSS followed by the extensions of the J record.
+  int hh, mm, ss;
+
+  if( len < 7 ||
+      ! decodeNumber( line + 1, 2, hh ) ||
+      ! decodeNumber( line + 3, 2, mm ) ||
+      ! decodeNumber( line + 5, 2, ss ) )
+    {
+      return;
+    }
+
+  KRecord record;
+  record.time = m_timeOfFlightDay + 3600 * hh + 60 * mm + ss;
+
+  if( record.time < m_preTime )
+    {
+      record.time += 86400;
+    }
+
+  for( int i = 0; i < m_kExtensions.size(); i++ )
+    {
+      const Extension& ext = m_kExtensions.at(i);
+      int value;
+
+      if( ext.begin >= 0 && ext.begin < len &&
+          decodeLooseNumber( line + ext.begin,
+                             qMin( ext.length, len - ext.begin ),
+                             value ) )
+        {
+          record.values.insert( ext.mnemonic, value );
+        }
+    }
+
+  m_kRecords.append( record );
+}
+
+void IgcParser::__parseCRecord( const char* line, const int len,
+                                ProjectionBase* projection )
+{
+  if( len < 18 ||
+      ( line[8] != 'N' && line[8] != 'S' && line[17] != 'W' && line[17] != 'E' ) )
+    {
+      return;
+    }
+
+  // We have a waypoint
+  int latTemp, lonTemp;
+
+  if( ! decodeCoordinate( line + 1, 2, 'N', 'S', latTemp ) ||
+      ! decodeCoordinate( line + 9, 3, 'E', 'W', lonTemp ) )
+    {
+      return;
+    }
+
+  if( latTemp != 0 && lonTemp != 0 )
+    {
+      Waypoint* newWP = new Waypoint;
+      newWP->name = QString::fromLocal8Bit( line + 18, qMin( 20, len - 18 ) );
+      newWP->origP = WGSPoint( latTemp, lonTemp );
+
+      if( projection != 0 )
+        {
+          newWP->projP = MapMatrix::wgsToMap( projection, latTemp, lonTemp );
+        }
+
+      newWP->type = Flight::NotSet;
+
+      if( m_preWP == 0 )
+        {
+          newWP->distance = 0;
+        }
+      else
+        {
+          newWP->distance = dist( newWP, m_preWP );
+        }
+
+      m_fsd.waypoints.append( newWP );
+      m_preWP = newWP;
+    }
+  else
+    {
+      // Sinnvoller wäre es aus der IGC Datei auszulesen wieviele
+      // WendePunkte es gibt. <- Ist IGC Datei immer korrekt??
+      if( m_wpCount != 0 && m_last0 != (int) (m_wpCount - 1) && m_preWP != 0 )
+        {
+          Waypoint* newWP = new Waypoint;
+          newWP->name =  m_preWP->name;
+          newWP->origP = m_preWP->origP;
+          newWP->projP = m_preWP->projP;
+
+          m_fsd.waypoints.append( newWP );
+        }
+
+      m_last0 = m_wpCount;
+    }
+
+  m_wpCount++;
+}
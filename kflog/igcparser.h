@@ -0,0 +1,234 @@
+/***********************************************************************
+**
+**   igcparser.h
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#ifndef IGC_PARSER_H
+#define IGC_PARSER_H
+
+#include <ctime>
+
+#include <QAtomicInt>
+#include <QList>
+#include <QMap>
+#include <QObject>
+#include <QString>
+
+#include "flight.h"
+#include "flighttrack.h"
+
+class ProjectionBase;
+
+/**
+ * \class IgcParser
+ *
+ * \author agent
+ *
+ * \brief Parser for IGC flight files.
+ *
+ * The parser works directly on the memory mapped file content. The records
+ * are decoded column by column without creating intermediate string copies.
+ * Only the text values of the header records are converted into strings.
+ *
+ * The parser does not use any GUI elements and can be used without a main
+ * window, also in another thread. Every thread must pass its own projection
+ * object, because the projection objects are not thread safe. The progress
+ * is reported with the signal \ref progress in chunks of the file. A running
+ * parse can be aborted with \ref slotCancel.
+ *
+ * \date 2026
+ */
+class IgcParser : public QObject
+{
+  Q_OBJECT
+
+ private:
+
+  Q_DISABLE_COPY ( IgcParser )
+
+ public:
+
+  /**
+   * Result codes of the parser.
+   */
+  enum Result { Ok = 0, FileError, SyntaxError, Canceled };
+
+  /**
+   * The decoded extension data of a K record.
+   */
+  class KRecord
+  {
+   public:
+
+    KRecord() : time(0) {};
+
+    /** Time of the record. */
+    time_t time;
+
+    /** The extension values, the mnemonic is the key. */
+    QMap<QString, int> values;
+  };
+
+  IgcParser( QObject* parent = 0 );
+
+  virtual ~IgcParser();
+
+  /**
+   * Parses an IGC file.
+   *
+   * \param fileName The path of the IGC file.
+   *
+   * \param projection The projection used for the projected positions of the
+   *        flight points and waypoints. If it is null, the projected
+   *        positions are not set.
+   *
+   * \return The result of the parse.
+   */
+  Result parse( const QString& fileName, ProjectionBase* projection );
+
+  /**
+   * Parses the content of an IGC file.
+   *
+   * \param data The file content.
+   *
+   * \param size The size of the content in bytes.
+   *
+   * \param projection The projection used for the projected positions.
+   *
+   * \return The result of the parse.
+   */
+  Result parse( const char* data, const qint64 size, ProjectionBase* projection );
+
+  /**
+   * Takes over the parsed flight points.
+   */
+  FlightTrack takeRoute();
+
+  /**
+   * Takes over the static flight data. The caller is the owner of the
+   * contained waypoints.
+   */
+  Flight::FlightStaticData takeStaticData();
+
+  /**
+   * \return The decoded K records.
+   */
+  const QList<KRecord>& kRecords() const
+  {
+    return m_kRecords;
+  };
+
+  /**
+   * \return The line number of a syntax error.
+   */
+  int errorLine() const
+  {
+    return m_errorLine;
+  };
+
+  /**
+   * \return The full name of a flight recorder manufacturer.
+   */
+  static QString manufacturerName( const QString& code );
+
+ public slots:
+
+  /**
+   * Aborts a running parse at the next progress report.
+   */
+  void slotCancel();
+
+ signals:
+
+  /**
+   * Emitted after every parsed chunk of the file.
+   *
+   * \param percent The parsed part of the file in percent.
+   */
+  void progress( int percent );
+
+ private:
+
+  /**
+   * Definition of an extension field of the B or K records, as announced by
+   * the I or J record.
+   */
+  class Extension
+  {
+   public:
+
+    /** Start column in the record, counted from zero. */
+    int begin;
+
+    /** Number of columns. */
+    int length;
+
+    /** Three letter code of the extension. */
+    QString mnemonic;
+  };
+
+  /** Removes all results of a former parse. */
+  void __clear();
+
+  /** Decodes a B record. Returns false on a syntax error. */
+  bool __parseBRecord( const char* line, const int len, ProjectionBase* projection );
+
+  /** Decodes a C record of the task declaration. */
+  void __parseCRecord( const char* line, const int len, ProjectionBase* projection );
+
+  /** Decodes a H record. */
+  void __parseHRecord( const char* line, const int len );
+
+  /** Decodes the extension definitions of an I or J record. */
+  void __parseExtensions( const char* line, const int len, QList<Extension>& extensions );
+
+  /** Decodes a K record. */
+  void __parseKRecord( const char* line, const int len );
+
+  /** The parsed flight points. */
+  FlightTrack m_route;
+
+  /** The parsed static flight data. */
+  Flight::FlightStaticData m_fsd;
+
+  /** The decoded K records. */
+  QList<KRecord> m_kRecords;
+
+  /** Extensions of the B records. */
+  QList<Extension> m_bExtensions;
+
+  /** Extensions of the K records. */
+  QList<Extension> m_kExtensions;
+
+  /** Start time of the flight day. */
+  time_t m_timeOfFlightDay;
+
+  /** Time of the last fix. */
+  time_t m_preTime;
+
+  /** Waypoint parsing state of the task declaration. */
+  Waypoint* m_preWP;
+  unsigned int m_wpCount;
+  int m_last0;
+
+  /** Current line number. */
+  int m_lineCount;
+
+  /** Line number of a syntax error. */
+  int m_errorLine;
+
+  /** Set by \ref slotCancel. */
+  QAtomicInt m_canceled;
+};
+
+#endif
@@ -44,41 +44,6 @@ Isohypse::Isohypse( QPolygon elevationCoordinates,
 Isohypse::~Isohypse()
 {}
 
-QPainterPath* Isohypse::drawRegion( QPainter* targetP, const QRect &viewRect,
-                                    bool really_draw, bool isolines )
-{
-
-  if( isVisible() == false )
-    {
-      return static_cast<QPainterPath *> (0);
-    }
-
-  QPolygon mP = glMapMatrix->map(projPolygon);
-
-  if (really_draw)
-    {
-      if (mP.boundingRect().isNull())
-        {
-          // ignore null values and return also no region
-          return static_cast<QPainterPath *> (0);
-        }
-
-      targetP->setClipRegion(viewRect);
-
-      targetP->drawPolygon(mP);
-
-      if( isolines )
-        {
-          targetP->drawPolyline(mP);
-        }
-    }
-
-  QPainterPath *path = new QPainterPath;
-  path->addPolygon(projPolygon);
-  path->closeSubpath();
-  return path;
-}
-
 bool Isohypse::isVisible() const
 {
   // Check, if this isohypse tile has a map overlapping otherwise we can ignore
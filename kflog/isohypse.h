@@ -56,20 +56,6 @@ public:
    */
   virtual ~Isohypse();
 
-  /**
-   * Draws the isoline region into the given painter.
-   *
-   * @param targetP The painter to draw the element into.
-   * @param viewRect The bounding rectangle of the draw region.
-   * @param really_draw Switches region drawing on/off.
-   * @param isolines Switches outline drawing on/off
-   *
-   * @return The projected region polygon as QPainterPath object usable
-   *         for later elevation finding.
-   */
-  QPainterPath* drawRegion( QPainter* targetP, const QRect &viewRect,
-                            bool really_draw=true, bool isolines=false );
-
   /**
    * @return the elevation of the line
    */
@@ -63,6 +63,7 @@ SOURCES = \
     airfield.cpp \
     AirfieldSelectionList.cpp \
     airspace.cpp \
+    airspacecache.cpp \
     AirspaceHelper.cpp \
     airspacelistviewitem.cpp \
     altitude.cpp \
@@ -77,18 +78,24 @@ SOURCES = \
     distance.cpp \
     downloadmanager.cpp \
     elevationfinder.cpp \
+    elevationgrid.cpp \
     evaluationdialog.cpp \
     evaluationframe.cpp \
     evaluationview.cpp \
     flight.cpp \
     flightdataprint.cpp \
+    flightdownloadqueue.cpp \
     flightgroup.cpp \
     flightgrouplistviewitem.cpp \
+    flightimporter.cpp \
     flightlistviewitem.cpp \
     flightloader.cpp \
     flightrecorderpluginbase.cpp \
     flightselectiondialog.cpp \
     flighttask.cpp \
+    flighttrack.cpp \
+    flighttracklod.cpp \
+    flighttrackstats.cpp \
     helpwindow.cpp \
     httpclient.cpp \
     igc3ddialog.cpp \
@@ -96,8 +103,8 @@ SOURCES = \
     igc3dpolyhedron.cpp \
     igc3dview.cpp \
     igc3dviewstate.cpp \
+    igcparser.cpp \
     isohypse.cpp \
-    isolist.cpp \
     kflogconfig.cpp \
     kflogtreewidget.cpp \
     lineelement.cpp \
@@ -108,7 +115,11 @@ SOURCES = \
     mapconfig.cpp \
     mapcontents.cpp \
     mapcontrolview.cpp \
+    mapelementindex.cpp \
+    maphitindex.cpp \
     mapmatrix.cpp \
+    maptilecache.cpp \
+    maptileloader.cpp \
     MessageHelpBox.cpp \
     objecttree.cpp \
     OpenAip.cpp \
@@ -116,6 +127,7 @@ SOURCES = \
     openairparser.cpp \
     optimization.cpp \
     optimizationwizard.cpp \
+    poicache.cpp \
     projectionbase.cpp \
     projectioncylindric.cpp \
     projectionlambert.cpp \
@@ -123,6 +135,7 @@ SOURCES = \
     recorderdialog.cpp \
     rowdelegate.cpp \
     runway.cpp \
+    scoringengine.cpp \
     singlepoint.cpp \
     Speed.cpp \
     taskdataprint.cpp \
@@ -143,6 +156,7 @@ HEADERS = \
     airfield.h \
     AirfieldSelectionList.h \
     airspace.h \
+    airspacecache.h \
     AirspaceHelper.h \
     airspacelistviewitem.h \
     airspacewarningdistance.h \
@@ -158,19 +172,25 @@ HEADERS = \
     distance.h \
     downloadmanager.h \
     elevationfinder.h \
+    elevationgrid.h \
     evaluationdialog.h \
     evaluationframe.h \
     evaluationview.h \
     flight.h \
     flightdataprint.h \
+    flightdownloadqueue.h \
     flightgroup.h \
     flightgrouplistviewitem.h \
+    flightimporter.h \
     flightlistviewitem.h \
     flightloader.h \
     flightpoint.h \
     flightrecorderpluginbase.h \
     flightselectiondialog.h \
     flighttask.h \
+    flighttrack.h \
+    flighttracklod.h \
+    flighttrackstats.h \
     frstructs.h \
     gliders.h \
     helpwindow.h \
@@ -180,7 +200,7 @@ HEADERS = \
     igc3dpolyhedron.h \
     igc3dview.h \
     igc3dviewstate.h \
-    isolist.h \
+    igcparser.h \
     isohypse.h \
     kflogconfig.h \
     kflogtreewidget.h \
@@ -191,8 +211,12 @@ HEADERS = \
     mapconfig.h \
     mapcontents.h \
     mapcontrolview.h \
+    mapelementindex.h \
+    maphitindex.h \
     mapdefaults.h \
     mapmatrix.h \
+    maptilecache.h \
+    maptileloader.h \
     MessageHelpBox.h \
     MetaTypes.h \
     objecttree.h \
@@ -201,6 +225,7 @@ HEADERS = \
     openairparser.h \
     optimization.h \
     optimizationwizard.h \
+    poicache.h \
     projectionbase.h \
     projectioncylindric.h \
     projectionlambert.h \
@@ -211,6 +236,7 @@ HEADERS = \
     Speed.h \
     resource.h \
     runway.h \
+    scoringengine.h \
     taskdataprint.h \
     TaskEditor.h \
     tasklistviewitem.h \
@@ -245,6 +271,16 @@ INSTALLS += landscape points airspaces translations
 
 !win32 {
 DESTDIR = ../release/bin
+
+# Serial line access of the flight recorder plugins
+HEADERS += serialtransport.h
+SOURCES += serialtransport.cpp
+
+# Flight recorder simulator and download benchmark
+HEADERS += recorderbenchmark.h \
+    recordersimulator.h
+SOURCES += recorderbenchmark.cpp \
+    recordersimulator.cpp
 }
 
 OTHER_FILES += \
@@ -282,6 +282,7 @@ void KFLogConfig::slotOk()
   _settings.setValue( "/Homesite/Latitude", homeLatE->KFLogDegree() );
   _settings.setValue( "/Homesite/Longitude", homeLonE->KFLogDegree() );
   _settings.setValue( "/MapData/ProjectionType", projectionSelect->currentIndex() );
+  _settings.setValue( "/MapData/TileMemoryLimit", tileMemoryLimit->value() );
 
   _settings.setValue( "/Points/Source", pointsSourceBox->currentIndex() );
   _settings.setValue( "/Points/Countries", pointsOpenAipCountries->text().trimmed().toLower() );
@@ -932,6 +933,31 @@ void KFLogConfig::__addMapTab()
 
   elementGroupBox->setLayout( vbox );
 
+  //----------------------------------------------------------------------------
+  QGroupBox* memoryGroupBox = new QGroupBox( tr("Map Tile Memory") );
+
+  tileMemoryLimit = new QSpinBox;
+  tileMemoryLimit->setRange( 0, 16384 );
+  tileMemoryLimit->setSingleStep( 64 );
+  tileMemoryLimit->setButtonSymbols( QSpinBox::PlusMinus );
+  tileMemoryLimit->setSuffix( " MB" );
+  tileMemoryLimit->setSpecialValueText( tr("Unlimited") );
+  tileMemoryLimit->setToolTip( tr("If the loaded map tiles need more memory, "
+                                  "the longest not visible tiles are removed.") );
+  tileMemoryLimit->setValue( _settings.value( "/MapData/TileMemoryLimit", 256 ).toInt() );
+
+  tileMemoryUsage = new QLabel( tr("Loaded map tiles use %1 MB.")
+                                .arg( _globalMapContents->getTileMemoryUsage() / (1024 * 1024) ) );
+
+  QGridLayout* memoryLayout = new QGridLayout;
+  memoryLayout->setMargin( 10 );
+  memoryLayout->addWidget( new QLabel( tr("Memory limit:") ), 0, 0 );
+  memoryLayout->addWidget( tileMemoryLimit, 0, 1 );
+  memoryLayout->addWidget( tileMemoryUsage, 1, 0, 1, 3 );
+  memoryLayout->setColumnStretch( 2, 10 );
+
+  memoryGroupBox->setLayout( memoryLayout );
+
   QPushButton* defaultElements = new QPushButton( tr("Defaults") );
   defaultElements->setToolTip( tr("All map elements are set to their default values.") );
   defaultElements->setMaximumWidth(defaultElements->sizeHint().width() + 10);
@@ -939,6 +965,7 @@ void KFLogConfig::__addMapTab()
 
   QVBoxLayout* vboxAll = new QVBoxLayout();
   vboxAll->addWidget( elementGroupBox );
+  vboxAll->addWidget( memoryGroupBox );
   vboxAll->addStretch( 10 );
   vboxAll->addWidget( defaultElements, Qt::AlignLeft );
 
@@ -478,6 +478,9 @@ class KFLogConfig : public QDialog
   QLineEdit* dateOfBirthE;
   QComboBox* languageBox;
 
+  QSpinBox* tileMemoryLimit;
+  QLabel*   tileMemoryUsage;
+
   QSpinBox* altitudePenWidth;
   QSpinBox* cyclingPenWidth;
   QSpinBox* speedPenWidth;
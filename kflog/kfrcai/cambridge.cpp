@@ -193,6 +193,8 @@ int Cambridge::openRecorder(const QString& pName, int baud)
   portID = open(portName, O_RDWR | O_NOCTTY);
 
   if(portID != -1) {
+    _transport.attach(portID);
+
     //
     // Before we change any port-settings, we must establish a
     // signal-handler, which is used to restore the port-settings
@@ -304,6 +306,7 @@ int Cambridge::openRecorder(const QString& pName, int baud)
     // Activating the port-settings
     qDebug("activating port setting ...");
     tcsetattr(portID, TCSANOW, &newTermEnv);
+    _transport.setBaudRate(baud);
     qDebug("Done.");
     wait_ms(50);
 
@@ -341,6 +344,7 @@ int Cambridge::closeRecorder()
       sendCommand("pnp");
     }
 
+    _transport.detach();
     tcsetattr(portID, TCSANOW, &oldTermEnv);
     close(portID);
     portID = -1;
@@ -864,7 +868,10 @@ QString Cambridge::lon2cai(int lon)
 int Cambridge::wb(unsigned char c)
 {
   // qDebug ("wb (%x)", c);
-  if (write(portID, &c, 1) != 1) {
+  // The logger expects delays between some bytes, so every byte is sent
+  // immediately.
+  _transport.writeByte(c);
+  if (!_transport.flush()) {
     return -1;
   }
   return 1;
@@ -877,17 +884,8 @@ void Cambridge::wait_ms(const int t)
 
 unsigned char *Cambridge::readData(unsigned char *bufP, int count)
 {
-  int rc;
-  switch (rc = read(portID, bufP, count)) {
-  case -1:
-    qWarning("readData(): ERROR");
-    break;
-  default:
-    // qDebug ("readData: %x(%x)", rc, count);
-    bufP += rc;
-    break;
-  }
-  return bufP;
+  // Returns, what arrives within 0.1 s like a read with VTIME = 1.
+  return bufP + _transport.read(bufP, count, 100);
 }
 
 int Cambridge::calcChecksum8(unsigned char *buf, int count)
@@ -910,12 +908,12 @@ int Cambridge::calcChecksum16(unsigned char *buf, int count)
 
 int Cambridge::sendCommand(QString cmd)
 {
-  // flush the buffer and send the command
-  tcflush(portID, TCIOFLUSH);
-  ssize_t ret = write(portID, cmd.toLatin1().data(), cmd.length());
-  wb('\r');
+  // flush the buffer and send the command with a single write
+  _transport.discard();
+  _transport.write(cmd.toLatin1().data(), cmd.length());
+  _transport.writeByte('\r');
 
-  if( ret == -1 )
+  if( ! _transport.flush() )
     {
       return FR_ERROR;
     }
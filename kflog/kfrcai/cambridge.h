@@ -26,6 +26,7 @@
 #include "../frstructs.h"
 #include "../flighttask.h"
 #include "../flightrecorderpluginbase.h"
+#include "../serialtransport.h"
 
 class Cambridge : public FlightRecorderPluginBase
 {
@@ -139,6 +140,11 @@ private:
    */
   QString lat2cai(int lat);
   QString lon2cai(int lon);
+
+  /*
+   * buffered access to the serial port
+   */
+  SerialTransport _transport;
 };
 
 #endif
@@ -110,6 +110,8 @@ unsigned char STX = 0x02, /* Command prefix like AT for modems        */
 
 #define BUFSIZE 1024          /* General buffer size                  */
 
+#define READ_TIMEOUT 2000     /* Response time of the device in ms    */
+
   // @AP: Set a manufacture key that also Posigraph SDI logger files can be
   // converted in the right manner. They use the keyword SDI.
   //
@@ -156,6 +158,26 @@ void debugHex (const void* buf, unsigned int size)
     }
 }
 
+/**
+ * Returns the line speed in bits per second.
+ */
+static int speedToBaud( speed_t speed )
+{
+  switch( speed )
+    {
+      case B2400:
+        return 2400;
+      case B4800:
+        return 4800;
+      case B9600:
+        return 9600;
+      case B19200:
+        return 19200;
+      default:
+        return 38400;
+    }
+}
+
 /**
  * Needed to reset the serial port in any case of unexpected exiting
  * of the program. Called via signal-handler of the runtime-environment.
@@ -216,18 +238,26 @@ Filser::~Filser()
   */
 void Filser::slotTimeout()
 {
-  tcflush(portID, TCIOFLUSH); // Make sure the next ACK comes from the
-                              // following wb(SYN). And remove the
-                              // position data, that might have been
-                              // arrived.
+  if( ! _lineMutex.tryLock() )
+    {
+      // A flight is read by the download thread.
+      return;
+    }
+
+  _transport.discard(); // Make sure the next ACK comes from the
+                        // following wb(SYN). And remove the
+                        // position data, that might have been
+                        // arrived.
   wb( SYN );
-  tcdrain( portID );
+  _transport.drain();
   int ret = rb();
 
   if( ret != ACK )
     {
       qDebug( "Filser::keepalive failed: ret = %x", ret );
     }
+
+  _lineMutex.unlock();
 }
 
 /**
@@ -262,16 +292,13 @@ int Filser::getFlightDir( QList<FRDirEntry *>* dirList )
 
   _keepalive->blockSignals(true);
 
-  tcflush(portID, TCIOFLUSH);
+  _transport.discard();
 
   wb(STX);
   wb(M);
 
   while (indexByte) {
-    bufP = buf;
-    while ((FLIGHT_INDEX_WIDTH + buf - bufP) > 0) {
-      bufP = readData(bufP, (FLIGHT_INDEX_WIDTH + buf - bufP));
-    }
+    bufP = buf + readBlock(buf, FLIGHT_INDEX_WIDTH);
 
     indexByte = buf[0];
 
@@ -439,7 +466,7 @@ int Filser::getBasicData(FR_BasicData& data)
   _errorinfo = "";
   int lc = 0 ;
 
-  tcflush(portID, TCIOFLUSH);
+  _transport.discard();
 
   wb(STX);
   wb(REQ_BASIC_DATA);
@@ -525,7 +552,7 @@ int Filser::getBasicData(FR_BasicData& data)
     return FR_ERROR;
   }
 
-  tcflush(portID, TCIOFLUSH);
+  _transport.discard();
 
   wb(STX);
   wb(REQ_FLIGHT_DATA);
@@ -538,14 +565,14 @@ int Filser::getBasicData(FR_BasicData& data)
   // class descriptor you can get 9 bytes more with another function
   // ('I' | 0x80).
   //
-  bufP = buf;
-  while ((BASIC_LENGTH + buf - bufP + 1 ) > 0) {
-    bufP = readData(bufP, (BASIC_LENGTH + buf - bufP +1 ));
-  }
-  // uncomment this if you want to analyze the buffer
+  // uncomment the debugHex call if you want to analyze the buffer
   // debugHex (buf, BASIC_LENGTH);
-
-  if (calcCrcBuf(buf, BASIC_LENGTH) != buf[BASIC_LENGTH])
+  if (readBlock(buf, BASIC_LENGTH + 1) != BASIC_LENGTH + 1)
+  {
+    _errorinfo = tr("getBasicData(): Timeout while reading from LX-device");
+    rc = FR_ERROR;
+  }
+  else if (calcCrcBuf(buf, BASIC_LENGTH) != buf[BASIC_LENGTH])
   {
     _errorinfo = tr("getBasicData(): Bad CRC");
     rc = FR_ERROR;
@@ -582,7 +609,21 @@ int Filser::writeConfigData(FR_BasicData& /*basicdata*/, FR_ConfigData& /*config
   return FR_NOTSUPPORTED;
 }
 
-int Filser::downloadFlight(int flightID, int /*secMode*/, const QString& fileName)
+int Filser::downloadFlight(int flightID, int secMode, const QString& fileName)
+{
+  QByteArray data;
+
+  int rc = readFlightData( flightID, secMode, data );
+
+  if( rc == FR_OK )
+    {
+      rc = convertFlightData( data, fileName, _errorinfo );
+    }
+
+  return rc;
+}
+
+int Filser::readFlightData(int flightID, int /*secMode*/, QByteArray& data)
 {
   int rc;
   unsigned char memSection[0x21];/* Information received from the   */
@@ -591,7 +632,8 @@ int Filser::downloadFlight(int flightID, int /*secMode*/, const QString& fileNam
                                  /* for download. The table is      */
                                  /* 0x20 bytes long. Two bytes for  */
                                  /* a block. Plus one byte for CRC. */
-  FILE *f;
+
+  QMutexLocker locker( &_lineMutex );
 
   _errorinfo = "";
 
@@ -605,32 +647,47 @@ int Filser::downloadFlight(int flightID, int /*secMode*/, const QString& fileNam
     }
   else
     {
-      if( (f = fopen( fileName.toLatin1().data(), "w" )) != 0 )
-        {
-          if( convFil2Igc( f, memContents, memContents + contentSize ) )
-            {
-              rc = FR_OK;
-            }
-          else
-            {
-              _errorinfo += tr( "\nCheck igc file for further info." );
-              rc = FR_ERROR;
-            }
+      data = QByteArray( (const char *) memContents, contentSize );
+      rc = FR_OK;
+    }
+
+  if( memContents )
+    {
+      delete[] memContents;
+      memContents = 0;
+      contentSize = 0;
+    }
+
+  return rc;
+}
 
-          fclose( f );
+int Filser::convertFlightData(const QByteArray& data, const QString& fileName, QString& errorInfo)
+{
+  int rc;
+  FILE *f;
+
+  // The converter works on a private copy, the input is not modified.
+  QByteArray fil( data );
+  unsigned char *fil_p = (unsigned char *) fil.data();
+
+  if( (f = fopen( fileName.toLatin1().data(), "w" )) != 0 )
+    {
+      if( convFil2Igc( f, fil_p, fil_p + fil.size(), errorInfo ) )
+        {
+          rc = FR_OK;
         }
       else
         {
-          _errorinfo = tr( "\nCannot open temporary file: " ) + fileName;
+          errorInfo += tr( "\nCheck igc file for further info." );
           rc = FR_ERROR;
         }
-    }
 
-  if( memContents )
+      fclose( f );
+    }
+  else
     {
-      delete memContents;
-      memContents = 0;
-      contentSize = 0;
+      errorInfo = tr( "\nCannot open temporary file: " ) + fileName;
+      rc = FR_ERROR;
     }
 
   return rc;
@@ -643,6 +700,8 @@ int Filser::openRecorder(const QString& pName, int baud)
   portID = open(portName, O_RDWR | O_NOCTTY);
 
   if(portID != -1) {
+    _transport.attach(portID);
+
     //
     // Before we change any port-settings, we must establish a
     // signal-handler, which is used to restore the port-settings
@@ -704,9 +763,10 @@ int Filser::openRecorder(const QString& pName, int baud)
     cfsetispeed(&newTermEnv, _speed);
 
     // flush the device
-    tcflush (portID, TCIOFLUSH);
+    _transport.discard();
     // Activating the port-settings
     tcsetattr(portID, TCSANOW, &newTermEnv);
+    _transport.setBaudRate(speedToBaud(_speed));
 
     _isConnected = true;
     _da4BufferValid = false;
@@ -756,14 +816,14 @@ bool Filser::defMem(struct flightTable *ft)
   memcpy(address_buf + 3, &flight_end_adr, 3);
   address_buf[6] = calcCrcBuf(address_buf, 6);
 
-  tcflush(portID, TCIOFLUSH);
+  _transport.discard();
 
   wb(STX);
   wb(N);
   for(unsigned int i = 0; i < sizeof(address_buf); i++) {
     wb(address_buf[i]);
   }
-  tcdrain (portID);
+  _transport.drain();
   if (rb() != ACK) {
     _errorinfo = tr("Invalid response from LX-device.");
     return false;
@@ -773,15 +833,14 @@ bool Filser::defMem(struct flightTable *ft)
 
 bool Filser::getMemSection(unsigned char *memSection, int size)
 {
-  int i;
-
-  tcflush(portID, TCIOFLUSH);
+  _transport.discard();
 
   wb(STX);
   wb(L);
-  tcdrain (portID);
-  for(i = 0; i < size; i++) {
-    memSection[i] = rb();
+
+  if(readBlock(memSection, size) != size) {
+    _errorinfo = tr("get_mem_sections(): Timeout");
+    return false;
   }
 
   if(calcCrcBuf(memSection, size-1) != memSection[size-1]) {
@@ -793,7 +852,7 @@ bool Filser::getMemSection(unsigned char *memSection, int size)
 
 bool Filser::getLoggerData(unsigned char *memSection, int sectionSize)
 {
-  unsigned char *bufP, *bufP2;
+  unsigned char *bufP2;
   /*
    * Calculate the size the of the memory buffer
    */
@@ -816,7 +875,9 @@ bool Filser::getLoggerData(unsigned char *memSection, int sectionSize)
    */
 
   memContents = new unsigned char [(contentSize) + 1]; // for CRC
-  bufP = bufP2 = memContents;
+  bufP2 = memContents;
+
+  _transport.resetStatistics();
 
   // read each memory section
   for(int i = 0; i < ((sectionSize - 1) / 2); i++) {
@@ -825,23 +886,30 @@ bool Filser::getLoggerData(unsigned char *memSection, int sectionSize)
     }
     int count = ((unsigned char)memSection[2 * i] << 8) + (unsigned char)memSection[(2 * i) + 1];
 
-    tcflush(portID, TCIOFLUSH);
+    _transport.discard();
     wb(STX);
     wb(f + i);
-    while ((bufP - bufP2) < (count + 1)) {
-      bufP = readData(bufP, (bufP2 + count + 1 - bufP));
+
+    if (readBlock(bufP2, count + 1) != count + 1) {
+      _errorinfo = tr("get_logger_data(): Timeout");
+      delete[] memContents;
+      memContents = 0;
+      contentSize = 0;
+      return false;
     }
     if (calcCrcBuf(bufP2, count) != bufP2[count]) {
       _errorinfo = tr("get_logger_data(): Bad CRC");
-      delete memContents;
+      delete[] memContents;
       memContents = 0;
       contentSize = 0;
       return false;
     }
     bufP2 += count;
-    bufP = bufP2;
   }
 
+  qDebug("get_logger_data(): %d bytes, %.0f bytes/s",
+         contentSize, _transport.transferRate());
+
   return true;
 }
 
@@ -853,7 +921,7 @@ bool Filser::getLoggerData(unsigned char *memSection, int sectionSize)
  *
  * The resulting .igc-file is written to the open FILE pointer *figc.
  */
-bool Filser::convFil2Igc(FILE *figc,  unsigned char *fil_p, unsigned char *fil_p_last)
+bool Filser::convFil2Igc(FILE *figc,  unsigned char *fil_p, unsigned char *fil_p_last, QString& errorInfo)
 {
   int i, j, l, ftab[16], etab[16], time = 0, time_orig = 0, fix_lat, fix_lat_orig = 0, fix_lon, fix_lon_orig = 0, tp;
   unsigned char flight_no = 0, *fil_p_ev = 0;
@@ -1026,7 +1094,7 @@ bool Filser::convFil2Igc(FILE *figc,  unsigned char *fil_p, unsigned char *fil_p
         i++;
         fil_p++;
         if(fil_p > fil_p_last) {
-          _errorinfo = tr("unexpected end of '.fil'-file");
+          errorInfo = tr("unexpected end of '.fil'-file");
           return false;
         }
       }
@@ -1478,7 +1546,7 @@ bool Filser::convFil2Igc(FILE *figc,  unsigned char *fil_p, unsigned char *fil_p
     default:        /* ???? */
       fprintf(figc, "L%sUNKNOWN%#x\r\n", manufactureKey, fil_p[0]);
       fil_p++;
-      _errorinfo = tr("unexpected record id in '.fil'-file");
+      errorInfo = tr("unexpected record id in '.fil'-file");
       return false;
       break;
     }
@@ -1529,38 +1597,22 @@ unsigned char Filser::calcCrcBuf(const void *buf, unsigned int count)
  */
 unsigned char *Filser::readData(unsigned char *bufP, int count)
 {
-  int rc;
-  switch (rc = read(portID, bufP, count)) {
-  case -1:
-    qWarning("read_data(): ERROR");
-    break;
-  default:
-    // qDebug ("readData: %x(%x)", rc, count);
-    bufP += rc;
-    break;
-  }
-  return bufP;
+  // Returns, what arrives within 0.1 s like a read with VTIME = 1.
+  return bufP + _transport.read(bufP, count, 100);
 }
 
-unsigned char *Filser::writeData(unsigned char *bufP, int count)
+/*
+ * Reads a data block of a known size. The deadline covers the response
+ * time of the device and the transfer time at the current line speed.
+ */
+int Filser::readBlock(unsigned char *bufP, int count)
 {
-  int rc;
-  switch (rc = write(portID, bufP, count))
-  {
-  case -1:
-    qWarning("write_data(): ERROR");
-    break;
-  default:
-    // qDebug ("writeData: %x(%x)", rc, count);
-    bufP += rc;
-    break;
-  }
-  return bufP;
+  return _transport.read(bufP, count,
+                         READ_TIMEOUT + _transport.transferTime(count));
 }
 
 bool Filser::readMemSetting()
 {
-  unsigned char *bufP;
   unsigned char buf[BUFSIZE + 1];
 
   memset(buf, '\0', sizeof(buf));
@@ -1569,14 +1621,15 @@ bool Filser::readMemSetting()
     return false;
   }
 
-  tcflush(portID, TCIOFLUSH);
+  _transport.discard();
 
   wb(STX);
   wb(Q);
 
-  bufP = buf;
-  while ((LX_MEM_RET + buf - bufP) > 0) {
-    bufP = readData(bufP, LX_MEM_RET + buf - bufP);
+  if (readBlock(buf, LX_MEM_RET) != LX_MEM_RET)
+  {
+    qDebug("read_mem_setting(): Timeout");
+    return false;
   }
   // uncomment the next statement to analyze the buffer
   // debugHex (buf, LX_MEM_RET);
@@ -1628,18 +1681,18 @@ bool Filser::AutoBaud()
 
   t1 = time(0);
   while (!breakTransfer) {
-    tcflush(portID, TCIOFLUSH); // Make sure the next ACK comes from the
-                                // following wb(SYN). And remove the
-                                // position data, that might have been
-                                // arrived.
+    _transport.discard(); // Make sure the next ACK comes from the
+                          // following wb(SYN). And remove the
+                          // position data, that might have been
+                          // arrived.
     wb(SYN);
-    tcdrain (portID);
+    _transport.drain();
 
     while(0xff != rb())       // 12.03.2005 Fughe: Make the stream really
       lc++;                   //                   empty!
     qWarning ("while _AB: %d", lc);
     wb(SYN);
-    tcdrain (portID);
+    _transport.drain();
 
     int ret = rb();
     if (ret == ACK) {
@@ -1703,6 +1756,7 @@ bool Filser::AutoBaud()
     }
 
     tcsetattr(portID, TCSANOW, &newTermEnv);
+    _transport.setBaudRate(speedToBaud(_speed));
 
   }
   return rc;
@@ -1733,18 +1787,18 @@ bool Filser::check4Device()
 
   t1 = time(0);
   while (!breakTransfer) {
-    tcflush(portID, TCIOFLUSH); // Make sure the next ACK comes from the
-                                // following wb(SYN). And remove the
-                                // position data, that might have been
-                                // arrived.
+    _transport.discard(); // Make sure the next ACK comes from the
+                          // following wb(SYN). And remove the
+                          // position data, that might have been
+                          // arrived.
     wb(SYN);
-    tcdrain (portID);
+    _transport.drain();
 
     while(0xff != rb())         // 12.03.2005 Fughe: Make the stream really
       lc++;                     //                   empty!
     qWarning ("while c4d: %d", lc);
     wb(SYN);
-    tcdrain (portID);
+    _transport.drain();
 
     int ret = rb();
     if (ret == ACK) {
@@ -1819,10 +1873,8 @@ bool Filser::check4Device()
 int Filser::wb(unsigned char c)
 {
   // qDebug ("wb (%x)", c);
-  if( write( portID, &c, 1 ) != 1 )
-    {
-      return -1;
-    }
+  // The byte is sent with the next drain or read.
+  _transport.writeByte( c );
   return 1;
 }
 
@@ -1834,14 +1886,14 @@ int Filser::wb(unsigned char c)
 // On desktop, it is signed !!!
 unsigned char Filser::rb()
 {
-  unsigned char buf;
+  int c = _transport.readByte( 100 );
 
-  if( read( portID, &buf, 1 ) != 1 )
+  if( c == -1 )
     {
       return 0xff;
     }
 
-  return buf;
+  return c;
 }
 
 char *Filser::wordtoserno(unsigned int Binaer)
@@ -1865,6 +1917,7 @@ int Filser::closeRecorder()
   if( portID != -1 )
     {
       _keepalive->stop();
+      _transport.detach();
       tcsetattr( portID, TCSANOW, &oldTermEnv );
       close( portID );
       portID = -1;
@@ -2065,17 +2118,18 @@ int Filser::readDA4Buffer()
 
   _errorinfo = "";
 
-  tcflush( portID, TCIOFLUSH );
+  _transport.discard();
 
   wb( STX );
   wb( R );
 
-  unsigned char* bufP = (unsigned char*) &_da4Buffer;
-
-  while ((bufP - (unsigned char*)&_da4Buffer) < (int)sizeof (DA4Buffer))
-  {
-    bufP = readData(bufP, (sizeof (DA4Buffer) + (unsigned char*)&_da4Buffer - bufP));
-  }
+  if( readBlock( (unsigned char*) &_da4Buffer, sizeof(DA4Buffer) ) !=
+      (int) sizeof(DA4Buffer) )
+    {
+      _errorinfo = tr( "Filser::readWaypoints(): Timeout" );
+      qDebug( "%s", _errorinfo.toLatin1().data() );
+      return FR_ERROR;
+    }
 
   if( rb() != calcCrcBuf( &_da4Buffer, sizeof(DA4Buffer) ) )
     {
@@ -2147,24 +2201,19 @@ int Filser::writeDA4Buffer()
 
   _errorinfo = "";
 
-  tcflush(portID, TCIOFLUSH);
+  _transport.discard();
 
   wb(STX);
   wb(W);
 
   // transfer data to logger
-  unsigned char *bufP = (unsigned char*)&_da4Buffer;
-
-  while ((bufP - (unsigned char*)&_da4Buffer) < (int)sizeof (DA4Buffer))
-  {
-    bufP = writeData(bufP, (sizeof (DA4Buffer) + (unsigned char*)&_da4Buffer - bufP));
-  }
+  _transport.write(&_da4Buffer, sizeof (DA4Buffer));
 
   unsigned char crc = calcCrcBuf (&_da4Buffer, sizeof (DA4Buffer));
   wb (crc);
 
   // wait until all output has been written
-  tcdrain(portID);
+  _transport.drain();
   int result = rb();
 
   if( result == ACK )
@@ -25,12 +25,14 @@
 #include <QObject>
 #include <QTimer>
 #include <QList>
+#include <QMutex>
 
 #include "../waypoint.h"
 #include "../frstructs.h"
 #include "../flighttask.h"
 #include "../flightrecorderpluginbase.h"
 #include "../da4record.h"
+#include "../serialtransport.h"
 
 /**
   *@author Christian Fughe, Harald Maier
@@ -78,6 +80,14 @@ public:
    *
    */
   virtual int downloadFlight(int flightID, int secMode, const QString& fileName);
+  /**
+   * Reads the .fil memory of a flight.
+   */
+  virtual int readFlightData(int flightID, int secMode, QByteArray& data);
+  /**
+   * Converts the .fil memory of a flight into an IGC file.
+   */
+  virtual int convertFlightData(const QByteArray& data, const QString& fileName, QString& errorInfo);
   /**
     * get basic flight recorder data
     */
@@ -166,9 +176,9 @@ private:
   bool defMem(struct flightTable *ft);
   bool getMemSection(unsigned char *memSection, int size);
   bool getLoggerData(unsigned char *memSection, int sectionSize);
-  bool convFil2Igc(FILE *figc,  unsigned char *fil_p, unsigned char *fil_p_last);
+  static bool convFil2Igc(FILE *figc,  unsigned char *fil_p, unsigned char *fil_p_last, QString& errorInfo);
   unsigned char *readData(unsigned char *buf_p, int count);
-  unsigned char *writeData(unsigned char *buf_p, int count);
+  int readBlock(unsigned char *buf_p, int count);
 
   QList <flightTable *> flightIndex;
 
@@ -180,7 +190,11 @@ private:
   int writeDA4Buffer();
   int findWaypoint (Waypoint* wp);
   QTimer* _keepalive;
+  // Held while a flight is read from a download thread. The keep alive
+  // must not talk to the device in between.
+  QMutex _lineMutex;
   speed_t _speed;
+  SerialTransport _transport;
 };
 
 #endif
@@ -35,7 +35,6 @@ extern int noninteractive;
 
 // sizes of VL memory regions
 const int VLAPI_DBB_MEMSIZE = 16384;
-const int32 VLAPI_LOG_MEMSIZE = 81920L;
 
 // ------------------------------------------------------------ 
 //                        VLA_XFR
@@ -808,6 +807,40 @@ VLA_ERROR VLAPI::read_igcfile(char *filename, int index, int secmode) {
   return err;
 }
 
+VLA_ERROR VLAPI::read_flight(lpb buffer, int index, int secmode) {
+  VLA_ERROR err = stillconnect();
+  if(err != VLA_ERR_NOERR)
+    return err;
+
+  if (flightget(buffer, VLAPI_LOG_MEMSIZE, index, secmode)>0)
+    return VLA_ERR_NOERR;
+
+  return VLA_ERR_MISC;
+}
+
+VLA_ERROR VLAPI::write_igcfile(char *filename, lpb buffer) {
+  FILE *outfile = fopen(filename,"wt");
+  if(!outfile)
+    return VLA_ERR_FILE;
+
+  VLA_ERROR err;
+  word serno; long sp;
+  long r = convert_gcs(0,outfile,buffer,1,&serno,&sp);
+  if(r>0) {
+    err = VLA_ERR_NOERR;
+    print_g_record(
+                   outfile,   // output to file
+                   buffer,    // binary file is in buffer
+                   r          // length of binary file to include
+                   );
+  }
+  else
+    err = VLA_ERR_MISC;
+
+  fclose(outfile);
+  return err;
+}
+
 
 // getting a waypoint object out of the database memory
 //
@@ -24,6 +24,9 @@
 #include "dbbconv.h"
 #include "vlconv.h"
 
+// size of the VL flight log memory
+const int32 VLAPI_LOG_MEMSIZE = 81920L;
+
 class VLAPI_DATA {
  public:
   // forward declarations for friend statements
@@ -189,6 +192,16 @@ class VLAPI : protected VLA_XFR, public VLAPI_DATA {
   // DSA is mandatory for DMST and FAI flight validation
   VLA_ERROR read_igcfile(char *filename,int index, int secure); 
 
+  // read the binary flight log number index into buffer, which must
+  // have a size of VLAPI_LOG_MEMSIZE. Together with write_igcfile it does
+  // the same as read_igcfile.
+  VLA_ERROR read_flight(lpb buffer, int index, int secure);
+
+  // convert a binary flight log read by read_flight into igcfile named
+  // "filename". The logger is not accessed, so that the conversion can
+  // run in parallel to the next read_flight.
+  static VLA_ERROR write_igcfile(char *filename, lpb buffer);
+
   // read database and flight declaration form from Volkslogger into the 
   // predefined structs DECLARATION and DATABASE (see above)
   VLA_ERROR read_db_and_declaration(); 
@@ -30,10 +30,17 @@
 #include <ctime>
 #include <unistd.h>
 
+#include "../serialtransport.h"
+
 using namespace std; 
 
 int noninteractive;
 
+/**
+ * Buffered access to the serial port of the VL.
+ */
+static SerialTransport transport;
+
 /**
  * Needed to reset the serial port in any case of unexpected exiting
  * of the programm. Called via signal-handler of the runtime-environment.
@@ -79,6 +86,8 @@ VLA_ERROR VLA_SYS::serial_open_port()
     return VLA_ERR_COMM;
   }
 
+  transport.attach(portID);
+
   //
   // Before we change any port-settings, we must establish a
   // signal-handler, which is used to restore the port-settings
@@ -177,6 +186,7 @@ VLA_ERROR VLA_SYS::serial_close_port()
     return VLA_ERR_COMM;
   }
 
+  transport.detach();
   tcsetattr(portID, TCSANOW, &oldTermEnv);
 
   return VLA_ERR_NOERR;
@@ -192,9 +202,11 @@ VLA_ERROR VLA_SYS::serial_out(const byte outbyte)
       return VLA_ERR_COMM;
     }
 
-  int res = write(portID, &outbyte, sizeof(outbyte));
+  // The protocol paces the output with delays, so every byte is sent
+  // immediately.
+  transport.writeByte(outbyte);
 
-  if( res < -1 )
+  if( transport.flush() )
     {
       return VLA_ERR_NOERR;
     }
@@ -216,9 +228,10 @@ VLA_ERROR VLA_SYS::serial_in(byte *inbyte)
     return VLA_ERR_COMM;
   }
 
-  int res = read(portID, inbyte, sizeof(*inbyte));
+  // Wait 0.1 s for a character like a read with VTIME = 1.
+  int res = transport.readByte(100);
 
-  if(res == 0) {
+  if(res == -1) {
     //  	  *inbyte = 0x03;
     // Kein Zeichen empfangen!!!
     //		  cerr << "\n Nichts gelesen !!!\n\n";
@@ -229,6 +242,7 @@ VLA_ERROR VLA_SYS::serial_in(byte *inbyte)
     return VLA_ERR_NOCHAR;		
   }
 
+  *inbyte = res;
   return VLA_ERR_NOERR;
 }
 
@@ -241,9 +255,7 @@ VLA_ERROR VLA_SYS::serial_empty_io_buffers()
     return VLA_ERR_COMM;
   }
 	
-  if(tcflush(portID, TCIOFLUSH) == -1) {
-    cerr << "\nERROR: could not empty buffer!\n";
-  }
+  transport.discard();
 
   return VLA_ERR_NOERR;
 }
@@ -290,6 +302,7 @@ VLA_ERROR VLA_SYS::serial_set_baudrate(const int32 baudrate)
     cfsetispeed(&newTermEnv, speed);
     // Activating the port-settings
     tcsetattr(portID, TCSANOW, &newTermEnv);
+    transport.setBaudRate(baudrate);
   }
 
   return VLA_ERR_NOERR;
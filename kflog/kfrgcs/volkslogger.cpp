@@ -164,6 +164,33 @@ int Volkslogger::downloadFlight(int flightID, int secMode, const QString& fileNa
   return (vl.read_igcfile( fileName.toLatin1().data(), flightID, secMode) == VLA_ERR_NOERR ? FR_OK : FR_ERROR);
 }
 
+int Volkslogger::readFlightData(int flightID, int secMode, QByteArray& data)
+{
+  data.fill( 0, VLAPI_LOG_MEMSIZE );
+
+  if( vl.read_flight( (lpb) data.data(), flightID, secMode ) != VLA_ERR_NOERR )
+    {
+      _errorinfo = QObject::tr( "Cannot read the flight from the Volkslogger." );
+      return FR_ERROR;
+    }
+
+  return FR_OK;
+}
+
+int Volkslogger::convertFlightData(const QByteArray& data, const QString& fileName, QString& errorInfo)
+{
+  // The converter works on a private copy, the input is not modified.
+  QByteArray log( data );
+
+  if( VLAPI::write_igcfile( fileName.toLatin1().data(), (lpb) log.data() ) != VLA_ERR_NOERR )
+    {
+      errorInfo = QObject::tr( "Cannot convert the flight log into file: " ) + fileName;
+      return FR_ERROR;
+    }
+
+  return FR_OK;
+}
+
 
 /**
   * get recorder basic data
@@ -194,7 +221,11 @@ int Volkslogger::writeConfigData(FR_BasicData& /*basicdata*/, FR_ConfigData& /*c
 int Volkslogger::openRecorder(const QString& pName, int baud)
 {
   int err;
-  portName = pName.toLatin1().data();
+
+  // The port name must stay valid, while the port is in use.
+  static QByteArray port;
+  port = pName.toLatin1();
+  portName = port.data();
 
   if((err = vl.open(1, 5, 0, baud)) != VLA_ERR_NOERR) {
     qWarning() << QObject::tr("No logger found!");
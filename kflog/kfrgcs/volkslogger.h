@@ -52,6 +52,14 @@ class Volkslogger : public FlightRecorderPluginBase
    *
    */
   virtual int downloadFlight(int flightID, int secMode, const QString& fileName);
+  /**
+   * Reads the binary flight log of a flight.
+   */
+  virtual int readFlightData(int flightID, int secMode, QByteArray& data);
+  /**
+   * Converts the binary flight log of a flight into an IGC file.
+   */
+  virtual int convertFlightData(const QByteArray& data, const QString& fileName, QString& errorInfo);
   /**
    * get recorder basic data
    */
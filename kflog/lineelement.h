@@ -101,6 +101,14 @@ public:
       return glMapMatrix->isVisible(bBox);
     };
 
+  /**
+   * \return The bounding box of the projected line element.
+   */
+  virtual QRect getBoundingBox() const
+    {
+      return bBox;
+    };
+
   /**
    * \return The projected positions of the line element.
    */
@@ -44,10 +44,15 @@
     #include <QtGui>
 #endif
 
+#include "flightimporter.h"
 #include "kflogconfig.h"
 #include "mainwindow.h"
 #include "target.h"
 
+#ifndef _WIN32
+#include "recorderbenchmark.h"
+#endif
+
 /**
  * Pointer to the main window.
  */
@@ -112,6 +117,17 @@ int main(int argc, char **argv)
   qDebug() << "KFLog Built Date:" << __DATE__;
   qDebug() << "KFLog Install Root:" << rootPath;
 
+#ifndef _WIN32
+  // The recorder benchmark runs without the main window. All following
+  // arguments are passed to it.
+  int benchIdx = app.arguments().indexOf( "--recorder-benchmark" );
+
+  if( benchIdx > 0 )
+    {
+      return RecorderBenchmark::exec( app.arguments().mid( benchIdx + 1 ) );
+    }
+#endif
+
   if( _settings.value( "/GeneralOptions/Logo", true ).toBool() )
     {
       QSplashScreen splash( QPixmap( ":/pics/splash.png" ) );
@@ -133,8 +149,10 @@ int main(int argc, char **argv)
 
   QString argument, fileOpenIGC, fileExportPNG, width = "640", height = "480";
   QString waypointsOptionArg;
+  QStringList importFiles;
 
   bool batch = false, comment = true, exportPNG = false, fileOpen = false;
+  bool import = false;
 
   for( int i = 0; i < app.arguments().size(); i++ )
     {
@@ -172,6 +190,15 @@ int main(int argc, char **argv)
         {
           waypointsOptionArg = app.arguments().at(i++);
         }
+      else if( argument == "--import" || argument == "-i" )
+        {
+          // All following file arguments are imported in parallel.
+          import = true;
+        }
+      else if( i != 0 && import )
+        {
+          importFiles.append( QFileInfo( app.arguments().at(i) ).absoluteFilePath() );
+        }
       else if( i != 0 )
         {
           fileOpen = true;
@@ -188,6 +215,28 @@ int main(int argc, char **argv)
       _mainWindow->slotSetWaypointCatalog( waypointsOptionArg );
     }
 
+  if( importFiles.size() > 0 )
+    {
+      FlightImporter* importer = _mainWindow->getFlightImporter();
+
+      // Wait for the end of the import and report the result.
+      QEventLoop loop;
+      QObject::connect( importer, SIGNAL(finished(int, int)), &loop, SLOT(quit()) );
+
+      importer->importFiles( importFiles );
+
+      if( importer->isRunning() )
+        {
+          loop.exec();
+        }
+
+      if( batch && ! fileOpen )
+        {
+          qDebug() << "Exiting.";
+          return 0;
+        }
+    }
+
   if( fileOpen )
     {
       if( exportPNG )
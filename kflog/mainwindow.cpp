@@ -38,6 +38,7 @@
 #include "distance.h"
 #include "evaluationdialog.h"
 #include "flightdataprint.h"
+#include "flightimporter.h"
 #include "flightloader.h"
 #include "helpwindow.h"
 #include "igc3ddialog.h"
@@ -169,6 +170,20 @@ MainWindow::MainWindow( QWidget *parent, Qt::WindowFlags flags ) :
   connect( _globalMapConfig, SIGNAL(configChanged()),
            _globalMapMatrix, SLOT(slotInitMatrix()) );
 
+  connect( _globalMapConfig, SIGNAL(configChanged()),
+           _globalMapContents, SLOT(slotClearTerrainCache()) );
+
+  flightImporter = new FlightImporter( this );
+
+  connect( flightImporter, SIGNAL(progress(int, int)),
+           this, SLOT(slotImportProgress(int, int)) );
+
+  connect( flightImporter, SIGNAL(finished(int, int)),
+           this, SLOT(slotImportFinished(int, int)) );
+
+  connect( flightImporter, SIGNAL(flightImported(const QString&)),
+           this, SLOT(slotSetCurrentFile(const QString&)) );
+
   _globalMapConfig->slotReadConfig();
 
   toolBar = addToolBar( tr("Toolbar") );
@@ -807,6 +822,24 @@ void MainWindow::createMenuBar()
   flightAnimateEndAction->setEnabled(true);
   connect(flightAnimateEndAction, SIGNAL(triggered()), map, SLOT(slotFlightEnd()));
 
+  // flight animation speed actions, the data is the multiple of real time
+  flightAnimateSpeedGroupAction = new QActionGroup( this );
+
+  int animationSpeed = _settings.value( "/Flight/AnimationSpeed", 60 ).toInt();
+  int speeds[] = { 10, 30, 60, 120, 300 };
+
+  for( int i = 0; i < 5; i++ )
+    {
+      QAction* action = new QAction( tr("%1x Real Time").arg( speeds[i] ), this );
+      action->setCheckable( true );
+      action->setChecked( speeds[i] == animationSpeed );
+      action->setData( speeds[i] );
+      flightAnimateSpeedGroupAction->addAction( action );
+    }
+
+  connect( flightAnimateSpeedGroupAction, SIGNAL(triggered(QAction *)),
+           this, SLOT(slotFlightAnimationSpeedAction(QAction *)) );
+
   //----------------------------------------------------------------------------
   // Flight menu creation
   //----------------------------------------------------------------------------
@@ -830,6 +863,8 @@ void MainWindow::createMenuBar()
   flightMenu->addAction( flightAnimateStartAction );
   flightMenu->addAction( flightAnimatePauseAction );
   flightMenu->addAction( flightAnimateStopAction );
+  fasMenu = flightMenu->addMenu( tr("Animation Speed") );
+  fasMenu->addActions( flightAnimateSpeedGroupAction->actions() );
   flightMenu->addSeparator();
   flightMenu->addAction( flightAnimateHomeAction );
   flightMenu->addAction( flightAnimateNextAction );
@@ -1331,6 +1366,15 @@ void MainWindow::slotOpenFile()
           return;
         }
 
+      flightDir = fd->directory().canonicalPath();
+
+      if( fNames.size() > 1 )
+        {
+          // Many files are imported in parallel in the background.
+          slotImportFlights( fNames );
+          return;
+        }
+
       for (int i = 0; i < fNames.size(); i++)
       {
           QFile file( fNames[i] );
@@ -1349,6 +1393,37 @@ void MainWindow::slotOpenFile()
   slotSetStatusMsg( tr( "Ready." ) );
 }
 
+void MainWindow::slotImportFlights( const QStringList& files )
+{
+  slotSetStatusMsg( tr( "Importing flights..." ) );
+  flightImporter->importFiles( files );
+}
+
+void MainWindow::slotImportProgress( int done, int total )
+{
+  slotSetStatusMsg( tr( "Importing flights %1 of %2..." ).arg( done ).arg( total ) );
+
+  if( total > 0 )
+    {
+      slotSetProgress( done * 100 / total );
+    }
+}
+
+void MainWindow::slotImportFinished( int imported, int failed )
+{
+  slotSetProgress( 0 );
+
+  if( failed > 0 )
+    {
+      slotSetStatusMsg( tr( "%1 flights imported, %2 files failed." )
+                        .arg( imported ).arg( failed ) );
+    }
+  else
+    {
+      slotSetStatusMsg( tr( "%1 flights imported." ).arg( imported ) );
+    }
+}
+
 void MainWindow::slotOpenFile( const QUrl& url )
 {
   slotSetStatusMsg(tr("Opening file..."));
@@ -1613,6 +1688,14 @@ void MainWindow::slotFlightDataTypeGroupAction( QAction* action )
   map->slotRedrawFlight();
 }
 
+void MainWindow::slotFlightAnimationSpeedAction( QAction* action )
+{
+  int speed = action->data().toInt();
+
+  _settings.setValue( "/Flight/AnimationSpeed", speed );
+  map->slotSetAnimationSpeed( speed );
+}
+
 void MainWindow::selectFlightDataAction( const int index )
 {
   switch( index )
@@ -43,6 +43,7 @@
 
 class DataView;
 class EvaluationDialog;
+class FlightImporter;
 class FlightPoint;
 class HelpWindow;
 class Map;
@@ -116,6 +117,14 @@ public:
     return evaluationWindow;
   }
 
+  /**
+   * \return The importer used for batch imports of flight files.
+   */
+  FlightImporter* getFlightImporter()
+  {
+    return flightImporter;
+  }
+
 signals:
 
   /**
@@ -157,6 +166,18 @@ public slots:
    * Opens the file given in url.
    */
   void slotOpenFile(const QUrl& url);
+  /**
+   * Imports many flight files in parallel in the background.
+   */
+  void slotImportFlights(const QStringList& files);
+  /**
+   * Shows the progress of a flight import in the status bar.
+   */
+  void slotImportProgress(int done, int total);
+  /**
+   * Shows the result of a flight import in the status bar.
+   */
+  void slotImportFinished(int imported, int failed);
   /**
    * Opens a task-file-open-dialog.
    */
@@ -256,6 +277,11 @@ public slots:
    */
   void slotFlightDataTypeGroupAction( QAction *action );
 
+  /**
+   * Called, if an animation speed action is triggered.
+   */
+  void slotFlightAnimationSpeedAction( QAction *action );
+
   /**
    * Shows version and copyright.
    */
@@ -347,6 +373,9 @@ private:
 
   QToolBar* toolBar;
 
+  /** Imports many flight files in parallel. */
+  FlightImporter* flightImporter;
+
   /**
    * Actions for the menu File
    */
@@ -395,6 +424,9 @@ private:
   QAction* flightAnimateHomeAction;
   QAction* flightAnimateEndAction;
 
+  /** Playback speeds of the flight animation. */
+  QActionGroup* flightAnimateSpeedGroupAction;
+
   QActionGroup* flightDataTypeGroupAction;
   QAction *altitudeAction;
   QAction *cyclingAction;
@@ -413,6 +445,11 @@ private:
    */
   QMenu *fdtMenu;
 
+  /**
+   * Animation speed submenu.
+   */
+  QMenu *fasMenu;
+
   /**
    * Flights root menu.
    */
@@ -65,6 +65,8 @@ Map::Map( QWidget* parent ) :
   preStepIndex(-1),
   drawFlightStepCursor(false),
   animationPaused(false),
+  animationPlayTime(0),
+  animationSpeed(60),
   planning(0),
   tempTask(""),
   startDragZoom(false),
@@ -72,7 +74,8 @@ Map::Map( QWidget* parent ) :
   isMapMoveActive(false),
   isDrawing(false),
   redrawRequest(false),
-  preSnapPoint(-999, -999)
+  preSnapPoint(-999, -999),
+  m_waypointHitCount(-1)
 {
   pixCursor = QPixmap(40,40);
   pixCursor.fill(Qt::transparent);
@@ -141,6 +144,8 @@ Map::Map( QWidget* parent ) :
 
   __createPopupMenu();
 
+  animationSpeed = _settings.value( "/Flight/AnimationSpeed", 60 ).toInt();
+
   // create the animation timer
   timerAnimate = new QTimer( this );
   connect( timerAnimate, SIGNAL(timeout()), SLOT(slotAnimateFlightTimeout()) );
@@ -267,7 +272,6 @@ void Map::mouseMoveEvent( QMouseEvent* event )
 
       QList<Waypoint*> taskPointList = ft->getWPList();
       QList<Waypoint*> tempTaskPointList = ft->getWPList();
-      QList<Waypoint*> &wpList = _globalMapContents->getWaypointList();
 
       // 3: Task beendet verschieben eines Punktes
 
@@ -312,9 +316,21 @@ void Map::mouseMoveEvent( QMouseEvent* event )
           if(!isSnapping)
             {
               Waypoint wp;
+
+              // The task points and the map points are checked first.
               bool found = __getTaskWaypoint(current, &wp, taskPointList);
-              if (!found) // check wp catalog
-              found = __getTaskWaypoint(current, &wp, wpList);
+
+              if( ! found )
+                {
+                  // Check the waypoint catalog through its hit index.
+                  Waypoint* catalogWp = findWaypoint( current, 16 );
+
+                  if( catalogWp )
+                    {
+                      wp = *catalogWp;
+                      found = true;
+                    }
+                }
 
               if(found)
                 {
@@ -566,18 +582,29 @@ QString getInfoString (Waypoint* wp)
   return text;
 }
 
-Waypoint* Map::findWaypoint (const QPoint& current)
+Waypoint* Map::findWaypoint (const QPoint& current, int delta)
 {
+  QList<Waypoint*> &wpList = _globalMapContents->getWaypointList();
+
+  if( m_waypointHitCount == wpList.size() )
+    {
+      int idx = m_waypointHitIndex.find( current, delta );
+
+      return ( idx >= 0 ) ? wpList.at(idx) : 0;
+    }
+
+  // The waypoint list was changed after the last redraw, search the
+  // whole list.
   Waypoint *wp;
 
-  foreach( wp, _globalMapContents->getWaypointList() )
+  foreach( wp, wpList )
   {
     QPoint sitePos (_globalMapMatrix->map(_globalMapMatrix->wgsToMap(wp->origP)));
-    double dX = abs(sitePos.x() - current.x());
-    double dY = abs(sitePos.y() - current.y());
+    int dX = abs(sitePos.x() - current.x());
+    int dY = abs(sitePos.y() - current.y());
 
     // Abstand entspricht der Icon-Grösse.
-    if ( (dX < 8.0) && (dY < 8.0) )
+    if ( (dX < delta) && (dY < delta) )
     {
       return wp;
     }
@@ -600,55 +627,31 @@ void Map::__displayMapInfo(const QPoint& current, bool automatic)
 
   QString text;
 
-  // compose search list
-  QList<int> searchList;
-  searchList << MapContents::GliderfieldList
-	     << MapContents::AirfieldList
-	     << MapContents::OutLandingList
-	     << MapContents::NavaidList
-	     << MapContents::HotspotList;
+  // Look for a drawn airfield, outlanding, navaid or hotspot.
+  SinglePoint *sp = __findDrawnPoint( current, delta );
 
-  for( int k = 0; k < searchList.size(); k++ )
+  if( sp )
     {
-      for( int i = 0; i < _globalMapContents->getListLength(searchList.at(k) ); i++ )
-      {
-        SinglePoint *sp = dynamic_cast<SinglePoint *>(_globalMapContents->getElement(searchList.at(k), i));
-
-        if( sp == 0 )
-          {
-            continue;
-          }
-
-        QPoint sitePos = sp->getMapPosition();
-
-        int dX = abs( sitePos.x() - current.x() );
-        int dY = abs( sitePos.y() - current.y() );
-
-        // Abstand entspricht der Icon-Größe.
-        if( dX < delta && dY < delta )
-          {
-            Airfield *af   = dynamic_cast<Airfield *>(sp); // try casting to an airfield
-            RadioPoint *rp = dynamic_cast<RadioPoint *>(sp); // try casting to a navaid
+      Airfield *af   = dynamic_cast<Airfield *>(sp); // try casting to an airfield
+      RadioPoint *rp = dynamic_cast<RadioPoint *>(sp); // try casting to a navaid
 
-            if( af )
-              {
-                text += af->getInfoString();
-              }
-            else if( rp )
-              {
-                text += rp->getInfoString();
-              }
-            else
-              {
-                text += sp->getInfoString();
-              }
+      if( af )
+        {
+          text += af->getInfoString();
+        }
+      else if( rp )
+        {
+          text += rp->getInfoString();
+        }
+      else
+        {
+          text += sp->getInfoString();
+        }
 
-            // Text anzeigen
-            WhatsThat* box = new WhatsThat( this, text, timeout, mapToGlobal( current ) );
-            box->setVisible( true );
-            return;
-          }
-       }
+      // Text anzeigen
+      WhatsThat* box = new WhatsThat( this, text, timeout, mapToGlobal( current ) );
+      box->setVisible( true );
+      return;
     }
 
   BaseFlightElement *baseFlight = _globalMapContents->getFlight();
@@ -836,7 +839,13 @@ void Map::__graphicalPlanning(const QPoint& current, QMouseEvent* event)
   if( ! found )
     {
       // Try the waypoint catalog to find it.
-      found = __getTaskWaypoint( current, &wp, wpList );
+      Waypoint* catalogWp = findWaypoint( current, 16 );
+
+      if( catalogWp )
+        {
+          wp = *catalogWp;
+          found = true;
+        }
     }
 
   if( ! found )
@@ -1416,6 +1425,8 @@ void Map::__drawMap()
   QPainter isoMapP(&pixIsoMap);
 
   m_drawnCityList.clear();
+  m_drawnPointList.clear();
+  m_pointHitIndex.clear();
   QList<BaseMapElement *> drawnElements;
 
   // Take the color of the subterrain for filling
@@ -1474,27 +1485,64 @@ void Map::__drawMap()
 
   emit setStatusBarProgress(70);
 
-  _globalMapContents->drawList(&aeroP, MapContents::HotspotList, drawnElements);
+  __drawPointList(&aeroP, MapContents::HotspotList);
 
-  _globalMapContents->drawList(&aeroP, MapContents::NavaidList, drawnElements);
+  __drawPointList(&aeroP, MapContents::NavaidList);
 
   emit setStatusBarProgress(75);
 
-  _globalMapContents->drawList(&aeroP, MapContents::AirfieldList, drawnElements);
+  __drawPointList(&aeroP, MapContents::AirfieldList);
 
   emit setStatusBarProgress(80);
 
-  _globalMapContents->drawList(&aeroP, MapContents::GliderfieldList, drawnElements);
+  __drawPointList(&aeroP, MapContents::GliderfieldList);
 
   emit setStatusBarProgress(90);
 
-  _globalMapContents->drawList(&aeroP, MapContents::OutLandingList, drawnElements);
+  __drawPointList(&aeroP, MapContents::OutLandingList);
 
   emit setStatusBarProgress(95);
 
   __drawGrid();
 }
 
+void Map::__drawPointList( QPainter* targetP, const int listID )
+{
+  QList<BaseMapElement *> drawnElements;
+  QVector<int> drawnIndexes;
+
+  _globalMapContents->drawList( targetP, listID, drawnElements, &drawnIndexes );
+
+  // Index the screen positions of the drawn points for the hit tests.
+  for( int i = 0; i < drawnElements.size(); i++ )
+    {
+      SinglePoint *sp = static_cast<SinglePoint *>( drawnElements.at(i) );
+
+      m_pointHitIndex.insert( sp->getMapPosition(), m_drawnPointList.size() );
+      m_drawnPointList.append( qMakePair( listID, drawnIndexes.at(i) ) );
+    }
+}
+
+SinglePoint* Map::__findDrawnPoint( const QPoint& pos, const int delta )
+{
+  int idx = m_pointHitIndex.find( pos, delta );
+
+  if( idx < 0 )
+    {
+      return static_cast<SinglePoint *> (0);
+    }
+
+  const QPair<int, int>& point = m_drawnPointList.at(idx);
+
+  // The point list may have been cleared since the last redraw.
+  if( point.second >= _globalMapContents->getListLength( point.first ) )
+    {
+      return static_cast<SinglePoint *> (0);
+    }
+
+  return _globalMapContents->getSinglePoint( point.first, point.second );
+}
+
 void Map::__drawAirspaces()
 {
   QPainter cuAeroMapP;
@@ -1509,9 +1557,13 @@ void Map::__drawAirspaces()
 
   SortableAirspaceList& airspaceList = _globalMapContents->getAirspaceList();
 
-  for( int i = 0; i < airspaceList.size(); i++ )
+  // Only the airspaces near to the visible map area are checked.
+  const QVector<int> visible =
+    _globalMapContents->getVisibleElements( MapContents::AirspaceList );
+
+  for( int i = 0; i < visible.size(); i++ )
     {
-      Airspace& as = airspaceList[i];
+      Airspace& as = airspaceList[visible[i]];
 
       if( ! as.isDrawable() )
         {
@@ -1758,7 +1810,13 @@ void Map::slotRedrawMap()
 
 void Map::slotScheduleRedrawMap()
 {
-  redrawMapTimer->start(500);
+  // Do not restart a running timer. Otherwise a stream of requests, as
+  // caused by map tiles loaded in the background, would defer the redraw
+  // until the last request has arrived.
+  if( ! redrawMapTimer->isActive() )
+    {
+      redrawMapTimer->start(500);
+    }
 }
 
 void Map::slotActivatePlanning()
@@ -1799,6 +1857,20 @@ void Map::__showLayer()
   update();
 }
 
+void Map::__showLayer( const QRect& rect )
+{
+  QPainter buffer(&pixBuffer);
+
+  buffer.drawPixmap(rect, pixIsoMap, rect);
+  buffer.drawPixmap(rect, pixUnderMap, rect);
+  buffer.drawPixmap(rect, pixAirspace, rect);
+  buffer.drawPixmap(rect, pixFlight, rect);
+  buffer.drawPixmap(rect, pixPlan, rect);
+  buffer.drawPixmap(rect, pixAero, rect);
+  buffer.drawPixmap(rect, pixWaypoints, rect);
+  buffer.drawPixmap(rect, pixGrid, rect);
+}
+
 void Map::__showFlightData( const QPoint& mapPos )
 {
   // Show flight data, if position is in the near of a flight.
@@ -2051,6 +2123,7 @@ void Map::slotAnimateFlightStart()
     {
       // Animation was paused, continue animation.
       animationPaused = false;
+      animationClock.start();
       timerAnimate->start( 50 );
       return;
     }
@@ -2093,6 +2166,10 @@ void Map::slotAnimateFlightStart()
   // Force an immediate redraw of the map to see the animation.
   repaint();
 
+  // The playback clock is independent of the fix intervals of the flights.
+  animationPlayTime = 0;
+  animationClock.start();
+
   // start 50ms timer
   timerAnimate->start( 50 );
 }
@@ -2102,10 +2179,41 @@ void Map::slotAnimateFlightStart()
  */
 void Map::slotAnimateFlightPause()
 {
+  if( timerAnimate->isActive() )
+    {
+      animationPlayTime += animationClock.elapsed() * animationSpeed;
+    }
+
   animationPaused = true;
   timerAnimate->stop();
 }
 
+/**
+ * Called to change the playback speed of the animation.
+ */
+void Map::slotSetAnimationSpeed( int speed )
+{
+  if( timerAnimate->isActive() )
+    {
+      // The reached playback time is kept.
+      animationPlayTime += animationClock.restart() * animationSpeed;
+    }
+
+  animationSpeed = qMax( 1, speed );
+}
+
+int Map::__animationSeconds() const
+{
+  qint64 playTime = animationPlayTime;
+
+  if( timerAnimate->isActive() )
+    {
+      playTime += animationClock.elapsed() * animationSpeed;
+    }
+
+  return (int) (playTime / 1000);
+}
+
 /**
  * Called for every timeout of the animation timer.
  */
@@ -2122,43 +2230,68 @@ void Map::slotAnimateFlightTimeout()
       return;
     }
 
-  // Loop through the flight list and reset animation flag.
+  const int seconds = __animationSeconds();
+
+  // Erase the previous glider symbols. That is done in reverse order,
+  // because the symbols can overlap each other.
+  QPainter p;
+  p.begin( &pixBuffer );
+
+  for( int i = flightList.size() - 1; i >= 0; i-- )
+    {
+      Flight *flight = flightList.at(i);
+      QPoint lastpos = flight->getLastAnimationPos();
+
+      p.drawPixmap( lastpos.x() - 20, lastpos.y() - 20, flight->getLastAnimationPixmap() );
+    }
+
+  p.end();
+
+  // Append only the newly reached segments to the flight layer.
+  QList<QRect> dirtyRects;
+
+  p.begin( &pixFlight );
+
   for( int i = 0; i < flightList.size(); i++ )
     {
       Flight *flight = flightList.at(i);
 
-      flight->setAnimationNextIndex();
+      flight->setAnimationTime( seconds );
 
       if( flight->isAnimationActive() )
         {
           bDone = false;
         }
 
-      // Write info from current point on statusbar. The last flight in the list
-      // is always the winner.
-      FlightPoint cP = flight->getPoint( (flight->getAnimationIndex()) );
-      QPoint pos = _globalMapMatrix->map( cP.projP );
-      QPoint lastpos = flight->getLastAnimationPos();
-      QPixmap& pix = flight->getLastAnimationPixmap();
-      emit showFlightPoint( cP.origP, cP );
+      QRect dirty = flight->drawAnimationStep( &p );
 
-      // Show elevation in status bar
-      emit elevation(cP.surfaceHeight);
+      if( dirty.isValid() )
+        {
+          dirtyRects.append( dirty );
+        }
+    }
 
-      // Erase previous glider symbol
-      QPainter p;
-      p.begin( &pixBuffer );
-      p.drawPixmap( lastpos.x() - 20, lastpos.y() - 20, pix );
+  p.end();
 
-      // Draw flight up to this point in pixFlight.
-      __drawFlight();
+  // Update the map buffer in the changed areas.
+  for( int i = 0; i < dirtyRects.size(); i++ )
+    {
+      __showLayer( dirtyRects.at(i) );
+    }
 
-      // draw flight at the map.
-      p.drawPixmap( 0, 0, pixFlight );
+  p.begin( &pixBuffer );
+
+  for( int i = 0; i < flightList.size(); i++ )
+    {
+      Flight *flight = flightList.at(i);
+
+      FlightPoint cP = flight->getPoint( (flight->getAnimationIndex()) );
+      QPoint pos = _globalMapMatrix->map( cP.projP );
 
       // save map part for next timeout
-      pix = pixBuffer.copy( pos.x() - 20, pos.y() - 20, 40, 40 );
-      flight->setLastAnimationPos(pos);
+      QPixmap pix = pixBuffer.copy( pos.x() - 20, pos.y() - 20, 40, 40 );
+      flight->setLastAnimationPixmap( pix );
+      flight->setLastAnimationPos( pos );
 
       int bearing = (int) rint(cP.bearing * 180.0 / M_PI);
 
@@ -2167,9 +2300,20 @@ void Map::slotAnimateFlightTimeout()
 
       // draw the right glider symbol at the map
       p.drawPixmap( pos.x() - 20, pos.y() - 20, pixGliders, rot*40, 0, 40, 40 );
-      p.end();
+
+      // Write info from current point on statusbar. The last flight in the
+      // list is always the winner.
+      if( i == flightList.size() - 1 )
+        {
+          emit showFlightPoint( cP.origP, cP );
+
+          // Show elevation in status bar
+          emit elevation(cP.surfaceHeight);
+        }
     }
 
+  p.end();
+
   if( bDone )
     {
       // if one of the flights still is active, bDone will be false
@@ -2554,6 +2698,9 @@ void Map::__drawWaypoints()
 
   QList<Waypoint*> &wpList = _globalMapContents->getWaypointList();
 
+  m_waypointHitIndex.clear();
+  m_waypointHitCount = wpList.size();
+
   QPainter painter(&pixWaypoints);
   QFont font = painter.font();
   font.setPointSize( 10 );
@@ -2579,6 +2726,8 @@ void Map::__drawWaypoints()
         continue;
       }
 
+    m_waypointHitIndex.insert( mp, i );
+
     // draw marker
     painter.drawRect( mp.x() - 4, mp.y() - 4, 8, 8 );
 
@@ -2702,8 +2851,37 @@ void Map::slotWaypointCatalogChanged(WaypointCatalog* c)
 
   filterArea = (c->areaLat2 != 0 && c->areaLong2 != 0 && !filterRadius);
 
-  foreach(w, c->wpList)
+  const WGSPoint center = c->getCenterPoint();
+
+  // We have to consider the user chosen distance unit.
+  const double catalogDist = Distance::convertToMeters( c->radiusSize ) / 1000.;
+
+  // Only the waypoints near to the filter area are checked.
+  QVector<int> candidates;
+
+  if( filterArea )
+    {
+      candidates = c->findWaypoints( QRect( QPoint( c->areaLat1, c->areaLong1 ),
+                                            QPoint( c->areaLat2, c->areaLong2 ) ) );
+    }
+  else if( filterRadius )
+    {
+      candidates = c->findWaypoints( center, catalogDist );
+    }
+  else
+    {
+      candidates.resize( c->wpList.size() );
+
+      for( int i = 0; i < candidates.size(); i++ )
+        {
+          candidates[i] = i;
+        }
+    }
+
+  for( int i = 0; i < candidates.size(); i++ )
   {
+        w = c->wpList.at( candidates[i] );
+
         if( !c->showAll )
           {
             switch( w->type )
@@ -2776,12 +2954,9 @@ void Map::slotWaypointCatalogChanged(WaypointCatalog* c)
           }
         else if( filterRadius )
           {
-            // We have to consider the user chosen distance unit.
-            double catalogDist = Distance::convertToMeters( c->radiusSize ) / 1000.;
-
             // This distance is calculated in kilometers.
-            double radiusDist = dist( c->getCenterPoint().lat(),
-                                      c->getCenterPoint().lon(),
+            double radiusDist = dist( center.lat(),
+                                      center.lon(),
                                       w->origP.lat(),
                                       w->origP.lon() );
 
@@ -3246,77 +3421,45 @@ QString Map::calculateRealMapScale( const int metersPerPixel )
 
 bool Map::findMapPoint( int delta, const QPoint& mapPosition, Waypoint *w )
 {
-  // compose search list
-  QList<int> searchList;
-  searchList << MapContents::GliderfieldList
-	     << MapContents::AirfieldList
-	     << MapContents::OutLandingList
-	     << MapContents::NavaidList
-	     << MapContents::HotspotList;
+  // Look for a drawn airfield, outlanding, navaid or hotspot.
+  SinglePoint *sp = __findDrawnPoint( mapPosition, delta );
 
-  int dX, dY;
+  if( ! sp )
+    {
+      return false;
+    }
 
   // select Waypoint
   QRegExp blank( "[ ]" );
 
-  for( int k = 0; k < searchList.size(); k++ )
-    {
-      for( int i = 0; i < _globalMapContents->getListLength(searchList.at(k) ); i++ )
-      {
-        SinglePoint *sp = dynamic_cast<SinglePoint *>(_globalMapContents->getElement(searchList.at(k), i));
-
-          if( sp == 0 )
-            {
-              continue;
-            }
+  QString name = sp->getName();
+  w->name = name.replace( blank, "" ).left( 8 ).toUpper();
+  w->description = sp->getName();
+  w->country = sp->getCountry();
+  w->type = sp->getTypeID();
+  w->origP = sp->getWGSPosition();
+  w->projP = sp->getPosition();
+  w->elevation = sp->getElevation();
+  w->comment = sp->getComment();
+  w->icao = "";
+  w->frequency = 0.0;
+  w->rwyList.clear();
 
-        QPoint sitePos = sp->getMapPosition();
+  Airfield *af   = dynamic_cast<Airfield *>(sp); // try casting to an airfield
+  RadioPoint *rp = dynamic_cast<RadioPoint *>(sp); // try casting to a navaid
 
-        dX = abs( sitePos.x() - mapPosition.x() );
-        dY = abs( sitePos.y() - mapPosition.y() );
-
-        // Abstand entspricht der Icon-Größe.
-        if( dX < delta && dY < delta )
-          {
-            QString name = sp->getName();
-            w->name = name.replace( blank, "" ).left( 8 ).toUpper();
-            w->description = sp->getName();
-            w->country = sp->getCountry();
-            w->type = sp->getTypeID();
-            w->origP = sp->getWGSPosition();
-            w->projP = sp->getPosition();
-            w->elevation = sp->getElevation();
-            w->comment = sp->getComment();
-            w->icao = "";
-            w->frequency = 0.0;
-            w->rwyList.clear();
-
-            Airfield *af   = dynamic_cast<Airfield *>(sp); // try casting to an airfield
-            RadioPoint *rp = dynamic_cast<RadioPoint *>(sp); // try casting to a navaid
-
-            if( af )
-              {
-                w->icao = af->getICAO();
-                w->frequency = af->getFrequency();
-                w->rwyList = af->getRunwayList();
-              }
-            else if( rp )
-              {
-                w->icao = rp->getICAO();
-                w->frequency = rp->getFrequency();
-                w->comment = rp->getAdditionalText();
-              }
-            else
-              {
-                w->icao = "";
-                w->frequency = 0.0;
-                w->rwyList.clear();
-              }
-
-          return true;
-        }
-      }
+  if( af )
+    {
+      w->icao = af->getICAO();
+      w->frequency = af->getFrequency();
+      w->rwyList = af->getRunwayList();
+    }
+  else if( rp )
+    {
+      w->icao = rp->getICAO();
+      w->frequency = rp->getFrequency();
+      w->comment = rp->getAdditionalText();
     }
 
-  return false;
+  return true;
 }
@@ -32,19 +32,24 @@
 #define MAP_H
 
 #include <QBitmap>
+#include <QElapsedTimer>
 #include <QList>
 #include <QMenu>
+#include <QPair>
 #include <QRegion>
 #include <QSize>
 #include <QTimer>
 #include <QUrl>
+#include <QVector>
 #include <QWheelEvent>
 #include <QWidget>
 
 #include "flighttask.h"
+#include "maphitindex.h"
 #include "waypointcatalog.h"
 
 class Flight;
+class SinglePoint;
 class WaypointDialog;
 
 class Map : public QWidget
@@ -125,7 +130,8 @@ private:
     /**
      * Animation slot.
      * Called for every timeout of the animation timer. Advances the cross-hair
-     * one single step.
+     * of every flight to the current playback time and draws only the newly
+     * reached part of the flight ways.
      */
     void slotAnimateFlightTimeout();
     /**
@@ -140,6 +146,10 @@ private:
      * Animation slot. Called to stop the animation timer.
      */
     void slotAnimateFlightStop();
+    /**
+     * Animation slot. Sets the playback speed as multiple of the real time.
+     */
+    void slotSetAnimationSpeed( int speed );
     /**
      * Stepping slots.
      */
@@ -300,8 +310,12 @@ private:
 
     /**
      * tries to find a waypoint at current position
+     *
+     * \param current Position at the drawn map
+     *
+     * \param delta Maximum distance to the waypoint position
      */
-    Waypoint* findWaypoint (const QPoint& current);
+    Waypoint* findWaypoint (const QPoint& current, int delta=8);
 
     /**
      * Redraws the map.
@@ -311,6 +325,14 @@ private:
      * Copies the pixmaps into pixBuffer and calls a paintEvent().
      */
     void __showLayer();
+    /**
+     * Copies the pixmaps in the passed rectangle into pixBuffer.
+     */
+    void __showLayer( const QRect& rect );
+    /**
+     * @return The playback time of the animation in seconds.
+     */
+    int __animationSeconds() const;
 
     /**
      *  Show flight data, if position is in the near of a flight.
@@ -329,6 +351,16 @@ private:
      * Draws all airspaces on the map.
      */
     void __drawAirspaces();
+    /**
+     * Draws a list of point elements and adds the drawn points to the
+     * hit index.
+     */
+    void __drawPointList( QPainter* targetP, const int listID );
+    /**
+     * \return The drawn point element under the passed position or 0, if
+     *         there is none.
+     */
+    SinglePoint* __findDrawnPoint( const QPoint& pos, const int delta );
     /**
      */
     void __drawFlight();
@@ -466,6 +498,12 @@ private:
     QTimer* timerAnimate;
     /** Flag to indicate an animation pause. */
     bool animationPaused;
+    /** Measures the real time since the last start or speed change. */
+    QElapsedTimer animationClock;
+    /** Playback time in ms, which was reached before animationClock was started. */
+    qint64 animationPlayTime;
+    /** Playback speed as multiple of the real time. */
+    int animationSpeed;
     /**
      * contains planning task points
      * enthält die Punkte!!!
@@ -537,6 +575,25 @@ private:
 
     /** List of drawn cities. */
     QList<BaseMapElement *> m_drawnCityList;
+
+    /**
+     * The drawn airfields, outlandings, navaids and hotspots as pairs of
+     * list identifier and list index. No pointers are kept, because the
+     * point lists can be reloaded before the next redraw.
+     */
+    QVector< QPair<int, int> > m_drawnPointList;
+
+    /** Screen positions of m_drawnPointList, rebuilt with every redraw. */
+    MapHitIndex m_pointHitIndex;
+
+    /**
+     * Screen positions of the drawn waypoints of the waypoint catalog. The
+     * identifiers are the list positions in the waypoint list.
+     */
+    MapHitIndex m_waypointHitIndex;
+
+    /** Size of the waypoint list, when m_waypointHitIndex was built. */
+    int m_waypointHitCount;
 };
 
 #endif
@@ -20,6 +20,7 @@
 #include <cmath>
 #include <cstdlib>
 
+#include "flighttrack.h"
 #include "mapcalc.h"
 #include "mapdefaults.h"
 
@@ -119,6 +120,12 @@ double dist(FlightPoint* fp1,  FlightPoint* fp2)
                  fp2->origP.lat(), fp2->origP.lon() ) );
 }
 
+double dist( Waypoint* wp, const FlightTrack& track, const int index )
+{
+  return ( dist( wp->origP.lat(), wp->origP.lon(),
+                 track.lat(index), track.lon(index) ) );
+}
+
 double dist(QPoint* p1, QPoint* p2)
 {
     return ( dist( double(p1->x()), double(p1->y()),
@@ -262,22 +269,25 @@ float getVario(FlightPoint p) { return (float)p.dH / (float)p.dT; }
    source: openairparser.cpp
 */
 float getBearing(FlightPoint p1, FlightPoint p2)
+{
+  return getBearing( p1.origP.x(), p1.origP.y(), p2.origP.x(), p2.origP.y() );
+}
+
+float getBearing(int lat1, int lon1, int lat2, int lon2)
 {
   // Arcus computing constant for kflog corordinates. PI is devided by
   // 180 degrees multiplied with 600.000 because one degree in kflog
   // is multiplied with this resolution factor.
   const float pi_180 = M_PI / 108000000.0;
 
-  // qDebug( "x1=%d y1=%d, x2=%d y2=%d",  p1.x(), p1.y(), p2.x(), p2.y() );
-
-  int dx = p2.origP.x() - p1.origP.x(); // latitude
-  int dy = p2.origP.y() - p1.origP.y(); // longitude
+  int dx = lat2 - lat1; // latitude
+  int dy = lon2 - lon1; // longitude
 
   // compute latitude distance in meters
   float latDist = dx * MILE_kfl / 10000.; // b
 
   // compute latitude average
-  float latAv = ( ( p2.origP.x() + p1.origP.x() ) / 2.0);
+  float latAv = ( ( lat2 + lat1 ) / 2.0);
 
   // compute longitude distance in meters
   float lonDist = dy * cos( pi_180 * latAv ) * MILE_kfl / 10000.; // a
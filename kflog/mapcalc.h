@@ -27,6 +27,8 @@
 #include "waypoint.h"
 #include "wgspoint.h"
 
+class FlightTrack;
+
 /**
  * Calculates the distance between two given points according to great circle in km.
  */
@@ -56,6 +58,11 @@ double dist(Waypoint* wp, FlightPoint* fp);
  */
 double dist( FlightPoint* fp1, FlightPoint* fp2);
 
+/**
+ * Calculates the distance between a waypoint and a fix of a track (in km).
+ */
+double dist( Waypoint* wp, const FlightTrack& track, const int index );
+
 /**
  * Converts the given time (in sec. from 1.1.1970 00:00:00) into a readable string.
  * ( hh:mm:ss )
@@ -83,6 +90,12 @@ float getSpeed(FlightPoint p);
  */
 float getBearing(FlightPoint p1, FlightPoint p2);
 
+/**
+ * Calculates the bearing from the first to the second position, given in
+ * the internal WGS84 format.
+ */
+float getBearing(int lat1, int lon1, int lat2, int lon2);
+
 /**
  * Converts a x/y position into a polar-coordinate.
  */
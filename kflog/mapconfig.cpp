@@ -531,6 +531,39 @@ QPen MapConfig::getDrawPen( FlightPoint* fP,
                             int altitude_max/*= 5000*/,
                             float speed_max/*=80*/,
                             enum MapConfig::DrawFlightPointType dfpt )
+{
+  return __getDrawPen( fP->dH, fP->dT, fP->dS, fP->height, fP->f_state,
+                       fP->isAirspaceIntersected, fP->engineNoise,
+                       va_min, va_max, altitude_max, speed_max, dfpt );
+}
+
+QPen MapConfig::getDrawPen( const FlightTrack& track,
+                            const int index,
+                            float va_min/*=-10*/,
+                            float va_max/*=10*/,
+                            int altitude_max/*= 5000*/,
+                            float speed_max/*=80*/,
+                            enum MapConfig::DrawFlightPointType dfpt )
+{
+  return __getDrawPen( track.dH(index), track.dT(index), track.dS(index),
+                       track.height(index), track.fState(index),
+                       track.isAirspaceIntersected(index),
+                       track.engineNoise(index),
+                       va_min, va_max, altitude_max, speed_max, dfpt );
+}
+
+QPen MapConfig::__getDrawPen( const int dH,
+                              const int dT,
+                              const int dS,
+                              const int height,
+                              const unsigned int fState,
+                              const bool isAirspaceIntersected,
+                              const int engineNoise,
+                              float va_min,
+                              float va_max,
+                              int altitude_max,
+                              float speed_max,
+                              enum MapConfig::DrawFlightPointType dfpt )
 {
   //
   // Dynamische Farben im Flug:
@@ -562,18 +595,18 @@ QPen MapConfig::getDrawPen( FlightPoint* fP,
             vario_range = 10.0;
           }
 
-        color = getRainbowColor( 0.5 - (fP->dH / fP->dT) / vario_range );
+        color = getRainbowColor( 0.5 - (dH / dT) / vario_range );
         width = _settings.value( "/FlightPathLine/Vario", FlightPathLineWidth ).toInt();
         break;
 
       case MapConfig::Speed:
         speed_max -= 15;
-        color = getRainbowColor(1-(fP->dS/qMax(1, fP->dT)-15)/speed_max);
+        color = getRainbowColor(1-(dS/qMax(1, dT)-15)/speed_max);
         width = _settings.value("/FlightPathLine/Speed", FlightPathLineWidth).toInt();
         break;
 
       case MapConfig::Altitude:
-        color = getRainbowColor((float)fP->height/altitude_max);
+        color = getRainbowColor((float)height/altitude_max);
         width = _settings.value("/FlightPathLine/Altitude", FlightPathLineWidth).toInt();
         break;
 
@@ -581,7 +614,7 @@ QPen MapConfig::getDrawPen( FlightPoint* fP,
 
         width = _settings.value("/FlightPathLine/Cycling", FlightPathLineWidth).toInt();
 
-        switch(fP->f_state)
+        switch(fState)
           {
             case Flight::LeftTurn:
               color = _settings.value( "/FlightColor/LeftTurn", FlightTypeLeftTurnColor.name() ).value<QColor>();
@@ -604,7 +637,7 @@ QPen MapConfig::getDrawPen( FlightPoint* fP,
 
       case MapConfig::Airspace:
           {
-            if( fP->isAirspaceIntersected == true )
+            if( isAirspaceIntersected == true )
               {
                 color = Qt::magenta;
               }
@@ -627,7 +660,7 @@ QPen MapConfig::getDrawPen( FlightPoint* fP,
     }
 
   // Simple approach to see "engine was running"
-  if( fP->engineNoise > 350 )
+  if( engineNoise > 350 )
     {
       width = _settings.value("/FlightPathLine/Engine", FlightPathLineWidth).toInt();
       //  Put a white (or configured color) strip there in every case
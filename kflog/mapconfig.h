@@ -49,6 +49,7 @@ const int topoLevels[] = {
   5000,5250,5500,5750,6000,6250,6500,6750,7000,7250,7500,7750,8000,8250,8500,8750,10000};
 
 class FlightPoint;
+class FlightTrack;
 
 class MapConfig : public QObject
 {
@@ -111,6 +112,22 @@ public:
                    int altitude_max = 5000,
                    float speed_max=80,
                    enum MapConfig::DrawFlightPointType dfpt=MapConfig::Altitude );
+  /**
+   * @param  track  The fixes of a flight.
+   * @param  index  The index of the fix, which is used to determine the
+   *                color of the line.
+   *
+   * The other parameters are the same as above.
+   *
+   * @return the pen for drawing a line between two flight points of a flight.
+   */
+  QPen getDrawPen( const FlightTrack& track,
+                   const int index,
+                   float va_min=-10,
+                   float va_max=10,
+                   int altitude_max = 5000,
+                   float speed_max=80,
+                   enum MapConfig::DrawFlightPointType dfpt=MapConfig::Altitude );
   /**
    * @param  c  A value between 0.0 and 1.0
    * @return Color from dark red(0.0)->red->yellow->green->cyan->blue->dark blue(1.0)
@@ -278,6 +295,23 @@ private:
    */
   QPen& __getPen( unsigned int typeID, int sIndex );
 
+  /**
+   * Determines the pen for drawing a flight segment from the values of
+   * its end point.
+   */
+  QPen __getDrawPen( const int dH,
+                     const int dT,
+                     const int dS,
+                     const int height,
+                     const unsigned int fState,
+                     const bool isAirspaceIntersected,
+                     const int engineNoise,
+                     float va_min,
+                     float va_max,
+                     int altitude_max,
+                     float speed_max,
+                     enum MapConfig::DrawFlightPointType dfpt );
+
   /**
    * Reads the draw and print borders from the configuration file.
    */
@@ -17,6 +17,7 @@
 #ifndef _MSC_VER
 #include <unistd.h>
 #endif
+#include <climits>
 #include <cmath>
 
 #ifdef QT_5
@@ -42,8 +43,12 @@
 #include "mapcontents.h"
 #include "mapmatrix.h"
 #include "mapcalc.h"
+#include "mapelementindex.h"
+#include "maptilecache.h"
+#include "maptileloader.h"
 #include "OpenAipPoiLoader.h"
 #include "openairparser.h"
+#include "projectionbase.h"
 #include "radiopoint.h"
 #include "singlepoint.h"
 #include "welt2000.h"
@@ -55,34 +60,11 @@
 // number of different isoline levels
 #define ISO_LINE_NUM 50
 
-// general KFLOG file token: @KFL
-#define KFLOG_FILE_MAGIC    0x404b464c
-
-// uncompiled map file types
-#define FILE_TYPE_AERO        0x41
-#define FILE_TYPE_GROUND      0x47
-#define FILE_TYPE_TERRAIN     0x54
-#define FILE_TYPE_MAP         0x4d
-#define FILE_TYPE_LM          0x4c
-
-// versions
-// The *_OLD files are based on GTOPO30 data. Support for this will disappear in the QT4 release.
-// The newer files are based on SRTM3 data.
-#define FILE_VERSION_GROUND_OLD   100
-#define FILE_VERSION_GROUND       102
-#define FILE_VERSION_TERRAIN_OLD  100
-#define FILE_VERSION_TERRAIN      102
-#define FILE_VERSION_MAP          101
-
-#define READ_POINT_LIST \
-    in >> locLength; \
-    all.resize(locLength); \
-    for(uint i = 0; i < locLength; i++) \
-      { \
-        in >> lat_temp; \
-        in >> lon_temp; \
-        all.setPoint( i, _globalMapMatrix->wgsToMap(lat_temp, lon_temp) ); \
-      }
+// Minimum memory in bytes used for the rasters of the terrain tiles
+#define ISO_RASTER_CACHE_SIZE (64 * 1024 * 1024)
+
+// Largest raster of a single terrain tile in pixels
+#define ISO_RASTER_MAX_PIXELS (2048 * 2048)
 
 // List of elevation levels in meters (51 in total):
 const short MapContents::isoLevels[] =
@@ -97,18 +79,77 @@ const short MapContents::isoLevels[] =
 extern MainWindow *_mainWindow;
 extern QSettings _settings;
 
+/**
+ * Estimates the memory, which is used by the map elements created from the
+ * given tile elements.
+ */
+static qint64 estimateTileMemory( const QList<MapTileCache::Element>& elements,
+                                  const int elementSize )
+{
+  qint64 bytes = 0;
+
+  for( int i = 0; i < elements.size(); i++ )
+    {
+      const MapTileCache::Element& element = elements.at(i);
+
+      bytes += elementSize +
+               element.polygon.size() * sizeof(QPoint) +
+               element.name.size() * sizeof(QChar);
+    }
+
+  return bytes;
+}
+
+/**
+ * Removes all elements from the list, which belong to one of the given
+ * map tiles.
+ *
+ * \return The number of removed elements.
+ */
+template<class T>
+static int removeTileElements( QList<T>& list, const QSet<int>& tiles )
+{
+  QList<T> kept;
+  kept.reserve( list.size() );
+
+  for( int i = 0; i < list.size(); i++ )
+    {
+      if( ! tiles.contains( list.at(i).getMapSegment() ) )
+        {
+          kept.append( list.at(i) );
+        }
+    }
+
+  int removed = list.size() - kept.size();
+
+  if( removed > 0 )
+    {
+      list = kept;
+    }
+
+  return removed;
+}
+
 MapContents::MapContents( QObject* object ) :
   QObject(object),
   currentFlight(0),
+  m_tileUseCounter(0),
   askUser(true),
   loadPoints(true),
   loadAirspaces(true),
+  m_airspaceGeneration(0),
   m_downloadManger(0),
   m_downloadMangerW2000(0),
   m_downloadOpenAipAsManger(0),
   m_downloadOpenAipPoiManger(0),
   m_currentFlightListIndex(-1)
 {
+  m_tileLoader = new MapTileLoader( this );
+
+  m_isoRasterCache.setMaxCost( ISO_RASTER_CACHE_SIZE );
+
+  connect( m_tileLoader, SIGNAL(tilesAvailable()), SLOT(slotTilesLoaded()) );
+
   // Setup a hash used as reverse mapping from isoLine value to array index to
   // speed up loading of ground and terrain files.
   for( int i = 0; i < ISO_LINE_LEVELS; i++ )
@@ -116,11 +157,6 @@ MapContents::MapContents( QObject* object ) :
       isoHash.insert( isoLevels[i], i );
     }
 
-  _nextIsoLevel = 10000;
-  _lastIsoLevel = -1;
-  _isoLevelReset = true;
-  _lastIsoEntry = 0;
-
   // Create all needed map directories.
   createMapDirectories();
 
@@ -131,8 +167,21 @@ MapContents::MapContents( QObject* object ) :
 
 MapContents::~MapContents()
 {
+  // The loader threads are children of this object and must be finished,
+  // before they are deleted.
+  if( ! m_airspaceThread.isNull() )
+    {
+      m_airspaceThread->wait();
+    }
+
+  if( ! m_poiThread.isNull() )
+    {
+      m_poiThread->wait();
+    }
+
   qDeleteAll(flightList);
   qDeleteAll(wpList);
+  __removeElevationGrid( -1 );
 }
 
 extern MapContents* _globalMapContents;
@@ -516,6 +565,7 @@ void MapContents::slotReloadAirspaceData()
 {
   airspaceList.clear();
   airspaceRegionList.clear();
+  m_airspaceGeneration++;
 
   loadAirspaces = true;
   emit contentsChanged();
@@ -828,204 +878,121 @@ bool MapContents::__readTerrainFile( const int fileSecID,
 {
   extern MapMatrix *_globalMapMatrix;
 
-  if ( fileTypeID != FILE_TYPE_TERRAIN && fileTypeID != FILE_TYPE_GROUND )
-    {
-      qWarning( "Requested terrain file type 0x%X is unsupported!", fileTypeID );
-      return false;
-    }
-
-  QString path, file;
-
-  path = getMapRootDirectory() + "/landscape/";
+  QList<MapTileCache::Element> elements;
 
-  file.sprintf( "%c_%.5d.kfl", fileTypeID, fileSecID );
+  MapTileLoader::ReadResult res =
+    MapTileLoader::readTerrainFile( getMapRootDirectory(),
+                                    fileSecID,
+                                    fileTypeID,
+                                    _globalMapMatrix->getProjection(),
+                                    elements );
 
-  QString pathName = path + file;
-
-  QFile mapfile(pathName);
-
-  if( ! mapfile.open(QIODevice::ReadOnly) )
+  if( res == MapTileLoader::FileMissing )
     {
-      qWarning() << "KFLog: Can not open Terrain file" << pathName;
-
-      int answer = __askUserForDownload( tr("KFLog maps") );
-
-      if( answer == Automatic )
-        {
-          __downloadMapFile( file, path );
-        }
-      else
-        {
-          qDebug() << "Auto download is disabled! Bye";
-        }
-
+      __handleMissingTileFile( fileSecID, fileTypeID );
       return false;
     }
 
-  QDataStream in( &mapfile );
-  in.setVersion( QDataStream::Qt_3_3 );
-
-  // qDebug("reading file %s", pathName.toLatin1().data());
-
-  qint8 loadTypeID;
-  quint16 loadSecID, formatID;
-  quint32 magic;
-  QDateTime createDateTime;
-
-  in >> magic;
-  in >> loadTypeID;
-  in >> formatID;
-  in >> loadSecID;
-  in >> createDateTime;
-
-  if( magic != KFLOG_FILE_MAGIC )
+  if( res != MapTileLoader::ReadOk )
     {
-      mapfile.close();
-
-      // We remove the wrong file to over come this dead lock by a new download
-      // of this file from the KFLog map room..
-      unlink( pathName.toLatin1().data() );
-
-      qWarning( "KFLog: %s Wrong magic key %x read! Abort loading...",
-                pathName.toLatin1().data(), magic );
-
       return false;
     }
 
-  if( loadTypeID != fileTypeID ) // wrong type
-    {
-      mapfile.close();
-
-      qWarning("KFLog: %s Wrong load type identifier %x read! Abort loading...",
-                pathName.toLatin1().data(), loadTypeID );
+  __addTerrainElements( fileSecID, fileTypeID, elements );
 
-      return false;
-    }
+  return true;
+}
 
-  // Determine, which file format id is expected
-  int expFormatID;
+void MapContents::__addTerrainElements( const int fileSecID,
+                                        const int fileTypeID,
+                                        const QList<MapTileCache::Element>& elements )
+{
+  // Check in which map the isohypse has to be stored. We do use two
+  // different maps, one for Ground and another for Terrain. The default
+  // is set to terrain because there are a lot more.
+  QMap<int, QList<Isohypse> > *usedMap = &terrainMap;
 
-  if( fileTypeID == FILE_TYPE_TERRAIN )
-    {
-      expFormatID = FILE_VERSION_TERRAIN;
-    }
-  else
+  if( fileTypeID == FILE_TYPE_GROUND )
     {
-      expFormatID = FILE_VERSION_GROUND;
+      usedMap = &groundMap;
     }
 
-  qDebug( "Reading File=%s, Magic=0x%x, TypeId=%c, formatId=%d, Date=%s",
-          pathName.toLatin1().data(), magic, loadTypeID, formatID,
-          createDateTime.toString(Qt::ISODate).toLatin1().data() );
+  // Store new isohypses in the isomap. The tile section identifier is the key.
+  // A new entry in the isomap is created, if it does not exist.
+  QList<Isohypse>& isoList = (*usedMap)[fileSecID];
 
-  // Check map file
-  if ( formatID < expFormatID )
+  for( int i = 0; i < elements.size(); i++ )
     {
-      mapfile.close();
+      const MapTileCache::Element& element = elements.at(i);
 
-      // too old ...
-      qWarning("KFLog: File format too old! (version %d, expecting: %d) "
-               "Aborting ...", formatID, expFormatID );
-      return false;
-    }
-  else if (formatID > expFormatID )
-    {
-      // too new ...
-      mapfile.close();
+      // determine elevation index, 0 is returned as default for not existing values
+      uchar elevationIdx = isoHash.value( element.elevation, 0 );
 
-      qWarning("KFLog: File format too new! (version %d, expecting: %d) "
-               "Aborting ...", formatID, expFormatID );
-      return false;
+      isoList.append( Isohypse( element.polygon,
+                                element.elevation,
+                                elevationIdx,
+                                fileSecID,
+                                fileTypeID ) );
     }
 
-  if ( loadSecID != fileSecID )
-    {
-      mapfile.close();
+  m_tileMemory[fileSecID] += estimateTileMemory( elements, sizeof(Isohypse) );
 
-      qWarning( "KFLog: %s: Wrong section, bogus file name! Arborting ...",
-                pathName.toLatin1().data() );
+  __addElevationGrid( fileSecID, elements );
 
-      return false;
-    }
+  // An old raster of this tile does not contain the new isolines.
+  __removeTerrainRasters( fileSecID );
+}
 
-  while ( ! in.atEnd() )
-    {
-      qint16 elevation;
-      qint32 pointNumber, lat, lon;
-      QPolygon isoline;
+void MapContents::__addElevationGrid( const int fileSecID,
+                                      const QList<MapTileCache::Element>& elements )
+{
+  extern MapMatrix *_globalMapMatrix;
 
-      in >> elevation;
-      in >> pointNumber;
-      isoline.resize( pointNumber );
+  QWriteLocker locker( &m_elevationLock );
 
-      for (int i = 0; i < pointNumber; i++)
-        {
-          in >> lat;
-          in >> lon;
+  ElevationGrid* grid = m_elevationGrids.value( fileSecID, 0 );
 
-          // This is what causes the long delays, lots of floating point calculations
-          isoline.setPoint( i, _globalMapMatrix->wgsToMap(lat, lon));
-        }
+  if( grid == 0 )
+    {
+      // The projected tile border is curved, so the bounds are determined
+      // from points along the border of the tile.
+      QRect tileBox = getTileBox( fileSecID );
+      QRect bounds;
 
-      // Check, if first point and last point of the isoline identical. In this
-      // case we can remove the last point and repeat the check.
-      for( int i = isoline.size() - 1; i >= 0; i-- )
+      for( int i = 0; i <= 4; i++ )
         {
-          if( isoline.point(0) == isoline.point(i) )
-             {
-               //qWarning( "Isoline Tile=%d has same start and end point. Remove end point.",
-               //           loadSecID );
-
-               // remove last point and check again
-               isoline.remove(i);
-               continue;
-             }
-
-          break;
-        }
+          for( int j = 0; j <= 4; j++ )
+            {
+              QPoint p = _globalMapMatrix->wgsToMap( tileBox.top() + i * tileBox.height() / 4,
+                                                     tileBox.left() + j * tileBox.width() / 4 );
 
-      if( isoline.size() < 3)
-        {
-          // ignore to small isolines
-          qWarning( "Isoline Tile=%d, elevation=%dm has too less points!",
-                     loadSecID, elevation );
-          continue;
+              bounds = bounds.united( QRect( p, QSize( 1, 1 ) ) );
+            }
         }
 
-      // determine elevation index, 0 is returned as default for not existing values
-      uchar elevationIdx = isoHash.value( elevation, 0 );
-
-      Isohypse newItem( isoline, elevation, elevationIdx, fileSecID, fileTypeID );
+      grid = new ElevationGrid( bounds );
+      m_elevationGrids.insert( fileSecID, grid );
+      m_tileMemory[fileSecID] += grid->memoryUsage();
+    }
 
-      // Check in which map the isohypse has to be stored. We do use two
-      // different maps, one for Ground and another for Terrain. The default
-      // is set to terrain because there are a lot more.
-      QMap<int, QList<Isohypse> > *usedMap = &terrainMap;
+  for( int i = 0; i < elements.size(); i++ )
+    {
+      grid->addIsoline( elements.at(i).polygon, elements.at(i).elevation );
+    }
+}
 
-      if( fileTypeID == FILE_TYPE_GROUND )
-        {
-          usedMap = &groundMap;
-        }
+void MapContents::__removeElevationGrid( const int secID )
+{
+  QWriteLocker locker( &m_elevationLock );
 
-      // Store new isohypse in the isomap. The tile section identifier is the key.
-      if( usedMap->contains( fileSecID ))
-        {
-          // append isohypse to existing vector
-          QList<Isohypse>& isoList = (*usedMap)[fileSecID];
-          isoList.append( newItem );
-        }
-      else
-        {
-          // create a new entry in the isomap
-          QList<Isohypse> isoList;
-          isoList.append( newItem );
-          usedMap->insert( fileSecID, isoList );
-        }
+  if( secID == -1 )
+    {
+      qDeleteAll( m_elevationGrids );
+      m_elevationGrids.clear();
+      return;
     }
 
-  mapfile.close();
-
-  return true;
+  delete m_elevationGrids.take( secID );
 }
 
 bool MapContents::__readBinaryFile( const int  fileSecID,
@@ -1033,258 +1000,149 @@ bool MapContents::__readBinaryFile( const int  fileSecID,
 {
   extern MapMatrix *_globalMapMatrix;
 
-  QString path, file;
+  QList<MapTileCache::Element> elements;
 
-  path = getMapRootDirectory() + "/landscape/";
+  MapTileLoader::ReadResult res =
+    MapTileLoader::readMapFile( getMapRootDirectory(),
+                                fileSecID,
+                                fileTypeID,
+                                _globalMapMatrix->getProjection(),
+                                elements );
 
-  file.sprintf("%c_%.5d.kfl", fileTypeID, fileSecID);
-
-  QString pathName = path + file;
-
-  QFile mapfile(pathName);
-
-  if( !mapfile.open( QIODevice::ReadOnly ) )
+  if( res == MapTileLoader::FileMissing )
     {
-      qWarning() << "KFLog: Can not open map file" << pathName;
-
-      int answer = __askUserForDownload( tr("KFLog maps") );
-
-      if( answer == Automatic )
-        {
-          __downloadMapFile( file, path );
-        }
-
+      __handleMissingTileFile( fileSecID, fileTypeID );
       return false;
     }
 
-  QDataStream in( &mapfile );
-  in.setVersion( QDataStream::Qt_2_0 );
-
-  qint8 loadTypeID;
-  quint16 loadSecID, formatID;
-  quint32 magic;
-  QDateTime createDateTime;
-
-  in >> magic;
-
-  if( magic != KFLOG_FILE_MAGIC )
+  if( res != MapTileLoader::ReadOk )
     {
-      mapfile.close();
-
-      // We remove the wrong file to over come this dead lock by a new download
-      // of this file from the KFLog map room..
-      unlink( pathName.toLatin1().data() );
-
-      qWarning( "KFLog: %s Wrong magic key %x read! Abort loading...",
-                pathName.toLatin1().data(), magic );
-
       return false;
     }
 
-  in >> loadTypeID;
-
-  if( loadTypeID != fileTypeID ) // wrong type
-    {
-      mapfile.close();
-      qWarning("KFLog: %s Wrong load type identifier %x read! Abort loading...",
-                pathName.toLatin1().data(), loadTypeID );
+  __addMapElements( fileSecID, elements );
 
-      return false;
-    }
+  return true;
+}
 
-  in >> formatID;
+void MapContents::__handleMissingTileFile( const int fileSecID,
+                                           const char fileTypeID )
+{
+  QString path = getMapRootDirectory() + "/landscape/";
+  QString file = MapTileLoader::tileFileName( fileSecID, fileTypeID );
 
-  if( formatID < FILE_VERSION_MAP )
-    {
-      qWarning( "KFLog: File format too old! (version %d, expecting: %d)",
-                formatID, FILE_VERSION_MAP );
+  int answer = __askUserForDownload( tr("KFLog maps") );
 
-      return false;
-    }
-  else if( formatID > FILE_VERSION_MAP )
+  if( answer == Automatic )
     {
-      qWarning( "KFLog: File format too new! (version %d, expecting: %d)",
-                 formatID, FILE_VERSION_MAP );
-
-      return false;
+      __downloadMapFile( file, path );
     }
-
-  in >> loadSecID;
-
-  if( loadSecID != fileSecID )
+  else
     {
-      mapfile.close();
-
-      qWarning( "KFLog: %s: Wrong section, bogus file name! Arborting ...",
-                pathName.toLatin1().data() );
-
-      return false;
+      qDebug() << "Auto download is disabled! Bye";
     }
+}
 
-  in >> createDateTime;
-
-  qDebug( "Reading File=%s, Magic=0x%x, TypeId=%c, formatId=%d, Date=%s",
-           pathName.toLatin1().data(), magic, loadTypeID, formatID,
-           createDateTime.toString(Qt::ISODate).toLatin1().data() );
-
-  quint8 lm_typ;
-  qint8 sort, elev;
-  qint32 lat_temp, lon_temp;
-  quint32 locLength = 0;
-  QString name = "";
-
-  uint allElements = 0;
-
-  while( ! in.atEnd() )
+void MapContents::__addMapElements( const int fileSecID,
+                                    const QList<MapTileCache::Element>& elements )
+{
+  for( int i = 0; i < elements.size(); i++ )
     {
-      BaseMapElement::objectType typeIn = BaseMapElement::NotSelected;
-
-      in >> (quint8 &)typeIn;
+      const MapTileCache::Element& element = elements.at(i);
 
-      locLength = 0;
-      name = "";
-
-      QPolygon all;
-      QPoint single;
-
-      allElements++;
+      BaseMapElement::objectType typeIn = (BaseMapElement::objectType) element.type;
 
       switch (typeIn)
         {
         case BaseMapElement::Motorway:
-          READ_POINT_LIST
 
-          highwayList.append( LineElement("", typeIn, all, false, fileSecID) );
+          highwayList.append( LineElement("", typeIn, element.polygon, false, fileSecID) );
           break;
 
         case BaseMapElement::Road:
         case BaseMapElement::Trail:
-          READ_POINT_LIST
 
-          roadList.append( LineElement("", typeIn, all, false, fileSecID) );
+          roadList.append( LineElement("", typeIn, element.polygon, false, fileSecID) );
           break;
 
         case BaseMapElement::Aerial_Cable:
         case BaseMapElement::Railway:
         case BaseMapElement::Railway_D:
-          READ_POINT_LIST
 
-          railList.append( LineElement("", typeIn, all, false, fileSecID) );
+          railList.append( LineElement("", typeIn, element.polygon, false, fileSecID) );
           break;
 
-        case BaseMapElement::Canal:
         case BaseMapElement::River:
-        case BaseMapElement::River_T:
-
-          typeIn = BaseMapElement::River; //don't use different river types internally
-          in >> name;
-          READ_POINT_LIST
 
-          hydroList.append( LineElement(name, typeIn, all, false, fileSecID) );
+          hydroList.append( LineElement(element.name, typeIn, element.polygon, false, fileSecID) );
           break;
 
         case BaseMapElement::City:
-          in >> sort;
-          in >> name;
 
-          READ_POINT_LIST
-
-          cityList.append( LineElement(name, typeIn, all, sort, fileSecID) );
-          // qDebug("added city '%s'", name.toLatin1().data());
+          cityList.append( LineElement(element.name, typeIn, element.polygon, element.sort, fileSecID) );
           break;
 
         case BaseMapElement::Lake:
-        case BaseMapElement::Lake_T:
-
-          typeIn=BaseMapElement::Lake; // don't use different lake type internally
-          in >> sort;
-          in >> name;
 
-          READ_POINT_LIST
-
-          lakeList.append( LineElement(name, typeIn, all, sort, fileSecID) );
+          lakeList.append( LineElement(element.name, typeIn, element.polygon, element.sort, fileSecID) );
           break;
 
         case BaseMapElement::Forest:
         case BaseMapElement::Glacier:
         case BaseMapElement::PackIce:
-          in >> sort;
-          in >> name;
-
-          READ_POINT_LIST
 
-          topoList.append( LineElement(name, typeIn, all, sort, fileSecID) );
+          topoList.append( LineElement(element.name, typeIn, element.polygon, element.sort, fileSecID) );
           break;
 
         case BaseMapElement::Village:
 
-          in >> name;
-          in >> lat_temp;
-          in >> lon_temp;
-
-          single = _globalMapMatrix->wgsToMap(lat_temp, lon_temp);
-
-          villageList.append( SinglePoint(name, "",
-                                          typeIn,
-                                          WGSPoint(lat_temp, lon_temp),
-                                          single,
-                                          0.0,
-                                          "",
-                                          "",
-                                          fileSecID ));
-          // qDebug("added village '%s'", name.toLatin1().data());
+          villageList.append( SinglePoint( element.name,
+                                           "",
+                                           typeIn,
+                                           WGSPoint(element.latitude, element.longitude),
+                                           element.polygon.at(0),
+                                           0.0,
+                                           "",
+                                           "",
+                                           fileSecID ));
           break;
 
         case BaseMapElement::Spot:
 
-          in >> elev;
-          in >> lat_temp;
-          in >> lon_temp;
-
-          single = _globalMapMatrix->wgsToMap(lat_temp, lon_temp);
-
-          obstacleList.append( SinglePoint( "Spot",
+          obstacleList.append( SinglePoint( element.name,
                                             "",
                                             typeIn,
-                                            WGSPoint(lat_temp, lon_temp),
-                                           single,
-                                           0.0,
-                                           "",
-                                           "",
-                                           fileSecID));
+                                            WGSPoint(element.latitude, element.longitude),
+                                            element.polygon.at(0),
+                                            0.0,
+                                            "",
+                                            "",
+                                            fileSecID ));
           break;
 
         case BaseMapElement::Landmark:
 
-          in >> lm_typ;
-          in >> name;
-          in >> lat_temp;
-          in >> lon_temp;
-
-          single = _globalMapMatrix->wgsToMap(lat_temp, lon_temp);
-
-          landmarkList.append( SinglePoint( name,
+          landmarkList.append( SinglePoint( element.name,
                                             "",
                                             typeIn,
-                                            WGSPoint(lat_temp, lon_temp),
-                                            single,
+                                            WGSPoint(element.latitude, element.longitude),
+                                            element.polygon.at(0),
                                             0.0,
                                             "",
                                             "",
                                             fileSecID ));
-          // qDebug("added landmark '%s'", name.toLatin1().data());
           break;
 
         default:
 
-          qWarning ("MapContents::__readBinaryFile; Type not handled in switch: %d", typeIn);
+          qWarning ("MapContents::__addMapElements; Type not handled in switch: %d", typeIn);
           break;
         }
     }
 
-  mapfile.close();
+  m_tileMemory[fileSecID] += estimateTileMemory( elements, sizeof(LineElement) );
 
-  return true;
+  __invalidateListIndexes();
 }
 
 BaseFlightElement* MapContents::getFlight()
@@ -1499,6 +1357,10 @@ void MapContents::proofeSection(bool isPrint)
   char step, hasstep; // used as small integers
   TilePartMap::Iterator it;
 
+  // All tiles of the current view, they are protected against an eviction.
+  QSet<int> visibleTiles;
+  m_tileUseCounter++;
+
   for(int row = northCorner; row <= southCorner; row++)
     {
       for(int col = westCorner; col <= eastCorner; col++)
@@ -1508,6 +1370,9 @@ void MapContents::proofeSection(bool isPrint)
 
           if( secID >= 0 && secID <= MAX_TILE_NUMBER )
             {
+              visibleTiles.insert( secID );
+              m_tileLastUse.insert( secID, m_tileUseCounter );
+
               // a valid tile (2x2 degree area) must be in the range 0 ... 16200
               if (! tileSectionSet.contains(secID))
                 {
@@ -1526,90 +1391,131 @@ void MapContents::proofeSection(bool isPrint)
                       hasstep = it.value();
                     }
 
-                  //try loading the currently unloaded files
-                  if (!(hasstep & 1))
+                  if( ! isPrint )
+                    {
+                      // Load the missing files of the tile in the background.
+                      // The tile is published by slotTilesLoaded, when it
+                      // is ready.
+                      m_tileLoader->requestTile( secID,
+                                                 ~hasstep & TILE_PART_ALL,
+                                                 getMapRootDirectory(),
+                                                 _globalMapMatrix->getProjection() );
+                      continue;
+                    }
+
+                  // A print needs all data at once, try loading the
+                  // currently unloaded files here.
+                  if (!(hasstep & TILE_PART_GROUND))
                     {
                       if (__readTerrainFile(secID, FILE_TYPE_GROUND))
                         {
-                          step |= 1;
+                          step |= TILE_PART_GROUND;
                         }
                     }
 
-                  if (!(hasstep & 2))
+                  if (!(hasstep & TILE_PART_TERRAIN))
                     {
                       if (__readTerrainFile(secID, FILE_TYPE_TERRAIN))
                         {
-                          step |= 2;
+                          step |= TILE_PART_TERRAIN;
                         }
                     }
 
-                  if (!(hasstep & 4))
+                  if (!(hasstep & TILE_PART_MAP))
                     {
                       if (__readBinaryFile(secID, FILE_TYPE_MAP))
                         {
-                          step |= 4;
+                          step |= TILE_PART_MAP;
                         }
                     }
 
-                  if (step == 7) //set the correct flags for this map tile
-                    {
-                      tileSectionSet.insert(secID);  // add section id to set
-                      tilePartMap.remove(secID); // make sure we don't leave it as partly loaded
-                    }
-                  else
-                    {
-                      if (step > 0)
-                        {
-                          tilePartMap.insert(secID, step);
-                        }
-                    }
+                  __setTileParts( secID, hasstep | step );
                 }
             }
         }
     }
 
-  // Checking for Airspaces
-  if( loadAirspaces == true || airspaceList.isEmpty() )
+  if( ! isPrint )
+    {
+      // The map is redrawn after this call, so that no references to evicted
+      // elements are left. A print must keep the elements drawn on the screen.
+      __enforceTileMemoryLimit( visibleTiles );
+    }
+
+  // Checking for Airspaces. They are loaded in the background and
+  // published by slotAirspacesLoaded, the map is drawn meanwhile without
+  // them. A print can not be redrawn later, it waits for the airspaces.
+  if( isPrint )
+    {
+      // A load started before a reload delivers an outdated result.
+      __waitForAirspaces();
+    }
+
+  if( loadAirspaces == true && m_airspaceThread.isNull() )
     {
       loadAirspaces = false;
 
-      int res = AirspaceHelper::loadAirspaces( airspaceList );
+      // The loader thread must not use the configuration and the map matrix,
+      // it gets copies of the needed values.
+      m_airspaceThread =
+        new AirspaceHelperThread( getMapRootDirectory(),
+                                  _settings.value( "/Airspace/FileList",
+                                                   QStringList(QString("All")) ).toStringList(),
+                                  __projectionSnapshot(),
+                                  this );
 
-      if( res == 0 )
-        {
-          // No airspace files found, try to download any.
-          QTimer::singleShot(500, this, SLOT(slotGetOpenAipAirspaces()));
-        }
+      connect( m_airspaceThread, SIGNAL(loadedList( int, SortableAirspaceList* )),
+               this, SLOT(slotAirspacesLoaded( int, SortableAirspaceList* )) );
 
-      // finally, sort the airspaces
-      airspaceList.sort();
+      m_airspaceThread->start();
+    }
 
-      // Say the world that airspaces have been changed.
-      updateFlightAirspaceIntersections();
-      emit airspacesLoaded();
+  if( isPrint )
+    {
+      __waitForAirspaces();
     }
 
   // qDebug() << "MapContents::proofeSection() loadPoints=" << loadPoints;
 
-  // Checking for point data
-  if( loadPoints == true )
+  // Checking for point data. The openAIP points are loaded in the
+  // background like the airspaces, a print waits for them.
+  if( isPrint )
+    {
+      // A load started before a reload delivers an outdated result.
+      __waitForPoints();
+    }
+
+  if( loadPoints == true && m_poiThread.isNull() )
     {
       loadPoints = false;
 
+      m_listIndex[AirfieldList].invalidate();
+      m_listIndex[GliderfieldList].invalidate();
+      m_listIndex[OutLandingList].invalidate();
+      m_listIndex[NavaidList].invalidate();
+      m_listIndex[HotspotList].invalidate();
+
       int pointSource = _settings.value( "/Points/Source", KFLogConfig::OpenAIP ).toInt();
 
       if( pointSource == 0 )
         {
-          OpenAipPoiLoader poiLoader;
-          int res = poiLoader.load( airfieldList );
-          res += poiLoader.load( navaidList );
-          res += poiLoader.load( hotspotList );
-
-          if( res == 0 )
-            {
-              // No openAIP point data loaded, try to download any.
-              QTimer::singleShot(500, this, SLOT(slotGetOpenAipPoints()));
-            }
+          // The openAIP files are loaded in the background and published
+          // by slotOpenAipPointsLoaded. The loader gets copies of the
+          // configuration values and of the map projection.
+          OpenAipPoiLoader loader( getMapRootDirectory(),
+                                   _settings.value( "/Points/FileList",
+                                                    QStringList(QString("All")) ).toStringList(),
+                                   __projectionSnapshot(),
+                                   OpenAip::userFilterValues() );
+
+          m_poiThread = new OpenAipPoiLoaderThread( loader, this );
+
+          connect( m_poiThread,
+                   SIGNAL(loadedLists( int, QList<Airfield>*, QList<RadioPoint>*, QList<SinglePoint>* )),
+                   this,
+                   SLOT(slotOpenAipPointsLoaded( int, QList<Airfield>*, QList<RadioPoint>*, QList<SinglePoint>* )) );
+
+          m_poiThread->start();
         }
       else if( pointSource == 1 )
         {
@@ -1625,6 +1531,340 @@ void MapContents::proofeSection(bool isPrint)
             }
         }
     }
+
+  if( isPrint )
+    {
+      __waitForPoints();
+    }
+}
+
+QByteArray MapContents::__projectionSnapshot()
+{
+  QByteArray projection;
+  QDataStream out( &projection, QIODevice::WriteOnly );
+  SaveProjection( out, _globalMapMatrix->getProjection() );
+
+  return projection;
+}
+
+void MapContents::__waitForAirspaces()
+{
+  if( m_airspaceThread.isNull() )
+    {
+      return;
+    }
+
+  m_airspaceThread->wait();
+
+  // The result is passed via a queued connection, deliver it now.
+  QCoreApplication::sendPostedEvents( this, QEvent::MetaCall );
+}
+
+void MapContents::__waitForPoints()
+{
+  if( m_poiThread.isNull() )
+    {
+      return;
+    }
+
+  m_poiThread->wait();
+
+  // The result is passed via a queued connection, deliver it now.
+  QCoreApplication::sendPostedEvents( this, QEvent::MetaCall );
+}
+
+void MapContents::slotAirspacesLoaded( int loadedFiles, SortableAirspaceList* list )
+{
+  m_airspaceThread = 0;
+
+  if( loadAirspaces == true )
+    {
+      // A reload has been requested meanwhile, the result is outdated.
+      delete list;
+      emit contentsChanged();
+      return;
+    }
+
+  if( loadedFiles == 0 )
+    {
+      // No airspace files found, try to download any.
+      QTimer::singleShot(500, this, SLOT(slotGetOpenAipAirspaces()));
+    }
+
+  // The regions refer to the replaced airspaces.
+  airspaceRegionList.clear();
+
+  airspaceList.clear();
+  airspaceList.append( *list );
+  delete list;
+
+  // finally, sort the airspaces
+  airspaceList.sort();
+  m_airspaceGeneration++;
+  m_listIndex[AirspaceList].invalidate();
+
+  // Say the world that airspaces have been changed.
+  updateFlightAirspaceIntersections();
+  emit airspacesLoaded();
+  emit contentsChanged();
+}
+
+void MapContents::slotOpenAipPointsLoaded( int loadedFiles,
+                                           QList<Airfield>* airfields,
+                                           QList<RadioPoint>* navaids,
+                                           QList<SinglePoint>* hotspots )
+{
+  m_poiThread = 0;
+
+  if( loadPoints == false )
+    {
+      airfieldList += *airfields;
+      navaidList   += *navaids;
+      hotspotList  += *hotspots;
+
+      m_listIndex[AirfieldList].invalidate();
+      m_listIndex[NavaidList].invalidate();
+      m_listIndex[HotspotList].invalidate();
+
+      if( loadedFiles == 0 )
+        {
+          // No openAIP point data loaded, try to download any.
+          QTimer::singleShot(500, this, SLOT(slotGetOpenAipPoints()));
+        }
+    }
+
+  // Otherwise a reload has been requested meanwhile and the result is
+  // outdated.
+  delete airfields;
+  delete navaids;
+  delete hotspots;
+
+  emit contentsChanged();
+}
+
+void MapContents::__setTileParts( const int secID, const char parts )
+{
+  if( (parts & TILE_PART_ALL) == TILE_PART_ALL )
+    {
+      // set the correct flags for this map tile
+      tileSectionSet.insert(secID);  // add section id to set
+      tilePartMap.remove(secID); // make sure we don't leave it as partly loaded
+    }
+  else if( parts > 0 )
+    {
+      tilePartMap.insert(secID, parts);
+    }
+}
+
+void MapContents::slotTilesLoaded()
+{
+  QList<MapTileLoader::TileData *> tiles = m_tileLoader->takeResults();
+
+  bool changed = false;
+
+  for( int i = 0; i < tiles.size(); i++ )
+    {
+      MapTileLoader::TileData* tile = tiles.at(i);
+
+      const int secID = tile->secID;
+
+      // The tile could have been loaded meanwhile by a print request.
+      char hasstep = tileSectionSet.contains(secID) ?
+                     TILE_PART_ALL : tilePartMap.value(secID, 0);
+
+      char newParts = tile->loaded & ~hasstep;
+
+      if( newParts & TILE_PART_GROUND )
+        {
+          __addTerrainElements( secID, FILE_TYPE_GROUND, tile->ground );
+        }
+
+      if( newParts & TILE_PART_TERRAIN )
+        {
+          __addTerrainElements( secID, FILE_TYPE_TERRAIN, tile->terrain );
+        }
+
+      if( newParts & TILE_PART_MAP )
+        {
+          __addMapElements( secID, tile->map );
+        }
+
+      __setTileParts( secID, hasstep | newParts );
+
+      if( newParts != 0 )
+        {
+          changed = true;
+        }
+
+      // Missing files are requested from the download server.
+      if( tile->missing & TILE_PART_GROUND )
+        {
+          __handleMissingTileFile( secID, FILE_TYPE_GROUND );
+        }
+
+      if( tile->missing & TILE_PART_TERRAIN )
+        {
+          __handleMissingTileFile( secID, FILE_TYPE_TERRAIN );
+        }
+
+      if( tile->missing & TILE_PART_MAP )
+        {
+          __handleMissingTileFile( secID, FILE_TYPE_MAP );
+        }
+    }
+
+  qDeleteAll( tiles );
+
+  if( changed )
+    {
+      // Request a redraw of the map to show the new tiles.
+      emit contentsChanged();
+    }
+}
+
+qint64 MapContents::getTileMemoryUsage() const
+{
+  qint64 bytes = 0;
+
+  QHashIterator<int, qint64> it( m_tileMemory );
+
+  while( it.hasNext() )
+    {
+      it.next();
+      bytes += it.value();
+    }
+
+  return bytes;
+}
+
+QString MapContents::getTileMemoryReport() const
+{
+  int isoLines = 0;
+
+  QMapIterator<int, QList<Isohypse> > itg( groundMap );
+
+  while( itg.hasNext() )
+    {
+      itg.next();
+      isoLines += itg.value().size();
+    }
+
+  QMapIterator<int, QList<Isohypse> > itt( terrainMap );
+
+  while( itt.hasNext() )
+    {
+      itt.next();
+      isoLines += itt.value().size();
+    }
+
+  int lines = highwayList.size() + roadList.size() + railList.size() +
+              hydroList.size() + cityList.size() + lakeList.size() +
+              topoList.size();
+
+  int points = villageList.size() + obstacleList.size() + landmarkList.size();
+
+  QString report =
+    QString( "Map tiles: %1 loaded, %2 partially loaded, %3 pending; "
+             "isolines: %4, lines: %5, points: %6; "
+             "memory: %7 KB of %8 KB" )
+    .arg( tileSectionSet.size() )
+    .arg( tilePartMap.size() )
+    .arg( m_tileLoader->pendingTiles() )
+    .arg( isoLines )
+    .arg( lines )
+    .arg( points )
+    .arg( getTileMemoryUsage() / 1024 )
+    .arg( __tileMemoryLimit() / 1024 );
+
+  return report;
+}
+
+qint64 MapContents::__tileMemoryLimit() const
+{
+  // The limit is configured in MB, 0 disables the eviction of tiles.
+  return qint64( _settings.value( "/MapData/TileMemoryLimit", 256 ).toInt() ) * 1024 * 1024;
+}
+
+void MapContents::__enforceTileMemoryLimit( const QSet<int>& visibleTiles )
+{
+  const qint64 limit = __tileMemoryLimit();
+
+  qint64 usage = getTileMemoryUsage();
+
+  if( limit <= 0 || usage <= limit )
+    {
+      return;
+    }
+
+  // Sort the loaded tiles, which are not visible, by their last usage.
+  QMultiMap<uint, int> candidates;
+
+  QHashIterator<int, qint64> it( m_tileMemory );
+
+  while( it.hasNext() )
+    {
+      it.next();
+
+      if( ! visibleTiles.contains( it.key() ) )
+        {
+          candidates.insert( m_tileLastUse.value( it.key(), 0 ), it.key() );
+        }
+    }
+
+  QSet<int> victims;
+
+  QMapIterator<uint, int> itc( candidates );
+
+  while( itc.hasNext() && usage > limit )
+    {
+      itc.next();
+
+      const int secID = itc.value();
+
+      usage -= m_tileMemory.value( secID, 0 );
+      victims.insert( secID );
+    }
+
+  if( victims.isEmpty() )
+    {
+      return;
+    }
+
+  // Remove the tiles from all per tile containers in one pass.
+  QSetIterator<int> itv( victims );
+
+  while( itv.hasNext() )
+    {
+      const int secID = itv.next();
+
+      groundMap.remove( secID );
+      terrainMap.remove( secID );
+      __removeTerrainRasters( secID );
+      __removeElevationGrid( secID );
+      tileSectionSet.remove( secID );
+      tilePartMap.remove( secID );
+      m_tileMemory.remove( secID );
+      m_tileLastUse.remove( secID );
+    }
+
+  int removed = 0;
+
+  removed += removeTileElements( highwayList, victims );
+  removed += removeTileElements( roadList, victims );
+  removed += removeTileElements( railList, victims );
+  removed += removeTileElements( hydroList, victims );
+  removed += removeTileElements( cityList, victims );
+  removed += removeTileElements( lakeList, victims );
+  removed += removeTileElements( topoList, victims );
+  removed += removeTileElements( villageList, victims );
+  removed += removeTileElements( obstacleList, victims );
+  removed += removeTileElements( landmarkList, victims );
+
+  __invalidateListIndexes();
+
+  qDebug() << "MapContents: Evicted" << victims.size() << "map tiles with"
+           << removed << "map elements.";
+  qDebug() << getTileMemoryReport();
 }
 
 int MapContents::getListLength(int listIndex) const
@@ -1774,6 +2014,14 @@ void MapContents::slotReloadMapData()
 
   airspaceList.clear();
   airspaceRegionList.clear();
+  m_airspaceGeneration++;
+
+  // The flights refer to the cleared airspaces.
+  updateFlightAirspaceIntersections();
+  emit airspacesLoaded();
+
+  // The airspaces are projected, they must be loaded again.
+  loadAirspaces = true;
 
   airfieldList.clear();
   gliderfieldList.clear();
@@ -1795,10 +2043,19 @@ void MapContents::slotReloadMapData()
   // all isolines are cleared
   groundMap.clear();
   terrainMap.clear();
+  slotClearTerrainCache();
+  __removeElevationGrid( -1 );
+
+  // running tile loads are based on the old data, drop them
+  m_tileLoader->reset();
 
   // map tiles are cleared
   tileSectionSet.clear();
   tilePartMap.clear();
+  m_tileMemory.clear();
+  m_tileLastUse.clear();
+
+  __invalidateListIndexes();
 
   emit contentsChanged();
 }
@@ -1868,105 +2125,162 @@ void MapContents::printContents(QPainter* targetPainter, bool isText)
 
 void MapContents::drawList( QPainter* targetPainter,
                             unsigned int listID,
-                            QList<BaseMapElement *>& drawnElements )
+                            QList<BaseMapElement *>& drawnElements,
+                            QVector<int>* drawnIndexes )
 {
+  if( listID == FlightList )
+    {
+      // In some cases, getFlightIndex returns a non-valid index :-(
+      if (flightList.size() > 0 && getFlightIndex() >= 0 &&
+            getFlightIndex() < flightList.size() )
+          flightList.at(getFlightIndex())->drawMapElement(targetPainter);
+
+      return;
+    }
+
+  // Only the elements near to the visible map area are drawn.
+  const QVector<int> visible = getVisibleElements( listID );
+
   switch(listID)
     {
       case AirfieldList:
-        for (int i = 0; i < airfieldList.size(); i++)
-          airfieldList[i].drawMapElement(targetPainter);
+        for (int i = 0; i < visible.size(); i++)
+          {
+            if( airfieldList[visible[i]].drawMapElement(targetPainter) )
+              {
+                drawnElements.append( &airfieldList[visible[i]] );
+
+                if( drawnIndexes )
+                  {
+                    drawnIndexes->append( visible[i] );
+                  }
+              }
+          }
         break;
 
       case GliderfieldList:
-        for (int i = 0; i < gliderfieldList.size(); i++)
-          gliderfieldList[i].drawMapElement(targetPainter);
+        for (int i = 0; i < visible.size(); i++)
+          {
+            if( gliderfieldList[visible[i]].drawMapElement(targetPainter) )
+              {
+                drawnElements.append( &gliderfieldList[visible[i]] );
+
+                if( drawnIndexes )
+                  {
+                    drawnIndexes->append( visible[i] );
+                  }
+              }
+          }
         break;
 
       case OutLandingList:
-        for (int i = 0; i < outLandingList.size(); i++)
-          outLandingList[i].drawMapElement(targetPainter);
+        for (int i = 0; i < visible.size(); i++)
+          {
+            if( outLandingList[visible[i]].drawMapElement(targetPainter) )
+              {
+                drawnElements.append( &outLandingList[visible[i]] );
+
+                if( drawnIndexes )
+                  {
+                    drawnIndexes->append( visible[i] );
+                  }
+              }
+          }
         break;
 
       case NavaidList:
-        for (int i = 0; i < navaidList.size(); i++)
-          navaidList[i].drawMapElement(targetPainter);
+        for (int i = 0; i < visible.size(); i++)
+          {
+            if( navaidList[visible[i]].drawMapElement(targetPainter) )
+              {
+                drawnElements.append( &navaidList[visible[i]] );
+
+                if( drawnIndexes )
+                  {
+                    drawnIndexes->append( visible[i] );
+                  }
+              }
+          }
         break;
 
       case HotspotList:
-        for (int i = 0; i < hotspotList.size(); i++)
-          hotspotList[i].drawMapElement(targetPainter);
+        for (int i = 0; i < visible.size(); i++)
+          {
+            if( hotspotList[visible[i]].drawMapElement(targetPainter) )
+              {
+                drawnElements.append( &hotspotList[visible[i]] );
+
+                if( drawnIndexes )
+                  {
+                    drawnIndexes->append( visible[i] );
+                  }
+              }
+          }
         break;
 
       case AirspaceList:
-        for (int i = 0; i < airspaceList.size(); i++)
-          airspaceList[i].drawMapElement(targetPainter);
+        for (int i = 0; i < visible.size(); i++)
+          airspaceList[visible[i]].drawMapElement(targetPainter);
         break;
 
       case ObstacleList:
-        for (int i = 0; i < obstacleList.size(); i++)
-          obstacleList[i].drawMapElement(targetPainter);
+        for (int i = 0; i < visible.size(); i++)
+          obstacleList[visible[i]].drawMapElement(targetPainter);
         break;
 
       case ReportList:
-        for (int i = 0; i < reportList.size(); i++)
-          reportList[i].drawMapElement(targetPainter);
+        for (int i = 0; i < visible.size(); i++)
+          reportList[visible[i]].drawMapElement(targetPainter);
         break;
 
       case CityList:
-        for (int i = 0; i < cityList.size(); i++)
+        for (int i = 0; i < visible.size(); i++)
           {
-           if( cityList[i].drawMapElement(targetPainter) )
+           if( cityList[visible[i]].drawMapElement(targetPainter) )
              {
-               drawnElements.append( &cityList[i] );
+               drawnElements.append( &cityList[visible[i]] );
              }
           }
         break;
 
       case VillageList:
-        for (int i = 0; i < villageList.size(); i++)
-          villageList[i].drawMapElement(targetPainter);
+        for (int i = 0; i < visible.size(); i++)
+          villageList[visible[i]].drawMapElement(targetPainter);
         break;
 
       case LandmarkList:
-        for (int i = 0; i < landmarkList.size(); i++)
-          landmarkList[i].drawMapElement(targetPainter);
+        for (int i = 0; i < visible.size(); i++)
+          landmarkList[visible[i]].drawMapElement(targetPainter);
         break;
 
       case HighwayList:
-        for (int i = 0; i < highwayList.size(); i++)
-          highwayList[i].drawMapElement(targetPainter);
+        for (int i = 0; i < visible.size(); i++)
+          highwayList[visible[i]].drawMapElement(targetPainter);
         break;
 
       case RoadList:
-        for (int i = 0; i < roadList.size(); i++)
-          roadList[i].drawMapElement(targetPainter);
+        for (int i = 0; i < visible.size(); i++)
+          roadList[visible[i]].drawMapElement(targetPainter);
         break;
 
       case RailList:
-        for (int i = 0; i < railList.size(); i++)
-          railList[i].drawMapElement(targetPainter);
+        for (int i = 0; i < visible.size(); i++)
+          railList[visible[i]].drawMapElement(targetPainter);
         break;
 
       case HydroList:
-        for (int i = 0; i < hydroList.size(); i++)
-          hydroList[i].drawMapElement(targetPainter);
+        for (int i = 0; i < visible.size(); i++)
+          hydroList[visible[i]].drawMapElement(targetPainter);
         break;
 
       case LakeList:
-        for (int i = 0; i < lakeList.size(); i++)
-          lakeList[i].drawMapElement(targetPainter);
+        for (int i = 0; i < visible.size(); i++)
+          lakeList[visible[i]].drawMapElement(targetPainter);
         break;
 
       case TopoList:
-        for (int i = 0; i < topoList.size(); i++)
-          topoList[i].drawMapElement(targetPainter);
-        break;
-
-      case FlightList:
-        // In some cases, getFlightIndex returns a non-valid index :-(
-        if (flightList.size() > 0 && getFlightIndex() >= 0 &&
-              getFlightIndex() < flightList.size() )
-            flightList.at(getFlightIndex())->drawMapElement(targetPainter);
+        for (int i = 0; i < visible.size(); i++)
+          topoList[visible[i]].drawMapElement(targetPainter);
         break;
 
       default:
@@ -1975,6 +2289,45 @@ void MapContents::drawList( QPainter* targetPainter,
     }
 }
 
+QVector<int> MapContents::getVisibleElements( const int listID )
+{
+  extern MapMatrix *_globalMapMatrix;
+
+  if( listID <= NotSet || listID >= WaypointList )
+    {
+      return QVector<int>();
+    }
+
+  const int count = getListLength( listID );
+
+  MapElementIndex& index = m_listIndex[listID];
+
+  if( ! index.isValid( count ) )
+    {
+      // (Re)build the index from the projected bounding boxes.
+      QVector<QRect> boxes( count );
+
+      for( int i = 0; i < count; i++ )
+        {
+          boxes[i] = getElement( listID, i )->getBoundingBox();
+        }
+
+      index.build( boxes );
+    }
+
+  // The elements check their visibility against the map border, so we use
+  // the same area for the query.
+  return index.query( _globalMapMatrix->getMapBorder() );
+}
+
+void MapContents::__invalidateListIndexes()
+{
+  for( int i = 0; i < WaypointList; i++ )
+    {
+      m_listIndex[i].invalidate();
+    }
+}
+
 void MapContents::drawIsoList( QPainter* targetP, QRect windowRect )
 {
   // qDebug() << "MapContents::drawIsoList():";
@@ -1983,24 +2336,46 @@ void MapContents::drawIsoList( QPainter* targetP, QRect windowRect )
   t.start();
 
   extern MapConfig* _globalMapConfig;
+  extern MapMatrix* _globalMapMatrix;
+
+  const QTransform& wm = _globalMapMatrix->getWorldMatrix();
+
+  // Split the world matrix into its rotation/scale part and into its
+  // translation part. The rasters of the tiles depend only on the first one,
+  // a pan of the map changes only the translation.
+  const QTransform rotScale( wm.m11(), wm.m12(), wm.m21(), wm.m22(), 0, 0 );
+  const QPoint translation( qRound( wm.dx() ), qRound( wm.dy() ) );
+
+  // The rotation of the Lambert projection changes slightly with the map
+  // center. Small changes are ignored for the raster reuse.
+  const QString matrixKey =
+    QString( "%1_%2" ).arg( _globalMapMatrix->getScale(), 0, 'g', 10 )
+                      .arg( qRound( atan2( wm.m12(), wm.m11() ) * 10000.0 ) );
+
+  QRect viewBorder = _globalMapMatrix->getViewBorder();
 
-  _lastIsoEntry = 0;
-  _isoLevelReset = true;
-  pathIsoLines.clear();
+  // The rasters cover only the part of a tile near to the visible map
+  // area, so that their size depends on the window and not on the scale.
+  // The margin allows small pans without rendering the rasters again.
+  const QRect view = windowRect.translated( -translation );
 
-  int count = 2; // draw only the ground
+  const QRect rasterClip = view.adjusted( -view.width() / 4, -view.height() / 4,
+                                          view.width() / 4, view.height() / 4 );
 
-  bool drawTerrain = false; // Could be switched off
+  // The cache must hold the rasters of both layers for the whole window
+  // and the rasters of the previous scale.
+  const qint64 viewBytes = 4 * qint64( rasterClip.width() ) * qint64( rasterClip.height() );
 
-  // shall we draw the terrain too?
-  if( drawTerrain )
+  if( 4 * viewBytes > m_isoRasterCache.maxCost() )
     {
-      count++; // yes
+      m_isoRasterCache.setMaxCost( int( qMin( qint64( INT_MAX ), 4 * viewBytes ) ) );
     }
 
   QMap< int, QList<Isohypse> >* isoMaps[2] = { &groundMap, &terrainMap };
 
-  for( int i = 0; i < count; i++ )
+  targetP->setClipRegion( windowRect );
+
+  for( int i = 0; i < 2; i++ )
     {
       // assign the map to be drawn to the iterator
       QMapIterator<int, QList<Isohypse> > it(*isoMaps[i]);
@@ -2011,51 +2386,156 @@ void MapContents::drawIsoList( QPainter* targetP, QRect windowRect )
           // The isoline list contains all isolines of a tile in ascending order.
           it.next();
 
+          if( ! getTileBox(it.key()).intersects(viewBorder) )
+            {
+              continue;
+            }
+
           const QList<Isohypse> &isoList = it.value();
 
-          for (int i = 0; i < isoList.size(); i++)
+          // Draw the tile from the raster cache, if possible.
+          const QString key = QString( "%1_%2_%3" ).arg( it.key() ).arg( i ).arg( matrixKey );
+
+          IsoRaster* raster = m_isoRasterCache.object( key );
+
+          if( raster != 0 )
             {
-              Isohypse isoLine = isoList.at(i);
-
-              // Choose contour color.
-              // The index of the isoList has a fixed relation to the isocolor list
-              // normally with an offset of one.
-              int colorIdx = isoLine.getElevationIndex();
-
-              targetP->setPen(QPen(_globalMapConfig->getIsoColor(colorIdx), 1, Qt::SolidLine));
-              targetP->setBrush(QBrush(_globalMapConfig->getIsoColor(colorIdx), Qt::SolidPattern));
-
-              // draw the single isoline
-              QPainterPath* Path = isoLine.drawRegion( targetP,
-                                                       windowRect,
-                                                       true,
-                                                       false );
-              if( Path )
+              const QRect visible = raster->tileArea.intersected( view );
+
+              if( visible.isEmpty() )
                 {
-                  // store drawn path in extra list for elevation finding
-                  IsoListEntry entry( Path, isoLine.getElevation() );
-                  pathIsoLines.append( entry );
-                  //qDebug("  added Iso: %04x, %d", (int)reg, iso2.getElevation() );
+                  continue;
                 }
+
+              if( QRect( raster->origin, raster->image.size() ).contains( visible ) )
+                {
+                  targetP->drawImage( raster->origin + translation, raster->image );
+                  continue;
+                }
+
+              // The map was moved out of the rendered part of the tile.
+              m_isoRasterCache.remove( key );
+            }
+
+          raster = __renderIsoTile( isoList, rotScale, rasterClip );
+
+          if( raster == 0 )
+            {
+              // The raster would be too large, draw the isolines directly.
+              for (int j = 0; j < isoList.size(); j++)
+                {
+                  const Isohypse& isoLine = isoList.at(j);
+
+                  int colorIdx = isoLine.getElevationIndex();
+
+                  targetP->setPen(QPen(_globalMapConfig->getIsoColor(colorIdx), 1, Qt::SolidLine));
+                  targetP->setBrush(QBrush(_globalMapConfig->getIsoColor(colorIdx), Qt::SolidPattern));
+                  targetP->drawPolygon( _globalMapMatrix->map( isoLine.getProjectedPolygon() ) );
+                }
+
+              continue;
+            }
+
+          if( ! raster->image.isNull() )
+            {
+              targetP->drawImage( raster->origin + translation, raster->image );
             }
+
+          // The cache takes the ownership of the raster.
+          m_isoRasterCache.insert( key, raster, raster->image.byteCount() );
         }
     }
 
-  pathIsoLines.sort();
-  _isoLevelReset = false;
-
   // qDebug( "IsoList, drawTime=%dms", t.elapsed() );
+}
 
-#if 0
-  QString isos;
+MapContents::IsoRaster* MapContents::__renderIsoTile( const QList<Isohypse>& isoList,
+                                                      const QTransform& rotScale,
+                                                      const QRect& clip )
+{
+  extern MapConfig* _globalMapConfig;
 
-  for ( int l = 0; l < pathIsoLines.count(); l++ )
+  if( isoList.isEmpty() )
     {
-      isos += QString("%1, ").arg(pathIsoLines.at(l).height);
+      return static_cast<IsoRaster *> (0);
     }
 
-  qDebug( isos.toLatin1().data() );
-#endif
+  QRect box;
+
+  for( int i = 0; i < isoList.size(); i++ )
+    {
+      box = box.united( isoList.at(i).getBoundingBox() );
+    }
+
+  // Tile area in widget coordinates without translation.
+  const QRect tileArea = rotScale.mapRect( box ).adjusted( -1, -1, 1, 1 );
+
+  // Only the part near to the window is rendered.
+  const QRect area = tileArea.intersected( clip );
+
+  if( qint64( area.width() ) * qint64( area.height() ) > ISO_RASTER_MAX_PIXELS )
+    {
+      return static_cast<IsoRaster *> (0);
+    }
+
+  IsoRaster* raster = new IsoRaster;
+  raster->tileArea = tileArea;
+  raster->origin = area.topLeft();
+
+  if( area.isEmpty() )
+    {
+      // Nothing of the tile is near to the window, keep an empty raster.
+      return raster;
+    }
+
+  raster->image  = QImage( area.size(), QImage::Format_ARGB32_Premultiplied );
+  raster->image.fill( 0 );
+
+  QPainter painter( &raster->image );
+
+  for( int i = 0; i < isoList.size(); i++ )
+    {
+      const Isohypse& isoLine = isoList.at(i);
+
+      // Choose contour color.
+      // The index of the isoList has a fixed relation to the isocolor list
+      // normally with an offset of one.
+      int colorIdx = isoLine.getElevationIndex();
+
+      painter.setPen(QPen(_globalMapConfig->getIsoColor(colorIdx), 1, Qt::SolidLine));
+      painter.setBrush(QBrush(_globalMapConfig->getIsoColor(colorIdx), Qt::SolidPattern));
+
+      // The same rounding as done by MapMatrix::map, so that the raster is
+      // identical to a direct drawing.
+      QPolygon mP = rotScale.map( isoLine.getProjectedPolygon() );
+      mP.translate( -raster->origin );
+
+      painter.drawPolygon( mP );
+    }
+
+  painter.end();
+
+  return raster;
+}
+
+void MapContents::slotClearTerrainCache()
+{
+  m_isoRasterCache.clear();
+}
+
+void MapContents::__removeTerrainRasters( const int secID )
+{
+  const QString prefix = QString( "%1_" ).arg( secID );
+
+  QList<QString> keys = m_isoRasterCache.keys();
+
+  for( int i = 0; i < keys.size(); i++ )
+    {
+      if( keys.at(i).startsWith( prefix ) )
+        {
+          m_isoRasterCache.remove( keys.at(i) );
+        }
+    }
 }
 
 void MapContents::addDir (QStringList& list, const QString& _path, const QString& filter)
@@ -2450,6 +2930,9 @@ void MapContents::reProject()
 {
   BaseFlightElement *flight;
 
+  // The spatial indexes are based on projected coordinates.
+  __invalidateListIndexes();
+
   foreach(flight, flightList)
     {
       flight->reProject();
@@ -2477,70 +2960,41 @@ void MapContents::updateFlightAirspaceIntersections()
 }
 
 /** coorMap coordinates are expected as map based!. */
-int MapContents::getElevation( const QPoint& coordMap, Distance* errorDist )
+int MapContents::getElevation( const QPoint& coordMap, Distance* errorDist ) const
 {
-  const IsoListEntry* entry = 0;
   int height = -1;
   double error = 0.0;
 
-  // Use this only if input coordinate are WGS84 based
-  //QPoint coordP1 = _globalMapMatrix->wgsToMap(coordP.x(), coordP.y());
-  //QPoint coord   = _globalMapMatrix->map(coordP1);
-
-  QPoint coord = coordMap;
+  QReadLocker locker( &m_elevationLock );
 
-  IsoList* list = getIsohypseRegions();
+  QHashIterator<int, ElevationGrid *> it( m_elevationGrids );
 
-  if (_isoLevelReset)
+  while( it.hasNext() )
     {
-      qDebug("findElevation: Busy rebuilding the isomap. Returning last known result...");
-      return _lastIsoLevel;
-    }
-
-  int cnt = list->count();
+      it.next();
 
-  for ( int i=0; i<cnt; i++ )
-    {
-      entry = &(list->at(i));
-      // qDebug("i: %d entry->height %d contains %d",i,entry->height, entry->path->contains(coord) );
-      // qDebug("Point x:%d y:%d", coord.x(), coord.y() );
-      // qDebug("boundingRect l:%d r:%d t:%d b:%d", entry->path->boundingRect().left(),
-      //                                 entry->path->boundingRect().right(),
-      //                                 entry->path->boundingRect().top(),
-      //                                 entry->path->boundingRect().bottom() );
+      const ElevationGrid* grid = it.value();
 
-      if (entry->height > height && /*there is no reason to search a lower level if we already have a hit on a higher one*/
-          entry->height <= _nextIsoLevel) /* since the odds of skipping a level between two fixes are not too high, we can ignore higher levels, making searching more efficient.*/
+      if( ! grid->bounds().contains( coordMap ) )
         {
-          if (entry->height == _lastIsoLevel && _lastIsoEntry)
-            {
-              //qDebug("Trying previous entry...");
-              if (_lastIsoEntry->path->contains(coord))
-                {
-                  height = qMax(height, entry->height);
-                  //qDebug("Found on height %d",entry->height);
-                  break;
-                }
-            }
-
-          if (entry == _lastIsoEntry)
-            {
-              continue; //we already tried this one, and it wasn't it.
-            }
+          continue;
+        }
 
-          //qDebug("Probing on height %d...", entry->height);
+      // The bounds of neighbouring tiles overlap a little bit. Outside of
+      // its tile a grid has no data.
+      int h = errorDist ? grid->level( coordMap ) : grid->elevation( coordMap );
 
-          if (entry->path->contains(coord))
-            {
-              height = qMax(height,entry->height);
-              //qDebug("Found on height %d",entry->height);
-              _lastIsoEntry = entry;
-              break;
-            }
+      if( h != -1 )
+        {
+          height = h;
+          break;
         }
     }
 
-  _lastIsoLevel = height;
+  if( height == -1 )
+    {
+      return -1;
+    }
 
   // if errorDist is set, set the correct error margin and correct height.
   if(errorDist)
@@ -2549,25 +3003,21 @@ int MapContents::getElevation( const QPoint& coordMap, Distance* errorDist )
       // isolevel, therefore reduce error by taking the middle
       if ( height <100 )
         {
-          _nextIsoLevel = height+25;
           height += 12;
           error=12.5;
         }
       else if ( (height >=100) && (height < 500) )
         {
-          _nextIsoLevel = height+50;
           height += 25;
           error=25.0;
         }
       else if ( (height >=500) && (height < 1000) )
         {
-          _nextIsoLevel = height+100;
           height += 50;
           error=50.0;
         }
       else
         {
-          _nextIsoLevel = height+250;
           height += 125;
           error = 125.0;
         }
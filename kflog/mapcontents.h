@@ -34,7 +34,11 @@
 #define MAP_CONTENTS_H
 
 #include <QBitArray>
+#include <QByteArray>
+#include <QCache>
 #include <QFile>
+#include <QHash>
+#include <QImage>
 #include <QList>
 #include <QObject>
 #include <QMap>
@@ -42,14 +46,19 @@
 #include <QPainterPath>
 #include <QPair>
 #include <QPoint>
+#include <QPointer>
+#include <QReadWriteLock>
 #include <QRect>
 #include <QSet>
+#include <QTransform>
 
 #include "airfield.h"
 #include "airspace.h"
 #include "downloadmanager.h"
 #include "flighttask.h"
-#include "isolist.h"
+#include "elevationgrid.h"
+#include "mapelementindex.h"
+#include "maptilecache.h"
 #include "radiopoint.h"
 #include "singlepoint.h"
 
@@ -58,6 +67,9 @@ class Flight;
 class FlightGroup;
 class Isohypse;
 class LineElement;
+class AirspaceHelperThread;
+class MapTileLoader;
+class OpenAipPoiLoaderThread;
 
 // number of isoline levels
 #define ISO_LINE_LEVELS 51
@@ -123,7 +135,9 @@ class MapContents : public QObject
 
   /**
    * Proofs, which map sections are needed to draw the map and loads
-   * the missing sections.
+   * the missing sections. For the screen the sections are loaded in the
+   * background and published by \ref slotTilesLoaded. A print loads all
+   * missing sections immediately.
    *
    * @param  isPrint  "true", if the map should be printed.
    */
@@ -153,6 +167,15 @@ class MapContents : public QObject
     return airspaceList;
   };
 
+  /**
+   * \return The generation of the airspace list. It is incremented, when the
+   *         list is cleared or replaced.
+   */
+  uint getAirspaceGeneration() const
+  {
+    return m_airspaceGeneration;
+  };
+
   /**
    * \return The airspace region list.
    */
@@ -196,11 +219,24 @@ class MapContents : public QObject
    *
    * @param  targetP  The painter to draw the elements into
    * @param  listID  The index of the list to be drawn
-   * @param  drawnElements A list of drawn elements
+   * @param  drawnElements A list of drawn elements, filled by the city
+   *                       list and the lists of point elements
+   * @param  drawnIndexes If not null, filled with the list indexes of the
+   *                      drawn point elements
    */
   void drawList( QPainter* targetPainter,
                  unsigned int listID,
-                 QList<BaseMapElement *>& drawnElements );
+                 QList<BaseMapElement *>& drawnElements,
+                 QVector<int>* drawnIndexes = 0 );
+
+  /**
+   * Returns the elements of a list, which are near to the visible map
+   * area. The spatial index of the list is rebuilt, if it is outdated.
+   *
+   * @param  listID  The index of the list
+   * @return The ascending sorted list indexes of the elements
+   */
+  QVector<int> getVisibleElements( const int listID );
 
   /**
    * Draws all isohypses into the given painter
@@ -299,21 +335,20 @@ class MapContents : public QObject
   /** Checks if a task name is already in use or not. */
   bool taskNameInUse( QString name );
 
-  /** \return The list of IsoHypse Regions. */
-  IsoList* getIsohypseRegions()
-  {
-    return &pathIsoLines;
-  };
   /**
-   * Find the terrain elevation for the given point.
+   * Find the terrain elevation for the given point. The elevation is taken
+   * from the elevation grids of the loaded map tiles. The method can be
+   * called from any thread.
    *
    * \param coordMap The map coordinates of the point.
    *
-   * \param errorDist Distance error value in meters
+   * \param errorDist Distance error value in meters. If set, the elevation
+   *        is the middle of the found isoline level and the next one,
+   *        otherwise it is interpolated between the neighbouring grid cells.
    *
    * \returns The elevation in meters or -1 if the elevation could not be found.
    */
-  int getElevation(const QPoint& coordMap, Distance* errorDist);
+  int getElevation(const QPoint& coordMap, Distance* errorDist) const;
 
   /**
    * this function serves as a substitute for the not existing
@@ -348,6 +383,16 @@ class MapContents : public QObject
    */
   QString getMapRootDirectory();
 
+  /**
+   * \return The estimated memory in bytes used by all loaded map tiles.
+   */
+  qint64 getTileMemoryUsage() const;
+
+  /**
+   * \return A report about the loaded map tiles and their memory usage.
+   */
+  QString getTileMemoryReport() const;
+
   public slots:
   /**
    * Close current flight
@@ -425,8 +470,20 @@ class MapContents : public QObject
    */
   void slotCheckWelt20004Update();
 
+  /**
+   * Removes all cached terrain rasters. Must be called, if the terrain
+   * colors are changed.
+   */
+  void slotClearTerrainCache();
+
  private slots:
 
+  /**
+   * Called, if the tile loader has finished map tiles. The tiles are
+   * taken over into the element lists and a map redraw is requested.
+   */
+  void slotTilesLoaded();
+
   /** Called, if all downloads are finished. */
   void slotDownloadsFinished( int requests, int errors );
 
@@ -464,6 +521,21 @@ class MapContents : public QObject
    */
   void slotGetOpenAipAirspaces();
 
+  /**
+   * Called, if the airspace loader thread has finished. The loaded airspaces
+   * replace the current ones. The list is deleted here.
+   */
+  void slotAirspacesLoaded( int loadedFiles, SortableAirspaceList* list );
+
+  /**
+   * Called, if the openAIP point loader thread has finished. The loaded
+   * points are appended to the point lists. The lists are deleted here.
+   */
+  void slotOpenAipPointsLoaded( int loadedFiles,
+                                QList<Airfield>* airfields,
+                                QList<RadioPoint>* navaids,
+                                QList<SinglePoint>* hotspots );
+
  signals:
   /**
    * emitted during map loading to display a message f.e. in the
@@ -559,6 +631,134 @@ class MapContents : public QObject
    */
   bool __readTerrainFile(const int fileSecID, const int fileTypeID);
 
+  /**
+   * Creates isohypses from the projected isolines of a ground or terrain
+   * file and stores them in the related isomap.
+   *
+   * @param  fileSecID  The sectionID of the mapfile
+   * @param  fileTypeID  The typeID of the mapfile ("G" or "T")
+   * @param  elements  The projected isolines of the file
+   */
+  void __addTerrainElements( const int fileSecID,
+                             const int fileTypeID,
+                             const QList<MapTileCache::Element>& elements );
+
+  /**
+   * Creates the map elements from the projected elements of a map file and
+   * appends them to the related element lists.
+   *
+   * @param  fileSecID  The sectionID of the mapfile
+   * @param  elements  The projected elements of the file
+   */
+  void __addMapElements( const int fileSecID,
+                         const QList<MapTileCache::Element>& elements );
+
+  /**
+   * Enters the isolines of a ground or terrain file into the elevation grid
+   * of the tile. The grid is created, if it does not exist.
+   *
+   * @param  fileSecID  The sectionID of the mapfile
+   * @param  elements  The projected isolines of the file
+   */
+  void __addElevationGrid( const int fileSecID,
+                           const QList<MapTileCache::Element>& elements );
+
+  /**
+   * Removes the elevation grid of a tile.
+   *
+   * @param  secID  The sectionID of the tile, -1 removes all grids
+   */
+  void __removeElevationGrid( const int secID );
+
+  /**
+   * Returns a copy of the current map projection, stored by SaveProjection.
+   * The loader threads must not access the map matrix.
+   */
+  QByteArray __projectionSnapshot();
+
+  /**
+   * Waits for a running airspace load and takes over its result.
+   */
+  void __waitForAirspaces();
+
+  /**
+   * Waits for a running openAIP point load and takes over its result.
+   */
+  void __waitForPoints();
+
+  /**
+   * Asks the user for the download of a missing map tile file and starts
+   * the download, if allowed.
+   *
+   * @param  fileSecID  The sectionID of the mapfile
+   * @param  fileTypeID  The typeID of the mapfile
+   */
+  void __handleMissingTileFile( const int fileSecID, const char fileTypeID );
+
+  /**
+   * Updates the load state of a map tile.
+   *
+   * @param  secID  The sectionID of the tile
+   * @param  parts  The loaded parts of the tile as bit mask
+   */
+  void __setTileParts( const int secID, const char parts );
+
+  /**
+   * \return The configured memory limit in bytes for the loaded map tiles.
+   */
+  qint64 __tileMemoryLimit() const;
+
+  /**
+   * Evicts the least recently used map tiles from all per tile containers,
+   * until the memory usage of the tiles is below the configured limit.
+   *
+   * @param  visibleTiles  The tiles of the current view, they are never
+   *                       evicted.
+   */
+  void __enforceTileMemoryLimit( const QSet<int>& visibleTiles );
+
+  /**
+   * Marks the spatial indexes of all element lists as outdated.
+   */
+  void __invalidateListIndexes();
+
+  /**
+   * The rendered isolines of a terrain tile.
+   */
+  class IsoRaster
+  {
+   public:
+
+    /** The filled isolines of the rendered part of the tile. */
+    QImage image;
+
+    /** Position of the image in the map without the map translation. */
+    QPoint origin;
+
+    /** Area of the whole tile in the map without the map translation. */
+    QRect tileArea;
+  };
+
+  /**
+   * Renders the isolines of a tile into a raster.
+   *
+   * @param  isoList  The isolines of the tile
+   * @param  rotScale  The rotation and scaling part of the map matrix
+   * @param  clip  The part of the map to be rendered without the map
+   *               translation
+   * @return The new raster or 0, if the raster would be too large
+   */
+  IsoRaster* __renderIsoTile( const QList<Isohypse>& isoList,
+                              const QTransform& rotScale,
+                              const QRect& clip );
+
+  /**
+   * Removes the cached rasters of a tile.
+   *
+   * @param  secID  The sectionID of the tile
+   */
+  void __removeTerrainRasters( const int secID );
+
   /**
    * Returns the GUI language as two letter country code or ??
    * if no language could be found.
@@ -702,6 +902,27 @@ class MapContents : public QObject
   typedef QMap<int, char> TilePartMap;
   TilePartMap tilePartMap;
 
+  /**
+   * Estimated memory usage in bytes of all loaded map tiles. The tile
+   * section identifier is the key.
+   */
+  QHash<int, qint64> m_tileMemory;
+
+  /**
+   * Value of the usage counter at the last time, when a map tile was part
+   * of the view. Used for the LRU eviction of map tiles.
+   */
+  QHash<int, uint> m_tileLastUse;
+
+  /** Counter, incremented on every section check. */
+  uint m_tileUseCounter;
+
+  /**
+   * Spatial indexes of the map element lists over the projected bounding
+   * boxes. The list identifier is the array index.
+   */
+  MapElementIndex m_listIndex[WaypointList];
+
   /** */
   QString mapDir;
 
@@ -722,18 +943,24 @@ class MapContents : public QObject
   bool loadAirspaces;
 
   /**
-   * List of all drawn isohypses.
+   * Generation of the airspace list, incremented by every change.
    */
-  IsoList pathIsoLines;
+  uint m_airspaceGeneration;
 
   /**
-   * Elevation where the next search for the current elevation will start.
-   * Set to one level higher than the current level by findElevation().
+   * Elevation grids of the loaded map tiles, used for the elevation lookup.
+   * The tile section identifier is the key.
    */
-  int _nextIsoLevel;
-  int _lastIsoLevel;
-  bool _isoLevelReset;
-  const IsoListEntry* _lastIsoEntry;
+  QHash<int, ElevationGrid *> m_elevationGrids;
+
+  /** Protects the elevation grids against changes during a lookup. */
+  mutable QReadWriteLock m_elevationLock;
+
+  /**
+   * Cache of the rendered terrain tiles. The key is made from the tile
+   * section identifier, the isoline map and the map scale and rotation.
+   */
+  QCache<QString, IsoRaster> m_isoRasterCache;
 
   /**
    * Array containing the used elevation levels in meters. Is used as help
@@ -764,6 +991,15 @@ class MapContents : public QObject
    */
   bool __downloadMapFile( QString &file, QString &directory );
 
+  /** Loader of map tiles running in the background. */
+  MapTileLoader *m_tileLoader;
+
+  /** Loader of the airspace files, while it is running. */
+  QPointer<AirspaceHelperThread> m_airspaceThread;
+
+  /** Loader of the openAIP point files, while it is running. */
+  QPointer<OpenAipPoiLoaderThread> m_poiThread;
+
   /** Manager to handle downloads of missing map file. */
   DownloadManager *m_downloadManger;
 
@@ -0,0 +1,166 @@
+/***********************************************************************
+**
+**   mapelementindex.cpp
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <cmath>
+
+#include <QtCore>
+
+#include "mapelementindex.h"
+
+// Maximum number of buckets per grid edge
+#define MAX_GRID_CELLS 512
+
+// Elements covering more buckets are stored in the large element list
+#define MAX_ELEMENT_CELLS 64
+
+MapElementIndex::MapElementIndex() :
+  m_cellSize(1),
+  m_cols(0),
+  m_rows(0),
+  m_count(0),
+  m_valid(false)
+{
+}
+
+MapElementIndex::~MapElementIndex()
+{
+}
+
+void MapElementIndex::clear()
+{
+  m_bounds = QRect();
+  m_cellSize = 1;
+  m_cols = 0;
+  m_rows = 0;
+  m_cells.clear();
+  m_large.clear();
+  m_count = 0;
+  m_valid = false;
+}
+
+void MapElementIndex::build( const QVector<QRect>& boxes )
+{
+  clear();
+
+  m_count = boxes.size();
+  m_valid = true;
+
+  for( int i = 0; i < boxes.size(); i++ )
+    {
+      if( boxes.at(i).isValid() )
+        {
+          m_bounds = m_bounds.united( boxes.at(i) );
+        }
+    }
+
+  if( m_bounds.isEmpty() )
+    {
+      // Nothing with a position, return all elements on every query.
+      for( int i = 0; i < boxes.size(); i++ )
+        {
+          m_large.append( i );
+        }
+
+      return;
+    }
+
+  // Choose the bucket size, so that a bucket contains a few elements in
+  // average.
+  double area = double( m_bounds.width() ) * double( m_bounds.height() );
+  double cells = qMax( 1.0, double( m_count ) / 4.0 );
+
+  m_cellSize = qMax( 1, int( ceil( sqrt( area / cells ) ) ) );
+  m_cellSize = qMax( m_cellSize, m_bounds.width() / MAX_GRID_CELLS + 1 );
+  m_cellSize = qMax( m_cellSize, m_bounds.height() / MAX_GRID_CELLS + 1 );
+
+  m_cols = m_bounds.width() / m_cellSize + 1;
+  m_rows = m_bounds.height() / m_cellSize + 1;
+
+  m_cells.resize( m_cols * m_rows );
+
+  for( int i = 0; i < boxes.size(); i++ )
+    {
+      const QRect& box = boxes.at(i);
+
+      if( ! box.isValid() )
+        {
+          // Element without position, it is always returned.
+          m_large.append( i );
+          continue;
+        }
+
+      int c1 = ( box.left() - m_bounds.left() ) / m_cellSize;
+      int c2 = ( box.right() - m_bounds.left() ) / m_cellSize;
+      int r1 = ( box.top() - m_bounds.top() ) / m_cellSize;
+      int r2 = ( box.bottom() - m_bounds.top() ) / m_cellSize;
+
+      if( (c2 - c1 + 1) * (r2 - r1 + 1) > MAX_ELEMENT_CELLS )
+        {
+          m_large.append( i );
+          continue;
+        }
+
+      for( int r = r1; r <= r2; r++ )
+        {
+          for( int c = c1; c <= c2; c++ )
+            {
+              m_cells[r * m_cols + c].append( i );
+            }
+        }
+    }
+}
+
+QVector<int> MapElementIndex::query( const QRect& area ) const
+{
+  QVector<int> result( m_large );
+
+  QRect clipped = area.intersected( m_bounds );
+
+  if( ! clipped.isEmpty() && m_cols > 0 )
+    {
+      int c1 = ( clipped.left() - m_bounds.left() ) / m_cellSize;
+      int c2 = ( clipped.right() - m_bounds.left() ) / m_cellSize;
+      int r1 = ( clipped.top() - m_bounds.top() ) / m_cellSize;
+      int r2 = ( clipped.bottom() - m_bounds.top() ) / m_cellSize;
+
+      for( int r = r1; r <= r2; r++ )
+        {
+          for( int c = c1; c <= c2; c++ )
+            {
+              result += m_cells.at( r * m_cols + c );
+            }
+        }
+    }
+
+  // Restore the list order and remove the duplicates of elements, which
+  // are contained in several buckets.
+  qSort( result.begin(), result.end() );
+
+  int last = -1;
+  int j = 0;
+
+  for( int i = 0; i < result.size(); i++ )
+    {
+      if( result.at(i) != last )
+        {
+          last = result.at(i);
+          result[j++] = last;
+        }
+    }
+
+  result.resize( j );
+
+  return result;
+}
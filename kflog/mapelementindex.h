@@ -0,0 +1,109 @@
+/***********************************************************************
+**
+**   mapelementindex.h
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#ifndef MAP_ELEMENT_INDEX_H
+#define MAP_ELEMENT_INDEX_H
+
+#include <QRect>
+#include <QVector>
+
+/**
+ * \class MapElementIndex
+ *
+ * \author agent
+ *
+ * \brief Spatial grid index over the bounding boxes of map elements.
+ *
+ * The index divides the area covered by all elements into a grid of equal
+ * buckets. Every bucket holds the list indexes of the elements, whose
+ * bounding box touches the bucket. A query returns the indexes of all
+ * elements touching the buckets of the query area, in ascending order to
+ * keep the drawing order of the element list. The returned elements can
+ * be outside of the query area, the caller has to do the exact check.
+ *
+ * Elements, which cover many buckets, are stored in an extra list and are
+ * returned by every query.
+ *
+ * \date 2026
+ */
+class MapElementIndex
+{
+ public:
+
+  MapElementIndex();
+
+  virtual ~MapElementIndex();
+
+  /**
+   * Builds the index from the bounding boxes of the elements. The position
+   * of a box in the vector is the element index returned by \ref query.
+   */
+  void build( const QVector<QRect>& boxes );
+
+  /**
+   * Removes all entries and marks the index as invalid.
+   */
+  void clear();
+
+  /**
+   * Marks the index as invalid. It must be rebuilt before the next query.
+   */
+  void invalidate()
+  {
+    m_valid = false;
+  };
+
+  /**
+   * \return True, if the index is valid for the given number of elements.
+   */
+  bool isValid( const int count ) const
+  {
+    return m_valid && m_count == count;
+  };
+
+  /**
+   * \return The ascending sorted indexes of all elements, which can
+   *         intersect the given area.
+   */
+  QVector<int> query( const QRect& area ) const;
+
+ private:
+
+  /** Area covered by all indexed elements. */
+  QRect m_bounds;
+
+  /** Edge length of a bucket in map coordinates. */
+  int m_cellSize;
+
+  /** Number of bucket columns. */
+  int m_cols;
+
+  /** Number of bucket rows. */
+  int m_rows;
+
+  /** The buckets, row by row. */
+  QVector< QVector<int> > m_cells;
+
+  /** Elements covering too many buckets. */
+  QVector<int> m_large;
+
+  /** Number of indexed elements. */
+  int m_count;
+
+  /** Validity flag. */
+  bool m_valid;
+};
+
+#endif
@@ -0,0 +1,103 @@
+/***********************************************************************
+**
+**   maphitindex.cpp
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <QtCore>
+
+#include "maphitindex.h"
+
+// Edge length of a cell in pixels, the double of the largest search radius
+#define HIT_CELL_SIZE 32
+
+// Returns the cell of a screen coordinate, also for negative values.
+static inline int cellOf( const int value )
+{
+  return value >= 0 ? value / HIT_CELL_SIZE : (value + 1) / HIT_CELL_SIZE - 1;
+}
+
+MapHitIndex::MapHitIndex() :
+  m_count(0)
+{
+}
+
+MapHitIndex::~MapHitIndex()
+{
+}
+
+void MapHitIndex::clear()
+{
+  m_cells.clear();
+  m_count = 0;
+}
+
+void MapHitIndex::insert( const QPoint& pos, const int id )
+{
+  m_cells[__key( cellOf( pos.x() ), cellOf( pos.y() ) )].append( Entry( pos, id ) );
+  m_count++;
+}
+
+int MapHitIndex::find( const QPoint& pos, const int delta ) const
+{
+  if( m_count == 0 )
+    {
+      return -1;
+    }
+
+  const int c1 = cellOf( pos.x() - delta );
+  const int c2 = cellOf( pos.x() + delta );
+  const int r1 = cellOf( pos.y() - delta );
+  const int r2 = cellOf( pos.y() + delta );
+
+  int found = -1;
+  int minDist = 0;
+
+  for( int r = r1; r <= r2; r++ )
+    {
+      for( int c = c1; c <= c2; c++ )
+        {
+          QHash< uint, QVector<Entry> >::const_iterator it = m_cells.constFind( __key( c, r ) );
+
+          if( it == m_cells.constEnd() )
+            {
+              continue;
+            }
+
+          const QVector<Entry>& entries = it.value();
+
+          for( int i = 0; i < entries.size(); i++ )
+            {
+              const Entry& entry = entries.at(i);
+
+              const int dX = qAbs( entry.pos.x() - pos.x() );
+              const int dY = qAbs( entry.pos.y() - pos.y() );
+
+              if( dX >= delta || dY >= delta )
+                {
+                  continue;
+                }
+
+              const int dist = dX * dX + dY * dY;
+
+              if( found == -1 || dist < minDist ||
+                  ( dist == minDist && entry.id > found ) )
+                {
+                  found = entry.id;
+                  minDist = dist;
+                }
+            }
+        }
+    }
+
+  return found;
+}
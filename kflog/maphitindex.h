@@ -0,0 +1,102 @@
+/***********************************************************************
+**
+**   maphitindex.h
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#ifndef MAP_HIT_INDEX_H
+#define MAP_HIT_INDEX_H
+
+#include <QHash>
+#include <QPoint>
+#include <QVector>
+
+/**
+ * \class MapHitIndex
+ *
+ * \author agent
+ *
+ * \brief Spatial hash of the screen positions of drawn point elements.
+ *
+ * The screen is divided into square cells. Every used cell holds the
+ * positions and identifiers of the points inside it. A hit test looks only
+ * into the cells touched by the search square around the mouse position,
+ * so its costs do not depend on the number of drawn points.
+ *
+ * The index is filled, when the points are drawn, and must be cleared
+ * before every redraw of the map.
+ *
+ * \date 2026
+ */
+class MapHitIndex
+{
+ public:
+
+  MapHitIndex();
+
+  virtual ~MapHitIndex();
+
+  /** Removes all points. */
+  void clear();
+
+  /**
+   * Adds a point.
+   *
+   * \param pos The screen position of the point.
+   *
+   * \param id The identifier returned by \ref find.
+   */
+  void insert( const QPoint& pos, const int id );
+
+  /**
+   * Searches the point nearest to the passed position, whose distance
+   * in x and y is less than delta. If several points have the same
+   * distance, the one with the greater identifier is returned.
+   *
+   * \return The identifier of the found point or -1.
+   */
+  int find( const QPoint& pos, const int delta ) const;
+
+  /** \return The number of points in the index. */
+  int count() const
+  {
+    return m_count;
+  };
+
+ private:
+
+  /** Returns the hash key of the cell at the passed column and row. */
+  static uint __key( const int col, const int row )
+  {
+    return ( uint( col & 0xffff ) << 16 ) | uint( row & 0xffff );
+  };
+
+  class Entry
+  {
+   public:
+
+    Entry() : id(-1) {};
+
+    Entry( const QPoint& p, const int i ) : pos(p), id(i) {};
+
+    QPoint pos;
+    int id;
+  };
+
+  /** The used cells. */
+  QHash< uint, QVector<Entry> > m_cells;
+
+  /** Number of points in the index. */
+  int m_count;
+};
+
+#endif
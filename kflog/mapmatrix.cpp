@@ -93,9 +93,14 @@ QPoint MapMatrix::wgsToMap(const QPoint& origPoint) const
 
 QPoint MapMatrix::wgsToMap(int lat, int lon) const
 {
-  return QPoint((int) rint(currentProjection->projectX(NUM_TO_RAD(lat), NUM_TO_RAD(lon)) *
+  return wgsToMap(currentProjection, lat, lon);
+}
+
+QPoint MapMatrix::wgsToMap(ProjectionBase* projection, int lat, int lon)
+{
+  return QPoint((int) rint(projection->projectX(NUM_TO_RAD(lat), NUM_TO_RAD(lon)) *
                       RADIUS / MAX_SCALE),
-                (int) rint(currentProjection->projectY(NUM_TO_RAD(lat), NUM_TO_RAD(lon)) *
+                (int) rint(projection->projectY(NUM_TO_RAD(lat), NUM_TO_RAD(lon)) *
                       RADIUS / MAX_SCALE));
 }
 
@@ -97,6 +97,22 @@ public:
    * @return the projected point
    */
   QPoint wgsToMap(int lat, int lon) const;
+
+  /**
+   * Converts the given geographic-data with the given map-projection. The
+   * method does not use any member of the matrix and can be called from
+   * other threads, if the projection object is private to the caller.
+   *
+   * @param  projection  The map-projection to be used.
+   * @param  lat  The latitude of the point to be converted. The point must
+   *              be in the internal format of 1/10.000 minutes.
+   * @param  lon  The longitude of the point to be converted. The point must
+   *              be in the internal format of 1/10.000 minutes.
+   *
+   * @return the projected point
+   */
+  static QPoint wgsToMap(ProjectionBase* projection, int lat, int lon);
+
   /**
    * Converts the given geographic-data into the current map-projection.
    *
@@ -119,6 +135,15 @@ public:
     return worldMatrix.map(pPolygon);
   };
 
+  /**
+   * \return The matrix, which maps projected coordinates to the map
+   *         widget. Its translation part has always integer values.
+   */
+  const QTransform& getWorldMatrix() const
+  {
+    return worldMatrix;
+  };
+
   /**
    * Maps the given projected point into the current map-matrix.
    *
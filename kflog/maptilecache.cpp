@@ -0,0 +1,339 @@
+/***********************************************************************
+**
+**   maptilecache.cpp
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <cstring>
+
+#include <QtCore>
+
+#include "maptilecache.h"
+#include "projectionbase.h"
+
+// cache file token: @KFC
+#define CACHE_FILE_MAGIC    0x404b4643
+
+// Version of the cache file layout. Increment it, if the layout is changed.
+#define CACHE_FILE_VERSION  1
+
+// Maximum length of the serialized projection parameters
+#define CACHE_PROJECTION_KEY_SIZE 32
+
+/**
+ * Header at the beginning of every cache file. The byte order is the native
+ * one, a cache file written on another architecture is rejected by the magic
+ * check.
+ */
+struct CacheFileHeader
+{
+  quint32 magic;
+  quint16 version;
+  quint8  typeID;
+  quint8  reserved1;
+  qint32  secID;
+  quint32 elementCount;
+  qint64  sourceSize;
+  qint64  sourceModified;
+  quint32 projectionKeyLength;
+  char    projectionKey[CACHE_PROJECTION_KEY_SIZE];
+  quint32 reserved2;
+};
+
+/**
+ * Header of a single element record. It is followed by the name as UTF-16
+ * characters, padded to a multiple of 4 bytes, and by the point coordinates
+ * as pairs of qint32.
+ */
+struct CacheRecordHeader
+{
+  quint8  type;
+  qint8   sort;
+  qint16  elevation;
+  qint32  latitude;
+  qint32  longitude;
+  quint32 nameLength;
+  quint32 pointCount;
+};
+
+/** Returns the name size in bytes padded to a multiple of 4. */
+static inline quint32 paddedNameSize( quint32 nameLength )
+{
+  return ( nameLength * sizeof(ushort) + 3 ) & ~3U;
+}
+
+MapTileCache::MapTileCache( const QString& cacheDirectory,
+                            ProjectionBase* projection ) :
+  m_cacheDirectory(cacheDirectory)
+{
+  if( projection != 0 )
+    {
+      QDataStream out( &m_projectionKey, QIODevice::WriteOnly );
+      SaveProjection( out, projection );
+    }
+}
+
+MapTileCache::~MapTileCache()
+{
+}
+
+QString MapTileCache::__cacheFileName( const int secID, const char typeID ) const
+{
+  // The checksum of the projection parameters is part of the file name, so
+  // that caches of different projections can coexist.
+  quint16 crc = qChecksum( m_projectionKey.constData(), m_projectionKey.size() );
+
+  QString name;
+  name.sprintf( "%c_%.5d_%04x.kfc", typeID, secID, crc );
+
+  return m_cacheDirectory + "/" + name;
+}
+
+bool MapTileCache::load( const QString& sourceFile,
+                         const int secID,
+                         const char typeID,
+                         QList<Element>& elements ) const
+{
+  if( m_projectionKey.isEmpty() ||
+      m_projectionKey.size() > CACHE_PROJECTION_KEY_SIZE )
+    {
+      return false;
+    }
+
+  QFileInfo srcInfo( sourceFile );
+
+  if( ! srcInfo.exists() )
+    {
+      return false;
+    }
+
+  QFile cacheFile( __cacheFileName( secID, typeID ) );
+
+  if( ! cacheFile.exists() || ! cacheFile.open( QIODevice::ReadOnly ) )
+    {
+      return false;
+    }
+
+  const qint64 size = cacheFile.size();
+
+  if( size < (qint64) sizeof(CacheFileHeader) )
+    {
+      return false;
+    }
+
+  // Map the whole file into memory. If that fails, we read it in one go.
+  QByteArray buffer;
+  const uchar* data = cacheFile.map( 0, size );
+
+  if( data == 0 )
+    {
+      buffer = cacheFile.readAll();
+
+      if( buffer.size() != size )
+        {
+          return false;
+        }
+
+      data = reinterpret_cast<const uchar *> (buffer.constData());
+    }
+
+  const CacheFileHeader* header = reinterpret_cast<const CacheFileHeader *> (data);
+
+  if( header->magic != CACHE_FILE_MAGIC ||
+      header->version != CACHE_FILE_VERSION ||
+      header->typeID != (quint8) typeID ||
+      header->secID != secID ||
+      header->sourceSize != srcInfo.size() ||
+      header->sourceModified != (qint64) srcInfo.lastModified().toTime_t() ||
+      header->projectionKeyLength != (quint32) m_projectionKey.size() ||
+      memcmp( header->projectionKey, m_projectionKey.constData(),
+              m_projectionKey.size() ) != 0 )
+    {
+      // Cache file is outdated or belongs to another projection.
+      return false;
+    }
+
+  QList<Element> cached;
+  qint64 pos = sizeof(CacheFileHeader);
+
+  for( quint32 i = 0; i < header->elementCount; i++ )
+    {
+      if( pos + (qint64) sizeof(CacheRecordHeader) > size )
+        {
+          qWarning() << "MapTileCache: Truncated cache file"
+                     << cacheFile.fileName();
+          return false;
+        }
+
+      const CacheRecordHeader* rec =
+          reinterpret_cast<const CacheRecordHeader *> (data + pos);
+
+      pos += sizeof(CacheRecordHeader);
+
+      const qint64 nameSize   = paddedNameSize( rec->nameLength );
+      const qint64 pointsSize = (qint64) rec->pointCount * 2 * sizeof(qint32);
+
+      if( pos + nameSize + pointsSize > size )
+        {
+          qWarning() << "MapTileCache: Truncated cache file"
+                     << cacheFile.fileName();
+          return false;
+        }
+
+      Element element;
+      element.type      = rec->type;
+      element.sort      = rec->sort;
+      element.elevation = rec->elevation;
+      element.latitude  = rec->latitude;
+      element.longitude = rec->longitude;
+
+      if( rec->nameLength > 0 )
+        {
+          element.name = QString::fromUtf16( reinterpret_cast<const ushort *> (data + pos),
+                                             rec->nameLength );
+        }
+
+      pos += nameSize;
+
+      const qint32* coords = reinterpret_cast<const qint32 *> (data + pos);
+
+      element.polygon.resize( rec->pointCount );
+      QPoint* points = element.polygon.data();
+
+      for( quint32 j = 0; j < rec->pointCount; j++ )
+        {
+          points[j] = QPoint( coords[2 * j], coords[2 * j + 1] );
+        }
+
+      pos += pointsSize;
+
+      cached.append( element );
+    }
+
+  elements += cached;
+  return true;
+}
+
+bool MapTileCache::save( const QString& sourceFile,
+                         const int secID,
+                         const char typeID,
+                         const QList<Element>& elements ) const
+{
+  if( m_projectionKey.isEmpty() ||
+      m_projectionKey.size() > CACHE_PROJECTION_KEY_SIZE )
+    {
+      return false;
+    }
+
+  QFileInfo srcInfo( sourceFile );
+
+  if( ! srcInfo.exists() )
+    {
+      return false;
+    }
+
+  QDir dir( m_cacheDirectory );
+
+  if( ! dir.exists() && ! dir.mkpath( m_cacheDirectory ) )
+    {
+      qWarning() << "MapTileCache: Cannot create cache directory"
+                 << m_cacheDirectory;
+      return false;
+    }
+
+  CacheFileHeader header;
+  memset( &header, 0, sizeof(header) );
+
+  header.magic               = CACHE_FILE_MAGIC;
+  header.version             = CACHE_FILE_VERSION;
+  header.typeID              = (quint8) typeID;
+  header.secID               = secID;
+  header.elementCount        = elements.size();
+  header.sourceSize          = srcInfo.size();
+  header.sourceModified      = srcInfo.lastModified().toTime_t();
+  header.projectionKeyLength = m_projectionKey.size();
+  memcpy( header.projectionKey, m_projectionKey.constData(), m_projectionKey.size() );
+
+  // Assemble the whole file in memory to write it with a single call.
+  QByteArray buffer;
+  buffer.append( reinterpret_cast<const char *> (&header), sizeof(header) );
+
+  for( int i = 0; i < elements.size(); i++ )
+    {
+      const Element& element = elements.at(i);
+
+      CacheRecordHeader rec;
+      memset( &rec, 0, sizeof(rec) );
+
+      rec.type       = element.type;
+      rec.sort       = element.sort;
+      rec.elevation  = element.elevation;
+      rec.latitude   = element.latitude;
+      rec.longitude  = element.longitude;
+      rec.nameLength = element.name.size();
+      rec.pointCount = element.polygon.size();
+
+      buffer.append( reinterpret_cast<const char *> (&rec), sizeof(rec) );
+
+      const int nameSize = element.name.size() * sizeof(ushort);
+
+      buffer.append( reinterpret_cast<const char *> (element.name.utf16()), nameSize );
+      buffer.append( QByteArray( paddedNameSize( rec.nameLength ) - nameSize, '\0' ) );
+
+      QVector<qint32> coords( 2 * element.polygon.size() );
+
+      for( int j = 0; j < element.polygon.size(); j++ )
+        {
+          const QPoint& p = element.polygon.at(j);
+          coords[2 * j]     = p.x();
+          coords[2 * j + 1] = p.y();
+        }
+
+      buffer.append( reinterpret_cast<const char *> (coords.constData()),
+                     coords.size() * sizeof(qint32) );
+    }
+
+  // Write into a temporary file first and rename it afterwards. So a reader
+  // never sees a partially written cache file.
+  const QString fileName = __cacheFileName( secID, typeID );
+  const QString tmpName  = fileName + "." +
+                           QString::number( (quintptr) QThread::currentThreadId() ) +
+                           ".tmp";
+
+  QFile tmpFile( tmpName );
+
+  if( ! tmpFile.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    {
+      qWarning() << "MapTileCache: Cannot write" << tmpName;
+      return false;
+    }
+
+  if( tmpFile.write( buffer ) != buffer.size() )
+    {
+      qWarning() << "MapTileCache: Write error on" << tmpName;
+      tmpFile.close();
+      tmpFile.remove();
+      return false;
+    }
+
+  tmpFile.close();
+
+  QFile::remove( fileName );
+
+  if( ! QFile::rename( tmpName, fileName ) )
+    {
+      QFile::remove( tmpName );
+      return false;
+    }
+
+  return true;
+}
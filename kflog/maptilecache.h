@@ -0,0 +1,162 @@
+/***********************************************************************
+**
+**   maptilecache.h
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#ifndef MAP_TILE_CACHE_H
+#define MAP_TILE_CACHE_H
+
+#include <QByteArray>
+#include <QList>
+#include <QPolygon>
+#include <QString>
+
+class ProjectionBase;
+
+/**
+ * \class MapTileCache
+ *
+ * \author agent
+ *
+ * \brief Disk cache for already projected map tile data.
+ *
+ * Loading a KFLog map tile means decoding every point of the tile through a
+ * QDataStream and projecting it with \ref MapMatrix::wgsToMap. This class
+ * stores the result of that work in a compiled cache file per tile, which is
+ * keyed by tile section identifier, file type and the parameters of the
+ * current map projection. A cache file is only accepted, if the size and
+ * the modification time of its source file are unchanged.
+ *
+ * The cache files use a flat, native byte order layout which is read back
+ * via a memory mapping of the whole file. All records are 4 byte aligned,
+ * so that the point coordinates can be taken over directly.
+ *
+ * The class has no mutable state after construction and can be used from
+ * several threads at the same time.
+ *
+ * \date 2026
+ */
+class MapTileCache
+{
+ public:
+
+  /**
+   * One cached map element. Isolines use \ref elevation and \ref polygon,
+   * line elements \ref name, \ref sort and \ref polygon and single points
+   * store their WGS84 position in \ref latitude and \ref longitude and
+   * their projected position as the only point of \ref polygon.
+   */
+  class Element
+  {
+   public:
+
+    Element() :
+      type(0),
+      sort(0),
+      elevation(0),
+      latitude(0),
+      longitude(0)
+    {};
+
+    /** Element type, see \ref BaseMapElement::objectType. */
+    quint8 type;
+
+    /** Sort or valley flag of line elements. */
+    qint8 sort;
+
+    /** Elevation in meters of isolines and spots. */
+    qint16 elevation;
+
+    /** WGS84 latitude of single points in KFLog units. */
+    qint32 latitude;
+
+    /** WGS84 longitude of single points in KFLog units. */
+    qint32 longitude;
+
+    /** Name of the element. */
+    QString name;
+
+    /** Projected points of the element. */
+    QPolygon polygon;
+  };
+
+  /**
+   * Creates a cache accessor.
+   *
+   * \param cacheDirectory Directory, where the cache files are stored.
+   *
+   * \param projection The map projection, used to project the cached data.
+   */
+  MapTileCache( const QString& cacheDirectory, ProjectionBase* projection );
+
+  virtual ~MapTileCache();
+
+  /**
+   * Loads the cached elements of a map tile.
+   *
+   * \param sourceFile The uncompiled KFLog map file of the tile.
+   *
+   * \param secID The tile section identifier.
+   *
+   * \param typeID The file type identifier of the tile file.
+   *
+   * \param elements The list, to which the cached elements are appended.
+   *
+   * \return True, if a valid cache file was found and read otherwise false.
+   */
+  bool load( const QString& sourceFile,
+             const int secID,
+             const char typeID,
+             QList<Element>& elements ) const;
+
+  /**
+   * Writes the elements of a map tile into its cache file.
+   *
+   * \param sourceFile The uncompiled KFLog map file of the tile.
+   *
+   * \param secID The tile section identifier.
+   *
+   * \param typeID The file type identifier of the tile file.
+   *
+   * \param elements The already projected elements of the tile.
+   *
+   * \return True on success otherwise false.
+   */
+  bool save( const QString& sourceFile,
+             const int secID,
+             const char typeID,
+             const QList<Element>& elements ) const;
+
+  /**
+   * \return The directory, where the cache files are stored.
+   */
+  const QString& cacheDirectory() const
+    {
+      return m_cacheDirectory;
+    };
+
+ private:
+
+  /**
+   * \return The cache file name for the given tile.
+   */
+  QString __cacheFileName( const int secID, const char typeID ) const;
+
+  /** Directory of the cache files. */
+  QString m_cacheDirectory;
+
+  /** Serialized parameters of the map projection. */
+  QByteArray m_projectionKey;
+};
+
+#endif
@@ -0,0 +1,678 @@
+/***********************************************************************
+**
+**   maptileloader.cpp
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+
+#include <QtCore>
+
+#include "basemapelement.h"
+#include "mapmatrix.h"
+#include "maptileloader.h"
+#include "projectionbase.h"
+
+// general KFLOG file token: @KFL
+#define KFLOG_FILE_MAGIC    0x404b464c
+
+// versions
+// The *_OLD files are based on GTOPO30 data. Support for this will disappear in the QT4 release.
+// The newer files are based on SRTM3 data.
+#define FILE_VERSION_GROUND_OLD   100
+#define FILE_VERSION_GROUND       102
+#define FILE_VERSION_TERRAIN_OLD  100
+#define FILE_VERSION_TERRAIN      102
+#define FILE_VERSION_MAP          101
+
+#define READ_POINT_LIST \
+    in >> locLength; \
+    element.polygon.resize(locLength); \
+    for(uint i = 0; i < locLength; i++) \
+      { \
+        in >> lat_temp; \
+        in >> lon_temp; \
+        element.polygon.setPoint( i, MapMatrix::wgsToMap(projection, lat_temp, lon_temp) ); \
+      }
+
+/**
+ * \class MapTileLoaderTask
+ *
+ * \brief Loads the requested parts of one map tile in a worker thread.
+ */
+class MapTileLoaderTask : public QRunnable
+{
+ public:
+
+  MapTileLoaderTask( MapTileLoader* loader,
+                     MapTileLoader::TileData* data,
+                     const QString& mapRootDir,
+                     const QByteArray& projection ) :
+    m_loader(loader),
+    m_data(data),
+    m_mapRootDir(mapRootDir),
+    m_projection(projection)
+  {
+    setAutoDelete( true );
+  };
+
+  virtual ~MapTileLoaderTask()
+  {
+  };
+
+  virtual void run();
+
+ private:
+
+  /** Reads one tile part and updates the part masks. */
+  void __readPart( const char part,
+                   const char typeID,
+                   ProjectionBase* projection,
+                   QList<MapTileCache::Element>& elements );
+
+  MapTileLoader* m_loader;
+  MapTileLoader::TileData* m_data;
+  QString m_mapRootDir;
+  QByteArray m_projection;
+};
+
+void MapTileLoaderTask::run()
+{
+  // The projection objects are not thread safe. Every task works with its
+  // own copy of the current map projection.
+  QDataStream in( m_projection );
+  ProjectionBase* projection = LoadProjection( in );
+
+  if( projection != 0 )
+    {
+      __readPart( TILE_PART_GROUND, FILE_TYPE_GROUND, projection, m_data->ground );
+      __readPart( TILE_PART_TERRAIN, FILE_TYPE_TERRAIN, projection, m_data->terrain );
+      __readPart( TILE_PART_MAP, FILE_TYPE_MAP, projection, m_data->map );
+
+      delete projection;
+    }
+
+  m_loader->__storeResult( m_data );
+}
+
+void MapTileLoaderTask::__readPart( const char part,
+                                    const char typeID,
+                                    ProjectionBase* projection,
+                                    QList<MapTileCache::Element>& elements )
+{
+  if( ! (m_data->requested & part) )
+    {
+      return;
+    }
+
+  MapTileLoader::ReadResult res;
+
+  if( typeID == FILE_TYPE_MAP )
+    {
+      res = MapTileLoader::readMapFile( m_mapRootDir, m_data->secID, typeID,
+                                        projection, elements );
+    }
+  else
+    {
+      res = MapTileLoader::readTerrainFile( m_mapRootDir, m_data->secID, typeID,
+                                            projection, elements );
+    }
+
+  if( res == MapTileLoader::ReadOk )
+    {
+      m_data->loaded |= part;
+    }
+  else if( res == MapTileLoader::FileMissing )
+    {
+      m_data->missing |= part;
+    }
+}
+
+/*---------------------- MapTileLoader ---------------------------------------*/
+
+MapTileLoader::MapTileLoader( QObject* parent ) :
+  QObject(parent),
+  m_generation(0)
+{
+  setObjectName( "MapTileLoader" );
+
+  m_pool = new QThreadPool( this );
+  m_pool->setMaxThreadCount( qMax( 1, QThread::idealThreadCount() ) );
+}
+
+MapTileLoader::~MapTileLoader()
+{
+  reset();
+  m_pool->waitForDone();
+
+  qDeleteAll( m_results );
+}
+
+bool MapTileLoader::requestTile( const int secID,
+                                 const char parts,
+                                 const QString& mapRootDir,
+                                 ProjectionBase* projection )
+{
+  if( projection == 0 || (parts & TILE_PART_ALL) == 0 )
+    {
+      return false;
+    }
+
+  QMutexLocker locker( &m_mutex );
+
+  if( m_pending.contains( secID ) )
+    {
+      return false;
+    }
+
+  m_pending.insert( secID );
+
+  TileData* data   = new TileData;
+  data->secID      = secID;
+  data->generation = m_generation;
+  data->requested  = parts & TILE_PART_ALL;
+
+  QByteArray projData;
+  QDataStream out( &projData, QIODevice::WriteOnly );
+  SaveProjection( out, projection );
+
+  m_pool->start( new MapTileLoaderTask( this, data, mapRootDir, projData ) );
+
+  return true;
+}
+
+bool MapTileLoader::isPending( const int secID ) const
+{
+  QMutexLocker locker( &m_mutex );
+  return m_pending.contains( secID );
+}
+
+int MapTileLoader::pendingTiles() const
+{
+  QMutexLocker locker( &m_mutex );
+  return m_pending.size();
+}
+
+QList<MapTileLoader::TileData *> MapTileLoader::takeResults()
+{
+  QMutexLocker locker( &m_mutex );
+
+  QList<TileData *> results;
+
+  for( int i = 0; i < m_results.size(); i++ )
+    {
+      TileData* data = m_results.at(i);
+
+      if( data->generation != m_generation )
+        {
+          // Result of an invalidated request.
+          delete data;
+          continue;
+        }
+
+      m_pending.remove( data->secID );
+      results.append( data );
+    }
+
+  m_results.clear();
+
+  return results;
+}
+
+void MapTileLoader::reset()
+{
+  QMutexLocker locker( &m_mutex );
+
+  m_generation++;
+  m_pending.clear();
+
+  qDeleteAll( m_results );
+  m_results.clear();
+}
+
+void MapTileLoader::waitForDone()
+{
+  m_pool->waitForDone();
+}
+
+void MapTileLoader::__storeResult( TileData* data )
+{
+  m_mutex.lock();
+  m_results.append( data );
+  m_mutex.unlock();
+
+  // Inform the loader in its own thread about the new result.
+  QMetaObject::invokeMethod( this, "slotTileFinished", Qt::QueuedConnection );
+}
+
+void MapTileLoader::slotTileFinished()
+{
+  m_mutex.lock();
+  bool available = ! m_results.isEmpty();
+  m_mutex.unlock();
+
+  if( available )
+    {
+      emit tilesAvailable();
+    }
+}
+
+QString MapTileLoader::tileFileName( const int secID, const char typeID )
+{
+  QString file;
+  file.sprintf( "%c_%.5d.kfl", typeID, secID );
+  return file;
+}
+
+MapTileLoader::ReadResult
+MapTileLoader::readTerrainFile( const QString& mapRootDir,
+                                const int fileSecID,
+                                const char fileTypeID,
+                                ProjectionBase* projection,
+                                QList<MapTileCache::Element>& elements )
+{
+  if ( fileTypeID != FILE_TYPE_TERRAIN && fileTypeID != FILE_TYPE_GROUND )
+    {
+      qWarning( "Requested terrain file type 0x%X is unsupported!", fileTypeID );
+      return FileError;
+    }
+
+  QString path = mapRootDir + "/landscape/";
+
+  QString pathName = path + tileFileName( fileSecID, fileTypeID );
+
+  QFile mapfile(pathName);
+
+  if( ! mapfile.open(QIODevice::ReadOnly) )
+    {
+      qWarning() << "KFLog: Can not open Terrain file" << pathName;
+      return FileMissing;
+    }
+
+  // Check, if we have already a compiled and projected version of this file.
+  MapTileCache tileCache( path + "cache", projection );
+
+  if( tileCache.load( pathName, fileSecID, fileTypeID, elements ) )
+    {
+      mapfile.close();
+      return ReadOk;
+    }
+
+  QDataStream in( &mapfile );
+  in.setVersion( QDataStream::Qt_3_3 );
+
+  // qDebug("reading file %s", pathName.toLatin1().data());
+
+  qint8 loadTypeID;
+  quint16 loadSecID, formatID;
+  quint32 magic;
+  QDateTime createDateTime;
+
+  in >> magic;
+  in >> loadTypeID;
+  in >> formatID;
+  in >> loadSecID;
+  in >> createDateTime;
+
+  if( magic != KFLOG_FILE_MAGIC )
+    {
+      mapfile.close();
+
+      // We remove the wrong file to over come this dead lock by a new download
+      // of this file from the KFLog map room..
+      unlink( pathName.toLatin1().data() );
+
+      qWarning( "KFLog: %s Wrong magic key %x read! Abort loading...",
+                pathName.toLatin1().data(), magic );
+
+      return FileError;
+    }
+
+  if( loadTypeID != fileTypeID ) // wrong type
+    {
+      mapfile.close();
+
+      qWarning("KFLog: %s Wrong load type identifier %x read! Abort loading...",
+                pathName.toLatin1().data(), loadTypeID );
+
+      return FileError;
+    }
+
+  // Determine, which file format id is expected
+  int expFormatID;
+
+  if( fileTypeID == FILE_TYPE_TERRAIN )
+    {
+      expFormatID = FILE_VERSION_TERRAIN;
+    }
+  else
+    {
+      expFormatID = FILE_VERSION_GROUND;
+    }
+
+  qDebug( "Reading File=%s, Magic=0x%x, TypeId=%c, formatId=%d, Date=%s",
+          pathName.toLatin1().data(), magic, loadTypeID, formatID,
+          createDateTime.toString(Qt::ISODate).toLatin1().data() );
+
+  // Check map file
+  if ( formatID < expFormatID )
+    {
+      mapfile.close();
+
+      // too old ...
+      qWarning("KFLog: File format too old! (version %d, expecting: %d) "
+               "Aborting ...", formatID, expFormatID );
+      return FileError;
+    }
+  else if (formatID > expFormatID )
+    {
+      // too new ...
+      mapfile.close();
+
+      qWarning("KFLog: File format too new! (version %d, expecting: %d) "
+               "Aborting ...", formatID, expFormatID );
+      return FileError;
+    }
+
+  if ( loadSecID != fileSecID )
+    {
+      mapfile.close();
+
+      qWarning( "KFLog: %s: Wrong section, bogus file name! Arborting ...",
+                pathName.toLatin1().data() );
+
+      return FileError;
+    }
+
+  QList<MapTileCache::Element> isolines;
+
+  while ( ! in.atEnd() )
+    {
+      qint16 elevation;
+      qint32 pointNumber, lat, lon;
+      QPolygon isoline;
+
+      in >> elevation;
+      in >> pointNumber;
+      isoline.resize( pointNumber );
+
+      for (int i = 0; i < pointNumber; i++)
+        {
+          in >> lat;
+          in >> lon;
+
+          // This is what causes the long delays, lots of floating point calculations
+          isoline.setPoint( i, MapMatrix::wgsToMap(projection, lat, lon));
+        }
+
+      // Check, if first point and last point of the isoline identical. In this
+      // case we can remove the last point and repeat the check.
+      for( int i = isoline.size() - 1; i >= 0; i-- )
+        {
+          if( isoline.point(0) == isoline.point(i) )
+             {
+               //qWarning( "Isoline Tile=%d has same start and end point. Remove end point.",
+               //           loadSecID );
+
+               // remove last point and check again
+               isoline.remove(i);
+               continue;
+             }
+
+          break;
+        }
+
+      if( isoline.size() < 3)
+        {
+          // ignore to small isolines
+          qWarning( "Isoline Tile=%d, elevation=%dm has too less points!",
+                     loadSecID, elevation );
+          continue;
+        }
+
+      MapTileCache::Element element;
+      element.type      = BaseMapElement::Isohypse;
+      element.elevation = elevation;
+      element.polygon   = isoline;
+
+      isolines.append( element );
+    }
+
+  mapfile.close();
+
+  // Store the projected isolines for the next load of this tile.
+  tileCache.save( pathName, fileSecID, fileTypeID, isolines );
+
+  elements += isolines;
+
+  return ReadOk;
+}
+
+MapTileLoader::ReadResult
+MapTileLoader::readMapFile( const QString& mapRootDir,
+                            const int fileSecID,
+                            const char fileTypeID,
+                            ProjectionBase* projection,
+                            QList<MapTileCache::Element>& elements )
+{
+  QString path = mapRootDir + "/landscape/";
+
+  QString pathName = path + tileFileName( fileSecID, fileTypeID );
+
+  QFile mapfile(pathName);
+
+  if( !mapfile.open( QIODevice::ReadOnly ) )
+    {
+      qWarning() << "KFLog: Can not open map file" << pathName;
+      return FileMissing;
+    }
+
+  // Check, if we have already a compiled and projected version of this file.
+  MapTileCache tileCache( path + "cache", projection );
+
+  if( tileCache.load( pathName, fileSecID, fileTypeID, elements ) )
+    {
+      mapfile.close();
+      return ReadOk;
+    }
+
+  QDataStream in( &mapfile );
+  in.setVersion( QDataStream::Qt_2_0 );
+
+  qint8 loadTypeID;
+  quint16 loadSecID, formatID;
+  quint32 magic;
+  QDateTime createDateTime;
+
+  in >> magic;
+
+  if( magic != KFLOG_FILE_MAGIC )
+    {
+      mapfile.close();
+
+      // We remove the wrong file to over come this dead lock by a new download
+      // of this file from the KFLog map room..
+      unlink( pathName.toLatin1().data() );
+
+      qWarning( "KFLog: %s Wrong magic key %x read! Abort loading...",
+                pathName.toLatin1().data(), magic );
+
+      return FileError;
+    }
+
+  in >> loadTypeID;
+
+  if( loadTypeID != fileTypeID ) // wrong type
+    {
+      mapfile.close();
+      qWarning("KFLog: %s Wrong load type identifier %x read! Abort loading...",
+                pathName.toLatin1().data(), loadTypeID );
+
+      return FileError;
+    }
+
+  in >> formatID;
+
+  if( formatID < FILE_VERSION_MAP )
+    {
+      qWarning( "KFLog: File format too old! (version %d, expecting: %d)",
+                formatID, FILE_VERSION_MAP );
+
+      return FileError;
+    }
+  else if( formatID > FILE_VERSION_MAP )
+    {
+      qWarning( "KFLog: File format too new! (version %d, expecting: %d)",
+                 formatID, FILE_VERSION_MAP );
+
+      return FileError;
+    }
+
+  in >> loadSecID;
+
+  if( loadSecID != fileSecID )
+    {
+      mapfile.close();
+
+      qWarning( "KFLog: %s: Wrong section, bogus file name! Arborting ...",
+                pathName.toLatin1().data() );
+
+      return FileError;
+    }
+
+  in >> createDateTime;
+
+  qDebug( "Reading File=%s, Magic=0x%x, TypeId=%c, formatId=%d, Date=%s",
+           pathName.toLatin1().data(), magic, loadTypeID, formatID,
+           createDateTime.toString(Qt::ISODate).toLatin1().data() );
+
+  quint8 lm_typ;
+  qint8 sort, elev;
+  qint32 lat_temp, lon_temp;
+  quint32 locLength = 0;
+  QString name = "";
+
+  QList<MapTileCache::Element> mapElements;
+
+  while( ! in.atEnd() )
+    {
+      BaseMapElement::objectType typeIn = BaseMapElement::NotSelected;
+
+      in >> (quint8 &)typeIn;
+
+      locLength = 0;
+      name = "";
+
+      MapTileCache::Element element;
+
+      switch (typeIn)
+        {
+        case BaseMapElement::Motorway:
+        case BaseMapElement::Road:
+        case BaseMapElement::Trail:
+        case BaseMapElement::Aerial_Cable:
+        case BaseMapElement::Railway:
+        case BaseMapElement::Railway_D:
+          READ_POINT_LIST
+          break;
+
+        case BaseMapElement::Canal:
+        case BaseMapElement::River:
+        case BaseMapElement::River_T:
+
+          typeIn = BaseMapElement::River; //don't use different river types internally
+          in >> name;
+          READ_POINT_LIST
+          break;
+
+        case BaseMapElement::City:
+        case BaseMapElement::Forest:
+        case BaseMapElement::Glacier:
+        case BaseMapElement::PackIce:
+          in >> sort;
+          in >> name;
+
+          READ_POINT_LIST
+
+          element.sort = sort;
+          break;
+
+        case BaseMapElement::Lake:
+        case BaseMapElement::Lake_T:
+
+          typeIn=BaseMapElement::Lake; // don't use different lake type internally
+          in >> sort;
+          in >> name;
+
+          READ_POINT_LIST
+
+          element.sort = sort;
+          break;
+
+        case BaseMapElement::Village:
+
+          in >> name;
+          in >> lat_temp;
+          in >> lon_temp;
+
+          element.latitude  = lat_temp;
+          element.longitude = lon_temp;
+          element.polygon << MapMatrix::wgsToMap(projection, lat_temp, lon_temp);
+          break;
+
+        case BaseMapElement::Spot:
+
+          in >> elev;
+          in >> lat_temp;
+          in >> lon_temp;
+
+          name = "Spot";
+          element.elevation = elev;
+          element.latitude  = lat_temp;
+          element.longitude = lon_temp;
+          element.polygon << MapMatrix::wgsToMap(projection, lat_temp, lon_temp);
+          break;
+
+        case BaseMapElement::Landmark:
+
+          in >> lm_typ;
+          in >> name;
+          in >> lat_temp;
+          in >> lon_temp;
+
+          element.latitude  = lat_temp;
+          element.longitude = lon_temp;
+          element.polygon << MapMatrix::wgsToMap(projection, lat_temp, lon_temp);
+          break;
+
+        default:
+
+          qWarning ("MapTileLoader::readMapFile; Type not handled in switch: %d", typeIn);
+          continue;
+        }
+
+      element.type = typeIn;
+      element.name = name;
+      mapElements.append( element );
+    }
+
+  mapfile.close();
+
+  // Store the projected map elements for the next load of this tile.
+  tileCache.save( pathName, fileSecID, fileTypeID, mapElements );
+
+  elements += mapElements;
+
+  return ReadOk;
+}
@@ -0,0 +1,259 @@
+/***********************************************************************
+**
+**   maptileloader.h
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#ifndef MAP_TILE_LOADER_H
+#define MAP_TILE_LOADER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QString>
+
+#include "maptilecache.h"
+
+class ProjectionBase;
+class QThreadPool;
+
+// uncompiled map file types
+#define FILE_TYPE_AERO        0x41
+#define FILE_TYPE_GROUND      0x47
+#define FILE_TYPE_TERRAIN     0x54
+#define FILE_TYPE_MAP         0x4d
+#define FILE_TYPE_LM          0x4c
+
+// bits of the map tile parts, as used by the tile part map
+#define TILE_PART_GROUND      1
+#define TILE_PART_TERRAIN     2
+#define TILE_PART_MAP         4
+#define TILE_PART_ALL         7
+
+/**
+ * \class MapTileLoader
+ *
+ * \author agent
+ *
+ * \brief Loads map tiles on a pool of worker threads.
+ *
+ * The loader decodes and projects the ground, terrain and map files of the
+ * requested map tiles in the background. Every worker uses its own copy of
+ * the map projection, because the projection objects cache intermediate
+ * results and are therefore not thread safe.
+ *
+ * Finished tiles are collected by the loader and announced by the signal
+ * \ref tilesAvailable, which is always emitted in the thread of the loader.
+ * The receiver fetches them with \ref takeResults and publishes them into
+ * its element lists.
+ *
+ * A call of \ref reset invalidates all running requests. Their results are
+ * dropped, when they arrive later on.
+ *
+ * \date 2026
+ */
+class MapTileLoader : public QObject
+{
+  Q_OBJECT
+
+ private:
+
+  Q_DISABLE_COPY ( MapTileLoader )
+
+ public:
+
+  /**
+   * Result codes of the map file readers.
+   */
+  enum ReadResult { ReadOk = 0, FileMissing, FileError };
+
+  /**
+   * The loaded data of one map tile.
+   */
+  class TileData
+  {
+   public:
+
+    TileData() :
+      secID(-1),
+      generation(0),
+      requested(0),
+      loaded(0),
+      missing(0)
+    {};
+
+    /** The tile section identifier. */
+    int secID;
+
+    /** The loader generation of the request. */
+    uint generation;
+
+    /** The requested tile parts as bit mask. */
+    char requested;
+
+    /** The successfully loaded tile parts as bit mask. */
+    char loaded;
+
+    /** The tile parts, whose files do not exist, as bit mask. */
+    char missing;
+
+    /** The isolines of the ground file. */
+    QList<MapTileCache::Element> ground;
+
+    /** The isolines of the terrain file. */
+    QList<MapTileCache::Element> terrain;
+
+    /** The elements of the map file. */
+    QList<MapTileCache::Element> map;
+  };
+
+  MapTileLoader( QObject* parent = 0 );
+
+  virtual ~MapTileLoader();
+
+  /**
+   * Requests the background load of a map tile.
+   *
+   * \param secID The tile section identifier.
+   *
+   * \param parts The tile parts to be loaded as bit mask.
+   *
+   * \param mapRootDir The map root directory.
+   *
+   * \param projection The map projection to be used.
+   *
+   * \return True, if the request was queued. False, if the tile is already
+   *         in work.
+   */
+  bool requestTile( const int secID,
+                    const char parts,
+                    const QString& mapRootDir,
+                    ProjectionBase* projection );
+
+  /**
+   * \return True, if the tile is requested and not yet taken over.
+   */
+  bool isPending( const int secID ) const;
+
+  /**
+   * \return The number of requested tiles not yet taken over.
+   */
+  int pendingTiles() const;
+
+  /**
+   * Takes over all finished tiles of the current generation. The caller is
+   * the owner of the returned objects and has to delete them.
+   */
+  QList<TileData *> takeResults();
+
+  /**
+   * Invalidates all running and finished requests. Must be called, if the
+   * map projection is changed or the map data are reloaded.
+   */
+  void reset();
+
+  /**
+   * Waits until all running requests are finished.
+   */
+  void waitForDone();
+
+  /**
+   * Reads a ground or terrain file. The projected isolines are taken from
+   * the tile cache, if possible.
+   *
+   * \param mapRootDir The map root directory.
+   *
+   * \param secID The tile section identifier.
+   *
+   * \param typeID The file type, \ref FILE_TYPE_GROUND or \ref FILE_TYPE_TERRAIN.
+   *
+   * \param projection The map projection to be used.
+   *
+   * \param elements The list, to which the isolines are appended.
+   *
+   * \return The result of the read.
+   */
+  static ReadResult readTerrainFile( const QString& mapRootDir,
+                                     const int secID,
+                                     const char typeID,
+                                     ProjectionBase* projection,
+                                     QList<MapTileCache::Element>& elements );
+
+  /**
+   * Reads a map file. The projected elements are taken from the tile cache,
+   * if possible.
+   *
+   * \param mapRootDir The map root directory.
+   *
+   * \param secID The tile section identifier.
+   *
+   * \param typeID The file type, \ref FILE_TYPE_MAP.
+   *
+   * \param projection The map projection to be used.
+   *
+   * \param elements The list, to which the map elements are appended.
+   *
+   * \return The result of the read.
+   */
+  static ReadResult readMapFile( const QString& mapRootDir,
+                                 const int secID,
+                                 const char typeID,
+                                 ProjectionBase* projection,
+                                 QList<MapTileCache::Element>& elements );
+
+  /**
+   * \return The file name of a tile file without any path prefixes.
+   */
+  static QString tileFileName( const int secID, const char typeID );
+
+ signals:
+
+  /**
+   * Emitted, if finished tiles can be fetched with \ref takeResults.
+   */
+  void tilesAvailable();
+
+ private slots:
+
+  /**
+   * Called via a queued connection, if a worker has finished a tile.
+   */
+  void slotTileFinished();
+
+ private:
+
+  friend class MapTileLoaderTask;
+
+  /**
+   * Called by a worker thread to store its result.
+   */
+  void __storeResult( TileData* data );
+
+  /** Worker pool of the loader. */
+  QThreadPool* m_pool;
+
+  /** Protects all members below. */
+  mutable QMutex m_mutex;
+
+  /** Finished tiles, not yet taken over. */
+  QList<TileData *> m_results;
+
+  /** Requested tiles, not yet taken over. */
+  QSet<int> m_pending;
+
+  /** Current generation of the requests. */
+  uint m_generation;
+};
+
+#endif
@@ -27,6 +27,7 @@
 #include "openairparser.h"
 #include "mapcalc.h"
 #include "mapdefaults.h"
+#include "mapmatrix.h"
 #include "resource.h"
 
 OpenAirParser::OpenAirParser() :
@@ -39,7 +40,8 @@ OpenAirParser::OpenAirParser() :
   asLower(BaseMapElement::NotSet),
   asLowerType(BaseMapElement::NotSet),
   _awy_width(0),
-  _direction(1)
+  _direction(1),
+  m_projection(0)
 {
   QLocale::setDefault(QLocale::C);
 }
@@ -308,7 +310,16 @@ void OpenAirParser::finishAirspace()
 
   for (int i = 0; i < asPA.count(); i++)
     {
-      astPA.append( _globalMapMatrix->wgsToMap(asPA.at(i)) );
+      if( m_projection != 0 )
+        {
+          astPA.append( MapMatrix::wgsToMap( m_projection,
+                                             asPA.at(i).x(),
+                                             asPA.at(i).y() ) );
+        }
+      else
+        {
+          astPA.append( _globalMapMatrix->wgsToMap(asPA.at(i)) );
+        }
     }
 
   Airspace as( asName,
@@ -53,6 +53,7 @@
 #include "basemapelement.h"
 
 class Airspace;
+class ProjectionBase;
 
 class OpenAirParser
 {
@@ -79,6 +80,16 @@ public:
    */
   bool parse(const QString& path, QList<Airspace>& list);
 
+  /**
+   * Sets the projection used for the airspace polygons. The caller keeps
+   * the ownership. Without a projection the one of the global map matrix
+   * is used, which must not be done outside of the main thread.
+   */
+  void setProjection( ProjectionBase* projection )
+  {
+    m_projection = projection;
+  };
+
 private:
 
   void resetState();
@@ -123,6 +134,9 @@ private:
    * Mapper openair airspace type to Cumulus airspace type.
    */
   QMap<QString, BaseMapElement::objectType> m_airspaceTypeMapper;
+
+  /** Projection of the polygons, if not the global one is used. */
+  ProjectionBase* m_projection;
 };
 
 #endif
@@ -23,51 +23,196 @@
 **
 ***********************************************************************/
 
+#include <cmath>
 #include <cstdlib>
 
-#include <QApplication>
+#include <QtCore>
 #include <QMessageBox>
 
 #include "optimization.h"
 #include "mainwindow.h"
+#include "mapdefaults.h"
+#include "scoringengine.h"
 
 extern MainWindow *_mainWindow;
 
-// different weight for last two legs
+// Maximum number of points of the decimated track
+#define OPT_COARSE_POINTS 2000
+
+// Number of consecutive points sharing one distance bound
+#define OPT_BLOCK_SIZE 64
+
+// Minimum number of rows solved by one worker task
+#define OPT_MIN_ROWS 256
+
+// Pi / (180 degrees * 600000 KFLog degrees)
+#define OPT_RAD (M_PI / 108000000.0)
+
+/**
+ * \class Optimization::SolveState
+ *
+ * \brief The data of a solve, shared by the row tasks of a leg.
+ *
+ * The tasks of a leg only read the previous leg and write disjoint rows
+ * of the current leg.
+ */
+class Optimization::SolveState
+{
+ public:
+
+  int n;
+  int nb;
+  const int* fix;
+
+  /** Bounding caps of the point blocks on the unit sphere. */
+  const double* bx;
+  const double* by;
+  const double* bz;
+  const double* bRadius;
+
+  /** Maximum of the previous leg per point block. */
+  const double* blockMax;
+
+  const double* farthest;
+  double diameter;
+  double lowerBound;
+  double tolerance;
+
+  /** Leg dependent weights. */
+  double wLeg;
+  double nextWeight;
+  double restWeight;
+
+  bool showProgress;
+
+  const double* prev;
+  double* cur;
+  unsigned int* w;
+};
+
+/**
+ * \class OptimizationTask
+ *
+ * \brief Runs an optimization in a worker thread.
+ */
+class OptimizationTask : public QRunnable
+{
+ public:
+
+  OptimizationTask( Optimization* optimization ) :
+    m_optimization(optimization)
+  {
+    setAutoDelete( true );
+  };
+
+  virtual ~OptimizationTask()
+  {
+  };
+
+  virtual void run()
+  {
+    bool ok = m_optimization->__run();
+
+    // Inform the optimization in its own thread about the end of the run.
+    QMetaObject::invokeMethod( m_optimization, "slotRunFinished",
+                               Qt::QueuedConnection, Q_ARG( bool, ok ) );
+  };
+
+ private:
+
+  Optimization* m_optimization;
+};
+
+/**
+ * \class OptimizationRowTask
+ *
+ * \brief Solves a range of rows of one leg in a worker thread.
+ */
+class OptimizationRowTask : public QRunnable
+{
+ public:
+
+  OptimizationRowTask( Optimization* optimization,
+                       Optimization::SolveState* state,
+                       const int k,
+                       const int i1,
+                       const int i2,
+                       QSemaphore* done ) :
+    m_optimization(optimization),
+    m_state(state),
+    m_k(k),
+    m_i1(i1),
+    m_i2(i2),
+    m_done(done)
+  {
+    setAutoDelete( true );
+  };
+
+  virtual ~OptimizationRowTask()
+  {
+  };
+
+  virtual void run()
+  {
+    m_optimization->__solveRows( *m_state, m_k, m_i1, m_i2 );
+    m_done->release();
+  };
+
+ private:
+
+  Optimization* m_optimization;
+  Optimization::SolveState* m_state;
+  int m_k;
+  int m_i1;
+  int m_i2;
+  QSemaphore* m_done;
+};
+
+// different weight for last two legs, as given by the OLC 2003 rule
 double Optimization::weight(unsigned int k)
 {
-  switch( k )
+  if( k > 0 && k <= (unsigned int) m_weights.size() )
     {
-    case LEGS:
-      return 0.6;
-    case LEGS - 1:
-      return 0.8;
-    default:
-      return 1.0;
+      return m_weights[k - 1];
     }
+
+  return 1.0;
 }
 
 Optimization::Optimization( unsigned int firstPoint,
                             unsigned int lastPoint,
-                            QList<FlightPoint*> ptr_route,
+                            const FlightTrack& ptr_route,
                             QProgressBar *progressBar ) :
   QObject(0),
   original_route( ptr_route ),
-  progress( progressBar )
+  progressBar( progressBar ),
+  m_weights( ScoringRule::olc2003().legWeights )
 {
   Q_UNUSED( firstPoint)
   Q_UNUSED( lastPoint )
 
-  setTimes( 0, original_route.count() );
   optimized = false;
-  progress = progressBar;
-  stopit = false;
+  running = false;
+  stopit = 0;
   start = 0;
   stop = original_route.count();
+  setTimes( 0, original_route.count() );
+
+  // The run itself occupies one thread, while it waits for its row tasks.
+  m_pool = new QThreadPool( this );
+  m_pool->setMaxThreadCount( qMax( 1, QThread::idealThreadCount() ) + 1 );
+
+  if( progressBar )
+    {
+      // Queued, because the signal is emitted in the worker threads.
+      connect( this, SIGNAL(progress(int)), progressBar, SLOT(setValue(int)) );
+    }
 }
 
 Optimization::~Optimization()
 {
+  stopRun();
+  m_pool->waitForDone();
 }
 
 double Optimization::optimizationResult(unsigned int* retList, double *retPoints)
@@ -83,9 +228,9 @@ double Optimization::optimizationResult(unsigned int* retList, double *retPoints
 
   for( ; i <= LEGS + 1; i++ )
     {
-      retList[i] = original_route.indexOf( route.at( pointList[j] ) );
+      retList[i] = start + pointList[j];
 
-      if( pointList[j] > (uint) original_route.count() )
+      if( retList[i] > (uint) original_route.count() )
         {
           // qWarning("##k:%d\tstart:%d\t\tpointList[k]:%d", i, start, pointList[i]);
 
@@ -107,158 +252,558 @@ double Optimization::optimizationResult(unsigned int* retList, double *retPoints
 
 void Optimization::setTimes(unsigned int start_int, unsigned int stop_int)
 {
-  start = start_int;
-  stop = stop_int;
-
-  // delete actual route
-  while( route.count() > 0 )
+  if( running )
     {
-      route.removeLast();
+      // The running optimization uses the current range.
+      return;
     }
 
-  qWarning( "Items in list:%d", original_route.count() );
+  start = start_int;
+  stop = qMin( stop_int, (unsigned int) original_route.count() );
 
-  // construct route
-  for( uint i = start_int; i < stop_int; i++ )
-    {
-      route.append( original_route.at( i ) );
-    }
+  qWarning( "Items in list:%d", original_route.count() );
 
-  qDebug( "Number of points for optimization:%d", route.count() );
+  // The optimized route is the part [start, stop) of the track.
+  qDebug( "Number of points for optimization:%d", stop - start );
 }
 
 void Optimization::stopRun()
 {
-  stopit=true;
+  stopit.fetchAndStoreOrdered( 1 );
 }
 
 void Optimization::enableRun()
 {
-  stopit=false;
+  stopit.fetchAndStoreOrdered( 0 );
+}
+
+void Optimization::waitForDone()
+{
+  m_pool->waitForDone();
 }
 
 void Optimization::run()
 {
-  double *L;               // length values
-  unsigned int *w;         // waypoints
+  if( running )
+    {
+      return;
+    }
 
-  int ii;                  // loop variables
-  int n;                   // number of points
-  double c;                // temp variables
-  unsigned int index;
-  double wLeg;
-  FlightPoint **rp;
+  optimized = false;
+
+  const int cnt = stop - start;
+
+  qWarning("Number of points to optimize: %d", cnt + 1);
 
-  n = route.count() + 1;
+  if( cnt < 2 )
+    {
+      emit finished( false );
+      return;
+    }
 
-  qWarning("Number of points to optimize: %d", n);
+  __prepare();
 
-  if( progress )
+  if( progressBar )
     {
-      progress->setMinimumWidth( progress->sizeHint().width() + 45 );
-      progress->setRange( 0, 7 * n );
-      progress->setValue( 0 );
+      progressBar->setMinimumWidth( progressBar->sizeHint().width() + 45 );
+      progressBar->setRange( 0, (LEGS + 1) * cnt );
+      progressBar->setValue( 0 );
     }
 
-  // allocate memory
-  L = (double *) malloc( (n + 1) * (LEGS + 1) * sizeof(double) );
-  w = (unsigned int *) malloc( (n + 1) * (LEGS + 1) * sizeof(unsigned int) );
-  rp = (FlightPoint **) malloc( route.count() * sizeof(FlightPoint *) );
+  m_rowsDone.fetchAndStoreOrdered( 0 );
+  running = true;
 
-  Q_CHECK_PTR(L);
-  Q_CHECK_PTR(w);
-  Q_CHECK_PTR(rp);
+  m_pool->start( new OptimizationTask( this ) );
+}
 
-  for( int i = 0; i <= n - 1; i++ )
+void Optimization::slotRunFinished( bool ok )
+{
+  running = false;
+  __finishRun();
+
+  optimized = ok;
+
+  if( ok )
     {
-      L[i + 0 * n] = 0;
+      qWarning("Distance:%f\nPoints:%f", distance, points);
     }
 
-  for( int i = 0; i < route.count(); i++ )
+  emit finished( ok );
+}
+
+bool Optimization::__run()
+{
+  const int cnt = stop - start;
+
+  // Stage 1: Solve the task on a decimated track. The points of that task
+  // are a lower bound for the result on the full track.
+  double lowerBound = 0.0;
+
+  if( cnt > OPT_COARSE_POINTS )
     {
-      rp[i] = route.at( i );
+      const int step = ( cnt + OPT_COARSE_POINTS - 1 ) / OPT_COARSE_POINTS;
+
+      QVector<int> coarse;
+      coarse.reserve( cnt / step + 1 );
+
+      for( int i = 0; i < cnt; i += step )
+        {
+          coarse.append( i );
+        }
+
+      unsigned int coarseList[LEGS + 1];
+
+      if( ! __solve( coarse, 0.0, false, coarseList, lowerBound ) )
+        {
+          return false;
+        }
+    }
+
+  // Stage 2: Solve the task on the full track.
+  QVector<int> fixes( cnt );
+
+  for( int i = 0; i < cnt; i++ )
+    {
+      fixes[i] = i;
+    }
+
+  if( ! __solve( fixes, lowerBound, true, pointList, points ) )
+    {
+      return false;
+    }
+
+  distance = 0.0;
+
+  for( int k = 0; k < LEGS; k++ )
+    {
+      distance += original_route.distance( start + pointList[k],
+                                           start + pointList[k + 1] );
+    }
+
+  return true;
+}
+
+void Optimization::__finishRun()
+{
+  if( progressBar )
+    {
+      progressBar->setValue( 0 );
+    }
+
+  m_lat.clear();
+  m_lon.clear();
+  m_cosLat.clear();
+  m_ux.clear();
+  m_uy.clear();
+  m_uz.clear();
+}
+
+void Optimization::__prepare()
+{
+  const int cnt = stop - start;
+
+  m_lat.resize( cnt );
+  m_lon.resize( cnt );
+  m_cosLat.resize( cnt );
+  m_ux.resize( cnt );
+  m_uy.resize( cnt );
+  m_uz.resize( cnt );
+
+  for( int i = 0; i < cnt; i++ )
+    {
+      const double lat = original_route.lat( start + i );
+      const double lon = original_route.lon( start + i );
+
+      m_lat[i]    = lat;
+      m_lon[i]    = lon;
+      m_cosLat[i] = cos( lat * OPT_RAD );
+
+      // Position on the unit sphere, used for the distance bounds.
+      m_ux[i] = m_cosLat[i] * cos( lon * OPT_RAD );
+      m_uy[i] = m_cosLat[i] * sin( lon * OPT_RAD );
+      m_uz[i] = sin( lat * OPT_RAD );
     }
+}
+
+double Optimization::__dist( const int i, const int j ) const
+{
+  // The same formula as dist() in mapcalc.cpp, but with the precalculated
+  // cosines. The result is identical to dist().
+  double dlon = (m_lon[i] - m_lon[j]) * OPT_RAD / 2;
+  double dlat = (m_lat[i] - m_lat[j]) * OPT_RAD / 2;
+
+  double sinLatd = sin(dlat);
+  sinLatd = sinLatd * sinLatd;
+
+  double sinLond = sin(dlon);
+  sinLond = sinLond * sinLond;
+
+  double arc = 2 * asin( sqrt( sinLatd + m_cosLat[i] * m_cosLat[j] * sinLond ) );
+
+  return arc * RADIUS / 1000.;
+}
+
+/**
+ * Upper bound of the great circle distance in km belonging to a chord of
+ * the unit sphere. It uses asin(x) <= x / sqrt(1 - x*x) and needs no
+ * trigonometric function.
+ */
+static inline double maxArc( const double chord )
+{
+  const double h = chord * 0.5;
+
+  if( h >= 0.999 )
+    {
+      return M_PI * RADIUS / 1000.;
+    }
+
+  return ( chord / sqrt( 1.0 - h * h ) ) * RADIUS / 1000.;
+}
+
+static inline double chord( const double x1, const double y1, const double z1,
+                            const double x2, const double y2, const double z2 )
+{
+  const double dx = x1 - x2;
+  const double dy = y1 - y2;
+  const double dz = z1 - z2;
+
+  return sqrt( dx * dx + dy * dy + dz * dz );
+}
 
-  for( int k = 1; k <= LEGS; k++ )
+bool Optimization::__solve( const QVector<int>& fixes,
+                            const double lowerBound,
+                            const bool showProgress,
+                            unsigned int* resultList,
+                            double& resultPoints )
+{
+  const int n  = fixes.size();
+  const int nb = ( n + OPT_BLOCK_SIZE - 1 ) / OPT_BLOCK_SIZE;
+  const int* fix = fixes.constData();
+
+  // Bounding caps of the point blocks on the unit sphere.
+  QVector<double> bx( nb ), by( nb ), bz( nb ), bRadius( nb );
+
+  for( int b = 0; b < nb; b++ )
     {
-      ii = (k - 1) * n;
-      wLeg = weight( k );
+      const int j1 = b * OPT_BLOCK_SIZE;
+      const int j2 = qMin( j1 + OPT_BLOCK_SIZE, n );
+
+      double x = 0.0, y = 0.0, z = 0.0;
 
-      for( int i = 0; i < n - 1; i++ )
+      for( int j = j1; j < j2; j++ )
         {
-          qApp->processEvents();
+          x += m_ux[fix[j]];
+          y += m_uy[fix[j]];
+          z += m_uz[fix[j]];
+        }
 
-          if( stopit )
-            {
-              free( L );
-              free( w );
-              free( rp );
-              progress->setValue( 0 );
-              optimized = false;
-              return;
-            }
+      double len = sqrt( x * x + y * y + z * z );
+
+      if( len < 1e-9 )
+        {
+          x = m_ux[fix[j1]];
+          y = m_uy[fix[j1]];
+          z = m_uz[fix[j1]];
+        }
+      else
+        {
+          x /= len;
+          y /= len;
+          z /= len;
+        }
 
-          index = i + k * n;
+      double r = 0.0;
 
-          if( progress )
+      for( int j = j1; j < j2; j++ )
+        {
+          r = qMax( r, chord( x, y, z, m_ux[fix[j]], m_uy[fix[j]], m_uz[fix[j]] ) );
+        }
+
+      bx[b] = x;
+      by[b] = y;
+      bz[b] = z;
+      bRadius[b] = maxArc( r );
+    }
+
+  // Upper bound of the distance from every point to any other point and
+  // of the track diameter. Used to close dead ends of the table early.
+  QVector<double> farthest( n, 0.0 );
+  double diameter = 0.0;
+
+  if( lowerBound > 0.0 )
+    {
+      for( int i = 0; i < n; i++ )
+        {
+          const double x = m_ux[fix[i]];
+          const double y = m_uy[fix[i]];
+          const double z = m_uz[fix[i]];
+
+          double far = 0.0;
+
+          for( int b = 0; b < nb; b++ )
             {
-              progress->setValue( index );
+              far = qMax( far, maxArc( chord( x, y, z, bx[b], by[b], bz[b] ) ) + bRadius[b] );
             }
 
-          L[index] = 0;
-          c = 0;
+          farthest[i] = far;
+          diameter = qMax( diameter, far );
+        }
+    }
 
-          for( int j = 0; j < i; j++ )
+  // Points of the best task ending at a point, for the previous and the
+  // current number of legs. A negative value marks a point, which can not
+  // be part of a task better than the lower bound.
+  QVector<double> prev( n, 0.0 ), cur( n, 0.0 );
+  QVector<double> blockMax( nb );
+
+  // The predecessor of a point in the best task for every number of legs.
+  QVector<unsigned int> w( (LEGS + 1) * n, 0 );
+
+  SolveState state;
+  state.n            = n;
+  state.nb           = nb;
+  state.fix          = fix;
+  state.bx           = bx.constData();
+  state.by           = by.constData();
+  state.bz           = bz.constData();
+  state.bRadius      = bRadius.constData();
+  state.blockMax     = blockMax.constData();
+  state.farthest     = farthest.constData();
+  state.diameter     = diameter;
+  state.lowerBound   = lowerBound;
+  state.tolerance    = 1e-9 * ( 1.0 + lowerBound );
+  state.showProgress = showProgress;
+  state.w            = w.data();
+
+  // The costs of a row grow with its index. The row ranges are chosen so,
+  // that they have nearly the same costs.
+  const int tasks = qMax( 1, qMin( 4 * m_pool->maxThreadCount(), n / OPT_MIN_ROWS ) );
+
+  QVector<int> bounds( tasks + 1 );
+
+  for( int t = 0; t <= tasks; t++ )
+    {
+      bounds[t] = (int) ( n * sqrt( double(t) / tasks ) );
+    }
+
+  bounds[tasks] = n;
+
+  QSemaphore done;
+
+  for( int k = 0; k <= LEGS; k++ )
+    {
+      state.wLeg = ( k > 0 ) ? weight( k ) : 0.0;
+
+      // Upper bound of the points, which can be added after a point.
+      state.restWeight = 0.0;
+
+      for( int m = k + 2; m <= LEGS; m++ )
+        {
+          state.restWeight += weight( m );
+        }
+
+      state.nextWeight = ( k < LEGS ) ? weight( k + 1 ) : 0.0;
+
+      if( k > 0 )
+        {
+          for( int b = 0; b < nb; b++ )
             {
-              c = L[j + ii] + wLeg * dist( rp[j], rp[i] );
+              const int j1 = b * OPT_BLOCK_SIZE;
+              const int j2 = qMin( j1 + OPT_BLOCK_SIZE, n );
+
+              double max = -1.0;
 
-              if( c > L[index] )
+              for( int j = j1; j < j2; j++ )
                 {
-                  L[index] = c;
-                  w[index] = j;
+                  max = qMax( max, prev[j] );
                 }
+
+              blockMax[b] = max;
+            }
+        }
+
+      state.prev = prev.constData();
+      state.cur  = cur.data();
+
+      // The last row range is solved by this thread.
+      int started = 0;
+
+      for( int t = 0; t < tasks - 1; t++ )
+        {
+          if( bounds[t] < bounds[t + 1] )
+            {
+              m_pool->start( new OptimizationRowTask( this, &state, k,
+                                                      bounds[t], bounds[t + 1],
+                                                      &done ) );
+              started++;
             }
         }
+
+      __solveRows( state, k, bounds[tasks - 1], bounds[tasks] );
+
+      done.acquire( started );
+
+      if( stopit.fetchAndAddOrdered( 0 ) != 0 )
+        {
+          return false;
+        }
+
+      prev.swap( cur );
     }
 
   // find maximal length i.e. points
-  points = 0;
+  resultPoints = 0;
+  resultList[LEGS] = 0;
 
-  for( int i = 0; i < n - 1; i++ )
+  for( int i = 0; i < n; i++ )
     {
-      if( L[i + LEGS * n] > points )
+      if( prev[i] > resultPoints )
         {
-          points = L[i + LEGS * n];
-          pointList[LEGS] = i;
+          resultPoints = prev[i];
+          resultList[LEGS] = i;
         }
     }
 
   // find waypoints
   for( int k = LEGS - 1; k >= 0; k-- )
     {
-      qWarning( "  k:%d\tpointList[k+1]:%d", k, (int) pointList[k + 1] );
-      pointList[k] = w[pointList[k + 1] + (k + 1) * n];
-      qWarning( "->k:%d\tpointList[k]:%d", k, (int) pointList[k] );
+      resultList[k] = w[(k + 1) * n + resultList[k + 1]];
     }
 
-  distance = dist(route.at(pointList[0]),route.at(pointList[1]))+
-    dist(route.at(pointList[1]),route.at(pointList[2]))+
-    dist(route.at(pointList[2]),route.at(pointList[3]))+
-    dist(route.at(pointList[3]),route.at(pointList[4]))+
-    dist(route.at(pointList[4]),route.at(pointList[5]))+
-    dist(route.at(pointList[5]),route.at(pointList[6]));
+  // Map the indices to the fixes of the track.
+  for( int k = 0; k <= LEGS; k++ )
+    {
+      resultList[k] = fix[resultList[k]];
+    }
 
-  qWarning("Distance:%f\nPoints:%f", distance, points);
+  return true;
+}
+
+void Optimization::__solveRows( SolveState& state,
+                                const int k,
+                                const int i1,
+                                const int i2 )
+{
+  const int n = state.n;
+  const int* fix = state.fix;
+  const double* prev = state.prev;
+  double* cur = state.cur;
+  unsigned int* w = state.w;
 
-  // free memory
-  free( L );
-  free( w );
-  free( rp );
+  // Rows of the range already reported as progress.
+  int reported = i1;
 
-  if( progress )
+  for( int i = i1; i < i2; i++ )
     {
-      progress->setValue( 0 );
+      if( ( i & 63 ) == 0 && i > i1 )
+        {
+          if( state.showProgress )
+            {
+              emit progress( m_rowsDone.fetchAndAddOrdered( i - reported ) + i - reported );
+              reported = i;
+            }
+
+          if( stopit.fetchAndAddOrdered( 0 ) != 0 )
+            {
+              return;
+            }
+        }
+
+      double best = 0.0;
+      int bestJ = -1;
+      bool deadPredecessor = false;
+
+      if( k > 0 )
+        {
+          const int fi = fix[i];
+          const double x = m_ux[fi];
+          const double y = m_uy[fi];
+          const double z = m_uz[fi];
+
+          // The predecessor of the previous point is a good first guess.
+          // Only rows of the own range are read, the others are in work.
+          if( i > i1 )
+            {
+              const int j = w[k * n + i - 1];
+
+              if( j < i && prev[j] >= 0.0 )
+                {
+                  const double c = prev[j] + state.wLeg * __dist( fix[j], fi );
+
+                  if( c > best )
+                    {
+                      best = c;
+                      bestJ = j;
+                    }
+                }
+            }
+
+          for( int b = 0; b < state.nb; b++ )
+            {
+              const int j1 = b * OPT_BLOCK_SIZE;
+
+              if( j1 >= i )
+                {
+                  break;
+                }
+
+              if( state.blockMax[b] < 0.0 )
+                {
+                  deadPredecessor = true;
+                  continue;
+                }
+
+              const double bound = state.blockMax[b] +
+                state.wLeg * ( maxArc( chord( x, y, z, state.bx[b], state.by[b], state.bz[b] ) ) +
+                               state.bRadius[b] );
+
+              if( bound + state.tolerance < best )
+                {
+                  // No point of this block can improve the result.
+                  continue;
+                }
+
+              const int j2 = qMin( j1 + OPT_BLOCK_SIZE, i );
+
+              for( int j = j1; j < j2; j++ )
+                {
+                  if( prev[j] < 0.0 )
+                    {
+                      deadPredecessor = true;
+                      continue;
+                    }
+
+                  const double c = prev[j] + state.wLeg * __dist( fix[j], fi );
+
+                  // Same choice as a scan in ascending order.
+                  if( c > best || ( c == best && bestJ > j ) )
+                    {
+                      best = c;
+                      bestJ = j;
+                    }
+                }
+            }
+        }
+
+      cur[i] = best;
+      w[k * n + i] = ( bestJ >= 0 ) ? bestJ : 0;
+
+      if( bestJ < 0 && deadPredecessor )
+        {
+          // All predecessors are dead ends, therefore this point too.
+          cur[i] = -1.0;
+        }
+      else if( state.lowerBound > 0.0 &&
+               best + state.nextWeight * state.farthest[i] +
+               state.restWeight * state.diameter + state.tolerance < state.lowerBound )
+        {
+          // Every task through this point is worse than the lower bound.
+          cur[i] = -1.0;
+        }
     }
 
-  optimized=true;
+  if( state.showProgress )
+    {
+      emit progress( m_rowsDone.fetchAndAddOrdered( i2 - reported ) + i2 - reported );
+    }
 }
@@ -19,16 +19,32 @@
 #ifndef OPTIMIZATION_H
 #define OPTIMIZATION_H
 
+#include <QAtomicInt>
 #include <QProgressBar>
+#include <QVector>
 
 #include "mapcalc.h"
-#include "flightpoint.h"
+#include "flighttrack.h"
 
 /**
  * \class Optimization
  *
   * \brief This class optimizes a task according to the OLC 2003 rules
   *
+  * The best task is found by dynamic programming over the fixes. The best
+  * predecessor of a fix is searched block wise. Every block of consecutive
+  * fixes has a bounding cap on the unit sphere, which gives an upper bound
+  * of the distances without any trigonometric function. Blocks, which can
+  * not improve the current best value, are skipped. A first solution on a
+  * decimated track gives a lower bound, which closes hopeless fixes early.
+  * The result is the same as of the full table search.
+  *
+  * The optimization runs in the background. The rows of a leg depend only
+  * on the rows of the previous leg, therefore every leg is split into row
+  * ranges, which are solved in parallel on a thread pool. The progress is
+  * reported with the signal \ref progress, the end of a run with the signal
+  * \ref finished.
+  *
   * \author Christof Bodner, Axel Pauli
   *
   * \date 2003-2011
@@ -37,7 +53,9 @@
   */
 
 #define LEGS 6  // number of legs
-  
+
+class QThreadPool;
+
 class Optimization : public QObject
 {
   Q_OBJECT
@@ -55,7 +73,7 @@ public:
   */
   Optimization( unsigned int firstPoint,
                 unsigned int lastPoint,
-                QList<FlightPoint*> route,
+                const FlightTrack& route,
                 QProgressBar *progressBar=0 );
  /**
   * Destructor
@@ -65,10 +83,22 @@ public:
   * @return the indices, the points awarded and the distance of the optimized task
   */
   double optimizationResult( unsigned int* pointList,double *points );
+ /**
+  * @return true, if an optimization is running in the background
+  */
+  bool isRunning() const
+  {
+    return running;
+  };
+ /**
+  * Waits until a running optimization has left the worker threads.
+  */
+  void waitForDone();
 
 public slots:
  /**
-  * Starts optimization of the given route
+  * Starts the optimization of the given route in the background. The
+  * result is announced with the signal finished.
   */
   void run();
  /**
@@ -84,19 +114,111 @@ public slots:
   */ 
   void enableRun();
 
+signals:
+ /**
+  * Emitted from the worker threads during the optimization.
+  *
+  * @param value Number of solved table rows, the range is set at the
+  *        progress bar given to the constructor.
+  */
+  void progress( int value );
+ /**
+  * Emitted in the thread of the optimization, when a run has ended.
+  *
+  * @param ok False, if the run was canceled.
+  */
+  void finished( bool ok );
+
+private slots:
+ /**
+  * Called via a queued connection, when the background run has ended.
+  */
+  void slotRunFinished( bool ok );
+
 private:
 
+  friend class OptimizationTask;
+  friend class OptimizationRowTask;
+
+  class SolveState;
+
   double weight(unsigned int k); // different weight for the legs
 
-  QList<FlightPoint*> original_route;
-  QList<FlightPoint*> route;
+  /** Precalculates the coordinates of the fixes to be optimized. */
+  void __prepare();
+
+  /** Resets the progress bar and frees the precalculated data. */
+  void __finishRun();
+
+  /**
+   * Runs both optimization stages. Called in a worker thread.
+   *
+   * \return False, if the optimization was canceled.
+   */
+  bool __run();
+
+  /**
+   * Distance in km between two fixes, given as index relative to start.
+   * The result is identical to dist() of mapcalc.
+   */
+  double __dist( const int i, const int j ) const;
+
+  /**
+   * Solves the optimization for the given fixes.
+   *
+   * \param fixes The fixes to be used, as ascending index relative to start.
+   *
+   * \param lowerBound Points of a known task. Fixes, which can not be part
+   *        of a better task, are skipped. Zero, if unknown.
+   *
+   * \param showProgress If true, the signal \ref progress is emitted.
+   *
+   * \param resultList The LEGS + 1 points of the best task.
+   *
+   * \param resultPoints The points of the best task.
+   *
+   * \return False, if the optimization was canceled.
+   */
+  bool __solve( const QVector<int>& fixes,
+                const double lowerBound,
+                const bool showProgress,
+                unsigned int* resultList,
+                double& resultPoints );
+
+  /**
+   * Solves the rows [i1, i2) of the leg k. Called in parallel for the
+   * row ranges of a leg.
+   */
+  void __solveRows( SolveState& state, const int k, const int i1, const int i2 );
+
+  FlightTrack original_route;
   double distance, points;
   unsigned int pointList[LEGS+1];   // solution points
   unsigned int start;    // first
   unsigned int stop;     // last valid point
   bool  optimized;
-  bool  stopit;
-  QProgressBar *progress;
+  bool  running;
+  QAtomicInt stopit;
+  QProgressBar *progressBar;
+
+  /** Worker threads of the optimization. */
+  QThreadPool* m_pool;
+
+  /** Number of solved table rows of the running run. */
+  QAtomicInt m_rowsDone;
+
+  /** Leg weights of the OLC 2003 rule. */
+  QVector<double> m_weights;
+
+  /** Precalculated coordinates of the fixes between start and stop. */
+  QVector<double> m_lat;
+  QVector<double> m_lon;
+  QVector<double> m_cosLat;
+
+  /** Positions of the fixes on the unit sphere. */
+  QVector<double> m_ux;
+  QVector<double> m_uy;
+  QVector<double> m_uz;
 };
 
 #endif
@@ -35,7 +35,9 @@ extern MainWindow*  _mainWindow;
  *  TRUE to construct a modal wizard.
  */
 OptimizationWizard::OptimizationWizard( QWidget* parent ) :
-  QWizard( parent )
+  QWizard( parent ),
+  flight( 0 ),
+  optimization( 0 )
 {
   setObjectName("OptimizationWizard");
   setWindowTitle( tr( "OLC Optimization" ) );
@@ -172,6 +174,8 @@ OptimizationWizard::OptimizationWizard( QWidget* parent ) :
  */
 OptimizationWizard::~OptimizationWizard()
 {
+  // Stops a running optimization and waits for its worker threads.
+  delete optimization;
 }
 
 /*
@@ -204,6 +208,9 @@ void OptimizationWizard::init()
 
   optimization = new Optimization( 0, route.count(), route, progress );
 
+  connect( optimization, SIGNAL(finished(bool)),
+           this, SLOT(slotOptimizationFinished(bool)) );
+
   // That loads the current flight in the evaluation dialog.
   evaluationDialog->slotShowFlightData();
 
@@ -221,24 +228,41 @@ void OptimizationWizard::init()
 
 void OptimizationWizard::slotStartOptimization()
 {
+  if( optimization == 0 || optimization->isRunning() )
+    {
+      return;
+    }
+
   optimization->enableRun();
   btnStart->setEnabled(false);
   btnStop->setEnabled(true);
+  timeButton->setEnabled(false);
 
+  // The optimization runs in the background, the result is shown by
+  // slotOptimizationFinished().
   optimization->run();
+}
+
+void OptimizationWizard::slotOptimizationFinished( bool ok )
+{
+  btnStop->setEnabled(false);
+  btnStart->setEnabled(true);
+  timeButton->setEnabled(true);
+
+  if( ! ok ) // optimization was canceled
+    {
+      return;
+    }
 
   unsigned int idList[LEGS + 3];
   double points;
   double distance = optimizationResult( idList, &points );
 
-  if( distance < 0.0 ) // optimization was canceled
+  if( distance < 0.0 )
     {
       return;
     }
 
-  btnStop->setEnabled(false);
-  btnStart->setEnabled(true);
-
   QString text, distText, rawPointText;
   rawPointText.sprintf(" %.2f", points);
   distText.sprintf(" %.2f km  ", distance);
@@ -251,47 +275,47 @@ void OptimizationWizard::slotStartOptimization()
   text += "</thead><tbody>";
 
   text += "<tr><td>" + tr("Begin of Soaring") + "</td><td>"
-      + printTime(route.at(idList[0])->time,true) + "</td><td>"
-      + WGSPoint::printPos(route.at(idList[0])->origP.lat()) + "</td><td>"
-      + WGSPoint::printPos(route.at(idList[0])->origP.lon(), false) + "</td><td></td></tr>";
+      + printTime(route.time(idList[0]),true) + "</td><td>"
+      + WGSPoint::printPos(route.lat(idList[0])) + "</td><td>"
+      + WGSPoint::printPos(route.lon(idList[0]), false) + "</td><td></td></tr>";
   text += "<tr><td>" + tr("Begin of Task") + "</td><td>"
-      + printTime(route.at(idList[1])->time,true) + "</td><td>"
-      + WGSPoint::printPos(route.at(idList[1])->origP.lat()) + "</td><td>"
-      + WGSPoint::printPos(route.at(idList[1])->origP.lon(), false) + "</td><td></td></tr>";
+      + printTime(route.time(idList[1]),true) + "</td><td>"
+      + WGSPoint::printPos(route.lat(idList[1])) + "</td><td>"
+      + WGSPoint::printPos(route.lon(idList[1]), false) + "</td><td></td></tr>";
   text += "<tr><td>" + tr("1.Turnpoint") + "</td><td>"
-      + printTime(route.at(idList[2])->time,true) + "</td><td>"
-      + WGSPoint::printPos(route.at(idList[2])->origP.lat()) + "</td><td>"
-      + WGSPoint::printPos(route.at(idList[2])->origP.lon(), false) + "</td><td ALIGN=right>"
-      + QString("%1km</td></tr>").arg(dist(route.at(idList[1]),route.at(idList[2])),0,'f',2);
+      + printTime(route.time(idList[2]),true) + "</td><td>"
+      + WGSPoint::printPos(route.lat(idList[2])) + "</td><td>"
+      + WGSPoint::printPos(route.lon(idList[2]), false) + "</td><td ALIGN=right>"
+      + QString("%1km</td></tr>").arg(route.distance(idList[1], idList[2]),0,'f',2);
   text += "<tr><td>" + tr("2.Turnpoint") + "</td><td>"
-      + printTime(route.at(idList[3])->time,true) + "</td><td>"
-      + WGSPoint::printPos(route.at(idList[3])->origP.lat()) + "</td><td>"
-      + WGSPoint::printPos(route.at(idList[3])->origP.lon(), false) + "</td><td ALIGN=right>"
-      + QString("%1km</td></tr>").arg(dist(route.at(idList[2]),route.at(idList[3])),0,'f',2);
+      + printTime(route.time(idList[3]),true) + "</td><td>"
+      + WGSPoint::printPos(route.lat(idList[3])) + "</td><td>"
+      + WGSPoint::printPos(route.lon(idList[3]), false) + "</td><td ALIGN=right>"
+      + QString("%1km</td></tr>").arg(route.distance(idList[2], idList[3]),0,'f',2);
   text += "<tr><td>" + tr("3.Turnpoint") + "</td><td>"
-      + printTime(route.at(idList[4])->time,true) + "</td><td>"
-      + WGSPoint::printPos(route.at(idList[4])->origP.lat()) + "</td><td>"
-      + WGSPoint::printPos(route.at(idList[4])->origP.lon(), false) + "</td><td ALIGN=right>"
-      + QString("%1km</td></tr>").arg(dist(route.at(idList[3]),route.at(idList[4])),0,'f',2);
+      + printTime(route.time(idList[4]),true) + "</td><td>"
+      + WGSPoint::printPos(route.lat(idList[4])) + "</td><td>"
+      + WGSPoint::printPos(route.lon(idList[4]), false) + "</td><td ALIGN=right>"
+      + QString("%1km</td></tr>").arg(route.distance(idList[3], idList[4]),0,'f',2);
   text += "<tr><td>" + tr("4.Turnpoint") + "</td><td>"
-      + printTime(route.at(idList[5])->time,true) + "</td><td>"
-      + WGSPoint::printPos(route.at(idList[5])->origP.lat()) + "</td><td>"
-      + WGSPoint::printPos(route.at(idList[5])->origP.lon(), false) + "</td><td ALIGN=right>"
-      + QString("%1km</td></tr>").arg(dist(route.at(idList[4]),route.at(idList[5])),0,'f',2);
+      + printTime(route.time(idList[5]),true) + "</td><td>"
+      + WGSPoint::printPos(route.lat(idList[5])) + "</td><td>"
+      + WGSPoint::printPos(route.lon(idList[5]), false) + "</td><td ALIGN=right>"
+      + QString("%1km</td></tr>").arg(route.distance(idList[4], idList[5]),0,'f',2);
   text += "<tr><td>" +tr("5.Turnpoint") + "</td><td>"
-      + printTime(route.at(idList[6])->time,true) + "</td><td>"
-      + WGSPoint::printPos(route.at(idList[6])->origP.lat()) + "</td><td>"
-      + WGSPoint::printPos(route.at(idList[6])->origP.lon(), false) + "</td><td ALIGN=right>"
-      + QString("%1km</td></tr>").arg(dist(route.at(idList[5]),route.at(idList[6])),0,'f',2);
+      + printTime(route.time(idList[6]),true) + "</td><td>"
+      + WGSPoint::printPos(route.lat(idList[6])) + "</td><td>"
+      + WGSPoint::printPos(route.lon(idList[6]), false) + "</td><td ALIGN=right>"
+      + QString("%1km</td></tr>").arg(route.distance(idList[5], idList[6]),0,'f',2);
   text += "<tr><td>" + tr("End of Task") + "</td><td>"
-      + printTime(route.at(idList[7])->time,true) + "</td><td>"
-      + WGSPoint::printPos(route.at(idList[7])->origP.lat()) + "</td><td>"
-      + WGSPoint::printPos(route.at(idList[7])->origP.lon(), false) + "</td><td ALIGN=right>"
-      + QString("%1km</td></tr>").arg(dist(route.at(idList[6]),route.at(idList[7])),0,'f',2);
+      + printTime(route.time(idList[7]),true) + "</td><td>"
+      + WGSPoint::printPos(route.lat(idList[7])) + "</td><td>"
+      + WGSPoint::printPos(route.lon(idList[7]), false) + "</td><td ALIGN=right>"
+      + QString("%1km</td></tr>").arg(route.distance(idList[6], idList[7]),0,'f',2);
   text += "<tr><td>" + tr("End of Soaring") + "</td><td>"
-      + printTime(route.at(idList[8])->time,true) + "</td><td>"
-      + WGSPoint::printPos(route.at(idList[8])->origP.lat()) + "</td><td>"
-      + WGSPoint::printPos(route.at(idList[8])->origP.lon(), false) + "</td><td></td></tr>";
+      + printTime(route.time(idList[8]),true) + "</td><td>"
+      + WGSPoint::printPos(route.lat(idList[8])) + "</td><td>"
+      + WGSPoint::printPos(route.lon(idList[8]), false) + "</td><td></td></tr>";
   text += "</tbody></table><th>";
 
   text += "<br><table align=\"center\">";
@@ -300,7 +324,7 @@ void OptimizationWizard::slotStartOptimization()
   text += rawPointText+"</th></tr>";
   text += "</table>";
 
-  int heightDiff = route.at(idList[8])->height - route.at(idList[0])->height;
+  int heightDiff = route.height(idList[8]) - route.height(idList[0]);
 
   if (heightDiff<-1000)
     {
@@ -315,9 +339,13 @@ void OptimizationWizard::slotStartOptimization()
 
 void OptimizationWizard::slotStopOptimization()
 {
-    btnStart->setEnabled(true);
-    btnStop->setEnabled(false);
-    optimization->stopRun();
+  // The start button is enabled again, when the workers have stopped.
+  btnStop->setEnabled(false);
+
+  if( optimization )
+    {
+      optimization->stopRun();
+    }
 }
 
 void OptimizationWizard::slotSetTimes()
@@ -75,13 +75,19 @@ public slots:
 protected:
 
   Flight* flight;
-  QList<FlightPoint*> route;
+  FlightTrack route;
   Optimization* optimization;
 
 protected slots:
 
   virtual void languageChange();
 
+  /**
+   * Called, when the optimization running in the background has ended.
+   * Shows the result of the optimization.
+   */
+  virtual void slotOptimizationFinished( bool ok );
+
 };
 
 #endif // OLC_OPTIMIZATION_H
@@ -0,0 +1,486 @@
+/***********************************************************************
+**
+**   poicache.cpp
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <QtCore>
+
+#include "mapmatrix.h"
+#include "poicache.h"
+#include "runway.h"
+
+// compiled point data file token: @KPC
+#define POI_CACHE_FILE_MAGIC    0x404b5043
+
+// Version of the compiled file layout. Increment it, if the layout is changed.
+#define POI_CACHE_FILE_VERSION  1
+
+// Data stream version of the compiled files
+#define POI_CACHE_STREAM QDataStream::Qt_4_7
+
+extern MapMatrix *_globalMapMatrix;
+
+PoiCache::PoiCache( const QByteArray& filterKey, ProjectionBase* projection ) :
+  m_filterKey(filterKey),
+  m_projection(projection)
+{
+}
+
+PoiCache::~PoiCache()
+{
+}
+
+QString PoiCache::compiledFileName( const QString& sourceFile )
+{
+  return sourceFile + ".kpc";
+}
+
+bool PoiCache::__read( const QString& sourceFile,
+                       const DataKind kind,
+                       QByteArray& data ) const
+{
+  QFileInfo srcInfo( sourceFile );
+
+  if( ! srcInfo.exists() )
+    {
+      return false;
+    }
+
+  QFile cacheFile( compiledFileName( sourceFile ) );
+
+  if( ! cacheFile.exists() || ! cacheFile.open( QIODevice::ReadOnly ) )
+    {
+      return false;
+    }
+
+  // Read the whole file in one go, the records are decoded from memory.
+  QByteArray buffer = cacheFile.readAll();
+  cacheFile.close();
+
+  QDataStream in( buffer );
+  in.setVersion( POI_CACHE_STREAM );
+
+  quint32 magic;
+  quint16 version;
+  quint8 dataKind;
+  qint64 sourceSize;
+  qint64 sourceModified;
+  QByteArray filterKey;
+
+  in >> magic >> version;
+
+  if( in.status() != QDataStream::Ok ||
+      magic != POI_CACHE_FILE_MAGIC ||
+      version != POI_CACHE_FILE_VERSION )
+    {
+      return false;
+    }
+
+  in >> dataKind >> sourceSize >> sourceModified >> filterKey;
+
+  if( in.status() != QDataStream::Ok ||
+      dataKind != (quint8) kind ||
+      sourceSize != srcInfo.size() ||
+      sourceModified != (qint64) srcInfo.lastModified().toTime_t() ||
+      filterKey != m_filterKey )
+    {
+      // Compiled file is outdated or was made with other filter settings.
+      return false;
+    }
+
+  data = buffer.mid( in.device()->pos() );
+  return true;
+}
+
+bool PoiCache::__write( const QString& sourceFile,
+                        const DataKind kind,
+                        const QByteArray& data ) const
+{
+  QFileInfo srcInfo( sourceFile );
+
+  if( ! srcInfo.exists() )
+    {
+      return false;
+    }
+
+  QByteArray buffer;
+  QDataStream out( &buffer, QIODevice::WriteOnly );
+  out.setVersion( POI_CACHE_STREAM );
+
+  out << (quint32) POI_CACHE_FILE_MAGIC
+      << (quint16) POI_CACHE_FILE_VERSION
+      << (quint8) kind
+      << (qint64) srcInfo.size()
+      << (qint64) srcInfo.lastModified().toTime_t()
+      << m_filterKey;
+
+  buffer.append( data );
+
+  // Write into a temporary file first and rename it afterwards. So a reader
+  // never sees a partially written file.
+  const QString fileName = compiledFileName( sourceFile );
+  const QString tmpName  = fileName + "." +
+                           QString::number( (quintptr) QThread::currentThreadId() ) +
+                           ".tmp";
+
+  QFile tmpFile( tmpName );
+
+  if( ! tmpFile.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    {
+      qWarning() << "PoiCache: Cannot write" << tmpName;
+      return false;
+    }
+
+  if( tmpFile.write( buffer ) != buffer.size() )
+    {
+      qWarning() << "PoiCache: Write error on" << tmpName;
+      tmpFile.close();
+      tmpFile.remove();
+      return false;
+    }
+
+  tmpFile.close();
+
+  QFile::remove( fileName );
+
+  if( ! QFile::rename( tmpName, fileName ) )
+    {
+      QFile::remove( tmpName );
+      return false;
+    }
+
+  return true;
+}
+
+void PoiCache::__writePoint( QDataStream& out, const SinglePoint& sp )
+{
+  const WGSPoint wgs = sp.getWGSPosition();
+
+  out << sp.getName()
+      << sp.getShortName()
+      << (quint8) sp.getTypeID()
+      << (qint32) wgs.lat()
+      << (qint32) wgs.lon()
+      << sp.getElevation()
+      << sp.getComment()
+      << sp.getCountry();
+}
+
+SinglePoint PoiCache::__readPoint( QDataStream& in ) const
+{
+  QString name, shortName, comment, country;
+  quint8 typeID;
+  qint32 lat, lon;
+  float elevation;
+
+  in >> name >> shortName >> typeID >> lat >> lon >> elevation >> comment >> country;
+
+  // The projected position is calculated with the current map projection.
+  WGSPoint wgsPos( lat, lon );
+
+  QPoint position = ( m_projection != 0 ) ?
+                    MapMatrix::wgsToMap( m_projection, lat, lon ) :
+                    _globalMapMatrix->wgsToMap( wgsPos );
+
+  return SinglePoint( name, shortName, (BaseMapElement::objectType) typeID,
+                      wgsPos, position, elevation, comment, country );
+}
+
+void PoiCache::__writeAirfield( QDataStream& out, const Airfield& af )
+{
+  __writePoint( out, af );
+
+  const QList<Runway>& rwList = af.getRunwayList();
+
+  out << af.getICAO()
+      << af.getFrequency()
+      << af.getAtis()
+      << af.hasWinch()
+      << af.hasTowing()
+      << af.isLandable()
+      << (quint16) rwList.size();
+
+  for( int i = 0; i < rwList.size(); i++ )
+    {
+      const Runway& rw = rwList.at(i);
+
+      out << rw.m_length
+          << (quint16) rw.m_heading.first
+          << (quint16) rw.m_heading.second
+          << (quint8) rw.m_surface
+          << rw.m_isOpen
+          << rw.m_isBidirectional
+          << rw.m_width;
+    }
+}
+
+Airfield PoiCache::__readAirfield( QDataStream& in ) const
+{
+  SinglePoint sp = __readPoint( in );
+
+  QString icao;
+  float frequency, atis;
+  bool winch, towing, landable;
+  quint16 rwCount;
+
+  in >> icao >> frequency >> atis >> winch >> towing >> landable >> rwCount;
+
+  Airfield af( sp.getName(), icao, sp.getShortName(), sp.getTypeID(),
+               sp.getWGSPosition(), sp.getPosition(), sp.getElevation(),
+               frequency, sp.getCountry(), sp.getComment(),
+               winch, towing, landable, atis );
+
+  for( int i = 0; i < rwCount && in.status() == QDataStream::Ok; i++ )
+    {
+      float length, width;
+      quint16 heading1, heading2;
+      quint8 surface;
+      bool open, bidirectional;
+
+      in >> length >> heading1 >> heading2 >> surface >> open >> bidirectional >> width;
+
+      Runway rw( length,
+                 QPair<ushort, ushort> ( heading1, heading2 ),
+                 (enum Runway::SurfaceType) surface,
+                 open, bidirectional, width );
+
+      af.addRunway( rw );
+    }
+
+  return af;
+}
+
+void PoiCache::__writeRadioPoint( QDataStream& out, const RadioPoint& rp )
+{
+  __writePoint( out, rp );
+
+  out << rp.getICAO()
+      << rp.getFrequency()
+      << rp.getChannel()
+      << rp.getRange()
+      << rp.getDeclination()
+      << rp.isAligned2TrueNorth();
+}
+
+RadioPoint PoiCache::__readRadioPoint( QDataStream& in ) const
+{
+  SinglePoint sp = __readPoint( in );
+
+  QString icao, channel;
+  float frequency, range, declination;
+  bool aligned2TrueNorth;
+
+  in >> icao >> frequency >> channel >> range >> declination >> aligned2TrueNorth;
+
+  RadioPoint rp( sp.getName(), icao, sp.getShortName(), sp.getTypeID(),
+                 sp.getWGSPosition(), sp.getPosition(), frequency, channel,
+                 sp.getElevation(), sp.getCountry(), range, declination,
+                 aligned2TrueNorth );
+
+  rp.setComment( sp.getComment() );
+
+  return rp;
+}
+
+bool PoiCache::load( const QString& sourceFile,
+                     QList< QList<Airfield> >& lists ) const
+{
+  QByteArray data;
+
+  if( ! __read( sourceFile, AirfieldData, data ) )
+    {
+      return false;
+    }
+
+  QDataStream in( data );
+  in.setVersion( POI_CACHE_STREAM );
+
+  quint32 listCount;
+  in >> listCount;
+
+  QList< QList<Airfield> > cached;
+
+  for( quint32 l = 0; l < listCount && in.status() == QDataStream::Ok; l++ )
+    {
+      quint32 count;
+      in >> count;
+
+      QList<Airfield> list;
+      list.reserve( count );
+
+      for( quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++ )
+        {
+          list.append( __readAirfield( in ) );
+        }
+
+      cached.append( list );
+    }
+
+  if( in.status() != QDataStream::Ok )
+    {
+      qWarning() << "PoiCache: Truncated file" << compiledFileName( sourceFile );
+      return false;
+    }
+
+  lists = cached;
+  return true;
+}
+
+bool PoiCache::load( const QString& sourceFile,
+                     QList<Airfield>& airfieldList ) const
+{
+  QList< QList<Airfield> > lists;
+
+  if( ! load( sourceFile, lists ) || lists.size() != 1 )
+    {
+      return false;
+    }
+
+  airfieldList += lists.first();
+  return true;
+}
+
+bool PoiCache::load( const QString& sourceFile,
+                     QList<RadioPoint>& navaidList ) const
+{
+  QByteArray data;
+
+  if( ! __read( sourceFile, RadioPointData, data ) )
+    {
+      return false;
+    }
+
+  QDataStream in( data );
+  in.setVersion( POI_CACHE_STREAM );
+
+  quint32 count;
+  in >> count;
+
+  QList<RadioPoint> cached;
+  cached.reserve( count );
+
+  for( quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++ )
+    {
+      cached.append( __readRadioPoint( in ) );
+    }
+
+  if( in.status() != QDataStream::Ok )
+    {
+      qWarning() << "PoiCache: Truncated file" << compiledFileName( sourceFile );
+      return false;
+    }
+
+  navaidList += cached;
+  return true;
+}
+
+bool PoiCache::load( const QString& sourceFile,
+                     QList<SinglePoint>& hotspotList ) const
+{
+  QByteArray data;
+
+  if( ! __read( sourceFile, SinglePointData, data ) )
+    {
+      return false;
+    }
+
+  QDataStream in( data );
+  in.setVersion( POI_CACHE_STREAM );
+
+  quint32 count;
+  in >> count;
+
+  QList<SinglePoint> cached;
+  cached.reserve( count );
+
+  for( quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++ )
+    {
+      cached.append( __readPoint( in ) );
+    }
+
+  if( in.status() != QDataStream::Ok )
+    {
+      qWarning() << "PoiCache: Truncated file" << compiledFileName( sourceFile );
+      return false;
+    }
+
+  hotspotList += cached;
+  return true;
+}
+
+bool PoiCache::save( const QString& sourceFile,
+                     const QList< QList<Airfield> >& lists ) const
+{
+  QByteArray data;
+  QDataStream out( &data, QIODevice::WriteOnly );
+  out.setVersion( POI_CACHE_STREAM );
+
+  out << (quint32) lists.size();
+
+  for( int l = 0; l < lists.size(); l++ )
+    {
+      const QList<Airfield>& list = lists.at(l);
+
+      out << (quint32) list.size();
+
+      for( int i = 0; i < list.size(); i++ )
+        {
+          __writeAirfield( out, list.at(i) );
+        }
+    }
+
+  return __write( sourceFile, AirfieldData, data );
+}
+
+bool PoiCache::save( const QString& sourceFile,
+                     const QList<Airfield>& airfieldList ) const
+{
+  QList< QList<Airfield> > lists;
+  lists.append( airfieldList );
+
+  return save( sourceFile, lists );
+}
+
+bool PoiCache::save( const QString& sourceFile,
+                     const QList<RadioPoint>& navaidList ) const
+{
+  QByteArray data;
+  QDataStream out( &data, QIODevice::WriteOnly );
+  out.setVersion( POI_CACHE_STREAM );
+
+  out << (quint32) navaidList.size();
+
+  for( int i = 0; i < navaidList.size(); i++ )
+    {
+      __writeRadioPoint( out, navaidList.at(i) );
+    }
+
+  return __write( sourceFile, RadioPointData, data );
+}
+
+bool PoiCache::save( const QString& sourceFile,
+                     const QList<SinglePoint>& hotspotList ) const
+{
+  QByteArray data;
+  QDataStream out( &data, QIODevice::WriteOnly );
+  out.setVersion( POI_CACHE_STREAM );
+
+  out << (quint32) hotspotList.size();
+
+  for( int i = 0; i < hotspotList.size(); i++ )
+    {
+      __writePoint( out, hotspotList.at(i) );
+    }
+
+  return __write( sourceFile, SinglePointData, data );
+}
@@ -0,0 +1,162 @@
+/***********************************************************************
+**
+**   poicache.h
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#ifndef POI_CACHE_H
+#define POI_CACHE_H
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QList>
+#include <QString>
+
+#include "airfield.h"
+#include "radiopoint.h"
+#include "singlepoint.h"
+
+class ProjectionBase;
+
+/**
+ * \class PoiCache
+ *
+ * \author agent
+ *
+ * \brief Compiled form of the point data of a Welt2000 or openAIP file.
+ *
+ * The point loaders parse their source files and filter the entries by the
+ * user's country list, the radius around the home position and further
+ * options. This class stores the filtered result of a source file in a
+ * compiled file beside the source. A compiled file is only accepted, if the
+ * size and the modification time of its source file and the filter key are
+ * unchanged. The filter key is built by the loader from all settings, which
+ * influence its result.
+ *
+ * The compiled file is read in one go and decoded from memory. Only the
+ * WGS84 positions are stored, the projected positions are calculated with
+ * the current map projection during load.
+ *
+ * The class has no mutable state after construction. It can be used from
+ * several threads at the same time, if it got a projection.
+ *
+ * \date 2026
+ */
+class PoiCache
+{
+ public:
+
+  /**
+   * \param filterKey All filter settings of the loader, which influence
+   *        the loaded point data.
+   *
+   * \param projection Projection of the loaded positions, private to the
+   *        caller. If it is null, the projection of the global map matrix
+   *        is used, what is only allowed in the main thread.
+   */
+  PoiCache( const QByteArray& filterKey, ProjectionBase* projection = 0 );
+
+  virtual ~PoiCache();
+
+  /**
+   * Loads the compiled airfield lists of a source file.
+   *
+   * \param sourceFile The path of the source file.
+   *
+   * \param lists The loaded lists in the order in which they were saved.
+   *
+   * \return True, if a valid compiled file has been loaded.
+   */
+  bool load( const QString& sourceFile, QList< QList<Airfield> >& lists ) const;
+
+  /**
+   * Loads the compiled airfields of a source file and appends them to the
+   * passed list.
+   */
+  bool load( const QString& sourceFile, QList<Airfield>& airfieldList ) const;
+
+  /**
+   * Loads the compiled navaids of a source file and appends them to the
+   * passed list.
+   */
+  bool load( const QString& sourceFile, QList<RadioPoint>& navaidList ) const;
+
+  /**
+   * Loads the compiled hotspots of a source file and appends them to the
+   * passed list.
+   */
+  bool load( const QString& sourceFile, QList<SinglePoint>& hotspotList ) const;
+
+  /**
+   * Writes the compiled airfield lists of a source file.
+   *
+   * \param sourceFile The path of the source file.
+   *
+   * \param lists The filtered lists parsed from the source file.
+   *
+   * \return True in case of success.
+   */
+  bool save( const QString& sourceFile, const QList< QList<Airfield> >& lists ) const;
+
+  /** Writes the compiled airfields of a source file. */
+  bool save( const QString& sourceFile, const QList<Airfield>& airfieldList ) const;
+
+  /** Writes the compiled navaids of a source file. */
+  bool save( const QString& sourceFile, const QList<RadioPoint>& navaidList ) const;
+
+  /** Writes the compiled hotspots of a source file. */
+  bool save( const QString& sourceFile, const QList<SinglePoint>& hotspotList ) const;
+
+  /**
+   * \return The path of the compiled file belonging to a source file.
+   */
+  static QString compiledFileName( const QString& sourceFile );
+
+ private:
+
+  /** Kinds of the stored point data. */
+  enum DataKind { AirfieldData = 1, RadioPointData = 2, SinglePointData = 3 };
+
+  /**
+   * Reads the compiled file and checks its header.
+   *
+   * \param data The file content behind the header.
+   *
+   * \return True, if the compiled file is valid for the source file.
+   */
+  bool __read( const QString& sourceFile,
+               const DataKind kind,
+               QByteArray& data ) const;
+
+  /**
+   * Writes the header and the passed records into the compiled file.
+   */
+  bool __write( const QString& sourceFile,
+                const DataKind kind,
+                const QByteArray& data ) const;
+
+  static void __writePoint( QDataStream& out, const SinglePoint& sp );
+  static void __writeAirfield( QDataStream& out, const Airfield& af );
+  static void __writeRadioPoint( QDataStream& out, const RadioPoint& rp );
+
+  SinglePoint __readPoint( QDataStream& in ) const;
+  Airfield __readAirfield( QDataStream& in ) const;
+  RadioPoint __readRadioPoint( QDataStream& in ) const;
+
+  /** Settings of the loader, which influence the point data. */
+  QByteArray m_filterKey;
+
+  /** Projection of the loaded positions or null. */
+  ProjectionBase* m_projection;
+};
+
+#endif
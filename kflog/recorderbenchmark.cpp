@@ -0,0 +1,264 @@
+/***********************************************************************
+**
+**   recorderbenchmark.cpp
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <dlfcn.h>
+#include <stdio.h>
+
+#include <QtCore>
+
+#include "flightrecorderpluginbase.h"
+#include "recorderbenchmark.h"
+#include "recorderdialog.h"
+
+RecorderBenchmark::RecorderBenchmark( const RecorderSimulator::Protocol protocol,
+                                      const int flights,
+                                      const int fixes,
+                                      const int lineSpeed ) :
+  m_protocol(protocol),
+  m_simulator(protocol, flights, fixes),
+  m_lineSpeed(lineSpeed),
+  m_libHandle(0),
+  m_recorder(0),
+  m_out(stdout),
+  m_failed(false)
+{
+  m_simulator.setLineSpeed( lineSpeed );
+}
+
+RecorderBenchmark::~RecorderBenchmark()
+{
+  if( m_recorder )
+    {
+      delete m_recorder;
+    }
+
+  if( m_libHandle )
+    {
+      dlclose( m_libHandle );
+    }
+
+  m_simulator.stop();
+}
+
+bool RecorderBenchmark::__loadPlugin()
+{
+  QString libName;
+
+  switch( m_protocol )
+    {
+      case RecorderSimulator::Filser:
+        libName = "libkfrfil.so";
+        break;
+      case RecorderSimulator::Cambridge:
+        libName = "libkfrcai.so";
+        break;
+      case RecorderSimulator::Flarm:
+        libName = "libkfrfla.so";
+        break;
+      case RecorderSimulator::Volkslogger:
+        libName = "libkfrgcs.so";
+        break;
+    }
+
+  QString libPath = RecorderDialog::getLibraryPath() + "/" + libName;
+
+  m_libHandle = dlopen( libPath.toLatin1().data(), RTLD_NOW );
+
+  if( ! m_libHandle )
+    {
+      m_out << "Cannot load " << libPath << ": " << dlerror() << endl;
+      return false;
+    }
+
+  FlightRecorderPluginBase* (*getRecorder)();
+
+  getRecorder = (FlightRecorderPluginBase* (*) ()) dlsym( m_libHandle, "getRecorder" );
+
+  if( ! getRecorder )
+    {
+      m_out << "getRecorder function not defined in " << libPath << endl;
+      return false;
+    }
+
+  m_recorder = getRecorder();
+
+  return m_recorder != 0;
+}
+
+void RecorderBenchmark::__report( const QString& step, const int rc, const qint64 ms )
+{
+  qint64 received, sent;
+
+  m_simulator.takeCounters( received, sent );
+
+  const qint64 bytes = received + sent;
+
+  QString result;
+
+  if( rc == FR_NOTSUPPORTED )
+    {
+      result = "n/a";
+    }
+  else if( rc < FR_OK )
+    {
+      result = "error";
+      m_failed = true;
+    }
+  else
+    {
+      result = "ok";
+    }
+
+  // The transfer rate is calculated with a minimum duration of 1ms.
+  const qint64 rate = bytes * 1000 / qMax( (qint64) 1, ms );
+
+  m_out << qSetFieldWidth(16) << left << step
+        << qSetFieldWidth(6) << result
+        << qSetFieldWidth(10) << right << ms
+        << qSetFieldWidth(12) << bytes
+        << qSetFieldWidth(12) << rate
+        << qSetFieldWidth(0) << endl;
+}
+
+bool RecorderBenchmark::run()
+{
+  if( ! m_simulator.open() )
+    {
+      m_out << "Cannot start the recorder simulator" << endl;
+      return false;
+    }
+
+  if( ! __loadPlugin() )
+    {
+      return false;
+    }
+
+  m_simulator.start();
+
+  m_out << "Recorder benchmark: "
+        << RecorderSimulator::protocolName( m_protocol )
+        << " on " << m_simulator.portName()
+        << ", memory " << m_simulator.memorySize() << " bytes, line speed ";
+
+  if( m_lineSpeed > 0 )
+    {
+      m_out << m_lineSpeed << " bps" << endl;
+    }
+  else
+    {
+      m_out << "unlimited" << endl;
+    }
+
+  m_out << qSetFieldWidth(16) << left << "step"
+        << qSetFieldWidth(6) << "rc"
+        << qSetFieldWidth(10) << right << "ms"
+        << qSetFieldWidth(12) << "bytes"
+        << qSetFieldWidth(12) << "bytes/s"
+        << qSetFieldWidth(0) << endl;
+
+  QElapsedTimer timer;
+  timer.start();
+
+  const int baud = m_lineSpeed > 0 ? m_lineSpeed : 38400;
+
+  int rc = m_recorder->openRecorder( m_simulator.portName(), baud );
+
+  __report( "openRecorder", rc, timer.restart() );
+
+  if( rc < FR_OK )
+    {
+      m_out << m_recorder->lastError() << endl;
+      return false;
+    }
+
+  FlightRecorderPluginBase::FR_BasicData basicData;
+
+  rc = m_recorder->getBasicData( basicData );
+
+  __report( "getBasicData", rc, timer.restart() );
+
+  QList<FRDirEntry *> dirList;
+
+  rc = m_recorder->getFlightDir( &dirList );
+
+  __report( "getFlightDir", rc, timer.restart() );
+
+  if( rc == FR_OK )
+    {
+      QString fileName = QDir::tempPath() + "/kflog_benchmark.igc";
+
+      for( int i = 0; i < dirList.size(); i++ )
+        {
+          rc = m_recorder->downloadFlight( i, 0, fileName );
+
+          __report( QString( "downloadFlight %1" ).arg( i ), rc, timer.restart() );
+
+          if( rc < FR_OK )
+            {
+              m_out << m_recorder->lastError() << endl;
+              break;
+            }
+        }
+
+      QFile::remove( fileName );
+    }
+
+  qDeleteAll( dirList );
+
+  rc = m_recorder->closeRecorder();
+
+  __report( "closeRecorder", rc, timer.restart() );
+
+  return ! m_failed;
+}
+
+int RecorderBenchmark::exec( const QStringList& args )
+{
+  RecorderSimulator::Protocol protocol;
+
+  QString name = args.value( 0 ).toLower();
+
+  if( name == "filser" )
+    {
+      protocol = RecorderSimulator::Filser;
+    }
+  else if( name == "cambridge" )
+    {
+      protocol = RecorderSimulator::Cambridge;
+    }
+  else if( name == "flarm" )
+    {
+      protocol = RecorderSimulator::Flarm;
+    }
+  else if( name == "volkslogger" )
+    {
+      protocol = RecorderSimulator::Volkslogger;
+    }
+  else
+    {
+      QTextStream err( stderr );
+      err << "Usage: kflog --recorder-benchmark filser|cambridge|flarm|volkslogger"
+          << " [flights [fixes [bps]]]" << endl;
+      return 1;
+    }
+
+  const int flights   = qMax( 1, args.value( 1, "3" ).toInt() );
+  const int fixes     = qMax( 1, args.value( 2, "3600" ).toInt() );
+  const int lineSpeed = qMax( 0, args.value( 3, "0" ).toInt() );
+
+  RecorderBenchmark benchmark( protocol, flights, fixes, lineSpeed );
+
+  return benchmark.run() ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+/***********************************************************************
+**
+**   recorderbenchmark.h
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#ifndef RECORDER_BENCHMARK_H
+#define RECORDER_BENCHMARK_H
+
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+
+#include "recordersimulator.h"
+
+class FlightRecorderPluginBase;
+
+/**
+ * \class RecorderBenchmark
+ *
+ * \author agent
+ *
+ * \brief Download benchmark of the flight recorder plugins.
+ *
+ * The benchmark loads a flight recorder plugin and connects it to a
+ * \ref RecorderSimulator of the same protocol. It runs the steps of a flight
+ * download like the recorder dialog does: open the recorder, read the basic
+ * data and the flight directory, download every flight and close the
+ * recorder. For every step the result, the duration and the transfer rate
+ * are written to the standard output.
+ *
+ * The benchmark is started with the command line option
+ * <pre>
+ *   kflog --recorder-benchmark filser|cambridge|flarm|volkslogger [flights [fixes [bps]]]
+ * </pre>
+ * where bps is the simulated line speed. Without it, the data is passed
+ * as fast as the pseudo terminal allows.
+ *
+ * \date 2026
+ */
+class RecorderBenchmark
+{
+ public:
+
+  RecorderBenchmark( const RecorderSimulator::Protocol protocol,
+                     const int flights,
+                     const int fixes,
+                     const int lineSpeed );
+
+  virtual ~RecorderBenchmark();
+
+  /**
+   * Runs all steps of the benchmark.
+   *
+   * \return True, if all supported steps were successful.
+   */
+  bool run();
+
+  /**
+   * Parses the command line arguments behind the benchmark option and
+   * runs the benchmark.
+   *
+   * \return The exit code of the program.
+   */
+  static int exec( const QStringList& args );
+
+ private:
+
+  /** Loads the plugin library of the protocol and creates the recorder. */
+  bool __loadPlugin();
+
+  /** Writes the result line of a step. */
+  void __report( const QString& step, const int rc, const qint64 ms );
+
+  RecorderSimulator::Protocol m_protocol;
+
+  RecorderSimulator m_simulator;
+
+  int m_lineSpeed;
+
+  void* m_libHandle;
+
+  FlightRecorderPluginBase* m_recorder;
+
+  QTextStream m_out;
+
+  /** Set, if a supported step has failed. */
+  bool m_failed;
+};
+
+#endif
@@ -27,6 +27,8 @@
 
 #include <QtGui>
 
+#include "flightdownloadqueue.h"
+#include "flightimporter.h"
 #include "gliders.h"
 #include "mainwindow.h"
 #include "mapcalc.h"
@@ -43,6 +45,7 @@ extern QSettings    _settings;
 
 RecorderDialog::RecorderDialog( QWidget *parent ) :
   QDialog(parent),
+  downloadQueue(0),
   libHandle(0),
   activeRecorder(0)
 {
@@ -589,6 +592,9 @@ void RecorderDialog::__createFlightPage()
   QPushButton* saveB = new QPushButton( tr( "Save flight" ) );
   connect( saveB, SIGNAL(clicked()), SLOT(slotDownloadFlight()) );
 
+  QPushButton* saveAllB = new QPushButton( tr( "Save all" ) );
+  connect( saveAllB, SIGNAL(clicked()), SLOT(slotDownloadAllFlights()) );
+
   useLongNames = new QCheckBox( tr( "Long filenames" ) );
 
   // let's prefer short filenames. These are needed for OLC
@@ -603,6 +609,10 @@ void RecorderDialog::__createFlightPage()
                      "<b>Note!</b> Do not use fast download<BR>"
                      " when using the file for competitions.</html>"));
 
+  importFlights = new QCheckBox( tr( "Import flights" ) );
+  importFlights->setChecked( false );
+  importFlights->setToolTip( tr("If checked, the downloaded flights are loaded into KFLog.") );
+
   QVBoxLayout *flightPageLayout = new QVBoxLayout;
   flightPageLayout->setSpacing(10);
   flightPageLayout->setContentsMargins( 0, 0, 0, 0 );
@@ -613,10 +623,13 @@ void RecorderDialog::__createFlightPage()
   buttonBox->addWidget(loadB);
   buttonBox->addStretch( 10 );
   buttonBox->addWidget( saveB );
+  buttonBox->addWidget( saveAllB );
   buttonBox->addStretch( 10 );
   buttonBox->addWidget(useLongNames);
   buttonBox->addStretch( 10 );
   buttonBox->addWidget(useFastDownload);
+  buttonBox->addStretch( 10 );
+  buttonBox->addWidget(importFlights);
 
   flightPageLayout->addLayout( buttonBox );
   flightPage->setLayout( flightPageLayout );
@@ -1065,6 +1078,9 @@ void RecorderDialog::slotConnectRecorder()
 
 void RecorderDialog::slotCloseRecorder()
 {
+  // The plugin must be released by the download thread before.
+  __stopDownload();
+
   if( activeRecorder )
     {
       QApplication::setOverrideCursor( QCursor(Qt::WaitCursor) );
@@ -1300,45 +1316,203 @@ void RecorderDialog::slotDownloadFlight()
       return;
     }
 
-  slotDisablePages();
+  __startDownload( QList<int>() << flightID, QStringList() << fileName );
+}
 
-  QApplication::setOverrideCursor( QCursor(Qt::WaitCursor) );
-  statusBar->setText( tr("Downloading flight from recorder") );
-  QCoreApplication::processEvents();
-  QCoreApplication::flush();
+void RecorderDialog::slotDownloadAllFlights()
+{
+  if( dirList.isEmpty() || !activeRecorder )
+    {
+      return;
+    }
+
+  // If no DefaultFlightDirectory is configured, we must use $HOME instead of the root-directory
+  QString flightDir = _settings.value( "/Path/DefaultFlightDirectory",
+                                       _mainWindow->getApplicationDataDirectory() ).toString();
 
-  int ret = activeRecorder->downloadFlight( flightID,
-                                            !useFastDownload->isChecked(),
-                                            fileName );
+  flightDir = QFileDialog::getExistingDirectory( this,
+                                                 tr( "Select directory to save the flights to" ),
+                                                 flightDir );
+  if( flightDir.isEmpty() )
+    {
+      return;
+    }
 
-  QApplication::restoreOverrideCursor();
+  QList<int> flightIDs;
+  QStringList fileNames;
+  int existing = 0;
 
-  if( ret < FR_OK )
+  for( int i = 0; i < dirList.size(); i++ )
     {
-      QString errorDetails = activeRecorder->lastError();
+      QString fileName = flightDir + "/";
 
-      QString errorText = tr( "Cannot download flight from recorder." );
+      if( useLongNames->isChecked() )
+        {
+          fileName += dirList.at( i )->longFileName.toUpper();
+        }
+      else
+        {
+          fileName += dirList.at( i )->shortFileName.toUpper();
+        }
 
-      if( ! errorDetails.isEmpty() )
+      if( QFile::exists( fileName ) )
         {
-          errorText += "\n" + errorDetails;
+          existing++;
+        }
+
+      flightIDs.append( i );
+      fileNames.append( fileName );
+    }
+
+  if( existing > 0 )
+    {
+      int answer = QMessageBox::question( this,
+                                          tr( "Overwrite files?" ),
+                                          tr( "%1 of the flight files exist already. Overwrite them?" ).arg( existing ),
+                                          QMessageBox::Yes | QMessageBox::No,
+                                          QMessageBox::No );
+
+      if( answer != QMessageBox::Yes )
+        {
+          return;
         }
+    }
+
+  __startDownload( flightIDs, fileNames );
+}
+
+void RecorderDialog::__startDownload( const QList<int>& flightIDs,
+                                      const QStringList& fileNames )
+{
+  if( downloadQueue )
+    {
+      return;
+    }
+
+  slotDisablePages();
+
+  downloadErrors.clear();
+
+  // The plugin is used by the download thread until it is finished.
+  downloadQueue = new FlightDownloadQueue( activeRecorder, this );
+  downloadQueue->setSecMode( !useFastDownload->isChecked() );
+
+  for( int i = 0; i < flightIDs.size(); i++ )
+    {
+      downloadQueue->addFlight( flightIDs.at( i ), fileNames.at( i ) );
+    }
+
+  connect( downloadQueue, SIGNAL(transferStarted(int, int)),
+           this, SLOT(slotDownloadStarted(int, int)) );
+  connect( downloadQueue, SIGNAL(flightDownloaded(const QString&)),
+           this, SLOT(slotFlightDownloaded(const QString&)) );
+  connect( downloadQueue, SIGNAL(flightFailed(const QString&, const QString&)),
+           this, SLOT(slotFlightDownloadFailed(const QString&, const QString&)) );
+  connect( downloadQueue, SIGNAL(finished()),
+           this, SLOT(slotDownloadFinished()) );
+
+  downloadQueue->start();
+}
+
+void RecorderDialog::__stopDownload()
+{
+  if( ! downloadQueue )
+    {
+      return;
+    }
+
+  // No results are reported anymore, the dialog is going to be closed or
+  // the recorder is changed.
+  disconnect( downloadQueue, 0, this, 0 );
+
+  downloadQueue->cancel();
+  downloadQueue->wait();
+
+  delete downloadQueue;
+  downloadQueue = 0;
+
+  statusBar->setText("");
+}
+
+void RecorderDialog::slotDownloadStarted( int index, int total )
+{
+  statusBar->setText( tr("Downloading flight %1 of %2 from recorder")
+                      .arg( index + 1 ).arg( total ) );
+}
+
+void RecorderDialog::slotFlightDownloaded( const QString& fileName )
+{
+  if( importFlights->isChecked() )
+    {
+      // The importer adds the file to a running import.
+      _mainWindow->getFlightImporter()->importFiles( QStringList( fileName ) );
+    }
+}
+
+void RecorderDialog::slotFlightDownloadFailed( const QString& fileName,
+                                               const QString& reason )
+{
+  QString error = QFileInfo( fileName ).fileName();
+
+  if( ! reason.isEmpty() )
+    {
+      error += ": " + reason.trimmed();
+    }
+
+  downloadErrors.append( error );
+}
+
+void RecorderDialog::slotDownloadFinished()
+{
+  if( ! downloadQueue )
+    {
+      return;
+    }
+
+  const int total = downloadQueue->count();
+  const int downloaded = downloadQueue->downloaded();
+
+  downloadQueue->deleteLater();
+  downloadQueue = 0;
+
+  statusBar->setText("");
+  slotEnablePages();
+
+  if( ! downloadErrors.isEmpty() )
+    {
+      QString errorText = tr( "Cannot download %1 of %2 flights from recorder." )
+                          .arg( total - downloaded ).arg( total );
+
+      errorText += "\n" + downloadErrors.join( "\n" );
 
       QMessageBox::critical( this,
                              tr( "Library Error" ),
                              errorText,
                              QMessageBox::Ok );
     }
-  else
+  else if( downloaded < total )
+    {
+      QMessageBox::warning( this,
+                            tr("Flight download canceled"),
+                            tr("%1 of %2 flights were downloaded from the recorder.")
+                            .arg( downloaded ).arg( total ),
+                            QMessageBox::Ok );
+    }
+  else if( total == 1 )
     {
       QMessageBox::information( this,
                                 tr("Flight download finished"),
                                 tr("Flight successfully downloaded from the recorder."),
                                 QMessageBox::Ok );
     }
-
-  statusBar->setText("");
-  slotEnablePages();
+  else
+    {
+      QMessageBox::information( this,
+                                tr("Flight download finished"),
+                                tr("%1 flights successfully downloaded from the recorder.")
+                                .arg( total ),
+                                QMessageBox::Ok );
+    }
 }
 
 void RecorderDialog::slotWriteDeclaration()
@@ -31,6 +31,8 @@
 #include "kflogtreewidget.h"
 #include "waypointcatalog.h"
 
+class FlightDownloadQueue;
+
 /**
  * \class RecorderDialog
  *
@@ -81,6 +83,10 @@ class RecorderDialog : public QDialog
    * Downloads the currently selected flight from the recorder. You need to call slotReadFlightList before calling this slot.
    */
   void slotDownloadFlight();
+  /**
+   * Downloads all flights of the flight list into a directory.
+   */
+  void slotDownloadAllFlights();
   /**
    * Sends a declaration to the recorder
    */
@@ -134,6 +140,18 @@ class RecorderDialog : public QDialog
   /** No descriptions */
   void slotRecorderTypeChanged(const QString &name);
 
+  /** Called by the download queue, when the transfer of a flight starts. */
+  void slotDownloadStarted( int index, int total );
+
+  /** Called by the download queue, if the IGC file of a flight is written. */
+  void slotFlightDownloaded( const QString& fileName );
+
+  /** Called by the download queue, if a flight could not be downloaded. */
+  void slotFlightDownloadFailed( const QString& fileName, const QString& reason );
+
+  /** Called, when the download queue is finished. */
+  void slotDownloadFinished();
+
  signals:
 
   void addCatalog(WaypointCatalog *w);
@@ -145,12 +163,12 @@ class RecorderDialog : public QDialog
   /**
    * \return Path to the directory, where are the known loggers defined.
    */
-  QString getLoggerPath();
+  static QString getLoggerPath();
 
   /**
    * \return Path to the directory, where are the plugin libraries are located.
    */
-  QString getLibraryPath();
+  static QString getLibraryPath();
 
  private:
 
@@ -165,6 +183,16 @@ class RecorderDialog : public QDialog
   void __setRecorderConnectionType(FlightRecorderPluginBase::TransferMode);
   void __setRecorderCapabilities();
 
+  /**
+   * Starts the background download of the passed flights.
+   */
+  void __startDownload( const QList<int>& flightIDs, const QStringList& fileNames );
+
+  /**
+   * Cancels a running download and waits until the plugin is released.
+   */
+  void __stopDownload();
+
   /**
    * Creates and adds the Recorder page to the dialog
    */
@@ -265,6 +293,13 @@ class RecorderDialog : public QDialog
   QCheckBox* useFastDownload;
   /** */
   QCheckBox* useLongNames;
+  /** Imports the downloaded flights in the background, if checked. */
+  QCheckBox* importFlights;
+
+  /** The running flight download. */
+  FlightDownloadQueue* downloadQueue;
+  /** Errors of the running flight download. */
+  QStringList downloadErrors;
 
   /** Handle to the bound library plugin. */
   void* libHandle;
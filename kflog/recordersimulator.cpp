@@ -0,0 +1,1191 @@
+/***********************************************************************
+**
+**   recordersimulator.cpp
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <QtCore>
+
+#include "recordersimulator.h"
+
+// Filser command bytes, see kfrfil/filser.cpp
+#define FIL_STX          0x02
+#define FIL_ACK          0x06
+#define FIL_NAK          0x15
+#define FIL_SYN          0x16
+#define FIL_L            ('L' | 0x80)
+#define FIL_M            ('M' | 0x80)
+#define FIL_N            ('N' | 0x80)
+#define FIL_Q            ('Q' | 0x80)
+#define FIL_F            ('f' | 0x80)
+#define FIL_BASIC_DATA   0xc4
+#define FIL_FLIGHT_DATA  0xc9
+
+// Filser record sizes, see kfrfil/filser.h
+#define FIL_INDEX_WIDTH  0x60
+#define FIL_BASIC_LENGTH (1 + 118 + 230)
+#define FIL_SECTIONS     16
+#define FIL_SECTION_SIZE 0xf000
+#define FIL_START_ADDR   0x010000
+
+// Block size of the Cambridge IGC upload
+#define CAI_BLOCK_SIZE   1024
+
+// Interval of the Flarm position sentences in ms
+#define FLARM_NMEA_INTERVAL 100
+
+// Volkslogger control bytes and commands, see kfrgcs/vla_support.h
+#define VL_STX           0x02
+#define VL_ETX           0x03
+#define VL_ENQ           0x05
+#define VL_ACK           0x06
+#define VL_DLE           0x10
+#define VL_CMD_INF       0x00
+#define VL_CMD_DIR       0x01
+#define VL_CMD_GFL       0x02
+#define VL_CMD_GFS       0x03
+#define VL_CMD_SIG       0x08
+#define VL_CMD_RST       0x0c
+
+// Volkslogger header fields, see kfrgcs/vlconv.h
+#define VL_FLDPLT1       0x01
+#define VL_FLDGTY        0x05
+#define VL_FLDGID        0x06
+#define VL_FLDCID        0x07
+#define VL_FLDHDR        0x50
+
+// Size of the flight log buffer of libkfrgcs, see kfrgcs/vlapi2.h
+#define VL_LOG_MEMSIZE   81920
+
+// Serial number of the simulated Volkslogger
+#define VL_SERIAL        12969
+
+RecorderSimulator::RecorderSimulator( const Protocol protocol,
+                                      const int flights,
+                                      const int fixes,
+                                      QObject *parent ) :
+  QThread( parent ),
+  m_protocol(protocol),
+  m_flights(qBound(1, flights, 99)),
+  m_fixes(qMax(1, fixes)),
+  m_lineSpeed(0),
+  m_master(-1),
+  m_slave(-1),
+  m_stop(0),
+  m_commanded(false),
+  m_selected(-1),
+  m_uploadPos(0),
+  m_received(0),
+  m_sent(0)
+{
+  setObjectName( "RecorderSimulator" );
+
+  if( m_protocol == Filser )
+    {
+      // The flight memory must fit into the memory sections.
+      m_fixes = qMin( m_fixes, (FIL_SECTIONS * FIL_SECTION_SIZE - 64) / 11 );
+    }
+  else if( m_protocol == Volkslogger )
+    {
+      // A flight and its signature must fit into the log buffer of the
+      // plugin. A compressed position record has 9 bytes.
+      m_fixes = qMin( m_fixes, (VL_LOG_MEMSIZE - 1024) / 9 );
+    }
+}
+
+RecorderSimulator::~RecorderSimulator()
+{
+  stop();
+}
+
+QString RecorderSimulator::protocolName( const Protocol protocol )
+{
+  switch( protocol )
+    {
+      case Filser:
+        return "Filser";
+      case Cambridge:
+        return "Cambridge";
+      case Flarm:
+        return "Flarm";
+      case Volkslogger:
+        return "Volkslogger";
+      default:
+        return "";
+    }
+}
+
+bool RecorderSimulator::open()
+{
+  m_master = posix_openpt( O_RDWR | O_NOCTTY );
+
+  if( m_master == -1 || grantpt( m_master ) != 0 || unlockpt( m_master ) != 0 )
+    {
+      qWarning() << "RecorderSimulator: Cannot create a pseudo terminal";
+      stop();
+      return false;
+    }
+
+  m_portName = QString( ptsname( m_master ) );
+
+  // The slave is kept open, otherwise the master reports errors, when the
+  // plugin closes its port.
+  m_slave = ::open( m_portName.toLatin1().data(), O_RDWR | O_NOCTTY );
+
+  if( m_slave == -1 )
+    {
+      qWarning() << "RecorderSimulator: Cannot open" << m_portName;
+      stop();
+      return false;
+    }
+
+  struct termios tio;
+  tcgetattr( m_slave, &tio );
+  cfmakeraw( &tio );
+  tcsetattr( m_slave, TCSANOW, &tio );
+
+  // A plugin, which stops reading, must not block the simulator.
+  fcntl( m_master, F_SETFL, fcntl( m_master, F_GETFL ) | O_NONBLOCK );
+
+  switch( m_protocol )
+    {
+      case Filser:
+        __createFilserFlights();
+        break;
+      case Cambridge:
+        __createIgcFlights();
+        break;
+      case Volkslogger:
+        __createVolksloggerFlights();
+        break;
+      default:
+        break;
+    }
+
+  m_stop.fetchAndStoreOrdered( 0 );
+  m_commanded = false;
+  m_pending.clear();
+  return true;
+}
+
+void RecorderSimulator::stop()
+{
+  m_stop.fetchAndStoreOrdered( 1 );
+
+  if( isRunning() )
+    {
+      wait();
+    }
+
+  if( m_slave != -1 )
+    {
+      ::close( m_slave );
+      m_slave = -1;
+    }
+
+  if( m_master != -1 )
+    {
+      ::close( m_master );
+      m_master = -1;
+    }
+}
+
+void RecorderSimulator::takeCounters( qint64& received, qint64& sent )
+{
+  QMutexLocker locker( &m_mutex );
+
+  received   = m_received;
+  sent       = m_sent;
+  m_received = 0;
+  m_sent     = 0;
+}
+
+int RecorderSimulator::memorySize() const
+{
+  int size = 0;
+
+  for( int i = 0; i < m_memory.size(); i++ )
+    {
+      size += m_memory.at(i).size();
+    }
+
+  return size;
+}
+
+void RecorderSimulator::run()
+{
+  sigset_t sigset;
+  sigfillset( &sigset );
+
+  // deactivate all signals in this thread
+  pthread_sigmask( SIG_SETMASK, &sigset, 0 );
+
+  QElapsedTimer nmeaTimer;
+  nmeaTimer.start();
+
+  char buf[1024];
+
+  while( m_stop.fetchAndAddOrdered( 0 ) == 0 )
+    {
+      struct pollfd pfd;
+      pfd.fd      = m_master;
+      pfd.events  = POLLIN;
+      pfd.revents = 0;
+
+      const int rc = poll( &pfd, 1, m_protocol == Flarm ? 20 : 100 );
+
+      if( m_protocol == Flarm && ! m_commanded &&
+          nmeaTimer.elapsed() >= FLARM_NMEA_INTERVAL )
+        {
+          // The plugin detects the Flarm by its position sentences. They
+          // are stopped with the first command, otherwise they would fill
+          // the terminal buffer, while the plugin does not read.
+          __sendNmea( "$GPRMC,120000,A,5230.000,N,01320.000,E,0.0,0.0,010716,,,A" );
+          nmeaTimer.restart();
+        }
+
+      if( rc <= 0 || ! (pfd.revents & POLLIN) )
+        {
+          continue;
+        }
+
+      const ssize_t n = ::read( m_master, buf, sizeof(buf) );
+
+      if( n <= 0 )
+        {
+          continue;
+        }
+
+      m_mutex.lock();
+      m_received += n;
+      m_mutex.unlock();
+
+      m_input.append( buf, n );
+
+      switch( m_protocol )
+        {
+          case Filser:
+            __handleFilser();
+            break;
+          case Cambridge:
+            __handleCambridge();
+            break;
+          case Flarm:
+            __handleFlarm();
+            break;
+          case Volkslogger:
+            __handleVolkslogger();
+            break;
+        }
+    }
+}
+
+void RecorderSimulator::__send( const QByteArray& data )
+{
+  // Number of bytes, which are written at once with line speed pacing
+  const int chunk = 64;
+
+  int done = 0;
+
+  while( done < data.size() && m_stop.fetchAndAddOrdered( 0 ) == 0 )
+    {
+      const int size = m_lineSpeed > 0 ? qMin( chunk, data.size() - done )
+                                       : data.size() - done;
+
+      const ssize_t n = ::write( m_master, data.constData() + done, size );
+
+      if( n < 0 )
+        {
+          if( errno == EAGAIN || errno == EINTR )
+            {
+              // The terminal buffer is full, wait for the reader.
+              struct pollfd pfd;
+              pfd.fd      = m_master;
+              pfd.events  = POLLOUT;
+              pfd.revents = 0;
+
+              poll( &pfd, 1, 100 );
+              continue;
+            }
+
+          break;
+        }
+
+      done += n;
+
+      m_mutex.lock();
+      m_sent += n;
+      m_mutex.unlock();
+
+      if( m_lineSpeed > 0 )
+        {
+          // A byte needs 10 bits on the line.
+          usleep( (qint64) n * 10 * 1000000 / m_lineSpeed );
+        }
+    }
+}
+
+/*---------------------- Filser ----------------------------------------------*/
+
+unsigned char RecorderSimulator::__filserCrc( const QByteArray& data )
+{
+  // Same algorithm as Filser::calcCrcBuf()
+  unsigned char crc = 0xff;
+
+  for( int i = 0; i < data.size(); i++ )
+    {
+      unsigned char d = data.at(i);
+
+      for( int count = 8; --count >= 0; d <<= 1 )
+        {
+          const unsigned char tmp = crc ^ d;
+          crc <<= 1;
+
+          if( tmp & 0x80 )
+            {
+              crc ^= 0x69;
+            }
+        }
+    }
+
+  return crc;
+}
+
+void RecorderSimulator::__createFilserFlights()
+{
+  m_memory.clear();
+  m_directory.clear();
+
+  int address = FIL_START_ADDR;
+
+  for( int f = 0; f < m_flights; f++ )
+    {
+      QByteArray mem;
+
+      // START record, 8 bytes id and the flight of the day
+      mem.append( (char) 0x80 );
+      mem.append( "STReRAZ", 8 );
+      mem.append( (char) (f + 1) );
+
+      // DATUM record
+      mem.append( (char) 0xfb );
+      mem.append( (char) 1 );
+      mem.append( (char) 7 );
+      mem.append( (char) 0 );
+      mem.append( (char) 16 );
+
+      int time = 10 * 3600 + f * 3600;
+      int lat  = 52 * 60000 + 30000;
+      int lon  = 13 * 60000 + 20000;
+
+      int originTime = 0, originLat = 0, originLon = 0;
+
+      for( int i = 0; i < m_fixes; i++ )
+        {
+          if( i % 500 == 0 )
+            {
+              // ORIGIN record, the positions are relative to it.
+              originTime = time;
+              originLat  = lat;
+              originLon  = lon;
+
+              mem.append( (char) 0xa0 );
+
+              for( int v = 0; v < 3; v++ )
+                {
+                  const int value = v == 0 ? time : (v == 1 ? lat : lon);
+
+                  mem.append( (char) (value >> 24) );
+                  mem.append( (char) (value >> 16) );
+                  mem.append( (char) (value >> 8) );
+                  mem.append( (char) value );
+                }
+            }
+
+          const int dt   = time - originTime;
+          const int dlat = lat - originLat;
+          const int dlon = lon - originLon;
+          const int alt  = 1000 + (i % 200) * 5;
+
+          // POSITION_OK record
+          mem.append( (char) 0xbf );
+          mem.append( (char) (dt >> 8) );
+          mem.append( (char) dt );
+          mem.append( (char) (dlat >> 8) );
+          mem.append( (char) dlat );
+          mem.append( (char) (dlon >> 8) );
+          mem.append( (char) dlon );
+          mem.append( (char) (alt >> 8) );
+          mem.append( (char) alt );
+          mem.append( (char) (alt >> 8) );
+          mem.append( (char) alt );
+
+          time += 4;
+          lat  += 10;
+          lon  += 15;
+        }
+
+      // END record
+      mem.append( (char) 0x40 );
+
+      m_memory.append( mem );
+
+      // Flight directory record
+      const int endAddress = address + mem.size();
+      const int startTime  = 10 * 3600 + f * 3600;
+      const int stopTime   = time;
+
+      QByteArray rec( FIL_INDEX_WIDTH - 1, '\0' );
+
+      rec[0] = 1;
+      rec[1] = (char) (address >> 8);
+      rec[2] = (char) address;
+      rec[4] = (char) (address >> 16);
+      rec[5] = (char) (endAddress >> 8);
+      rec[6] = (char) endAddress;
+      rec[8] = (char) (endAddress >> 16);
+
+      const QByteArray start = QString().sprintf( "01.07.16 %02d:%02d:%02d",
+                                                  startTime / 3600 % 24,
+                                                  startTime / 60 % 60,
+                                                  startTime % 60 ).toLatin1();
+
+      const QByteArray stop = QString().sprintf( "%02d:%02d:%02d",
+                                                 stopTime / 3600 % 24,
+                                                 stopTime / 60 % 60,
+                                                 stopTime % 60 ).toLatin1();
+
+      rec.replace( 9, start.size(), start );
+      rec[17] = '\0';
+      rec.replace( 0x1b, stop.size(), stop );
+      rec.replace( 40, 15, QByteArray( "Simulated Pilot" ) );
+      rec[91] = (char) 0x30;
+      rec[92] = (char) 0x39;
+      rec[94] = (char) (f + 1);
+
+      rec.append( (char) __filserCrc( rec ) );
+      m_directory.append( rec );
+
+      address = endAddress;
+    }
+}
+
+void RecorderSimulator::__handleFilser()
+{
+  while( ! m_input.isEmpty() )
+    {
+      const unsigned char c = m_input.at(0);
+
+      if( c == FIL_SYN )
+        {
+          __send( (char) FIL_ACK );
+          m_input.remove( 0, 1 );
+          continue;
+        }
+
+      if( c != FIL_STX )
+        {
+          // Unknown byte, skip it.
+          m_input.remove( 0, 1 );
+          continue;
+        }
+
+      if( m_input.size() < 2 )
+        {
+          return;
+        }
+
+      const unsigned char cmd = m_input.at(1);
+
+      if( cmd == FIL_N )
+        {
+          // Memory definition, start and end address and a CRC
+          if( m_input.size() < 9 )
+            {
+              return;
+            }
+
+          const QByteArray def = m_input.mid( 2, 6 );
+          const bool crcOk = __filserCrc( def ) == (unsigned char) m_input.at(8);
+
+          const int start = (unsigned char) def.at(0) +
+                            ((unsigned char) def.at(1) << 8) +
+                            ((unsigned char) def.at(2) << 16);
+
+          m_input.remove( 0, 9 );
+          m_selected = -1;
+
+          int address = FIL_START_ADDR;
+
+          for( int i = 0; i < m_memory.size(); i++ )
+            {
+              if( address == start )
+                {
+                  m_selected = i;
+                  break;
+                }
+
+              address += m_memory.at(i).size();
+            }
+
+          __send( (char) (crcOk && m_selected >= 0 ? FIL_ACK : FIL_NAK) );
+          continue;
+        }
+
+      m_input.remove( 0, 2 );
+
+      if( cmd == FIL_M )
+        {
+          QByteArray dir;
+
+          for( int i = 0; i < m_directory.size(); i++ )
+            {
+              dir.append( m_directory.at(i) );
+            }
+
+          QByteArray last( FIL_INDEX_WIDTH - 1, '\0' );
+          last.append( (char) __filserCrc( last ) );
+          dir.append( last );
+
+          __send( dir );
+        }
+      else if( cmd == FIL_Q )
+        {
+          QByteArray mem( 6, '\0' );
+          mem[2] = 0x06;
+          mem[3] = (char) 0x80;
+          mem[5] = 0x0b;
+          mem.append( (char) __filserCrc( mem ) );
+
+          __send( mem );
+        }
+      else if( cmd == FIL_L && m_selected >= 0 )
+        {
+          // Table of the section sizes, big endian
+          QByteArray table( 2 * FIL_SECTIONS, '\0' );
+          int rest = m_memory.at(m_selected).size();
+
+          for( int i = 0; i < FIL_SECTIONS && rest > 0; i++ )
+            {
+              const int size = qMin( rest, FIL_SECTION_SIZE );
+
+              table[2 * i]     = (char) (size >> 8);
+              table[2 * i + 1] = (char) size;
+              rest -= size;
+            }
+
+          table.append( (char) __filserCrc( table ) );
+          __send( table );
+        }
+      else if( cmd >= FIL_F && cmd < FIL_F + FIL_SECTIONS && m_selected >= 0 )
+        {
+          QByteArray section = m_memory.at(m_selected).mid( (cmd - FIL_F) * FIL_SECTION_SIZE,
+                                                            FIL_SECTION_SIZE );
+          section.append( (char) __filserCrc( section ) );
+          __send( section );
+        }
+      else if( cmd == FIL_BASIC_DATA )
+        {
+          QByteArray text( "Version LX20 V5.2\r\nSN12969,HW3.0\r\n" );
+
+          while( text.size() < 0x140 )
+            {
+              text.append( "KFLog recorder simulator\r\n" );
+            }
+
+          __send( text );
+        }
+      else if( cmd == FIL_FLIGHT_DATA )
+        {
+          QByteArray data( FIL_BASIC_LENGTH, '\0' );
+          data.replace( 3, 15, QByteArray( "Simulated Pilot" ) );
+          data.replace( 0x16, 5, QByteArray( "ASW20" ) );
+          data.replace( 0x22, 6, QByteArray( "D-1234" ) );
+          data.replace( 0x2a, 2, QByteArray( "KF" ) );
+          data.append( (char) __filserCrc( data ) );
+
+          __send( data );
+        }
+    }
+}
+
+/*---------------------- Cambridge -------------------------------------------*/
+
+void RecorderSimulator::__createIgcFlights()
+{
+  m_memory.clear();
+
+  for( int f = 0; f < m_flights; f++ )
+    {
+      QByteArray igc( "ACAMSIM KFLog recorder simulator\r\nHFDTE010716\r\n" );
+
+      int time = 10 * 3600 + f * 3600;
+      int lat  = 52 * 60000 + 30000;
+      int lon  = 13 * 60000 + 20000;
+
+      for( int i = 0; i < m_fixes; i++ )
+        {
+          const int alt = 1000 + (i % 200) * 5;
+
+          igc.append( QString().sprintf( "B%02d%02d%02d%02d%05dN%03d%05dEA%05d%05d\r\n",
+                                         time / 3600 % 24, time / 60 % 60, time % 60,
+                                         lat / 60000, lat % 60000,
+                                         lon / 60000, lon % 60000,
+                                         alt, alt ).toLatin1() );
+          time += 4;
+          lat  += 10;
+          lon  += 15;
+        }
+
+      m_memory.append( igc );
+    }
+}
+
+void RecorderSimulator::__sendCambridgeReply( const QByteArray& cmd,
+                                              const QByteArray& data,
+                                              const bool large )
+{
+  const QByteArray payload = data + "\r\n\nup>";
+
+  unsigned char yy = 0;
+
+  for( int i = 0; i < cmd.size(); i++ )
+    {
+      yy ^= (unsigned char) cmd.at(i);
+    }
+
+  QByteArray reply = cmd;
+
+  if( large )
+    {
+      // Two bytes length, command checksum, two bytes sum of the payload
+      const int xx = 5 + payload.size();
+      int zz = 0;
+
+      for( int i = 0; i < payload.size(); i++ )
+        {
+          zz = (zz + (unsigned char) payload.at(i)) & 0xffff;
+        }
+
+      reply.append( (char) (xx >> 8) );
+      reply.append( (char) xx );
+      reply.append( (char) yy );
+      reply.append( (char) (zz >> 8) );
+      reply.append( (char) zz );
+    }
+  else
+    {
+      // Single byte length, command checksum and xor of the payload
+      unsigned char zz = 0;
+
+      for( int i = 0; i < payload.size(); i++ )
+        {
+          zz ^= (unsigned char) payload.at(i);
+        }
+
+      reply.append( (char) (3 + payload.size()) );
+      reply.append( (char) yy );
+      reply.append( (char) zz );
+    }
+
+  reply.append( payload );
+  __send( reply );
+}
+
+void RecorderSimulator::__handleCambridge()
+{
+  while( ! m_input.isEmpty() )
+    {
+      if( m_input.at(0) == 0x02 || m_input.at(0) == '\n' )
+        {
+          // Switch to command mode, nothing to answer.
+          m_input.remove( 0, 1 );
+          continue;
+        }
+
+      const int end = m_input.indexOf( '\r' );
+
+      if( end < 0 )
+        {
+          return;
+        }
+
+      const QByteArray cmd = m_input.left( end );
+      m_input.remove( 0, end + 1 );
+
+      if( cmd == "w" )
+        {
+          __sendCambridgeReply( cmd, QByteArray( 15, ' ' ) + "SIM", false );
+        }
+      else if( cmd == "o 0" )
+        {
+          __sendCambridgeReply( cmd, QByteArray( "Simulated Pilot" ).leftJustified( 24, ' ' ), false );
+        }
+      else if( cmd == "g 0" )
+        {
+          __sendCambridgeReply( cmd,
+                                QByteArray( "ASW20" ).leftJustified( 12, ' ' ) +
+                                QByteArray( "D-1234" ).leftJustified( 12, ' ' ),
+                                false );
+        }
+      else if( cmd == "b n" )
+        {
+          const QByteArray block = m_selected >= 0 ?
+            m_memory.at(m_selected).mid( m_uploadPos, CAI_BLOCK_SIZE ) : QByteArray();
+
+          m_uploadPos += block.size();
+
+          QByteArray data;
+          data.append( (char) (block.size() >> 8) );
+          data.append( (char) block.size() );
+          data.append( block );
+
+          __sendCambridgeReply( cmd, data, true );
+        }
+      else if( cmd == "b s" )
+        {
+          const QByteArray sig( "G0123456789ABCDEF\r\n" );
+
+          QByteArray data;
+          data.append( (char) (sig.size() >> 8) );
+          data.append( (char) sig.size() );
+          data.append( sig );
+
+          __sendCambridgeReply( cmd, data, true );
+        }
+      else if( cmd.startsWith( "b " ) )
+        {
+          const int block = cmd.mid( 2 ).toInt();
+
+          if( block >= 196 )
+            {
+              // Flight list in blocks of 8 flights
+              const int offset = block - 196;
+              QByteArray data;
+              data.append( (char) m_memory.size() );
+
+              for( int i = offset * 8; i < qMin( m_memory.size(), offset * 8 + 8 ); i++ )
+                {
+                  const int start = 10 + i;
+                  const int stop  = (start + m_fixes * 4 / 3600 + 1) % 24;
+
+                  const char times[12] = { 16, 7, 1, (char) start, 0, 0,
+                                           16, 7, 1, (char) stop, 0, 0 };
+
+                  data.append( times, sizeof(times) );
+                  data.append( QByteArray( "Simulated Pilot" ).leftJustified( 24, ' ' ) );
+                }
+
+              __sendCambridgeReply( cmd, data, true );
+            }
+          else
+            {
+              // Selection of a flight for the upload
+              m_selected  = block - 64;
+              m_uploadPos = 0;
+
+              QByteArray data;
+
+              if( m_selected >= 0 && m_selected < m_memory.size() )
+                {
+                  data.append( 'Y' );
+                  data.append( (char) (CAI_BLOCK_SIZE >> 8) );
+                  data.append( (char) (CAI_BLOCK_SIZE & 0xff) );
+                }
+              else
+                {
+                  m_selected = -1;
+                  data.append( "N\0\0", 3 );
+                }
+
+              __sendCambridgeReply( cmd, data, true );
+            }
+        }
+      else
+        {
+          // upload, baud and pnp just get a prompt.
+          __send( cmd + "\r\n\ncmd>" );
+        }
+    }
+}
+
+/*---------------------- Flarm -----------------------------------------------*/
+
+void RecorderSimulator::__sendNmea( const QByteArray& sentence )
+{
+  unsigned char cs = 0;
+
+  for( int i = 1; i < sentence.size(); i++ )
+    {
+      cs ^= (unsigned char) sentence.at(i);
+    }
+
+  __send( sentence + "*" + QByteArray::number( cs, 16 ).rightJustified( 2, '0' ) + "\r\n" );
+}
+
+void RecorderSimulator::__handleFlarm()
+{
+  while( true )
+    {
+      const int end = m_input.indexOf( '\n' );
+
+      if( end < 0 )
+        {
+          return;
+        }
+
+      QByteArray line = m_input.left( end ).trimmed();
+      m_input.remove( 0, end + 1 );
+
+      const int star = line.indexOf( '*' );
+
+      if( ! line.startsWith( '$' ) || star < 0 )
+        {
+          continue;
+        }
+
+      const QList<QByteArray> fields = line.left( star ).split( ',' );
+
+      if( fields.size() < 2 )
+        {
+          continue;
+        }
+
+      const QByteArray& cmd = fields.at(0);
+      m_commanded = true;
+      const QByteArray key  = fields.size() > 2 ? fields.at(2) : QByteArray();
+
+      if( cmd == "$PFLAE" )
+        {
+          // Self test without errors
+          __sendNmea( "$PFLAE,A,0,0" );
+        }
+      else if( cmd == "$PFLAV" )
+        {
+          __sendNmea( "$PFLAV,A,2.00,6.00," );
+        }
+      else if( cmd == "$PFLAS" )
+        {
+          __send( QByteArray( "FLARM,SIM001,DD1234,Build 6.00\r\n" ) );
+        }
+      else if( cmd == "$PFLAC" && fields.at(1) == "R" )
+        {
+          QByteArray value;
+
+          if( key == "PILOT" )
+            {
+              value = "Simulated Pilot";
+            }
+          else if( key == "GLIDERTYPE" )
+            {
+              value = "ASW20";
+            }
+          else if( key == "GLIDERID" )
+            {
+              value = "D-1234";
+            }
+          else if( key == "COMPID" )
+            {
+              value = "KF";
+            }
+
+          __sendNmea( "$PFLAC,A," + key + "," + value );
+        }
+      else if( cmd == "$PFLAC" )
+        {
+          // Configuration is accepted and confirmed.
+          __sendNmea( "$PFLAC,A" + line.left( star ).mid( 8 ) );
+        }
+    }
+}
+
+/*---------------------- Volkslogger -----------------------------------------*/
+
+unsigned short RecorderSimulator::__volksloggerCrc( const QByteArray& data )
+{
+  // Same CRC as VLA_XFR::UpdateCRC(), calculated without the table
+  unsigned short crc = 0;
+
+  for( int i = 0; i < data.size(); i++ )
+    {
+      crc ^= (unsigned char) data.at(i) << 8;
+
+      for( int count = 0; count < 8; count++ )
+        {
+          crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+
+  return crc;
+}
+
+QByteArray RecorderSimulator::__volksloggerField( const char id, const QByteArray& data )
+{
+  // Untimed variable record: type, total length, field id and data
+  QByteArray field;
+  field.append( (char) 0x20 );
+  field.append( (char) (3 + data.size()) );
+  field.append( id );
+  field.append( data );
+
+  return field;
+}
+
+void RecorderSimulator::__createVolksloggerFlights()
+{
+  m_memory.clear();
+  m_directory.clear();
+
+  for( int f = 0; f < m_flights; f++ )
+    {
+      // Separator of binary format version 1 and the header fields, which
+      // are part of the flight log and of its directory entry.
+      QByteArray head;
+      head.append( (char) 0x41 );
+
+      const char hdr[7] = { (char) (VL_SERIAL >> 8), (char) VL_SERIAL,
+                            100, 0x33, 0x42, 0, 50 };
+
+      head.append( __volksloggerField( VL_FLDHDR, QByteArray( hdr, sizeof(hdr) ) ) );
+      head.append( __volksloggerField( VL_FLDPLT1,
+                                       QByteArray( "Simulated Pilot" ).leftJustified( 16, ' ' ) +
+                                       QByteArray( 1, '\0' ) ) );
+      head.append( __volksloggerField( VL_FLDGID, QByteArray( "D-1234", 7 ) ) );
+      head.append( __volksloggerField( VL_FLDCID, QByteArray( "KF", 3 ) ) );
+
+      // Time and date record at the begin of the recording
+      const int startTime = 10 * 3600 + f * 3600;
+
+      QByteArray tnd( 8, '\0' );
+      tnd[0] = (char) 0xa0;
+      tnd[2] = (char) (startTime >> 16);
+      tnd[3] = (char) (startTime >> 8);
+      tnd[4] = (char) startTime;
+      tnd[5] = 0x16;
+      tnd[6] = 0x07;
+      tnd[7] = 0x01;
+
+      head.append( tnd );
+
+      // End record with the recording time and the begin of the recording
+      // relative to the time and date record.
+      const int duration = (m_fixes - 1) * 4;
+
+      QByteArray end( 7, '\0' );
+      end[0] = 0x60;
+      end[1] = (char) (duration >> 16);
+      end[2] = (char) (duration >> 8);
+      end[3] = (char) duration;
+
+      m_directory.append( head + end );
+
+      QByteArray mem = head;
+      mem.insert( mem.size() - tnd.size(),
+                  __volksloggerField( VL_FLDGTY, QByteArray( "ASW20", 6 ) ) );
+
+      int lat = 52 * 60000 + 30000;
+      int lon = 13 * 60000 + 20000;
+
+      for( int i = 0; i < m_fixes; i++ )
+        {
+          const int alt   = 1000 + (i % 200) * 5;
+          const int gpalt = (alt + 1000) / 10;
+          const int dt    = i == 0 ? 0 : 4;
+
+          // Pressure value of the standard atmosphere, 4096 are 1100 hPa.
+          const int press = qRound( 1013.25 * pow( 1.0 - 2.25577e-5 * alt, 5.25588 ) *
+                                    4096.0 / 1100.0 );
+
+          if( i % 500 == 0 )
+            {
+              // Position record, valid fix
+              mem.append( (char) (0x90 | (press >> 8)) );
+              mem.append( (char) press );
+              mem.append( (char) dt );
+              mem.append( (char) (lat >> 16) );
+              mem.append( (char) (lat >> 8) );
+              mem.append( (char) lat );
+              mem.append( (char) (lon >> 16) );
+              mem.append( (char) (lon >> 8) );
+              mem.append( (char) lon );
+              mem.append( (char) (((gpalt >> 4) & 0x70) | 1) );
+              mem.append( (char) gpalt );
+              mem.append( (char) 0 );
+            }
+          else
+            {
+              // Compressed position record relative to the last fix
+              const int dlat = 10;
+              const int dlon = 15;
+
+              mem.append( (char) (0xf0 | (press >> 8)) );
+              mem.append( (char) press );
+              mem.append( (char) dt );
+              mem.append( (char) (((dlon >> 5) & 0x78) | ((dlat >> 8) & 0x07)) );
+              mem.append( (char) dlat );
+              mem.append( (char) dlon );
+              mem.append( (char) (((gpalt >> 4) & 0x70) | 1) );
+              mem.append( (char) gpalt );
+              mem.append( (char) 0 );
+            }
+
+          lat += 10;
+          lon += 15;
+        }
+
+      // The end record of a flight log carries the security data.
+      mem.append( end );
+      mem.append( QByteArray( 41 - end.size(), '\0' ) );
+
+      m_memory.append( mem );
+    }
+}
+
+void RecorderSimulator::__sendVolksloggerBlock( const QByteArray& data )
+{
+  const unsigned short crc = __volksloggerCrc( data );
+
+  QByteArray block = data;
+  block.append( (char) (crc >> 8) );
+  block.append( (char) crc );
+
+  QByteArray frame;
+  frame.append( (char) VL_DLE );
+  frame.append( (char) VL_STX );
+
+  for( int i = 0; i < block.size(); i++ )
+    {
+      if( block.at(i) == VL_DLE )
+        {
+          // A DLE of the data is doubled.
+          frame.append( (char) VL_DLE );
+        }
+
+      frame.append( block.at(i) );
+    }
+
+  frame.append( (char) VL_DLE );
+  frame.append( (char) VL_ETX );
+
+  __send( frame );
+}
+
+void RecorderSimulator::__handleVolkslogger()
+{
+  while( ! m_input.isEmpty() )
+    {
+      const unsigned char c = m_input.at(0);
+
+      if( c == 'R' )
+        {
+          // Connection request, it is answered with a series of L.
+          __send( QByteArray( "LLLL" ) );
+          m_input.remove( 0, 1 );
+          continue;
+        }
+
+      if( c == VL_ACK )
+        {
+          // The first ACK requests the data block of the last command. The
+          // plugin sends further ACKs for every received byte.
+          if( ! m_pending.isEmpty() )
+            {
+              __sendVolksloggerBlock( m_pending );
+              m_pending.clear();
+            }
+
+          m_input.remove( 0, 1 );
+          continue;
+        }
+
+      if( c != VL_ENQ )
+        {
+          // CAN resets the command interpreter, other bytes are skipped.
+          m_input.remove( 0, 1 );
+          continue;
+        }
+
+      // Command packet, ENQ followed by 8 command bytes and the CRC
+      if( m_input.size() < 11 )
+        {
+          return;
+        }
+
+      const QByteArray packet = m_input.mid( 1, 10 );
+      m_input.remove( 0, 11 );
+
+      const unsigned char cmd = packet.at(0);
+      const int param = (unsigned char) packet.at(1);
+
+      // Return code of the command, 0 is ok, 1 a bad command.
+      char rc = 0;
+
+      m_pending.clear();
+
+      if( __volksloggerCrc( packet ) != 0 )
+        {
+          // The CRC over the command and its CRC must be zero.
+          rc = 1;
+        }
+      else if( cmd == VL_CMD_INF )
+        {
+          // Session id, serial number, firmware version and build
+          QByteArray info( 8, '\0' );
+          info[2] = (char) (VL_SERIAL >> 8);
+          info[3] = (char) VL_SERIAL;
+          info[4] = 0x42;
+          info[7] = 1;
+
+          m_pending = info;
+        }
+      else if( cmd == VL_CMD_DIR )
+        {
+          for( int i = 0; i < m_directory.size(); i++ )
+            {
+              m_pending.append( m_directory.at(i) );
+            }
+
+          // A position record with the end flag terminates the directory.
+          m_pending.append( "\xe0\x00\x80", 3 );
+        }
+      else if( cmd == VL_CMD_GFL || cmd == VL_CMD_GFS )
+        {
+          if( param < m_memory.size() )
+            {
+              m_pending = m_memory.at( param );
+            }
+          else
+            {
+              rc = 1;
+            }
+        }
+      else if( cmd == VL_CMD_SIG )
+        {
+          m_pending = QByteArray( "KFLog recorder simulator signature" );
+        }
+      else if( cmd != VL_CMD_RST )
+        {
+          rc = 1;
+        }
+
+      __send( rc );
+    }
+}
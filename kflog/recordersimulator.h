@@ -0,0 +1,216 @@
+/***********************************************************************
+**
+**   recordersimulator.h
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#ifndef RECORDER_SIMULATOR_H
+#define RECORDER_SIMULATOR_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+
+/**
+ * \class RecorderSimulator
+ *
+ * \author agent
+ *
+ * \brief Flight recorder on a pseudo terminal.
+ *
+ * The simulator opens a pseudo terminal and answers the requests of a flight
+ * recorder plugin, which has opened the slave side of the terminal as its
+ * serial port. It serves a number of synthetic flights, which are generated
+ * at startup. It is used by \ref RecorderBenchmark to exercise the plugins
+ * without a physical recorder.
+ *
+ * The following protocols are simulated:
+ *
+ * <ul>
+ * <li>Filser: The binary LX protocol of libkfrfil with flight directory, memory
+ *     sections and the compressed .fil flight memory.</li>
+ * <li>Cambridge: The command line protocol of the CAI 302 in libkfrcai with
+ *     the flight list and the block wise IGC download.</li>
+ * <li>Flarm: The NMEA configuration sentences of libkfrfla. The plugin does
+ *     not support flight downloads.</li>
+ * <li>Volkslogger: The command packets and the DLE framed data blocks of
+ *     libkfrgcs with the flight directory and the binary GCS flight logs.</li>
+ * </ul>
+ *
+ * All requests are answered in the thread of the simulator. If a line speed
+ * is set, the output is paced to that speed, otherwise the data is passed
+ * as fast as the pseudo terminal allows.
+ *
+ * \date 2026
+ */
+class RecorderSimulator : public QThread
+{
+ public:
+
+  enum Protocol { Filser, Cambridge, Flarm, Volkslogger };
+
+  /**
+   * \param protocol The simulated recorder protocol.
+   *
+   * \param flights Number of flights in the recorder memory.
+   *
+   * \param fixes Number of position fixes of every flight.
+   */
+  RecorderSimulator( const Protocol protocol,
+                     const int flights,
+                     const int fixes,
+                     QObject *parent = 0 );
+
+  virtual ~RecorderSimulator();
+
+  /**
+   * Opens the pseudo terminal and generates the flight memory.
+   *
+   * \return True in case of success.
+   */
+  bool open();
+
+  /**
+   * Stops the thread and closes the pseudo terminal.
+   */
+  void stop();
+
+  /**
+   * \return The device name of the slave side, which must be passed to the
+   *         plugin as serial port.
+   */
+  QString portName() const
+  {
+    return m_portName;
+  };
+
+  /**
+   * Sets the simulated line speed in bits per second. Zero switches the
+   * pacing off.
+   */
+  void setLineSpeed( const int bps )
+  {
+    m_lineSpeed = bps;
+  };
+
+  /**
+   * Returns the byte counters and resets them.
+   *
+   * \param received Bytes received from the plugin.
+   *
+   * \param sent Bytes sent to the plugin.
+   */
+  void takeCounters( qint64& received, qint64& sent );
+
+  /** \return The size of the flight memory of all flights in bytes. */
+  int memorySize() const;
+
+  static QString protocolName( const Protocol protocol );
+
+ protected:
+
+  /**
+   * That is the main method of the thread.
+   */
+  void run();
+
+ private:
+
+  /** Writes data to the master side with the simulated line speed. */
+  void __send( const QByteArray& data );
+
+  void __send( const char c )
+  {
+    __send( QByteArray( 1, c ) );
+  };
+
+  /**
+   * Handles the received data of the protocols. Processed bytes are
+   * removed from m_input.
+   */
+  void __handleFilser();
+  void __handleCambridge();
+  void __handleFlarm();
+  void __handleVolkslogger();
+
+  /** Generates the flight memory in the format of the protocol. */
+  void __createFilserFlights();
+  void __createIgcFlights();
+  void __createVolksloggerFlights();
+
+  /** Sends a reply of the Cambridge upload mode. */
+  void __sendCambridgeReply( const QByteArray& cmd,
+                             const QByteArray& data,
+                             const bool large );
+
+  /** Sends a NMEA sentence with checksum. */
+  void __sendNmea( const QByteArray& sentence );
+
+  /** Sends a Volkslogger data block with CRC in DLE framing. */
+  void __sendVolksloggerBlock( const QByteArray& data );
+
+  static unsigned char __filserCrc( const QByteArray& data );
+
+  static unsigned short __volksloggerCrc( const QByteArray& data );
+
+  /** Returns a variable Volkslogger record with a header field. */
+  static QByteArray __volksloggerField( const char id, const QByteArray& data );
+
+  Protocol m_protocol;
+
+  int m_flights;
+
+  int m_fixes;
+
+  int m_lineSpeed;
+
+  /** Master side of the pseudo terminal. */
+  int m_master;
+
+  /** Slave side kept open, that the master stays usable between sessions. */
+  int m_slave;
+
+  QString m_portName;
+
+  QAtomicInt m_stop;
+
+  /** Set, when the first Flarm command has been received. */
+  bool m_commanded;
+
+  QByteArray m_input;
+
+  /** Flight memory in protocol specific format, one entry per flight. */
+  QList<QByteArray> m_memory;
+
+  /** Filser and Volkslogger flight directory records. */
+  QList<QByteArray> m_directory;
+
+  /** Volkslogger data block, which is sent on the next ACK. */
+  QByteArray m_pending;
+
+  /** Filser flight selected by the last memory definition. */
+  int m_selected;
+
+  /** Cambridge download position in the selected flight. */
+  int m_uploadPos;
+
+  QMutex m_mutex;
+
+  qint64 m_received;
+
+  qint64 m_sent;
+};
+
+#endif
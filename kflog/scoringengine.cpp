@@ -0,0 +1,515 @@
+/***********************************************************************
+**
+**   scoringengine.cpp
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <QtCore>
+
+#include "flighttask.h"
+#include "flighttrack.h"
+#include "scoringengine.h"
+
+// Maximum number of candidate fixes of a flight
+#define SCORING_CANDIDATES 500
+
+// Maximum number of refinement rounds
+#define SCORING_REFINE_ROUNDS 10
+
+ScoringRule::ScoringRule() :
+  discipline(FreeDistance),
+  factor(1.0),
+  maxGapRatio(0.0)
+{
+}
+
+ScoringRule::ScoringRule( const QString& name,
+                          const Discipline discipline,
+                          const double factor,
+                          const QVector<double>& legWeights ) :
+  name(name),
+  discipline(discipline),
+  factor(factor),
+  legWeights(legWeights),
+  maxGapRatio(0.0)
+{
+}
+
+int ScoringRule::points() const
+{
+  switch( discipline )
+    {
+      case FreeDistance:
+        return legWeights.size() + 1;
+      default:
+        return 3;
+    }
+}
+
+ScoringRule ScoringRule::olc2003()
+{
+  QVector<double> weights( 6, 1.0 );
+  weights[4] = 0.8;
+  weights[5] = 0.6;
+
+  return ScoringRule( QObject::tr("OLC 2003"), FreeDistance, 1.0, weights );
+}
+
+ScoringRule ScoringRule::freeDistance()
+{
+  return ScoringRule( QObject::tr("Free distance"), FreeDistance, 1.0,
+                      QVector<double>( 4, 1.0 ) );
+}
+
+ScoringRule ScoringRule::freeTriangle()
+{
+  return ScoringRule( QObject::tr("Free triangle"), FreeTriangle, NORMAL_POINT );
+}
+
+ScoringRule ScoringRule::faiTriangle()
+{
+  return ScoringRule( QObject::tr("FAI triangle"), FaiTriangle, FAI_POINT );
+}
+
+ScoringRule ScoringRule::outAndReturn()
+{
+  ScoringRule rule( QObject::tr("Out and return"), OutAndReturn, 1.5 );
+  rule.maxGapRatio = 0.05;
+
+  return rule;
+}
+
+QList<ScoringRule> ScoringRule::standardRules()
+{
+  QList<ScoringRule> rules;
+
+  rules << olc2003()
+        << freeDistance()
+        << freeTriangle()
+        << faiTriangle()
+        << outAndReturn();
+
+  return rules;
+}
+
+/*---------------------- ScoringEngine ---------------------------------------*/
+
+ScoringEngine::ScoringEngine() :
+  m_n(0),
+  m_step(1)
+{
+}
+
+ScoringEngine::~ScoringEngine()
+{
+}
+
+void ScoringEngine::addRule( const ScoringRule& rule )
+{
+  m_rules.append( rule );
+}
+
+void ScoringEngine::clearRules()
+{
+  m_rules.clear();
+}
+
+QList<ScoringResult> ScoringEngine::score( const FlightTrack& track,
+                                           const int first,
+                                           int last )
+{
+  QList<ScoringResult> results;
+
+  for( int r = 0; r < m_rules.size(); r++ )
+    {
+      ScoringResult result;
+      result.rule = m_rules.at(r).name;
+      results.append( result );
+    }
+
+  if( last < 0 || last >= track.count() )
+    {
+      last = track.count() - 1;
+    }
+
+  if( first < 0 || last - first < 2 )
+    {
+      return results;
+    }
+
+  __prepare( track, first, last );
+
+  bool triangles = false;
+
+  for( int r = 0; r < m_rules.size(); r++ )
+    {
+      const ScoringRule& rule = m_rules.at(r);
+
+      if( rule.isTriangle() )
+        {
+          triangles = true;
+        }
+      else
+        {
+          __solveFreeDistance( rule, results[r] );
+        }
+    }
+
+  if( triangles )
+    {
+      __solveTriangles( results );
+    }
+
+  for( int r = 0; r < m_rules.size(); r++ )
+    {
+      if( results[r].valid )
+        {
+          __refine( track, m_rules.at(r), first, last, results[r] );
+        }
+    }
+
+  m_cand.clear();
+  m_dist.clear();
+  m_n = 0;
+
+  return results;
+}
+
+void ScoringEngine::__prepare( const FlightTrack& track,
+                               const int first,
+                               const int last )
+{
+  const int cnt = last - first + 1;
+
+  m_step = qMax( 1, ( cnt + SCORING_CANDIDATES - 1 ) / SCORING_CANDIDATES );
+
+  m_cand.clear();
+  m_cand.reserve( cnt / m_step + 2 );
+
+  for( int i = first; i <= last; i += m_step )
+    {
+      m_cand.append( i );
+    }
+
+  if( m_cand.last() != last )
+    {
+      m_cand.append( last );
+    }
+
+  m_n = m_cand.size();
+  m_dist.resize( m_n * m_n );
+
+  double* dist = m_dist.data();
+
+  for( int i = 0; i < m_n; i++ )
+    {
+      dist[i * m_n + i] = 0.0;
+
+      for( int j = i + 1; j < m_n; j++ )
+        {
+          const double d = track.distance( m_cand[i], m_cand[j] );
+
+          dist[i * m_n + j] = d;
+          dist[j * m_n + i] = d;
+        }
+    }
+}
+
+void ScoringEngine::__solveFreeDistance( const ScoringRule& rule,
+                                         ScoringResult& result )
+{
+  const int legs = rule.legWeights.size();
+  const int n = m_n;
+
+  if( legs < 1 || n <= legs )
+    {
+      return;
+    }
+
+  // Best weighted distance of a path ending at a candidate, for the previous
+  // and the current number of legs, and the predecessors of the paths.
+  QVector<double> prev( n, 0.0 ), cur( n );
+  QVector<int> w( (legs + 1) * n, 0 );
+
+  for( int k = 1; k <= legs; k++ )
+    {
+      const double weight = rule.legWeights[k - 1];
+
+      for( int i = 0; i < n; i++ )
+        {
+          double best = -1.0;
+          int bestJ = 0;
+
+          for( int j = k - 1; j < i; j++ )
+            {
+              const double c = prev[j] + weight * __dist( j, i );
+
+              if( c > best )
+                {
+                  best = c;
+                  bestJ = j;
+                }
+            }
+
+          cur[i] = best;
+          w[k * n + i] = bestJ;
+        }
+
+      prev.swap( cur );
+    }
+
+  int end = legs;
+
+  for( int i = legs; i < n; i++ )
+    {
+      if( prev[i] > prev[end] )
+        {
+          end = i;
+        }
+    }
+
+  QVector<int> path( legs + 1 );
+  path[legs] = end;
+
+  for( int k = legs; k > 0; k-- )
+    {
+      path[k - 1] = w[k * n + path[k]];
+    }
+
+  result.fixes.resize( legs + 1 );
+  result.distance = 0.0;
+
+  for( int k = 0; k <= legs; k++ )
+    {
+      result.fixes[k] = m_cand[path[k]];
+
+      if( k > 0 )
+        {
+          result.distance += __dist( path[k - 1], path[k] );
+        }
+    }
+
+  result.points = rule.factor * prev[end];
+  result.valid  = true;
+}
+
+double ScoringEngine::__trianglePoints( const ScoringRule& rule,
+                                        const double d1,
+                                        const double d2,
+                                        const double d3,
+                                        double& distance )
+{
+  switch( rule.discipline )
+    {
+      case ScoringRule::FreeTriangle:
+
+        distance = d1 + d2 + d3;
+        break;
+
+      case ScoringRule::FaiTriangle:
+
+        distance = d1 + d2 + d3;
+
+        if( ! FlightTask::isFAI( distance, d1, d2, d3 ) )
+          {
+            return -1.0;
+          }
+
+        break;
+
+      case ScoringRule::OutAndReturn:
+
+        // d3 is the gap between start and end.
+        if( d3 > rule.maxGapRatio * ( d1 + d2 ) )
+          {
+            return -1.0;
+          }
+
+        distance = d1 + d2 - d3;
+        break;
+
+      default:
+
+        return -1.0;
+    }
+
+  return distance * rule.factor;
+}
+
+void ScoringEngine::__solveTriangles( QList<ScoringResult>& results )
+{
+  const int n = m_n;
+
+  // The triangle rules and their best values.
+  QVector<int> rules;
+
+  for( int r = 0; r < m_rules.size(); r++ )
+    {
+      if( m_rules.at(r).isTriangle() )
+        {
+          rules.append( r );
+        }
+    }
+
+  const int nr = rules.size();
+
+  QVector<double> best( nr, 0.0 );
+  QVector<int> bestA( nr, -1 ), bestB( nr ), bestC( nr );
+
+  // One enumeration of all candidate triples serves all rules.
+  for( int a = 0; a < n - 2; a++ )
+    {
+      for( int b = a + 1; b < n - 1; b++ )
+        {
+          const double d1 = __dist( a, b );
+
+          for( int c = b + 1; c < n; c++ )
+            {
+              const double d2 = __dist( b, c );
+              const double d3 = __dist( a, c );
+
+              for( int r = 0; r < nr; r++ )
+                {
+                  double distance;
+                  const double points =
+                    __trianglePoints( m_rules.at(rules[r]), d1, d2, d3, distance );
+
+                  if( points > best[r] )
+                    {
+                      best[r]  = points;
+                      bestA[r] = a;
+                      bestB[r] = b;
+                      bestC[r] = c;
+                    }
+                }
+            }
+        }
+    }
+
+  for( int r = 0; r < nr; r++ )
+    {
+      if( bestA[r] < 0 )
+        {
+          continue;
+        }
+
+      ScoringResult& result = results[rules[r]];
+
+      result.fixes.resize( 3 );
+      result.fixes[0] = m_cand[bestA[r]];
+      result.fixes[1] = m_cand[bestB[r]];
+      result.fixes[2] = m_cand[bestC[r]];
+      result.points   = best[r];
+
+      __trianglePoints( m_rules.at(rules[r]),
+                        __dist( bestA[r], bestB[r] ),
+                        __dist( bestB[r], bestC[r] ),
+                        __dist( bestA[r], bestC[r] ),
+                        result.distance );
+
+      result.valid = true;
+    }
+}
+
+double ScoringEngine::__evaluate( const FlightTrack& track,
+                                  const ScoringRule& rule,
+                                  const QVector<int>& fixes,
+                                  double& distance )
+{
+  if( rule.isTriangle() )
+    {
+      return __trianglePoints( rule,
+                               track.distance( fixes[0], fixes[1] ),
+                               track.distance( fixes[1], fixes[2] ),
+                               track.distance( fixes[0], fixes[2] ),
+                               distance );
+    }
+
+  double points = 0.0;
+  distance = 0.0;
+
+  for( int k = 1; k < fixes.size(); k++ )
+    {
+      const double d = track.distance( fixes[k - 1], fixes[k] );
+
+      distance += d;
+      points   += rule.legWeights[k - 1] * d;
+    }
+
+  return points * rule.factor;
+}
+
+void ScoringEngine::__refine( const FlightTrack& track,
+                              const ScoringRule& rule,
+                              const int first,
+                              const int last,
+                              ScoringResult& result )
+{
+  if( m_step <= 1 )
+    {
+      // All fixes have been candidates.
+      return;
+    }
+
+  QVector<int> fixes = result.fixes;
+  const int cnt = fixes.size();
+
+  double distance;
+  double points = __evaluate( track, rule, fixes, distance );
+
+  for( int round = 0; round < SCORING_REFINE_ROUNDS; round++ )
+    {
+      bool improved = false;
+
+      for( int p = 0; p < cnt; p++ )
+        {
+          // The fixes of a task keep their order.
+          const int lo = qMax( fixes[p] - m_step, p > 0 ? fixes[p - 1] + 1 : first );
+          const int hi = qMin( fixes[p] + m_step, p < cnt - 1 ? fixes[p + 1] - 1 : last );
+
+          const int orig = fixes[p];
+          int bestFix = orig;
+
+          for( int i = lo; i <= hi; i++ )
+            {
+              if( i == orig )
+                {
+                  continue;
+                }
+
+              fixes[p] = i;
+
+              double d;
+              const double c = __evaluate( track, rule, fixes, d );
+
+              if( c > points )
+                {
+                  points   = c;
+                  distance = d;
+                  bestFix  = i;
+                  improved = true;
+                }
+            }
+
+          fixes[p] = bestFix;
+        }
+
+      if( ! improved )
+        {
+          break;
+        }
+    }
+
+  result.fixes    = fixes;
+  result.points   = points;
+  result.distance = distance;
+}
@@ -0,0 +1,255 @@
+/***********************************************************************
+**
+**   scoringengine.h
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#ifndef SCORING_ENGINE_H
+#define SCORING_ENGINE_H
+
+#include <QList>
+#include <QString>
+#include <QVector>
+
+class FlightTrack;
+
+/**
+ * \class ScoringRule
+ *
+ * \author agent
+ *
+ * \brief Descriptor of a contest rule.
+ *
+ * A rule describes the discipline of a scored task and its weighting. New
+ * rule sets are added to a \ref ScoringEngine as further descriptors, the
+ * engine itself does not know any contest.
+ *
+ * \date 2026
+ */
+class ScoringRule
+{
+ public:
+
+  /**
+   * The supported disciplines.
+   *
+   * FreeDistance: A path over the fixes with the number of legs given by
+   * the leg weights.
+   *
+   * FreeTriangle: A triangle over three fixes.
+   *
+   * FaiTriangle: A triangle over three fixes, which fulfills the FAI
+   * conditions of \ref FlightTask::isFAI.
+   *
+   * OutAndReturn: A flight to a turnpoint and back, the gap between start
+   * and end must not exceed the maximum gap ratio of the distance.
+   */
+  enum Discipline { FreeDistance, FreeTriangle, FaiTriangle, OutAndReturn };
+
+  ScoringRule();
+
+  ScoringRule( const QString& name,
+               const Discipline discipline,
+               const double factor,
+               const QVector<double>& legWeights = QVector<double>() );
+
+  /**
+   * \return The number of fixes of a task of this rule.
+   */
+  int points() const;
+
+  /**
+   * \return True, if the discipline is solved by the triangle pass.
+   */
+  bool isTriangle() const
+  {
+    return discipline != FreeDistance;
+  };
+
+  /** Name of the rule, used for the results. */
+  QString name;
+
+  Discipline discipline;
+
+  /** Points per km. */
+  double factor;
+
+  /** Weight of every leg of a free distance, the first leg first. */
+  QVector<double> legWeights;
+
+  /** Maximum gap of an out and return flight, relative to its distance. */
+  double maxGapRatio;
+
+  /** The OLC 2003 rule, six legs with reduced weights of the last two. */
+  static ScoringRule olc2003();
+
+  /** Free distance over three turnpoints. */
+  static ScoringRule freeDistance();
+
+  /** Free triangle as used by the task optimization of KFLog. */
+  static ScoringRule freeTriangle();
+
+  /** FAI triangle as used by the task optimization of KFLog. */
+  static ScoringRule faiTriangle();
+
+  /** Out and return flight. */
+  static ScoringRule outAndReturn();
+
+  /** \return All rules above. */
+  static QList<ScoringRule> standardRules();
+};
+
+/**
+ * \class ScoringResult
+ *
+ * \brief The best task of a flight for one rule.
+ */
+class ScoringResult
+{
+ public:
+
+  ScoringResult() : valid(false), distance(0.0), points(0.0) {};
+
+  /** Name of the rule. */
+  QString rule;
+
+  /** False, if the flight has no task for the rule. */
+  bool valid;
+
+  /** Distance of the task in km. */
+  double distance;
+
+  /** Points of the task. */
+  double points;
+
+  /** Indices of the task fixes in the flight track. */
+  QVector<int> fixes;
+};
+
+/**
+ * \class ScoringEngine
+ *
+ * \author agent
+ *
+ * \brief Scores a flight for many contest rules in one pass.
+ *
+ * The engine selects candidate fixes of the flight and calculates the
+ * distances between all candidates once. All rules are solved on this
+ * shared table: the free distances by dynamic programming, all triangle
+ * like disciplines together in one enumeration of the candidate triples.
+ * At last the task of every rule is refined on the full track, by moving
+ * every task fix to the best fix in its neighbourhood.
+ *
+ * The engine uses no GUI elements and no global data. Different flights can
+ * be scored in parallel with different engines.
+ *
+ * \date 2026
+ */
+class ScoringEngine
+{
+ public:
+
+  ScoringEngine();
+
+  ~ScoringEngine();
+
+  /** Adds a rule to be scored. */
+  void addRule( const ScoringRule& rule );
+
+  /** Removes all rules. */
+  void clearRules();
+
+  const QList<ScoringRule>& rules() const
+  {
+    return m_rules;
+  };
+
+  /**
+   * Scores the fixes [first, last] of a flight for all rules.
+   *
+   * \param track The fixes of the flight.
+   *
+   * \param first Index of the first fix to be used.
+   *
+   * \param last Index of the last fix to be used, -1 for the last fix of
+   *        the track.
+   *
+   * \return One result for every rule, in the order of the rules.
+   */
+  QList<ScoringResult> score( const FlightTrack& track,
+                              const int first = 0,
+                              int last = -1 );
+
+ private:
+
+  /** Selects the candidate fixes and calculates their distance table. */
+  void __prepare( const FlightTrack& track, const int first, const int last );
+
+  /** Distance in km between the candidates i and j. */
+  double __dist( const int i, const int j ) const
+  {
+    return m_dist[i * m_n + j];
+  };
+
+  /** Solves a free distance rule on the candidates. */
+  void __solveFreeDistance( const ScoringRule& rule, ScoringResult& result );
+
+  /** Solves all triangle like rules in one pass over the candidates. */
+  void __solveTriangles( QList<ScoringResult>& results );
+
+  /**
+   * Moves every fix of a result to the best fix of the full track
+   * in its neighbourhood.
+   */
+  void __refine( const FlightTrack& track,
+                 const ScoringRule& rule,
+                 const int first,
+                 const int last,
+                 ScoringResult& result );
+
+  /**
+   * Points of a triangle like task with the given leg distances.
+   *
+   * \return The points or a negative value, if the task is not valid.
+   */
+  static double __trianglePoints( const ScoringRule& rule,
+                                  const double d1,
+                                  const double d2,
+                                  const double d3,
+                                  double& distance );
+
+  /**
+   * Points of a task given by fixes of the full track.
+   *
+   * \return The points or a negative value, if the task is not valid.
+   */
+  static double __evaluate( const FlightTrack& track,
+                            const ScoringRule& rule,
+                            const QVector<int>& fixes,
+                            double& distance );
+
+  QList<ScoringRule> m_rules;
+
+  /** Track indices of the candidate fixes. */
+  QVector<int> m_cand;
+
+  /** Number of candidates. */
+  int m_n;
+
+  /** Distances between all candidates in km. */
+  QVector<double> m_dist;
+
+  /** Distance of track indices between two candidates. */
+  int m_step;
+};
+
+#endif
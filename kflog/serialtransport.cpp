@@ -0,0 +1,306 @@
+/***********************************************************************
+**
+**   serialtransport.cpp
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <QtCore>
+
+#include "serialtransport.h"
+
+SerialTransport::SerialTransport() :
+  m_fd(-1),
+  m_baudRate(9600),
+  m_head(0),
+  m_count(0),
+  m_bytesRead(0),
+  m_bytesWritten(0)
+{
+  m_rateTimer.start();
+}
+
+SerialTransport::~SerialTransport()
+{
+}
+
+void SerialTransport::attach( const int fd )
+{
+  m_fd = fd;
+  m_txBuffer.clear();
+  m_head  = 0;
+  m_count = 0;
+
+  resetStatistics();
+}
+
+void SerialTransport::detach()
+{
+  if( m_fd != -1 )
+    {
+      flush();
+    }
+
+  m_fd = -1;
+  m_txBuffer.clear();
+  m_head  = 0;
+  m_count = 0;
+}
+
+int SerialTransport::transferTime( const int bytes ) const
+{
+  // A byte needs 10 bits on the line, start and stop bit included.
+  return static_cast<int> ( (qint64) bytes * 10 * 1000 / qMax( 1, m_baudRate ) );
+}
+
+void SerialTransport::write( const void* data, const int count )
+{
+  if( count > 0 )
+    {
+      m_txBuffer.append( static_cast<const char *> (data), count );
+    }
+}
+
+bool SerialTransport::flush( const int timeout )
+{
+  if( m_txBuffer.isEmpty() )
+    {
+      return true;
+    }
+
+  if( m_fd == -1 )
+    {
+      m_txBuffer.clear();
+      return false;
+    }
+
+  QElapsedTimer timer;
+  timer.start();
+
+  int done = 0;
+
+  while( done < m_txBuffer.size() )
+    {
+      const int remaining = timeout - timer.elapsed();
+
+      if( remaining < 0 )
+        {
+          break;
+        }
+
+      struct pollfd pfd;
+      pfd.fd      = m_fd;
+      pfd.events  = POLLOUT;
+      pfd.revents = 0;
+
+      const int rc = poll( &pfd, 1, remaining );
+
+      if( rc < 0 && errno == EINTR )
+        {
+          continue;
+        }
+
+      if( rc <= 0 || (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) )
+        {
+          break;
+        }
+
+      const ssize_t n = ::write( m_fd,
+                                 m_txBuffer.constData() + done,
+                                 m_txBuffer.size() - done );
+
+      if( n < 0 )
+        {
+          if( errno == EINTR || errno == EAGAIN )
+            {
+              continue;
+            }
+
+          qWarning( "SerialTransport::flush(): write error %d", errno );
+          break;
+        }
+
+      done += n;
+    }
+
+  m_bytesWritten += done;
+
+  const bool ok = ( done == m_txBuffer.size() );
+
+  // Bytes, which could not be written, are dropped. The protocols restart
+  // with a new command after an error.
+  m_txBuffer.clear();
+
+  return ok;
+}
+
+bool SerialTransport::__fill( const int timeout )
+{
+  if( m_fd == -1 || m_count == SERIAL_RING_SIZE )
+    {
+      return false;
+    }
+
+  struct pollfd pfd;
+  pfd.fd      = m_fd;
+  pfd.events  = POLLIN;
+  pfd.revents = 0;
+
+  int rc;
+
+  do
+    {
+      rc = poll( &pfd, 1, timeout );
+    }
+  while( rc < 0 && errno == EINTR );
+
+  if( rc <= 0 || ! (pfd.revents & POLLIN) )
+    {
+      return false;
+    }
+
+  // Read into the contiguous free part behind the unread bytes.
+  const int tail = ( m_head + m_count ) % SERIAL_RING_SIZE;
+  const int space = qMin( SERIAL_RING_SIZE - m_count, SERIAL_RING_SIZE - tail );
+
+  const ssize_t n = ::read( m_fd, m_ring + tail, space );
+
+  if( n <= 0 )
+    {
+      if( n < 0 && errno != EINTR && errno != EAGAIN )
+        {
+          qWarning( "SerialTransport::read(): read error %d", errno );
+        }
+
+      return false;
+    }
+
+  m_count     += n;
+  m_bytesRead += n;
+  return true;
+}
+
+int SerialTransport::__take( unsigned char* data, const int count )
+{
+  int taken = 0;
+
+  while( taken < count && m_count > 0 )
+    {
+      const int chunk = qMin( qMin( count - taken, m_count ),
+                              SERIAL_RING_SIZE - m_head );
+
+      memcpy( data + taken, m_ring + m_head, chunk );
+
+      taken   += chunk;
+      m_count -= chunk;
+      m_head   = ( m_head + chunk ) % SERIAL_RING_SIZE;
+    }
+
+  if( m_count == 0 )
+    {
+      m_head = 0;
+    }
+
+  return taken;
+}
+
+int SerialTransport::read( void* data, const int count, const int timeout )
+{
+  flush();
+
+  unsigned char* dest = static_cast<unsigned char *> (data);
+
+  QElapsedTimer timer;
+  timer.start();
+
+  int got = __take( dest, count );
+
+  while( got < count )
+    {
+      const int remaining = qMax( 0, timeout - (int) timer.elapsed() );
+
+      if( ! __fill( remaining ) )
+        {
+          if( timeout - (int) timer.elapsed() <= 0 )
+            {
+              break;
+            }
+
+          // Interrupted or hang up, retry until the deadline is reached.
+          usleep( 1000 );
+          continue;
+        }
+
+      got += __take( dest + got, count - got );
+    }
+
+  return got;
+}
+
+int SerialTransport::readByte( const int timeout )
+{
+  unsigned char c;
+
+  if( read( &c, 1, timeout ) != 1 )
+    {
+      return -1;
+    }
+
+  return c;
+}
+
+void SerialTransport::discard()
+{
+  flush();
+
+  if( m_fd != -1 )
+    {
+      tcflush( m_fd, TCIOFLUSH );
+    }
+
+  m_head  = 0;
+  m_count = 0;
+}
+
+void SerialTransport::drain()
+{
+  flush();
+
+  if( m_fd != -1 )
+    {
+      tcdrain( m_fd );
+    }
+}
+
+double SerialTransport::transferRate() const
+{
+  const qint64 elapsed = m_rateTimer.elapsed();
+
+  if( elapsed <= 0 )
+    {
+      return 0.0;
+    }
+
+  return (double) ( m_bytesRead + m_bytesWritten ) * 1000.0 / elapsed;
+}
+
+void SerialTransport::resetStatistics()
+{
+  m_bytesRead    = 0;
+  m_bytesWritten = 0;
+  m_rateTimer.restart();
+}
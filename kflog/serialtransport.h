@@ -0,0 +1,200 @@
+/***********************************************************************
+**
+**   serialtransport.h
+**
+**   This file is part of KFLog.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by agent
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#ifndef SERIAL_TRANSPORT_H
+#define SERIAL_TRANSPORT_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+
+// Size of the receive ring buffer in bytes
+#define SERIAL_RING_SIZE 4096
+
+/**
+ * \class SerialTransport
+ *
+ * \author agent
+ *
+ * \brief Buffered serial line access for the flight recorder plugins.
+ *
+ * The plugins open and configure their serial port themselves and attach
+ * the file descriptor to a transport object. Written bytes are collected in
+ * a send buffer and are written with a single call, when the transport is
+ * flushed or when a read is started. Received bytes are read in blocks
+ * into a ring buffer. All blocking operations wait with poll() and end at a
+ * deadline, also if the recorder stops sending.
+ *
+ * The transport counts the transferred bytes and calculates the transfer
+ * rate since the last reset of the statistics.
+ *
+ * The class is only available on Unix like systems.
+ *
+ * \date 2026
+ */
+class SerialTransport
+{
+ public:
+
+  SerialTransport();
+
+  virtual ~SerialTransport();
+
+  /**
+   * Attaches an open serial port. Buffers and statistics are reset.
+   */
+  void attach( const int fd );
+
+  /**
+   * Detaches the serial port without closing it. Pending output is
+   * written before.
+   */
+  void detach();
+
+  bool isOpen() const
+  {
+    return m_fd != -1;
+  };
+
+  int fd() const
+  {
+    return m_fd;
+  };
+
+  /**
+   * Sets the line speed in bits per second. It is used to calculate the
+   * expected duration of a transfer.
+   */
+  void setBaudRate( const int baudRate )
+  {
+    m_baudRate = baudRate;
+  };
+
+  int baudRate() const
+  {
+    return m_baudRate;
+  };
+
+  /**
+   * \return The time in milliseconds, which the transfer of the passed
+   *         number of bytes needs at the current line speed.
+   */
+  int transferTime( const int bytes ) const;
+
+  /** Appends a byte to the send buffer. */
+  void writeByte( const unsigned char c )
+  {
+    m_txBuffer.append( static_cast<char> (c) );
+  };
+
+  /** Appends a data block to the send buffer. */
+  void write( const void* data, const int count );
+
+  /**
+   * Writes the content of the send buffer to the serial port.
+   *
+   * \param timeout Maximum time in milliseconds to wait for the port.
+   *
+   * \return True, if all bytes have been written.
+   */
+  bool flush( const int timeout = 1000 );
+
+  /**
+   * Reads data from the serial port. A pending output is flushed before.
+   *
+   * \param data Destination of the read bytes.
+   *
+   * \param count Number of bytes to read.
+   *
+   * \param timeout Deadline in milliseconds for the whole read.
+   *
+   * \return The number of read bytes, which is less than count, if the
+   *         deadline has passed or an error occurred.
+   */
+  int read( void* data, const int count, const int timeout );
+
+  /**
+   * Reads a single byte.
+   *
+   * \return The read byte or -1 in case of a timeout.
+   */
+  int readByte( const int timeout );
+
+  /**
+   * Writes the pending output and discards all received but not yet
+   * read data of the port and of the ring buffer.
+   */
+  void discard();
+
+  /**
+   * Writes the pending output and waits until it has been transmitted
+   * by the port.
+   */
+  void drain();
+
+  /** \return The number of bytes read since the last reset. */
+  qint64 bytesRead() const
+  {
+    return m_bytesRead;
+  };
+
+  /** \return The number of bytes written since the last reset. */
+  qint64 bytesWritten() const
+  {
+    return m_bytesWritten;
+  };
+
+  /**
+   * \return The average transfer rate in bytes per second of both
+   *         directions since the last reset.
+   */
+  double transferRate() const;
+
+  /** Resets the byte counters and the rate timer. */
+  void resetStatistics();
+
+ private:
+
+  /**
+   * Waits for received data and reads all available bytes into the
+   * ring buffer.
+   *
+   * \return False in case of a timeout or an error.
+   */
+  bool __fill( const int timeout );
+
+  /** Copies up to count bytes from the ring buffer to data. */
+  int __take( unsigned char* data, const int count );
+
+  int m_fd;
+
+  int m_baudRate;
+
+  QByteArray m_txBuffer;
+
+  unsigned char m_ring[SERIAL_RING_SIZE];
+
+  /** Index of the first unread byte in the ring buffer. */
+  int m_head;
+
+  /** Number of unread bytes in the ring buffer. */
+  int m_count;
+
+  qint64 m_bytesRead;
+  qint64 m_bytesWritten;
+
+  QElapsedTimer m_rateTimer;
+};
+
+#endif
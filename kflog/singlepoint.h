@@ -111,6 +111,14 @@ class SinglePoint : public BaseMapElement
       return position;
     };
 
+  /**
+   * @return the projected position of the element as bounding box.
+   */
+  virtual QRect getBoundingBox() const
+    {
+      return QRect( position, QSize( 1, 1 ) );
+    };
+
   /**
    * Set the projected position of the element.
    */
@@ -202,7 +210,7 @@ class SinglePoint : public BaseMapElement
   /**
    * @return the comment text of the single point
    */
-  const QString& getComment()
+  const QString& getComment() const
     {
       return comment;
     };
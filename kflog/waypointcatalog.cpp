@@ -106,7 +106,9 @@ char* getLogin()
 WaypointCatalog::WaypointCatalog(const QString& name) :
   modified(false),
   activatedFilter(None),
-  onDisc(false)
+  onDisc(false),
+  m_indexedCount(0),
+  m_indexedLast(0)
 {
   static int catalogNr = 1;
 
@@ -1322,6 +1324,9 @@ bool WaypointCatalog::readCup (const QString& catalog)
 
   int lineNo = 0;
 
+  // The read waypoints are inserted after reading the whole file.
+  QList<Waypoint*> newWaypoints;
+
   QTextStream in(&file);
   in.setCodec( "ISO 8859-15" );
 
@@ -1630,11 +1635,7 @@ bool WaypointCatalog::readCup (const QString& catalog)
             }
         }
 
-      if( !insertWaypoint(w) )
-        {
-          qWarning("CUP Read (%d): Error inserting waypoint in catalog", lineNo);
-          break;
-        }
+      newWaypoints.append( w );
 
       // Store used waypoint name in set.
       names.insert( w->name );
@@ -1643,6 +1644,9 @@ bool WaypointCatalog::readCup (const QString& catalog)
   file.close();
   QApplication::restoreOverrideCursor();
 
+  // The duplicates are resolved in one pass after reading the file.
+  insertWaypoints( newWaypoints );
+
   onDisc = true;
   path = catalog;
   return true;
@@ -1734,6 +1738,9 @@ bool WaypointCatalog::readWelt2000(const QString& catalog)
       countryDict.insert( countryList[i] );
     }
 
+  // The read waypoints are inserted after reading the whole file.
+  QList<Waypoint*> newWaypoints;
+
   QTextStream in(&file);
   in.setCodec( "ISO 8859-15" );
 
@@ -2189,86 +2196,200 @@ bool WaypointCatalog::readWelt2000(const QString& catalog)
             }
         }
 
-      if( !insertWaypoint(wp) )
-        {
-          qWarning("Welt2000 Read (%d): Error inserting waypoint in catalog", lineNo);
-          break;
-        }
+      newWaypoints.append( wp );
     } // End of while( ! in.atEnd() )
 
   file.close();
   QApplication::restoreOverrideCursor();
 
+  // The duplicates are resolved in one pass after reading the file.
+  insertWaypoints( newWaypoints );
+
   onDisc = true;
   path = catalog;
   return true;
 }
 
 bool WaypointCatalog::insertWaypoint(Waypoint *newWaypoint)
+{
+  QList<Waypoint*> newWaypoints;
+  newWaypoints.append( newWaypoint );
+
+  return insertWaypoints( newWaypoints );
+}
+
+bool WaypointCatalog::insertWaypoints( const QList<Waypoint*>& newWaypoints )
 {
   bool result = true;
-  int index;
 
-  Waypoint *existingWaypoint = findWaypoint( newWaypoint->name, index );
+  // Answer of the user for all further existing waypoints.
+  int answerAll = QMessageBox::NoButton;
 
-  if( existingWaypoint != 0 )
+  __updateIndex();
+
+  wpList.reserve( wpList.size() + newWaypoints.size() );
+
+  for( int i = 0; i < newWaypoints.size(); i++ )
     {
+      Waypoint *newWaypoint = newWaypoints.at(i);
+
+      if( result == false )
+        {
+          // The user has aborted the insertion.
+          delete newWaypoint;
+          continue;
+        }
+
+      QHash<QString, int>::const_iterator it = m_nameIndex.constFind( newWaypoint->name );
+
+      if( it == m_nameIndex.constEnd() )
+        {
+          m_nameIndex.insert( newWaypoint->name, wpList.size() );
+          wpList.append( newWaypoint );
+          continue;
+        }
+
+      const int index = it.value();
+      Waypoint *existingWaypoint = wpList.at( index );
+
       // qDebug() << "FoundWP" << existingWaypoint->name;
 
-      if( existingWaypoint->name != newWaypoint->name ||
-          existingWaypoint->angle != newWaypoint->angle ||
-          existingWaypoint->comment != newWaypoint->comment ||
-          existingWaypoint->description != newWaypoint->description ||
-          existingWaypoint->distance != newWaypoint->distance ||
-          existingWaypoint->elevation != newWaypoint->elevation ||
-          existingWaypoint->fixTime != newWaypoint->fixTime ||
-          existingWaypoint->frequency != newWaypoint->frequency ||
-          existingWaypoint->icao != newWaypoint->icao ||
-          existingWaypoint->importance != newWaypoint->importance ||
-          existingWaypoint->origP != newWaypoint->origP ||
-          existingWaypoint->type != newWaypoint->type ||
-          existingWaypoint->country != newWaypoint->country )
-        {
-          switch( QMessageBox::warning( _mainWindow,
-                                        QObject::tr("Waypoint exists"),
-                                        "<html>" + QObject::tr("A waypoint with the name<BR><BR><B>%1</B><BR><BR>is already in current catalog.<BR><BR>Do you want to replace the existing waypoint?").arg(newWaypoint->name) + "</html>",
-                                        QMessageBox::Yes|QMessageBox::No|QMessageBox::Abort,
-                                        QMessageBox::Yes ) )
-            {
-            case QMessageBox::Abort:
-              delete newWaypoint;
-              result = false;
-              break;
+      if( __isEqual( existingWaypoint, newWaypoint ) )
+        {
+          delete newWaypoint;
+          continue;
+        }
 
-            case QMessageBox::No:
-              delete newWaypoint;
-              break;
+      int answer = answerAll;
 
-            case QMessageBox::Yes:
-            default:
-              delete wpList.takeAt(index);
-              wpList.append(newWaypoint);
-              break;
+      if( answer == QMessageBox::NoButton )
+        {
+          QMessageBox::StandardButtons buttons = QMessageBox::Yes|QMessageBox::No|QMessageBox::Abort;
+
+          if( i < newWaypoints.size() - 1 )
+            {
+              // More waypoints are following, offer an answer for all of them.
+              buttons |= QMessageBox::YesToAll|QMessageBox::NoToAll;
+            }
+
+          answer = QMessageBox::warning( _mainWindow,
+                                         QObject::tr("Waypoint exists"),
+                                         "<html>" + QObject::tr("A waypoint with the name<BR><BR><B>%1</B><BR><BR>is already in current catalog.<BR><BR>Do you want to replace the existing waypoint?").arg(newWaypoint->name) + "</html>",
+                                         buttons,
+                                         QMessageBox::Yes );
+
+          if( answer == QMessageBox::YesToAll )
+            {
+              answerAll = answer = QMessageBox::Yes;
+            }
+          else if( answer == QMessageBox::NoToAll )
+            {
+              answerAll = answer = QMessageBox::No;
             }
         }
+
+      switch( answer )
+        {
+        case QMessageBox::Abort:
+          delete newWaypoint;
+          result = false;
+          break;
+
+        case QMessageBox::No:
+          delete newWaypoint;
+          break;
+
+        case QMessageBox::Yes:
+        default:
+          // The new waypoint takes the list position of the existing one,
+          // so that the name index stays valid.
+          delete existingWaypoint;
+          wpList[index] = newWaypoint;
+          break;
+        }
     }
-  else
+
+  m_indexedCount = wpList.size();
+  m_indexedLast = wpList.isEmpty() ? 0 : wpList.last();
+  m_areaIndex.invalidate();
+
+  return result;
+}
+
+bool WaypointCatalog::__isEqual( const Waypoint* wp1, const Waypoint* wp2 )
+{
+  return ( wp1->name == wp2->name &&
+           wp1->angle == wp2->angle &&
+           wp1->comment == wp2->comment &&
+           wp1->description == wp2->description &&
+           wp1->distance == wp2->distance &&
+           wp1->elevation == wp2->elevation &&
+           wp1->fixTime == wp2->fixTime &&
+           wp1->frequency == wp2->frequency &&
+           wp1->icao == wp2->icao &&
+           wp1->importance == wp2->importance &&
+           wp1->origP == wp2->origP &&
+           wp1->type == wp2->type &&
+           wp1->country == wp2->country );
+}
+
+void WaypointCatalog::__updateIndex()
+{
+  const int count = wpList.size();
+
+  if( m_indexedCount > count ||
+      ( m_indexedCount > 0 && wpList.at( m_indexedCount - 1 ) != m_indexedLast ) )
     {
-      wpList.append( newWaypoint );
+      // The list was changed not only by appending, rebuild the index.
+      m_nameIndex.clear();
+      m_indexedCount = 0;
+      m_areaIndex.invalidate();
     }
 
-  return result;
+  if( m_indexedCount == count )
+    {
+      return;
+    }
+
+  for( int i = m_indexedCount; i < count; i++ )
+    {
+      // The first waypoint with a name is found, like by a linear search.
+      if( ! m_nameIndex.contains( wpList.at(i)->name ) )
+        {
+          m_nameIndex.insert( wpList.at(i)->name, i );
+        }
+    }
+
+  m_indexedCount = count;
+  m_indexedLast = wpList.last();
+  m_areaIndex.invalidate();
+}
+
+void WaypointCatalog::invalidateIndex()
+{
+  m_nameIndex.clear();
+  m_indexedCount = 0;
+  m_indexedLast = 0;
+  m_areaIndex.invalidate();
 }
 
 Waypoint *WaypointCatalog::findWaypoint( const QString& name, int &index )
 {
-  for( int i=0; i < wpList.size(); i++ )
+  __updateIndex();
+
+  QHash<QString, int>::const_iterator it = m_nameIndex.constFind( name );
+
+  if( it != m_nameIndex.constEnd() )
     {
-      if( wpList.at(i)->name == name )
+      if( it.value() < wpList.size() && wpList.at( it.value() )->name == name )
         {
-          index = i;
-          return wpList.at(i);
+          index = it.value();
+          return wpList.at( index );
         }
+
+      // The index is outdated, the list was modified in place.
+      invalidateIndex();
+      return findWaypoint( name, index );
     }
 
   index = -1;
@@ -2278,16 +2399,66 @@ Waypoint *WaypointCatalog::findWaypoint( const QString& name, int &index )
 
 bool WaypointCatalog::removeWaypoint( const QString& name )
 {
-  for( int i = 0; i < wpList.size(); i++ )
+  int index;
+
+  if( findWaypoint( name, index ) == 0 )
     {
-      if( wpList.at(i)->name == name )
+      return false;
+    }
+
+  delete wpList.takeAt( index );
+
+  // The positions behind the removed waypoint are shifted.
+  invalidateIndex();
+
+  return true;
+}
+
+QVector<int> WaypointCatalog::findWaypoints( const QRect& area )
+{
+  __updateIndex();
+
+  if( ! m_areaIndex.isValid( wpList.size() ) )
+    {
+      QVector<QRect> boxes( wpList.size() );
+
+      for( int i = 0; i < wpList.size(); i++ )
         {
-          delete wpList.takeAt(i);
-          return true;
+          boxes[i] = QRect( wpList.at(i)->origP, QSize( 1, 1 ) );
         }
+
+      m_areaIndex.build( boxes );
     }
 
-  return false;
+  return m_areaIndex.query( area.normalized() );
+}
+
+QVector<int> WaypointCatalog::findWaypoints( const WGSPoint& center, const double radius )
+{
+  // Extent of the radius in KFLog degrees, with a small margin.
+  const double kflPerKm = ( 360.0 * 600000.0 ) / ( 2.0 * M_PI * RADIUS / 1000.0 );
+
+  const int dLat = (int) ceil( radius * kflPerKm * 1.01 );
+
+  // The longitude extent is taken at the latitude nearest to the pole.
+  const double maxLat = qMin( 90.0 * 600000.0, fabs( (double) center.lat() ) + dLat );
+  const double cosLat = cos( maxLat * M_PI / ( 180.0 * 600000.0 ) );
+
+  int dLon = 360 * 600000;
+
+  if( cosLat > 0.01 )
+    {
+      dLon = qMin( dLon, (int) ceil( dLat / cosLat ) );
+    }
+
+  if( qAbs( center.lon() ) + dLon > 180 * 600000 )
+    {
+      // The radius crosses the date line, take all longitudes.
+      dLon = 360 * 600000;
+    }
+
+  return findWaypoints( QRect( QPoint( center.lat() - dLat, center.lon() - dLon ),
+                               QPoint( center.lat() + dLat, center.lon() + dLon ) ) );
 }
 
 QList<QString> WaypointCatalog::splitCupLine( QString& line, bool &ok )
@@ -2418,6 +2589,9 @@ bool WaypointCatalog::readDat(const QString &catalog)
 
   int lineNo = 0;
 
+  // The read waypoints are inserted after reading the whole file.
+  QList<Waypoint*> newWaypoints;
+
   QTextStream in(&file);
   in.setCodec( "ISO 8859-15" );
 
@@ -2697,11 +2871,7 @@ bool WaypointCatalog::readDat(const QString &catalog)
             }
         }
 
-      if( !insertWaypoint(w) )
-        {
-          qWarning("DAT Read (%d): Error inserting waypoint in catalog", lineNo);
-          break;
-        }
+      newWaypoints.append( w );
 
       // Store used waypoint name in set.
       names.insert( w->name );
@@ -2710,6 +2880,9 @@ bool WaypointCatalog::readDat(const QString &catalog)
   file.close();
   QApplication::restoreOverrideCursor();
 
+  // The duplicates are resolved in one pass after reading the file.
+  insertWaypoints( newWaypoints );
+
   onDisc = true;
   path = catalog;
   return true;
@@ -32,8 +32,13 @@
 #ifndef WAYPOINT_CATALOG_H
 #define WAYPOINT_CATALOG_H
 
+#include <QHash>
 #include <QList>
+#include <QRect>
 #include <QSet>
+#include <QVector>
+
+#include "mapelementindex.h"
 
 class QString;
 class Waypoint;
@@ -104,6 +109,18 @@ public:
   /** insert a new waypoint into the list and check if waypoint already exist */
   bool insertWaypoint(Waypoint *newWaypoint);
 
+  /**
+   * Inserts a list of new waypoints in one pass. Waypoints with a name
+   * already existing in the catalog or earlier in the list are resolved
+   * like by \ref insertWaypoint. The catalog takes the ownership of all
+   * passed waypoints.
+   *
+   * \param newWaypoints Waypoints to be inserted.
+   *
+   * \return False, if the user has aborted the insertion.
+   */
+  bool insertWaypoints( const QList<Waypoint*>& newWaypoints );
+
   /**
    * Find a waypoint by using its name as search key.
    *
@@ -117,6 +134,36 @@ public:
 
   bool removeWaypoint(const QString& name);
 
+  /**
+   * Searches the waypoints in an area.
+   *
+   * \param area Area in KFLog coordinates, x is the latitude and y the
+   *             longitude.
+   *
+   * \return The ascending list indexes of the waypoints, which can be in
+   *         the area. The caller has to do the exact check.
+   */
+  QVector<int> findWaypoints( const QRect& area );
+
+  /**
+   * Searches the waypoints around a center point.
+   *
+   * \param center Center point of the search.
+   *
+   * \param radius Search radius in kilometers.
+   *
+   * \return The ascending list indexes of the waypoints, which can be in
+   *         the radius. The caller has to do the exact check.
+   */
+  QVector<int> findWaypoints( const WGSPoint& center, const double radius );
+
+  /**
+   * Must be called, if the name or the position of a waypoint in wpList
+   * was changed. Appending and removing of waypoints is detected by the
+   * catalog itself.
+   */
+  void invalidateIndex();
+
   /**
    * \return The center point of the radius.
    */
@@ -142,6 +189,15 @@ private:
    */
   QList<QString> splitCupLine( QString& line, bool &ok );
 
+  /**
+   * Brings the name index up to date with wpList. Appended waypoints are
+   * added to the index, after other changes it is rebuilt.
+   */
+  void __updateIndex();
+
+  /** Checks, if two waypoints contain the same data. */
+  static bool __isEqual( const Waypoint* wp1, const Waypoint* wp2 );
+
 public:
 
   /** filter values for display/import */
@@ -189,6 +245,18 @@ private: // Private attributes
 
   /** Set of existing catalog pathes. */
   static QSet<QString> catalogSet;
+
+  /** List indexes of the waypoints by name. */
+  QHash<QString, int> m_nameIndex;
+
+  /** Number of waypoints in the name index. */
+  int m_indexedCount;
+
+  /** Last waypoint in the name index, used to detect changes of wpList. */
+  Waypoint* m_indexedLast;
+
+  /** Spatial index of the waypoint positions. */
+  MapElementIndex m_areaIndex;
 };
 
 #endif
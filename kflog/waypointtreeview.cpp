@@ -612,6 +612,8 @@ void WaypointTreeView::slotEditWaypoint(Waypoint* w)
               w->rwyList.insert(0, rwy);
             }
 
+          // Name and position of the waypoint can be changed.
+          currentWaypointCatalog->invalidateIndex();
           currentWaypointCatalog->modified = true;
           slotFillWaypoints();
         }
@@ -30,6 +30,7 @@
 #include "mapcalc.h"
 #include "mapcontents.h"
 #include "mapmatrix.h"
+#include "poicache.h"
 #include "resource.h"
 #include "runway.h"
 #include "wgspoint.h"
@@ -219,6 +220,39 @@ bool Welt2000::parse( QString& path,
   qDebug() << "W2000: Read Outlandings=" << outlandings;
   qDebug( "W2000: Home radius is set to %.1f Km", c_homeRadius );
 
+  // All settings, which influence the parsing result, are part of the key
+  // of the compiled file.
+  QPoint homePos = _globalMapMatrix->getHomeCoord();
+
+  QString filterKey = c_countryList.join(",") + ";" +
+                      QString::number( outlandings ) + ";" +
+                      QString::number( c_homeRadius ) + ";" +
+                      QString::number( homePos.x() ) + "," +
+                      QString::number( homePos.y() );
+
+  PoiCache cache( filterKey.toUtf8() );
+  QList< QList<Airfield> > compiledLists;
+
+  if( cache.load( path, compiledLists ) && compiledLists.size() == 3 )
+    {
+      in.close();
+
+      airfieldList    += compiledLists.at(0);
+      gliderfieldList += compiledLists.at(1);
+      outlandingList  += compiledLists.at(2);
+
+      qDebug( "W2000: %d items loaded from compiled file in %dms",
+              compiledLists.at(0).size() + compiledLists.at(1).size() +
+              compiledLists.at(2).size(), t.elapsed() );
+
+      return true;
+    }
+
+  // Only the parsed entries are stored in the compiled file.
+  const int afStart = airfieldList.size();
+  const int glStart = gliderfieldList.size();
+  const int olStart = outlandingList.size();
+
   // put all entries of country list into a dictionary for faster
   // access
   QHash<QString, QString> countryDict;
@@ -850,6 +884,12 @@ bool Welt2000::parse( QString& path,
 
   in.close();
 
+  compiledLists << airfieldList.mid( afStart )
+                << gliderfieldList.mid( glStart )
+                << outlandingList.mid( olStart );
+
+  cache.save( path, compiledLists );
+
   qDebug( "W2000, Statistics from file %s: Parsing Time=%dms, Sum=%d, Airfields=%d, GL=%d, UL=%d, OL=%d",
           basename(path.toLatin1().data()), t.elapsed(), af+gl+ul+ol, af, gl, ul, ol );
 